@@ -0,0 +1,52 @@
+#include <prayground/prayground.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+using namespace prayground;
+
+/**
+ * Offline optimization of RGBToSpectrumTable.
+ * Usage: rgb2spectrum_opt <resolution> <output> [srgb|acescg]
+ * The output is loaded by RGBToSpectrumTable::load() at runtime.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        cerr << "Usage: " << argv[0] << " <resolution> <output> [srgb|acescg]" << endl;
+        return 1;
+    }
+
+    const int resolution = atoi(argv[1]);
+    if (resolution < 2)
+    {
+        cerr << "The resolution must be at least 2." << endl;
+        return 1;
+    }
+
+    RGBColorSpace color_space = RGBColorSpace::sRGB;
+    if (argc > 3)
+    {
+        if (strcmp(argv[3], "srgb") == 0)
+            color_space = RGBColorSpace::sRGB;
+        else if (strcmp(argv[3], "acescg") == 0)
+            color_space = RGBColorSpace::ACEScg;
+        else
+        {
+            cerr << "Unknown color space '" << argv[3] << "'. Use srgb or acescg." << endl;
+            return 1;
+        }
+    }
+
+    pgLog("Optimizing RGB to spectrum table with resolution", resolution, "...");
+    const auto start = chrono::steady_clock::now();
+    RGBToSpectrumTable table = RGBToSpectrumTable::optimize(color_space, resolution);
+    const auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+    pgLog("Optimization finished in", elapsed, "ms");
+
+    table.save(argv[2]);
+    pgLog("Saved the table to '" + string(argv[2]) + "'");
+    return 0;
+}
@@ -60,11 +60,13 @@ void App::setup()
 
     // OptixModuleをCUDAファイルから生成
     Module raygen_module, miss_module, hitgroups_module, textures_module, surfaces_module;
-    raygen_module = pipeline.createModuleFromCudaFile(context, "cuda/raygen.cu");
-    miss_module = pipeline.createModuleFromCudaFile(context, "cuda/miss.cu");
-    hitgroups_module = pipeline.createModuleFromCudaFile(context, "cuda/hitgroups.cu");
-    textures_module = pipeline.createModuleFromCudaFile(context, "cuda/textures.cu");
-    surfaces_module = pipeline.createModuleFromCudaFile(context, "cuda/surfaces.cu");
+    auto modules = pipeline.createModulesFromCudaFiles(context,
+        { "cuda/raygen.cu", "cuda/miss.cu", "cuda/hitgroups.cu", "cuda/textures.cu", "cuda/surfaces.cu" });
+    raygen_module = modules[0];
+    miss_module = modules[1];
+    hitgroups_module = modules[2];
+    textures_module = modules[3];
+    surfaces_module = modules[4];
 
     // レンダリング結果を保存する用のBitmapを用意
     result_bitmap.allocate(PixelFormat::RGBA, pgGetWidth(), pgGetHeight());
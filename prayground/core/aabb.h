@@ -2,6 +2,7 @@
 
 #include <optix.h>
 #include <prayground/math/vec.h>
+#include <cfloat>
 
 #ifndef __CUDACC__
 #include <prayground/core/stream_helpers.h>
@@ -11,35 +12,76 @@ namespace prayground {
 
     class AABB {
     public:
-        AABB() : m_min(Vec3f(0.f)), m_max(Vec3f(0.f)) {}
-        AABB(Vec3f min, Vec3f max) : m_min(min), m_max(max) {}
+        HOSTDEVICE AABB() : m_min(Vec3f(0.f)), m_max(Vec3f(0.f)) {}
+        HOSTDEVICE AABB(Vec3f min, Vec3f max) : m_min(min), m_max(max) {}
         HOSTDEVICE const Vec3f& min() const { return m_min; }
         HOSTDEVICE const Vec3f& max() const { return m_max; }
 
-        explicit operator OptixAabb() { return {m_min[0], m_min[1], m_min[2], m_max[0], m_max[1], m_max[2]}; }
+        explicit operator OptixAabb() const { return {m_min[0], m_min[1], m_min[2], m_max[0], m_max[1], m_max[2]}; }
 
-        float surfaceArea() {
-            float dx = m_max[0] - m_min[0];
-            float dy = m_max[1] - m_max[1];
-            float dz = m_max[2] - m_max[2];
-            return 2*(dx*dy + dy*dz + dz*dx);
+        /* Starting point of accumulation with merge()/expand(). It is not valid until something is added. */
+        static HOSTDEVICE AABB empty() { return AABB(Vec3f(FLT_MAX), Vec3f(-FLT_MAX)); }
+
+        HOSTDEVICE bool isValid() const
+        {
+            return m_min[0] <= m_max[0] && m_min[1] <= m_max[1] && m_min[2] <= m_max[2];
+        }
+
+        HOSTDEVICE Vec3f extent() const { return m_max - m_min; }
+        HOSTDEVICE Vec3f centroid() const { return (m_min + m_max) * 0.5f; }
+
+        HOSTDEVICE int longestAxis() const
+        {
+            const Vec3f e = extent();
+            if (e[0] >= e[1] && e[0] >= e[2]) return 0;
+            return e[1] >= e[2] ? 1 : 2;
+        }
+
+        // 0 for invalid boxes, so that empty children don't contribute to the SAH
+        HOSTDEVICE float surfaceArea() const { return 2.0f * halfArea(); }
+
+        // Half of the surface area. The factor 2 cancels out in the ratios of the SAH.
+        HOSTDEVICE float halfArea() const
+        {
+            if (!isValid())
+                return 0.0f;
+            const float dx = m_max[0] - m_min[0];
+            const float dy = m_max[1] - m_min[1];
+            const float dz = m_max[2] - m_min[2];
+            return dx*dy + dy*dz + dz*dx;
+        }
+
+        // NaN coordinates of the argument are ignored. min()/max() compile to minss/maxss on the host unlike fminf()/fmaxf().
+        HOSTDEVICE void expand(const Vec3f& p)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                m_min[i] = prayground::min(p[i], m_min[i]);
+                m_max[i] = prayground::max(p[i], m_max[i]);
+            }
+        }
+
+        HOSTDEVICE void expand(const AABB& box)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                m_min[i] = prayground::min(box.m_min[i], m_min[i]);
+                m_max[i] = prayground::max(box.m_max[i], m_max[i]);
+            }
+        }
+
+        static HOSTDEVICE AABB merge(const AABB& box0, const AABB& box1)
+        {
+            AABB ret = box0;
+            ret.expand(box1);
+            return ret;
         }
 
-        static AABB merge(AABB box0, AABB box1)
+        static HOSTDEVICE AABB merge(const AABB& box, const Vec3f& p)
         {
-            Vec3f min_box = Vec3f(
-                fmin(box0.min()[0], box1.min()[0]),
-                fmin(box0.min()[1], box1.min()[1]),
-                fmin(box0.min()[2], box1.min()[2])
-            );
-
-            Vec3f max_box = Vec3f(
-                fmax(box0.max()[0], box1.max()[0]),
-                fmax(box0.max()[1], box1.max()[1]),
-                fmax(box0.max()[2], box1.max()[2])
-            );
-
-            return AABB(min_box, max_box);
+            AABB ret = box;
+            ret.expand(p);
+            return ret;
         }
     private:
         Vec3f m_min, m_max;
@@ -50,9 +92,9 @@ namespace prayground {
     inline std::ostream& operator<<(std::ostream& out, const AABB& aabb)
     {
         out << "min: " << aabb.min() << ", max: " << aabb.max();
-        return out; 
+        return out;
     }
 
 #endif
 
-} // namespace prayground
\ No newline at end of file
+} // namespace prayground
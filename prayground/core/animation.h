@@ -0,0 +1,195 @@
+#pragma once
+
+#ifndef __CUDACC__
+
+#include <prayground/core/keypoint.h>
+#include <prayground/core/parallel.h>
+#include <prayground/core/util.h>
+#include <prayground/math/matrix.h>
+#include <algorithm>
+#include <vector>
+
+namespace prayground {
+
+    /**
+     * @brief
+     * Sorted keys of an animated value. Times and values are stored in separate arrays,
+     * so the search over the times doesn't touch the values.
+     * The easing between keys is fixed by E at compile time.
+     *
+     * @note evaluate() searches the bracketing keys in O(log n). evaluateCached() first
+     *       tries the segment of the previous call and the next one, which is O(1) while
+     *       the time advances frame by frame. It updates the hint, so a track must not be
+     *       evaluated with evaluateCached() from multiple threads at once.
+     */
+    template <typename T, EaseType E = EaseType::Linear>
+    class AnimationTrack {
+    public:
+        using ValueType = T;
+        static constexpr EaseType ease_type = E;
+
+        AnimationTrack() = default;
+
+        explicit AnimationTrack(std::vector<Keypoint<T>> keypoints)
+        {
+            // Keys with the same time keep their order, which makes a step at that time
+            std::stable_sort(keypoints.begin(), keypoints.end(),
+                [](const Keypoint<T>& a, const Keypoint<T>& b) { return a.t < b.t; });
+            m_times.reserve(keypoints.size());
+            m_values.reserve(keypoints.size());
+            for (const auto& k : keypoints)
+            {
+                m_times.push_back(k.t);
+                m_values.push_back(k.value);
+            }
+        }
+
+        void addKeypoint(const Keypoint<T>& keypoint)
+        {
+            const auto it = std::upper_bound(m_times.begin(), m_times.end(), keypoint.t);
+            const size_t i = static_cast<size_t>(it - m_times.begin());
+            m_times.insert(it, keypoint.t);
+            m_values.insert(m_values.begin() + i, keypoint.value);
+            m_hint = 0;
+        }
+
+        void removeKeypoint(size_t index)
+        {
+            if (index >= m_times.size())
+            {
+                pgLogWarn("Invalid index:", index);
+                return;
+            }
+            m_times.erase(m_times.begin() + index);
+            m_values.erase(m_values.begin() + index);
+            m_hint = 0;
+        }
+
+        Keypoint<T> keypoint(size_t index) const { return Keypoint<T>{ m_values[index], m_times[index] }; }
+        size_t numKeypoints() const { return m_times.size(); }
+        bool empty() const { return m_times.empty(); }
+
+        float startTime() const { return m_times.front(); }
+        float endTime() const { return m_times.back(); }
+
+        // Value at t. The first/last values are held outside the keys.
+        T evaluate(float t) const
+        {
+            return evaluateSegment(t, findSegment(t));
+        }
+
+        T evaluateCached(float t)
+        {
+            m_hint = findSegment(t, m_hint);
+            return evaluateSegment(t, m_hint);
+        }
+
+        // Index i of the keys with times[i] <= t < times[i + 1], clamped to [0, n - 2]
+        uint32_t findSegment(float t) const
+        {
+            const size_t n = m_times.size();
+            if (n < 2)
+                return 0;
+            const size_t i = static_cast<size_t>(std::upper_bound(m_times.begin(), m_times.end(), t) - m_times.begin());
+            return static_cast<uint32_t>(std::clamp<size_t>(i, 1, n - 1) - 1);
+        }
+
+        uint32_t findSegment(float t, uint32_t hint) const
+        {
+            const size_t n = m_times.size();
+            if (hint + 1 < n && m_times[hint] <= t)
+            {
+                if (t < m_times[hint + 1])
+                    return hint;
+                if (hint + 2 < n && t < m_times[hint + 2])
+                    return hint + 1;
+            }
+            return findSegment(t);
+        }
+    private:
+        T evaluateSegment(float t, uint32_t i) const
+        {
+            ASSERT(!m_times.empty(), "The animation track has no keypoints.");
+            if (t <= m_times.front())
+                return m_values.front();
+            if (t >= m_times.back())
+                return m_values.back();
+            return Keypoint<T>::template ease<E>(keypoint(i), keypoint(i + 1), t);
+        }
+
+        std::vector<float> m_times;
+        std::vector<T> m_values;
+        uint32_t m_hint { 0 };
+    };
+
+    /**
+     * @brief
+     * Translation, rotation and scale channels of an object. Rotation is XYZ Euler angles in radians,
+     * applied in the order of x, y and z. Empty channels are the identity.
+     * The matrix is translate * rotate * scale, as the transforms passed to Scene::addObject().
+     */
+    template <EaseType E = EaseType::Linear>
+    struct TransformTrack {
+        AnimationTrack<Vec3f, E> translation;
+        AnimationTrack<Vec3f, E> rotation;
+        AnimationTrack<Vec3f, E> scale;
+
+        Matrix4f evaluate(float t) const
+        {
+            return compose(
+                translation.empty() ? Vec3f(0.0f) : translation.evaluate(t),
+                rotation.empty() ? Vec3f(0.0f) : rotation.evaluate(t),
+                scale.empty() ? Vec3f(1.0f) : scale.evaluate(t));
+        }
+
+        Matrix4f evaluateCached(float t)
+        {
+            return compose(
+                translation.empty() ? Vec3f(0.0f) : translation.evaluateCached(t),
+                rotation.empty() ? Vec3f(0.0f) : rotation.evaluateCached(t),
+                scale.empty() ? Vec3f(1.0f) : scale.evaluateCached(t));
+        }
+
+        // Closed form of translate(t) * rotate(z) * rotate(y) * rotate(x) * scale(s)
+        static Matrix4f compose(const Vec3f& t, const Vec3f& r, const Vec3f& s)
+        {
+            const float sx = sinf(r.x()), cx = cosf(r.x());
+            const float sy = sinf(r.y()), cy = cosf(r.y());
+            const float sz = sinf(r.z()), cz = cosf(r.z());
+            return Matrix4f({
+                cz * cy * s.x(), (cz * sy * sx - sz * cx) * s.y(), (cz * sy * cx + sz * sx) * s.z(), t.x(),
+                sz * cy * s.x(), (sz * sy * sx + cz * cx) * s.y(), (sz * sy * cx - cz * sx) * s.z(), t.y(),
+                -sy * s.x(),     cy * sx * s.y(),                  cy * cx * s.z(),                  t.z(),
+                0.0f,            0.0f,                             0.0f,                             1.0f
+            });
+        }
+    };
+
+    /**
+     * Evaluate every track at t into out[0 ... tracks.size()). Tracks are distributed over host threads
+     * and use their cached segments, so evaluating frames in order costs O(1) per track.
+     * The results are contiguous, e.g. for Scene::updateObjectTransform() of each object.
+     */
+    template <typename T, EaseType E>
+    inline void evaluateTracks(std::vector<AnimationTrack<T, E>>& tracks, float t, T* out)
+    {
+        parallelForChunks(0, tracks.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                out[i] = tracks[i].evaluateCached(t);
+        }, 4096);
+    }
+
+    template <EaseType E>
+    inline void evaluateTracks(std::vector<TransformTrack<E>>& tracks, float t, Matrix4f* out)
+    {
+        parallelForChunks(0, tracks.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                out[i] = tracks[i].evaluateCached(t);
+        }, 1024);
+    }
+
+} // namespace prayground
+
+#endif // __CUDACC__
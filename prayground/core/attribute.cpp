@@ -1,139 +1,306 @@
 #include "attribute.h"
-#include <optional>
+#include <prayground/core/util.h>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
 
 namespace prayground {
 
-    #define FIND_PTR(items)                 \
-        for (const auto& item : items)      \
-        {                                   \
-            if (item->name == name)         \
-            {                               \
-                *n = item->numValues;       \
-                return item->values.get();  \
-            }                               \
-        }                                   \
-        return nullptr;
-
-    #define FIND_ONE(items)                                 \
-        for (const auto& item : items)                      \
-        {                                                   \
-            if (item->name == name && item->numValues == 1) \
-                return *(item->values.get());               \
-        }                                                   \
-        return d;                              
+    namespace {
+        constexpr size_t kMaxLinearSearch = 16;
+    } // nonamed namespace
 
     // Attributes
     // --------------------------------------------------------------------------------------
-    Attributes::Attributes() 
+    Attributes::Attributes()
     {
-    
+
+    }
+
+    // --------------------------------------------------------------------------------------
+    const Attributes::Entry* Attributes::findEntry(std::string_view name, AttribType type) const
+    {
+        if (!m_storage)
+            return nullptr;
+
+        const Storage& storage = *m_storage;
+
+        // A few entries, e.g. parameters of a material, are found faster by comparing
+        // the types and lengths than by hashing the name
+        if (storage.entries.size() <= kMaxLinearSearch)
+        {
+            for (const Entry& entry : storage.entries)
+            {
+                if (entry.type == type && entry.name_length == name.size()
+                    && std::memcmp(storage.names.data() + entry.name_offset, name.data(), name.size()) == 0)
+                    return &entry;
+            }
+            return nullptr;
+        }
+
+        const uint64_t hash = fnv1a(name);
+        const size_t mask = storage.slots.size() - 1;
+        for (size_t i = static_cast<size_t>(hash) & mask; storage.slots[i] != 0; i = (i + 1) & mask)
+        {
+            const Entry& entry = storage.entries[storage.slots[i] - 1];
+            if (entry.hash == hash && entry.type == type
+                && std::string_view(storage.names).substr(entry.name_offset, entry.name_length) == name)
+                return &entry;
+        }
+        return nullptr;
+    }
+
+    void Attributes::insertSlot(Storage& storage, uint32_t entry_index)
+    {
+        const size_t mask = storage.slots.size() - 1;
+        size_t i = static_cast<size_t>(storage.entries[entry_index].hash) & mask;
+        while (storage.slots[i] != 0)
+            i = (i + 1) & mask;
+        storage.slots[i] = entry_index + 1;
+    }
+
+    template <typename T>
+    void Attributes::add(AttribType type, const std::string& name, const T* values, int n)
+    {
+        Entry entry;
+        entry.hash = fnv1a(name);
+        entry.name_length = static_cast<uint32_t>(name.size());
+        entry.type = type;
+        entry.num_values = n;
+
+        // Entries with the same name are on the same probe sequence regardless of the type,
+        // so the interned name is shared with them.
+        bool interned = false;
+        if (m_storage)
+        {
+            const Storage& storage = *m_storage;
+            const size_t mask = storage.slots.size() - 1;
+            for (size_t i = static_cast<size_t>(entry.hash) & mask; storage.slots[i] != 0; i = (i + 1) & mask)
+            {
+                const Entry& e = storage.entries[storage.slots[i] - 1];
+                if (e.hash != entry.hash || std::string_view(storage.names).substr(e.name_offset, e.name_length) != name)
+                    continue;
+                if (e.type == type)
+                    return;
+                entry.name_offset = e.name_offset;
+                interned = true;
+            }
+        }
+
+        // Copy the table if it is shared with other Attributes. The storage is never created as const,
+        // so the one only this object refers to can be modified in place.
+        std::shared_ptr<Storage> storage;
+        if (!m_storage)
+            storage = std::make_shared<Storage>();
+        else if (m_storage.use_count() > 1)
+            storage = std::make_shared<Storage>(*m_storage);
+        else
+            storage = std::const_pointer_cast<Storage>(m_storage);
+
+        if (!interned)
+        {
+            entry.name_offset = static_cast<uint32_t>(storage->names.size());
+            storage->names += name;
+        }
+
+        if constexpr (std::is_same_v<T, std::string>)
+        {
+            entry.offset = static_cast<uint32_t>(storage->strings.size());
+            storage->strings.insert(storage->strings.end(), values, values + n);
+        }
+        else
+        {
+            std::vector<Chunk>& arena = storage->arena;
+            const size_t num_bytes = sizeof(T) * static_cast<size_t>(n);
+            entry.offset = static_cast<uint32_t>(arena.size());
+            arena.resize(arena.size() + (num_bytes + sizeof(Chunk) - 1) / sizeof(Chunk));
+            if (num_bytes > 0)
+                std::memcpy(arena.data() + entry.offset, values, num_bytes);
+        }
+
+        storage->entries.push_back(entry);
+
+        // Keep the load factor at most 1/2
+        if (storage->slots.size() < storage->entries.size() * 2)
+        {
+            storage->slots.assign(std::max<size_t>(16, storage->slots.size() * 2), 0);
+            for (uint32_t i = 0; i < static_cast<uint32_t>(storage->entries.size()); i++)
+                insertSlot(*storage, i);
+        }
+        else
+        {
+            insertSlot(*storage, static_cast<uint32_t>(storage->entries.size() - 1));
+        }
+
+        m_storage = std::move(storage);
+    }
+
+    template <typename T>
+    const T* Attributes::find(AttribType type, std::string_view name, int* n) const
+    {
+        const Entry* entry = findEntry(name, type);
+        if (!entry)
+            return nullptr;
+        *n = entry->num_values;
+        if constexpr (std::is_same_v<T, std::string>)
+            return m_storage->strings.data() + entry->offset;
+        else
+            return reinterpret_cast<const T*>(m_storage->arena.data() + entry->offset);
+    }
+
+    bool Attributes::contains(std::string_view name, AttribType type) const
+    {
+        return findEntry(name, type) != nullptr;
     }
 
     // --------------------------------------------------------------------------------------
     void Attributes::addBool(const std::string& name, std::unique_ptr<bool[]> values, int n)
     {
-        m_bools.emplace_back(new AttribItem<bool>(name, std::move(values), n));
+        add(AttribType::Bool, name, values.get(), n);
     }
 
     void Attributes::addInt(const std::string& name, std::unique_ptr<int[]> values, int n)
     {
-        m_ints.emplace_back(new AttribItem<int>(name, std::move(values), n));
-    }   
+        add(AttribType::Int, name, values.get(), n);
+    }
 
     void Attributes::addFloat(const std::string& name, std::unique_ptr<float[]> values, int n)
     {
-        m_floats.emplace_back(new AttribItem<float>(name, std::move(values), n));
+        add(AttribType::Float, name, values.get(), n);
     }
 
     void Attributes::addVec2f(const std::string& name, std::unique_ptr<Vec2f[]> values, int n)
     {
-        m_Vec2fs.emplace_back(new AttribItem<Vec2f>(name, std::move(values), n));
+        add(AttribType::Vec2f, name, values.get(), n);
     }
 
     void Attributes::addVec3f(const std::string& name, std::unique_ptr<Vec3f[]> values, int n)
     {
-        m_Vec3fs.emplace_back(new AttribItem<Vec3f>(name, std::move(values), n));
+        add(AttribType::Vec3f, name, values.get(), n);
     }
 
     void Attributes::addVec4f(const std::string& name, std::unique_ptr<Vec4f[]> values, int n)
     {
-        m_Vec4fs.emplace_back(new AttribItem<Vec4f>(name, std::move(values), n));
+        add(AttribType::Vec4f, name, values.get(), n);
     }
 
     void Attributes::addString(const std::string& name, std::unique_ptr<std::string[]> values, int n)
     {
-        m_strings.emplace_back(new AttribItem<std::string>(name, std::move(values), n));
+        add(AttribType::String, name, values.get(), n);
     }
 
     // --------------------------------------------------------------------------------------
-    const bool* Attributes::findBool(const std::string& name, int* n) const
+    void Attributes::addBool(const std::string& name, bool value)
+    {
+        add(AttribType::Bool, name, &value, 1);
+    }
+
+    void Attributes::addInt(const std::string& name, int value)
+    {
+        add(AttribType::Int, name, &value, 1);
+    }
+
+    void Attributes::addFloat(const std::string& name, float value)
     {
-        FIND_PTR(m_bools);
+        add(AttribType::Float, name, &value, 1);
     }
 
-    bool Attributes::findOneBool(const std::string& name, const bool& d) const
+    void Attributes::addVec2f(const std::string& name, const Vec2f& value)
     {
-        FIND_ONE(m_bools);
+        add(AttribType::Vec2f, name, &value, 1);
     }
 
-    const int* Attributes::findInt(const std::string& name, int* n) const
+    void Attributes::addVec3f(const std::string& name, const Vec3f& value)
     {
-        FIND_PTR(m_ints);
+        add(AttribType::Vec3f, name, &value, 1);
     }
 
-    int Attributes::findOneInt(const std::string& name, const int& d) const
+    void Attributes::addVec4f(const std::string& name, const Vec4f& value)
     {
-        FIND_ONE(m_ints);
+        add(AttribType::Vec4f, name, &value, 1);
     }
 
-    const float* Attributes::findFloat(const std::string& name, int* n) const
+    void Attributes::addString(const std::string& name, const std::string& value)
+    {
+        add(AttribType::String, name, &value, 1);
+    }
+
+    // --------------------------------------------------------------------------------------
+    #define FIND_ONE(T, type)                               \
+        int n = 0;                                          \
+        const T* values = find<T>(type, name, &n);          \
+        return values && n == 1 ? values[0] : d;
+
+    const bool* Attributes::findBool(std::string_view name, int* n) const
     {
-        FIND_PTR(m_floats);
+        return find<bool>(AttribType::Bool, name, n);
     }
 
-    float Attributes::findOneFloat(const std::string& name, const float& d) const
+    bool Attributes::findOneBool(std::string_view name, const bool& d) const
     {
-        FIND_ONE(m_floats);
+        FIND_ONE(bool, AttribType::Bool);
     }
 
-    const Vec2f* Attributes::findVec2f(const std::string& name, int* n) const
+    const int* Attributes::findInt(std::string_view name, int* n) const
     {
-        FIND_PTR(m_Vec2fs);
+        return find<int>(AttribType::Int, name, n);
     }
 
-    Vec2f Attributes::findOneVec2f(const std::string& name, const Vec2f& d) const
+    int Attributes::findOneInt(std::string_view name, const int& d) const
     {
-        FIND_ONE(m_Vec2fs)
+        FIND_ONE(int, AttribType::Int);
     }
 
-    const Vec3f* Attributes::findVec3f(const std::string& name, int* n) const
+    const float* Attributes::findFloat(std::string_view name, int* n) const
     {
-        FIND_PTR(m_Vec3fs);
+        return find<float>(AttribType::Float, name, n);
     }
 
-    Vec3f Attributes::findOneVec3f(const std::string& name, const Vec3f& d) const
+    float Attributes::findOneFloat(std::string_view name, const float& d) const
     {
-        FIND_ONE(m_Vec3fs);
+        FIND_ONE(float, AttribType::Float);
     }
 
-    const Vec4f* Attributes::findVec4f(const std::string& name, int* n) const
+    const Vec2f* Attributes::findVec2f(std::string_view name, int* n) const
     {
-        FIND_PTR(m_Vec4fs);
+        return find<Vec2f>(AttribType::Vec2f, name, n);
     }
 
-    Vec4f Attributes::findOneVec4f(const std::string& name, const Vec4f& d) const
+    Vec2f Attributes::findOneVec2f(std::string_view name, const Vec2f& d) const
     {
-        FIND_ONE(m_Vec4fs);
+        FIND_ONE(Vec2f, AttribType::Vec2f);
     }
 
-    const std::string* Attributes::findString(const std::string& name, int* n) const
+    const Vec3f* Attributes::findVec3f(std::string_view name, int* n) const
     {
-        FIND_PTR(m_strings);
+        return find<Vec3f>(AttribType::Vec3f, name, n);
     }
 
-    std::string Attributes::findOneString(const std::string& name, const std::string& d) const
+    Vec3f Attributes::findOneVec3f(std::string_view name, const Vec3f& d) const
     {
-        FIND_ONE(m_strings);
+        FIND_ONE(Vec3f, AttribType::Vec3f);
     }
 
+    const Vec4f* Attributes::findVec4f(std::string_view name, int* n) const
+    {
+        return find<Vec4f>(AttribType::Vec4f, name, n);
+    }
+
+    Vec4f Attributes::findOneVec4f(std::string_view name, const Vec4f& d) const
+    {
+        FIND_ONE(Vec4f, AttribType::Vec4f);
+    }
+
+    const std::string* Attributes::findString(std::string_view name, int* n) const
+    {
+        return find<std::string>(AttribType::String, name, n);
+    }
+
+    std::string Attributes::findOneString(std::string_view name, const std::string& d) const
+    {
+        FIND_ONE(std::string, AttribType::String);
+    }
+
+    #undef FIND_ONE
+
 } // namespace prayground
\ No newline at end of file
@@ -1,18 +1,41 @@
-#pragma once 
+#pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <prayground/math/vec.h>
 
 namespace prayground {
 
-    template <typename T> struct AttribItem;
+    enum class AttribType : uint8_t {
+        Bool = 0,
+        Int = 1,
+        Float = 2,
+        Vec2f = 3,
+        Vec3f = 4,
+        Vec4f = 5,
+        String = 6
+    };
 
+    /**
+     * @brief
+     * Named arrays of values, e.g. parameters of a material loaded from files.
+     * Values are stored in one contiguous arena (strings in their own array), and names are
+     * interned once per table. Lookups of (name, type) go through an open-addressing hash table.
+     * The table is shared between copies and is copied on the first add~~() to a shared one,
+     * so copying Attributes is O(1).
+     *
+     * @note The same name can be used for different types. If the same name is added twice
+     *       for one type, the first one is kept.
+     * @note Pointers returned by find~~() are valid until the next add~~() call to the object
+     *       they are found from, or until it is destroyed. Copies are not affected.
+     */
     class Attributes {
     public:
         Attributes();
-    
+
         void addBool(const std::string& name, std::unique_ptr<bool[]> values, int n);
         void addInt(const std::string& name, std::unique_ptr<int[]> values, int n);
         void addFloat(const std::string& name, std::unique_ptr<float[]> values, int n);
@@ -21,52 +44,79 @@ namespace prayground {
         void addVec4f(const std::string& name, std::unique_ptr<Vec4f[]> values, int n);
         void addString(const std::string& name, std::unique_ptr<std::string[]> values, int n);
 
+        // Single value, which doesn't need to allocate an array
+        void addBool(const std::string& name, bool value);
+        void addInt(const std::string& name, int value);
+        void addFloat(const std::string& name, float value);
+        void addVec2f(const std::string& name, const Vec2f& value);
+        void addVec3f(const std::string& name, const Vec3f& value);
+        void addVec4f(const std::string& name, const Vec4f& value);
+        void addString(const std::string& name, const std::string& value);
+
         /**
-         * find~~(): 
+         * find~~():
          * - Return attributes with ptr.
          * - If attributes are not found, nullptr will be returned.
-         * 
+         *
          * findOne~~():
          * - Return single value.
-         * - Get arg of default value \c d, and if the attribute is not found, 
+         * - Get arg of default value \c d, and if the attribute is not found,
          *   default value will be returned.
-         */ 
-        const bool* findBool(const std::string& name, int* n) const;
-        bool findOneBool(const std::string& name, const bool& d) const;
-        const int* findInt(const std::string& name, int* n) const;
-        int findOneInt(const std::string& name, const int& d) const;
-        const float* findFloat(const std::string& name, int* n) const;
-        float findOneFloat(const std::string& name, const float& d) const;
-        const Vec2f* findVec2f(const std::string& name, int* n) const;
-        Vec2f findOneVec2f(const std::string& name, const Vec2f& d) const;
-        const Vec3f* findVec3f(const std::string& name, int* n) const;
-        Vec3f findOneVec3f(const std::string& name, const Vec3f& d) const;
-        const Vec4f* findVec4f(const std::string& name, int* n) const;
-        Vec4f findOneVec4f(const std::string& name, const Vec4f& d) const;
-        const std::string* findString(const std::string&, int* n) const;
-        std::string findOneString(const std::string& name, const std::string& d) const;
-        
+         */
+        const bool* findBool(std::string_view name, int* n) const;
+        bool findOneBool(std::string_view name, const bool& d) const;
+        const int* findInt(std::string_view name, int* n) const;
+        int findOneInt(std::string_view name, const int& d) const;
+        const float* findFloat(std::string_view name, int* n) const;
+        float findOneFloat(std::string_view name, const float& d) const;
+        const Vec2f* findVec2f(std::string_view name, int* n) const;
+        Vec2f findOneVec2f(std::string_view name, const Vec2f& d) const;
+        const Vec3f* findVec3f(std::string_view name, int* n) const;
+        Vec3f findOneVec3f(std::string_view name, const Vec3f& d) const;
+        const Vec4f* findVec4f(std::string_view name, int* n) const;
+        Vec4f findOneVec4f(std::string_view name, const Vec4f& d) const;
+        const std::string* findString(std::string_view name, int* n) const;
+        std::string findOneString(std::string_view name, const std::string& d) const;
+
+        bool contains(std::string_view name, AttribType type) const;
+        size_t numAttributes() const { return m_storage ? m_storage->entries.size() : 0; }
+
     public:
         std::string name;
 
     private:
-        std::vector<std::shared_ptr<AttribItem<bool>>> m_bools;
-        std::vector<std::shared_ptr<AttribItem<int>>> m_ints;
-        std::vector<std::shared_ptr<AttribItem<float>>> m_floats;
-        std::vector<std::shared_ptr<AttribItem<Vec2f>>> m_Vec2fs;
-        std::vector<std::shared_ptr<AttribItem<Vec3f>>> m_Vec3fs;
-        std::vector<std::shared_ptr<AttribItem<Vec4f>>> m_Vec4fs;
-        std::vector<std::shared_ptr<AttribItem<std::string>>> m_strings;
-    };
+        struct Entry {
+            uint64_t hash;
+            // Range of the name in names
+            uint32_t name_offset;
+            uint32_t name_length;
+            // Offset in arena in units of Chunk, or index of strings
+            uint32_t offset;
+            int32_t num_values;
+            AttribType type;
+        };
+
+        // Unit of the arena, aligned to hold any of the value types
+        struct alignas(16) Chunk {
+            unsigned char bytes[16];
+        };
+
+        struct Storage {
+            std::vector<Entry> entries;
+            // Open addressing table of (index of entries + 1). 0 is an empty slot.
+            std::vector<uint32_t> slots;
+            std::string names;
+            std::vector<Chunk> arena;
+            std::vector<std::string> strings;
+        };
 
-    template <typename T>
-    struct AttribItem {
-        AttribItem(const std::string& name, std::unique_ptr<T[]> values, int n)
-        : name(name), values(std::move(values)), numValues(n) {}
+        template <typename T> void add(AttribType type, const std::string& name, const T* values, int n);
+        template <typename T> const T* find(AttribType type, std::string_view name, int* n) const;
+        const Entry* findEntry(std::string_view name, AttribType type) const;
+        static void insertSlot(Storage& storage, uint32_t entry_index);
 
-        const std::string name;
-        const std::unique_ptr<T[]> values;
-        const int numValues;
+        // Immutable while shared with copies
+        std::shared_ptr<const Storage> m_storage;
     };
 
 } // namespace prayground
\ No newline at end of file
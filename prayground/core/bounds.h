@@ -0,0 +1,120 @@
+#pragma once
+
+#ifndef __CUDACC__
+
+#include <prayground/core/aabb.h>
+#include <prayground/core/parallel.h>
+#include <prayground/math/matrix.h>
+#include <mutex>
+#include <vector>
+
+/**
+ * Bounds of primitive arrays on the host.
+ *
+ * Each chunk of the array is reduced with SIMD min/max on a worker thread, and the partial
+ * boxes are merged at the end. Arrays smaller than impl::kBoundsGrain stay on the calling thread.
+ * All functions return AABB{} for empty arrays, as Shape::bound() does for empty shapes.
+ */
+
+namespace prayground {
+
+    namespace impl {
+        constexpr size_t kBoundsGrain = 1 << 16;
+
+        // Vec3f is not padded, so it goes through an aligned copy
+        inline SimdFloat<4> loadVec3f(const Vec3f& v)
+        {
+            alignas(16) const float f[4] = { v[0], v[1], v[2], 0.0f };
+            return SimdFloat<4>::load(f);
+        }
+
+        inline Vec3f storeVec3f(const SimdFloat<4>& v)
+        {
+            alignas(16) float f[4];
+            v.store(f);
+            return Vec3f(f[0], f[1], f[2]);
+        }
+
+        template <class Func>
+        inline AABB reduceBounds(size_t n, const Func& bound_chunk)
+        {
+            if (n == 0)
+                return AABB{};
+
+            AABB result = AABB::empty();
+            std::mutex mutex;
+            parallelForChunks(0, n, [&](size_t begin, size_t end)
+            {
+                const AABB chunk = bound_chunk(begin, end);
+                std::lock_guard<std::mutex> lock(mutex);
+                result.expand(chunk);
+            }, kBoundsGrain);
+            return result;
+        }
+    } // namespace impl
+
+    inline AABB boundPoints(const Vec3f* points, size_t n)
+    {
+        return impl::reduceBounds(n, [&](size_t begin, size_t end)
+        {
+            Vec3f bmin, bmax;
+            impl::minMaxPoints(points + begin, end - begin, bmin, bmax);
+            return AABB(bmin, bmax);
+        });
+    }
+
+    inline AABB boundPoints(const std::vector<Vec3f>& points)
+    {
+        return boundPoints(points.data(), points.size());
+    }
+
+    // Union of the boxes. Invalid boxes such as AABB::empty() are ignored.
+    inline AABB boundBoxes(const AABB* boxes, size_t n)
+    {
+        return impl::reduceBounds(n, [&](size_t begin, size_t end)
+        {
+            using SimdT = SimdFloat<4>;
+            SimdT lo = SimdT::broadcast(FLT_MAX);
+            SimdT hi = SimdT::broadcast(-FLT_MAX);
+            for (size_t i = begin; i < end; i++)
+            {
+                lo = vmin(impl::loadVec3f(boxes[i].min()), lo);
+                hi = vmax(impl::loadVec3f(boxes[i].max()), hi);
+            }
+            return AABB(impl::storeVec3f(lo), impl::storeVec3f(hi));
+        });
+    }
+
+    inline AABB boundBoxes(const std::vector<AABB>& boxes)
+    {
+        return boundBoxes(boxes.data(), boxes.size());
+    }
+
+    /**
+     * Bound of spheres stored in an array of structures such as PointCloud::Data
+     * @code
+     * AABB aabb = boundSpheres(points, n, &PointCloud::Data::point, &PointCloud::Data::radius);
+     * @endcode
+     */
+    template <class T>
+    inline AABB boundSpheres(const T* items, size_t n, Vec3f T::* center, float T::* radius)
+    {
+        return impl::reduceBounds(n, [&](size_t begin, size_t end)
+        {
+            using SimdT = SimdFloat<4>;
+            SimdT lo = SimdT::broadcast(FLT_MAX);
+            SimdT hi = SimdT::broadcast(-FLT_MAX);
+            for (size_t i = begin; i < end; i++)
+            {
+                const SimdT c = impl::loadVec3f(items[i].*center);
+                const SimdT r = SimdT::broadcast(items[i].*radius);
+                lo = vmin(c - r, lo);
+                hi = vmax(c + r, hi);
+            }
+            return AABB(impl::storeVec3f(lo), impl::storeVec3f(hi));
+        });
+    }
+
+} // namespace prayground
+
+#endif // __CUDACC__
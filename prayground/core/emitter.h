@@ -27,8 +27,14 @@ namespace prayground {
         }
 
         void* devicePtr() const { return reinterpret_cast<void*>(d_data); }
+
+        // Dirty flag to tell the scene that the emitter data on device is outdated.
+        void markDirty() { m_dirty = true; }
+        void clearDirty() { m_dirty = false; }
+        virtual bool isDirty() const { return m_dirty; }
     protected:
         void* d_data { nullptr };
+        bool m_dirty { true };
 #endif
     };
 
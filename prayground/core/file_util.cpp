@@ -3,6 +3,13 @@
 #include <array>
 #include <prayground/core/util.h>
 
+#if !defined(_MSC_VER)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace prayground {
 
     namespace fs = std::filesystem;
@@ -140,4 +147,110 @@ namespace prayground {
         }
     }
 
+    // -------------------------------------------------------------------------------
+    MappedFile::MappedFile(const fs::path& filepath)
+    {
+        if (!open(filepath))
+            THROW("Failed to map the file '" + filepath.string() + "'.");
+    }
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            std::swap(m_open, other.m_open);
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+#if defined(_MSC_VER)
+            std::swap(m_file, other.m_file);
+            std::swap(m_mapping, other.m_mapping);
+#endif
+        }
+        return *this;
+    }
+
+    bool MappedFile::open(const fs::path& filepath)
+    {
+        close();
+#if defined(_MSC_VER)
+        HANDLE file = CreateFileW(filepath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+        {
+            CloseHandle(file);
+            return false;
+        }
+        m_file = file;
+        m_size = static_cast<size_t>(size.QuadPart);
+        m_open = true;
+        // Empty files can't be mapped
+        if (m_size > 0)
+        {
+            m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (m_mapping)
+                m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+#else
+        const int fd = ::open(filepath.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        m_size = static_cast<size_t>(st.st_size);
+        m_open = true;
+        // Empty files can't be mapped
+        if (m_size > 0)
+        {
+            void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+                m_data = static_cast<const uint8_t*>(data);
+        }
+        // The mapping stays valid after closing the descriptor
+        ::close(fd);
+#endif
+        if (m_size > 0 && !m_data)
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+#if defined(_MSC_VER)
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mapping)
+            CloseHandle(m_mapping);
+        if (m_file)
+            CloseHandle(m_file);
+        m_file = nullptr;
+        m_mapping = nullptr;
+#else
+        if (m_data)
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        m_open = false;
+        m_data = nullptr;
+        m_size = 0;
+    }
+
 } // namespace prayground
\ No newline at end of file
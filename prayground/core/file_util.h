@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <optional>
+#include <cstdint>
 
 namespace prayground {
 
@@ -56,4 +57,38 @@ namespace prayground {
     // Extract text data from the file
     std::string pgGetTextFromFile(const std::filesystem::path& filepath);
 
+    /**
+     * @brief Read-only memory mapping of a whole file.
+     * Pages are read by the OS on first access, so large binary data can be used in place without copying it
+     * into a buffer first. The mapping is released when the object is destroyed.
+     */
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        // Throw an exception when the file can't be mapped
+        explicit MappedFile(const std::filesystem::path& filepath);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        // Return false when the file can't be opened or mapped
+        bool open(const std::filesystem::path& filepath);
+        void close();
+
+        bool isOpen() const { return m_open; }
+        const uint8_t* data() const { return m_data; }
+        size_t size() const { return m_size; }
+    private:
+        bool m_open{ false };
+        const uint8_t* m_data{ nullptr };
+        size_t m_size{ 0 };
+#if defined(_MSC_VER)
+        void* m_file{ nullptr };
+        void* m_mapping{ nullptr };
+#endif
+    };
+
 } // namespace prayground
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#ifndef __CUDACC__
+#include <cstdint>
+#include <vector>
+
+namespace prayground {
+
+    // Contiguous range of indices [offset, offset + count)
+    struct IndexRange {
+        uint32_t offset;
+        uint32_t count;
+
+        bool operator==(const IndexRange& other) const
+        {
+            return offset == other.offset && count == other.count;
+        }
+    };
+
+    /**
+     * @brief Merge sorted indices into contiguous ranges, e.g. the dirty records of an SBT
+     * or the dirty instances of an InstanceArray to be uploaded.
+     * @param max_gap Number of clean indices allowed between two dirty indices
+     *                in the same range. Uploading a few clean elements is usually
+     *                cheaper than issuing another copy command.
+     */
+    inline std::vector<IndexRange> coalesceIndices(const std::vector<uint32_t>& sorted_indices, uint32_t max_gap = 0)
+    {
+        std::vector<IndexRange> ranges;
+        for (const uint32_t idx : sorted_indices)
+        {
+            if (!ranges.empty())
+            {
+                IndexRange& last = ranges.back();
+                const uint32_t last_end = last.offset + last.count;
+                if (idx < last_end)
+                    continue;
+                if (idx - last_end <= max_gap)
+                {
+                    last.count = idx - last.offset + 1;
+                    continue;
+                }
+            }
+            ranges.push_back({ idx, 1 });
+        }
+        return ranges;
+    }
+
+    // Total number of indices covered by the ranges
+    inline uint32_t numIndicesInRanges(const std::vector<IndexRange>& ranges)
+    {
+        uint32_t n = 0;
+        for (const auto& r : ranges)
+            n += r.count;
+        return n;
+    }
+
+} // namespace prayground
+
+#endif // __CUDACC__
@@ -23,114 +23,102 @@ namespace prayground {
         InOutExpo = 15
     };
 
+    /**
+     * @brief Eased interpolation weight of p in [0, 1].
+     * The easing is selected at compile time, so a track with a fixed EaseType has no dispatch per evaluation.
+     */
+    template <EaseType E>
+    INLINE HOSTDEVICE float easeWeight(float p)
+    {
+        if constexpr (E == EaseType::Linear)
+            return p;
+        // Sine easing functions
+        else if constexpr (E == EaseType::InSine)
+            return 1.0f - cosf(p * math::pi * 0.5f);
+        else if constexpr (E == EaseType::OutSine)
+            return sinf(p * math::pi * 0.5f);
+        else if constexpr (E == EaseType::InOutSine)
+            return -(cosf(math::pi * p) - 1.0f) * 0.5f;
+        // Quadratic easing functions
+        else if constexpr (E == EaseType::InQuad)
+            return p * p;
+        else if constexpr (E == EaseType::OutQuad)
+            return 1.0f - (1.0f - p) * (1.0f - p);
+        else if constexpr (E == EaseType::InOutQuad)
+            return p < 0.5f ? 2.0f * p * p : 1.0f - powf(-2.0f * p + 2.0f, 2.0f) * 0.5f;
+        // Cubic easing functions
+        else if constexpr (E == EaseType::InCubic)
+            return p * p * p;
+        else if constexpr (E == EaseType::OutCubic)
+            return 1.0f - powf(1.0f - p, 3.0f);
+        else if constexpr (E == EaseType::InOutCubic)
+            return p < 0.5f ? 4.0f * p * p * p : 1.0f - powf(-2.0f * p + 2.0f, 3.0f) * 0.5f;
+        // Quartic easing functions
+        else if constexpr (E == EaseType::InQuart)
+            return p * p * p * p;
+        else if constexpr (E == EaseType::OutQuart)
+            return 1.0f - powf(1.0f - p, 4.0f);
+        else if constexpr (E == EaseType::InOutQuart)
+            return p < 0.5f ? 8.0f * p * p * p * p : 1.0f - powf(-2.0f * p + 2.0f, 4.0f) * 0.5f;
+        // Exponential easing functions
+        else if constexpr (E == EaseType::InExpo)
+            return p == 0.0f ? 0.0f : powf(2.0f, 10.0f * (p - 1.0f));
+        else if constexpr (E == EaseType::OutExpo)
+            return p == 1.0f ? 1.0f : 1.0f - powf(2.0f, -10.0f * p);
+        else if constexpr (E == EaseType::InOutExpo)
+        {
+            if (p == 0.0f) return 0.0f;
+            if (p == 1.0f) return 1.0f;
+            return p < 0.5f ? powf(2.0f, 20.0f * p - 10.0f) * 0.5f : (2.0f - powf(2.0f, -20.0f * p + 10.0f)) * 0.5f;
+        }
+        else
+            return p;
+    }
+
     template <typename T>
     struct Keypoint {
         T value;
         float t;
 
-        static INLINE HOSTDEVICE T easeLinear(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            return a.value * (1.0f - p) + b.value * p;
-        }
-
-        // Sine easing functions
-        static INLINE HOSTDEVICE T easeInSine(Keypoint<T> a, Keypoint<T> b, float t) {
+        template <EaseType E>
+        static INLINE HOSTDEVICE T ease(Keypoint<T> a, Keypoint<T> b, float t) {
             float p = (t - a.t) / (b.t - a.t);
-            float x = 1.0f - cosf(p * math::pi * 0.5f);
+            if constexpr (E == EaseType::InOutExpo) {
+                if (p == 0.0f)
+                    return a.value;
+                if (p == 1.0f)
+                    return b.value;
+            }
+            float x = easeWeight<E>(p);
             return a.value * (1.0f - x) + b.value * x;
         }
 
-        static INLINE HOSTDEVICE T easeOutSine(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            float x = sinf(p * math::pi * 0.5f);
-            return a.value * (1.0f - x) + b.value * x;
-        }
+        static INLINE HOSTDEVICE T easeLinear(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::Linear>(a, b, t); }
 
-        static INLINE HOSTDEVICE T easeInOutSine(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            float x = -(cosf(math::pi * p) - 1.0f) * 0.5f;
-            return a.value * (1.0f - x) + b.value * x;
-        }
+        // Sine easing functions
+        static INLINE HOSTDEVICE T easeInSine(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::InSine>(a, b, t); }
+        static INLINE HOSTDEVICE T easeOutSine(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::OutSine>(a, b, t); }
+        static INLINE HOSTDEVICE T easeInOutSine(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::InOutSine>(a, b, t); }
 
         // Quadratic easing functions
-        static INLINE HOSTDEVICE T easeInQuad(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            float x = p * p;
-            return a.value * (1.0f - x) + b.value * x;
-        }
-
-        static INLINE HOSTDEVICE T easeOutQuad(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            float x = 1.0f - (1.0f - p) * (1.0f - p);
-            return a.value * (1.0f - x) + b.value * x;
-        }
-
-        static INLINE HOSTDEVICE T easeInOutQuad(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            float x = p < 0.5f ? 2.0f * p * p : 1.0f - powf(-2.0f * p + 2.0f, 2.0f) * 0.5f;
-            return a.value * (1.0f - x) + b.value * x;
-        }
+        static INLINE HOSTDEVICE T easeInQuad(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::InQuad>(a, b, t); }
+        static INLINE HOSTDEVICE T easeOutQuad(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::OutQuad>(a, b, t); }
+        static INLINE HOSTDEVICE T easeInOutQuad(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::InOutQuad>(a, b, t); }
 
         // Cubic easing functions
-        static INLINE HOSTDEVICE T easeInCubic(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            float x = p * p * p;
-            return a.value * (1.0f - x) + b.value * x;
-        }
-
-        static INLINE HOSTDEVICE T easeOutCubic(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            float x = 1.0f - powf(1.0f - p, 3.0f);
-            return a.value * (1.0f - x) + b.value * x;
-        }
-
-        static INLINE HOSTDEVICE T easeInOutCubic(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            float x = p < 0.5f ? 4.0f * p * p * p : 1.0f - powf(-2.0f * p + 2.0f, 3.0f) * 0.5f;
-            return a.value * (1.0f - x) + b.value * x;
-        }
+        static INLINE HOSTDEVICE T easeInCubic(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::InCubic>(a, b, t); }
+        static INLINE HOSTDEVICE T easeOutCubic(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::OutCubic>(a, b, t); }
+        static INLINE HOSTDEVICE T easeInOutCubic(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::InOutCubic>(a, b, t); }
 
         // Quartic easing functions
-        static INLINE HOSTDEVICE T easeInQuart(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            float x = p * p * p * p;
-            return a.value * (1.0f - x) + b.value * x;
-        }
-
-        static INLINE HOSTDEVICE T easeOutQuart(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            float x = 1.0f - powf(1.0f - p, 4.0f);
-            return a.value * (1.0f - x) + b.value * x;
-        }
-
-        static INLINE HOSTDEVICE T easeInOutQuart(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            float x = p < 0.5f ? 8.0f * p * p * p * p : 1.0f - powf(-2.0f * p + 2.0f, 4.0f) * 0.5f;
-            return a.value * (1.0f - x) + b.value * x;
-        }
+        static INLINE HOSTDEVICE T easeInQuart(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::InQuart>(a, b, t); }
+        static INLINE HOSTDEVICE T easeOutQuart(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::OutQuart>(a, b, t); }
+        static INLINE HOSTDEVICE T easeInOutQuart(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::InOutQuart>(a, b, t); }
 
         // Exponential easing functions
-        static INLINE HOSTDEVICE T easeInExpo(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            float x = p == 0.0f ? 0.0f : powf(2.0f, 10.0f * (p - 1.0f));
-            return a.value * (1.0f - x) + b.value * x;
-        }
-
-        static INLINE HOSTDEVICE T easeOutExpo(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            float x = p == 1.0f ? 1.0f : 1.0f - powf(2.0f, -10.0f * p);
-            return a.value * (1.0f - x) + b.value * x;
-        }
-
-        static INLINE HOSTDEVICE T easeInOutExpo(Keypoint<T> a, Keypoint<T> b, float t) {
-            float p = (t - a.t) / (b.t - a.t);
-            if (p == 0.0f)
-                return a.value;
-            if (p == 1.0f)
-                return b.value;
-            float x = p < 0.5f ? powf(2.0f, 20.0f * p - 10.0f) * 0.5f : (2.0f - powf(2.0f, -20.0f * p + 10.0f)) * 0.5f;
-            return a.value * (1.0f - x) + b.value * x;
-        }
+        static INLINE HOSTDEVICE T easeInExpo(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::InExpo>(a, b, t); }
+        static INLINE HOSTDEVICE T easeOutExpo(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::OutExpo>(a, b, t); }
+        static INLINE HOSTDEVICE T easeInOutExpo(Keypoint<T> a, Keypoint<T> b, float t) { return ease<EaseType::InOutExpo>(a, b, t); }
 
         static INLINE HOSTDEVICE T ease(Keypoint<T> a, Keypoint<T> b, float t, EaseType type) {
             switch (type) {
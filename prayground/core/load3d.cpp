@@ -178,40 +178,23 @@ namespace prayground {
 
         auto addTexture = [&](Attributes& attrib, const std::string& name, const std::string& tex_name) -> void
         {
-            if (!tex_name.empty()) {
-                std::unique_ptr<std::string[]> str(new std::string[1]);
-                str[0] = pgPathJoin(mtl_dir, tex_name).string();
-                attrib.addString(name, std::move(str), 1);
-            }
+            if (!tex_name.empty())
+                attrib.addString(name, pgPathJoin(mtl_dir, tex_name).string());
         };
     
         for (const auto& m : materials)
         {
             Attributes attrib;
             attrib.name = m.name;
-            Vec3f* ambient = new Vec3f;
-            Vec3f* diffuse = new Vec3f;
-            Vec3f* specular = new Vec3f;
-            Vec3f* transmittance = new Vec3f;
-            Vec3f* emission = new Vec3f;
-            *ambient = Vec3f(m.ambient[0], m.ambient[1], m.ambient[2]);
-            *diffuse = Vec3f(m.diffuse[0], m.diffuse[1], m.diffuse[2]);
-            *specular = Vec3f(m.specular[0], m.specular[1], m.specular[2]);
-            *transmittance = Vec3f(m.transmittance[0], m.transmittance[1], m.transmittance[2]);
-            *emission = Vec3f(m.emission[0], m.emission[1], m.emission[2]);
-
-            attrib.addVec3f("ambient", std::unique_ptr<Vec3f[]>(ambient), 1);
-            attrib.addVec3f("diffuse", std::unique_ptr<Vec3f[]>(diffuse), 1);
-            attrib.addVec3f("specular", std::unique_ptr<Vec3f[]>(specular), 1);
-            attrib.addVec3f("transmittance", std::unique_ptr<Vec3f[]>(transmittance), 1);
-            attrib.addVec3f("emission", std::unique_ptr<Vec3f[]>(emission), 1);
-
-            float* shininess = new float(m.shininess);
-            float* ior = new float(m.ior);
-            float* dissolve = new float(m.dissolve);
-            attrib.addFloat("shininess", std::unique_ptr<float[]>(shininess), 1);
-            attrib.addFloat("ior", std::unique_ptr<float[]>(ior), 1);
-            attrib.addFloat("dissolve", std::unique_ptr<float[]>(dissolve), 1);
+            attrib.addVec3f("ambient", Vec3f(m.ambient[0], m.ambient[1], m.ambient[2]));
+            attrib.addVec3f("diffuse", Vec3f(m.diffuse[0], m.diffuse[1], m.diffuse[2]));
+            attrib.addVec3f("specular", Vec3f(m.specular[0], m.specular[1], m.specular[2]));
+            attrib.addVec3f("transmittance", Vec3f(m.transmittance[0], m.transmittance[1], m.transmittance[2]));
+            attrib.addVec3f("emission", Vec3f(m.emission[0], m.emission[1], m.emission[2]));
+
+            attrib.addFloat("shininess", m.shininess);
+            attrib.addFloat("ior", m.ior);
+            attrib.addFloat("dissolve", m.dissolve);
 
             addTexture(attrib, "ambient_texture", m.ambient_texname);
             addTexture(attrib, "diffuse_texture", m.diffuse_texname);
@@ -222,7 +205,7 @@ namespace prayground {
             addTexture(attrib, "alpha_texture", m.alpha_texname);
             addTexture(attrib, "reflection_texture", m.reflection_texname);
 
-            material_attribs.emplace_back(attrib);
+            material_attribs.emplace_back(std::move(attrib));
         }
     }
 
@@ -24,8 +24,8 @@ namespace prayground {
         virtual SurfaceType surfaceType() const = 0;
     
         virtual void copyToDevice() {
-            if (m_bumpmap && !m_bumpmap->devicePtr())
-                m_bumpmap->copyToDevice();
+            if (m_bumpmap)
+                m_bumpmap->copyToDeviceIfDirty();
         }
 
         virtual void setTexture(const std::shared_ptr<Texture>& texture) = 0;
@@ -42,6 +42,7 @@ namespace prayground {
 
         void setBumpmap(const std::shared_ptr<Texture>& bumpmap) {
             m_bumpmap = bumpmap;
+            markDirty();
         }
         Texture::Data bumpmapData() const {
             if (m_bumpmap)
@@ -62,6 +63,19 @@ namespace prayground {
 
         SurfaceInfo* surfaceInfoDevicePtr() const { return d_surface_info; }
 
+        // Dirty flag to tell the scene that the material data on device is outdated.
+        // Setters of derived classes mark the material dirty, and Scene clears the flag
+        // after re-uploading the data with copyToDevice().
+        // A material is also dirty while its texture or bumpmap is, since they are
+        // re-uploaded by copyToDevice() of the material.
+        void markDirty() { m_dirty = true; }
+        void clearDirty() { m_dirty = false; }
+        virtual bool isDirty() const
+        {
+            auto tex = texture();
+            return m_dirty || (tex && tex->isDirty()) || (m_bumpmap && m_bumpmap->isDirty());
+        }
+
     protected:
         SurfaceCallableID m_surface_callable_id;
         void* d_data { nullptr };
@@ -72,6 +86,8 @@ namespace prayground {
         std::shared_ptr<Texture> m_bumpmap{ nullptr };
         int m_bumpmap_id { -1 };
 
+        bool m_dirty { true };
+
         // TODO: Displacement map
 #endif // __CUDACC__
     };
@@ -0,0 +1,89 @@
+#pragma once
+
+#ifndef __CUDACC__
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace prayground {
+
+    // Number of threads used by parallel loops on the host
+    inline uint32_t numHostThreads()
+    {
+        const uint32_t n = std::thread::hardware_concurrency();
+        return n == 0 ? 1u : n;
+    }
+
+    /**
+     * @brief Split [begin, end) into contiguous chunks and call func(chunk_begin, chunk_end) on worker threads.
+     * @param grain Minimum number of iterations per chunk. Loops smaller than this run on the calling thread.
+     * @note  The first exception thrown by a worker is re-thrown on the calling thread after all workers finished.
+     */
+    template <class Func>
+    inline void parallelForChunks(size_t begin, size_t end, const Func& func, size_t grain = 1024)
+    {
+        if (end <= begin)
+            return;
+
+        const size_t n = end - begin;
+        const size_t num_chunks = std::min<size_t>(numHostThreads(), (n + grain - 1) / std::max<size_t>(grain, 1));
+        if (num_chunks <= 1)
+        {
+            func(begin, end);
+            return;
+        }
+
+        std::exception_ptr exception = nullptr;
+        std::mutex exception_mutex;
+
+        auto run = [&](size_t chunk_begin, size_t chunk_end)
+        {
+            try
+            {
+                func(chunk_begin, chunk_end);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(exception_mutex);
+                if (!exception)
+                    exception = std::current_exception();
+            }
+        };
+
+        const size_t chunk_size = (n + num_chunks - 1) / num_chunks;
+        std::vector<std::thread> workers;
+        workers.reserve(num_chunks - 1);
+        for (size_t c = 1; c < num_chunks; c++)
+        {
+            const size_t chunk_begin = begin + c * chunk_size;
+            const size_t chunk_end = std::min(end, chunk_begin + chunk_size);
+            if (chunk_begin < chunk_end)
+                workers.emplace_back(run, chunk_begin, chunk_end);
+        }
+        // The calling thread processes the first chunk
+        run(begin, std::min(end, begin + chunk_size));
+
+        for (auto& w : workers)
+            w.join();
+
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+
+    // Call func(i) for each i in [begin, end) on worker threads
+    template <class Func>
+    inline void parallelFor(size_t begin, size_t end, const Func& func, size_t grain = 1024)
+    {
+        parallelForChunks(begin, end, [&](size_t chunk_begin, size_t chunk_end)
+        {
+            for (size_t i = chunk_begin; i < chunk_end; i++)
+                func(i);
+        }, grain);
+    }
+
+} // namespace prayground
+
+#endif // __CUDACC__
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <prayground/optix/macros.h>
+#include <prayground/core/util.h>
 #include <prayground/math/vec.h>
 #include <prayground/math/random.h>
 
@@ -24,22 +25,433 @@ namespace prayground {
         }
     };
 
+    /**
+     * @brief
+     * Independent uniform samples from the counter-based sampleHash(). Each dimension is a
+     * function of (pixel, sample index, dimension), so setDimension() can skip to any dimension.
+     * The 4 words of one Philox block are handed out over consecutive dimensions, so Philox
+     * runs only once per 4 dimensions. get2D() starts at an even dimension to take both values
+     * from one block, skipping a dimension when the current one is odd.
+     */
+    class IndependentSampler {
+    public:
+        HOSTDEVICE IndependentSampler(uint32_t pixel, uint32_t sample_index, uint32_t seed = 0, uint32_t dimension = 0)
+            : m_pixel(pixel), m_index(sample_index), m_seed(seed), m_dimension(dimension) {}
+
+        HOSTDEVICE float get1D()
+        {
+            return uintToFloat(nextWord());
+        }
+
+        HOSTDEVICE Vec2f get2D()
+        {
+            m_dimension += m_dimension & 1u;
+            return Vec2f{ get1D(), get1D() };
+        }
+
+        HOSTDEVICE Vec3f get3D()
+        {
+            const Vec2f xy = get2D();
+            return Vec3f{ xy[0], xy[1], get1D() };
+        }
+
+        HOSTDEVICE void setDimension(uint32_t dimension) { m_dimension = dimension; }
+        HOSTDEVICE uint32_t dimension() const { return m_dimension; }
+    private:
+        // sampleHash() of the current dimension
+        HOSTDEVICE uint32_t nextWord()
+        {
+            if ((m_dimension >> 2) != m_block_index)
+            {
+                m_block = sampleHashBlock(m_pixel, m_index, m_dimension, m_seed);
+                m_block_index = m_dimension >> 2;
+            }
+            return m_block[m_dimension++ & 3u];
+        }
+
+        uint32_t m_pixel;
+        uint32_t m_index;
+        uint32_t m_seed;
+        uint32_t m_dimension;
+        // Philox block of the dimensions 4 * m_block_index ... 4 * m_block_index + 3
+        Vec4ui m_block;
+        uint32_t m_block_index { 0xffffffffu };
+    };
+
+    // ---------------------------------------------------------------------------
+    // Sobol generator matrices
+    // ---------------------------------------------------------------------------
+    /// @note Dimensions beyond this number are drawn from padded (0,2)-sequences
+    constexpr uint32_t kNumSobolDimensions = 32;
+
+    // Primitive polynomial and initial direction numbers of a Sobol dimension (Joe & Kuo, new-joe-kuo-6.21201)
+    struct SobolPolynomial {
+        uint32_t degree;
+        // Coefficients a_1 ... a_{degree-1}, with a_1 in the most significant bit
+        uint32_t coeffs;
+        uint32_t m[7];
+    };
+
+    constexpr SobolPolynomial sobol_polynomials[kNumSobolDimensions - 1] = {
+        { 1,  0, { 1 } },
+        { 2,  1, { 1, 3 } },
+        { 3,  1, { 1, 3, 1 } },
+        { 3,  2, { 1, 1, 1 } },
+        { 4,  1, { 1, 1, 3, 3 } },
+        { 4,  4, { 1, 3, 5, 13 } },
+        { 5,  2, { 1, 1, 5, 5, 17 } },
+        { 5,  4, { 1, 1, 5, 5, 5 } },
+        { 5,  7, { 1, 1, 7, 11, 19 } },
+        { 5, 11, { 1, 1, 5, 1, 1 } },
+        { 5, 13, { 1, 1, 1, 3, 11 } },
+        { 5, 14, { 1, 3, 5, 5, 31 } },
+        { 6,  1, { 1, 3, 3, 9, 7, 49 } },
+        { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+        { 6, 16, { 1, 3, 1, 13, 27, 49 } },
+        { 6, 19, { 1, 1, 1, 15, 7, 5 } },
+        { 6, 22, { 1, 3, 1, 15, 13, 25 } },
+        { 6, 25, { 1, 1, 5, 5, 19, 61 } },
+        { 7,  1, { 1, 3, 7, 11, 23, 15, 103 } },
+        { 7,  4, { 1, 3, 7, 13, 13, 15, 69 } },
+        { 7,  7, { 1, 1, 3, 13, 7, 35, 63 } },
+        { 7,  8, { 1, 3, 5, 9, 1, 25, 53 } },
+        { 7, 14, { 1, 3, 1, 13, 9, 35, 107 } },
+        { 7, 19, { 1, 3, 1, 5, 27, 61, 31 } },
+        { 7, 21, { 1, 1, 5, 11, 19, 41, 61 } },
+        { 7, 28, { 1, 3, 5, 3, 3, 13, 69 } },
+        { 7, 31, { 1, 1, 7, 13, 1, 19, 1 } },
+        { 7, 32, { 1, 3, 7, 5, 13, 19, 59 } },
+        { 7, 37, { 1, 1, 3, 9, 25, 29, 41 } },
+        { 7, 41, { 1, 3, 5, 13, 23, 1, 55 } },
+        { 7, 42, { 1, 3, 7, 3, 13, 59, 17 } }
+    };
+
+    // columns[dim][bit] is XORed into the result when the bit of the sample index is set
+    struct SobolMatrices {
+        uint32_t columns[kNumSobolDimensions][32];
+    };
+
+    constexpr SobolMatrices generateSobolMatrices()
+    {
+        SobolMatrices matrices{};
+
+        // The first dimension is the van der Corput sequence
+        for (uint32_t k = 0; k < 32; k++)
+            matrices.columns[0][k] = 1u << (31 - k);
+
+        for (uint32_t d = 1; d < kNumSobolDimensions; d++)
+        {
+            const SobolPolynomial& p = sobol_polynomials[d - 1];
+            const uint32_t s = p.degree;
+
+            uint32_t m[32] = {};
+            for (uint32_t k = 0; k < s; k++)
+                m[k] = p.m[k];
+            // Bratley & Fox recurrence of the direction numbers
+            for (uint32_t k = s; k < 32; k++)
+            {
+                uint32_t mk = m[k - s] ^ (m[k - s] << s);
+                for (uint32_t i = 1; i < s; i++)
+                {
+                    if ((p.coeffs >> (s - 1 - i)) & 1u)
+                        mk ^= m[k - i] << i;
+                }
+                m[k] = mk;
+            }
+
+            for (uint32_t k = 0; k < 32; k++)
+                matrices.columns[d][k] = m[k] << (31 - k);
+        }
+        return matrices;
+    }
+
+    constexpr SobolMatrices sobol_matrices = generateSobolMatrices();
+
+#ifdef __CUDACC__
+    // Device copy of the matrices, because constexpr arrays can't be indexed at run-time in device code
+    static __constant__ SobolMatrices sobol_matrices_device = generateSobolMatrices();
+#endif
+
+    // ---------------------------------------------------------------------------
+    // Bit operations and hashing
+    // ---------------------------------------------------------------------------
+    INLINE HOSTDEVICE uint32_t reverseBits32(uint32_t v)
+    {
+#ifdef __CUDA_ARCH__
+        return __brev(v);
+#else
+        v = (v << 16) | (v >> 16);
+        v = ((v & 0x00ff00ffu) << 8) | ((v & 0xff00ff00u) >> 8);
+        v = ((v & 0x0f0f0f0fu) << 4) | ((v & 0xf0f0f0f0u) >> 4);
+        v = ((v & 0x33333333u) << 2) | ((v & 0xccccccccu) >> 2);
+        v = ((v & 0x55555555u) << 1) | ((v & 0xaaaaaaaau) >> 1);
+        return v;
+#endif
+    }
+
+    INLINE HOSTDEVICE uint64_t mixBits(uint64_t v)
+    {
+        v ^= (v >> 31);
+        v *= 0x7fb5d329728ea185ull;
+        v ^= (v >> 27);
+        v *= 0x81dadef4bc2dd44dull;
+        v ^= (v >> 33);
+        return v;
+    }
+
+    INLINE HOSTDEVICE uint32_t hashSeed(uint32_t a, uint32_t b)
+    {
+        return static_cast<uint32_t>(mixBits((static_cast<uint64_t>(a) << 32) | b));
+    }
+
+    INLINE HOSTDEVICE uint32_t hashSeed(uint32_t a, uint32_t b, uint32_t c)
+    {
+        return hashSeed(hashSeed(a, b), c);
+    }
+
+    /**
+     * @brief Nested uniform (Owen) scrambling of the bits with the hash-based
+     * Laine-Karras permutation (Burley, "Practical Hash-based Owen Scrambling", 2020).
+     * @note Each aligned block of 2^k values is mapped to an aligned block of 2^k values,
+     *       so the stratification of Sobol points is preserved.
+     */
+    INLINE HOSTDEVICE uint32_t owenScramble(uint32_t v, uint32_t seed)
+    {
+        v = reverseBits32(v);
+        v ^= v * 0x3d20adeau;
+        v += seed;
+        v *= (seed >> 16) | 1u;
+        v ^= v * 0x05526c56u;
+        v ^= v * 0x53a22864u;
+        return reverseBits32(v);
+    }
+
+    INLINE HOSTDEVICE float sobolBitsToFloat(uint32_t v)
+    {
+        // Largest float below 1
+        constexpr float kOneMinusEpsilon = 0x1.fffffep-1f;
+        const float f = static_cast<float>(v) * 0x1p-32f;
+        return f < kOneMinusEpsilon ? f : kOneMinusEpsilon;
+    }
+
+    // Unscrambled bits of the index-th Sobol point in the dimension
+    INLINE HOSTDEVICE uint32_t sobolBits(uint32_t index, uint32_t dim)
+    {
+#ifdef __CUDA_ARCH__
+        const uint32_t* columns = sobol_matrices_device.columns[dim];
+#else
+        const uint32_t* columns = sobol_matrices.columns[dim];
+#endif
+        uint32_t v = 0;
+        for (uint32_t bit = 0; index != 0; index >>= 1, bit++)
+        {
+            if (index & 1u)
+                v ^= columns[bit];
+        }
+        return v;
+    }
+
+    // Owen-scrambled Sobol sample in [0, 1)
+    INLINE HOSTDEVICE float sobolSample(uint32_t index, uint32_t dim, uint32_t scramble_seed)
+    {
+        return sobolBitsToFloat(owenScramble(sobolBits(index, dim), scramble_seed));
+    }
+
+    // ---------------------------------------------------------------------------
+    // Samplers
+    // ---------------------------------------------------------------------------
+    /**
+     * @brief
+     * Padded Sobol sampler. Each call draws from its own (0,2)-sequence, i.e. the first
+     * two Sobol dimensions, shuffled and Owen-scrambled with a hash of the pixel seed and
+     * the dimension. This keeps every 1D/2D sample stratified in any number of dimensions.
+     *
+     * @note Samples of one pixel must share the seed and have consecutive sample indices.
+     */
+    class PaddedSobolSampler {
+    public:
+        HOSTDEVICE PaddedSobolSampler(uint32_t seed, uint32_t sample_index, uint32_t dimension = 0)
+            : m_seed(seed), m_index(sample_index), m_dimension(dimension) {}
+
+        HOSTDEVICE float get1D()
+        {
+            const uint32_t hash = hashSeed(m_seed, m_dimension++);
+            const uint32_t index = owenScramble(m_index, hash);
+            return sobolSample(index, 0, hashSeed(hash, 0));
+        }
+
+        HOSTDEVICE Vec2f get2D()
+        {
+            const uint32_t hash = hashSeed(m_seed, m_dimension);
+            m_dimension += 2;
+            const uint32_t index = owenScramble(m_index, hash);
+            return Vec2f{ sobolSample(index, 0, hashSeed(hash, 0)), sobolSample(index, 1, hashSeed(hash, 1)) };
+        }
+
+        HOSTDEVICE Vec3f get3D()
+        {
+            const Vec2f xy = get2D();
+            return Vec3f{ xy[0], xy[1], get1D() };
+        }
+
+        HOSTDEVICE uint32_t dimension() const { return m_dimension; }
+    private:
+        uint32_t m_seed;
+        uint32_t m_index;
+        uint32_t m_dimension;
+    };
+
+    /**
+     * @brief
+     * Global Owen-scrambled Sobol sampler. The first kNumSobolDimensions dimensions come
+     * from one Sobol sequence, so the samples are stratified in higher dimensional projections
+     * as well. The sample index is shuffled per pixel with Owen scrambling to decorrelate pixels.
+     * The rest of dimensions fall back to padded sequences.
+     */
     class SobolSampler {
     public:
-        static HOSTDEVICE float get1D(uint32_t& prev)
+        HOSTDEVICE SobolSampler(uint32_t seed, uint32_t sample_index, uint32_t dimension = 0)
+            : m_seed(seed), m_index(owenScramble(sample_index, hashSeed(seed, 0x5eed5eedu))), m_dimension(dimension) {}
+
+        HOSTDEVICE float get1D()
         {
-            return rnd(prev);
+            const uint32_t dim = m_dimension++;
+            if (dim < kNumSobolDimensions)
+                return sobolSample(m_index, dim, hashSeed(m_seed, dim));
+            return PaddedSobolSampler(m_seed, m_index, dim).get1D();
         }
 
-        static HOSTDEVICE Vec2f get2D(uint32_t& prev)
+        HOSTDEVICE Vec2f get2D()
         {
-            return Vec2f{rnd(prev), rnd(prev)};
+            return Vec2f{ get1D(), get1D() };
         }
 
-        static HOSTDEVICE Vec3f get3D(uint32_t& prev)
+        HOSTDEVICE Vec3f get3D()
         {
-            return Vec3f{rnd(prev), rnd(prev), rnd(prev)};
+            return Vec3f{ get1D(), get1D(), get1D() };
+        }
+
+        HOSTDEVICE uint32_t dimension() const { return m_dimension; }
+    private:
+        uint32_t m_seed;
+        uint32_t m_index;
+        uint32_t m_dimension;
+    };
+
+    /**
+     * @brief
+     * Blue-noise Sobol sampler based on hierarchical Morton ordering of pixels
+     * (Ahmed & Wonka, "Screen-Space Blue-Noise Diffusion of Monte Carlo Sampling Error via
+     * Hierarchical Ordering of Pixels", 2020). Pixels and samples are enumerated along a
+     * Morton curve with randomly permuted base-4 digits, so neighbouring pixels take
+     * complementary points of one (0,2)-sequence and the error is distributed as blue noise.
+     *
+     * @note The number of samples per pixel must be a fixed power of two (2^log2_spp), and
+     *       log2_resolution is ceil(log2(max(width, height))).
+     * @note The scrambled Morton index of (pixel, sample) must fit in the 32 columns of the
+     *       Sobol matrices, i.e. 2 * log2_resolution + log2_spp <= 32 (e.g. up to 256 spp at 4096^2,
+     *       1024 spp at 2048^2). Beyond that, pixels in different screen quadrants would take the
+     *       same samples, so the constructor rejects it on the host.
+     */
+    class ZSobolSampler {
+    public:
+        HOSTDEVICE ZSobolSampler(const Vec2ui& pixel, uint32_t sample_index, uint32_t log2_spp, uint32_t log2_resolution, uint32_t seed, uint32_t dimension = 0)
+            : m_seed(seed), m_log2_spp(log2_spp), m_num_base4_digits(log2_resolution + (log2_spp + 1) / 2), m_dimension(dimension)
+        {
+#ifndef __CUDACC__
+            ASSERT(2 * log2_resolution + log2_spp <= 32,
+                "ZSobolSampler supports 2 * log2_resolution + log2_spp <= 32, but log2_resolution = "
+                + std::to_string(log2_resolution) + " and log2_spp = " + std::to_string(log2_spp) + ".");
+#endif
+            m_morton_index = (encodeMorton2(pixel[0], pixel[1]) << log2_spp) | sample_index;
         }
+
+        HOSTDEVICE float get1D()
+        {
+            const uint32_t dim = m_dimension++;
+            const uint32_t index = sampleIndex(dim);
+            return sobolSample(index, 0, hashSeed(m_seed, dim));
+        }
+
+        HOSTDEVICE Vec2f get2D()
+        {
+            const uint32_t dim = m_dimension;
+            m_dimension += 2;
+            const uint32_t index = sampleIndex(dim);
+            const uint32_t hash = hashSeed(m_seed, dim);
+            return Vec2f{ sobolSample(index, 0, hashSeed(hash, 0)), sobolSample(index, 1, hashSeed(hash, 1)) };
+        }
+
+        HOSTDEVICE Vec3f get3D()
+        {
+            const Vec2f xy = get2D();
+            return Vec3f{ xy[0], xy[1], get1D() };
+        }
+
+        HOSTDEVICE uint32_t dimension() const { return m_dimension; }
+
+        static HOSTDEVICE uint64_t encodeMorton2(uint32_t x, uint32_t y)
+        {
+            return (spreadBits(y) << 1) | spreadBits(x);
+        }
+    private:
+        static HOSTDEVICE uint64_t spreadBits(uint64_t v)
+        {
+            v &= 0xffffffffull;
+            v = (v | (v << 16)) & 0x0000ffff0000ffffull;
+            v = (v | (v << 8)) & 0x00ff00ff00ff00ffull;
+            v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0full;
+            v = (v | (v << 2)) & 0x3333333333333333ull;
+            v = (v | (v << 1)) & 0x5555555555555555ull;
+            return v;
+        }
+
+        // The digit-th element of the p-th permutation of {0, 1, 2, 3} (p < 24, Lehmer code)
+        static HOSTDEVICE uint32_t permute4(uint32_t p, uint32_t digit)
+        {
+            uint32_t remaining = 0x3210u;   // Unused elements packed by 4 bits
+            uint32_t value = 0;
+            uint32_t factorial = 6;
+            for (uint32_t i = 0; i <= digit; i++)
+            {
+                const uint32_t k = p / factorial;
+                p %= factorial;
+                factorial = i < 2 ? factorial / (3 - i) : 1;
+                value = (remaining >> (4 * k)) & 0xfu;
+                // Remove the k-th element
+                const uint32_t low = remaining & ((1u << (4 * k)) - 1u);
+                remaining = ((remaining >> (4 * (k + 1))) << (4 * k)) | low;
+            }
+            return value;
+        }
+
+        HOSTDEVICE uint32_t sampleIndex(uint32_t dim) const
+        {
+            uint64_t index = 0;
+            // With odd log2_spp, the last digit is base 2
+            const bool pow2_samples = m_log2_spp & 1u;
+            const int last_digit = pow2_samples ? 1 : 0;
+            for (int i = static_cast<int>(m_num_base4_digits) - 1; i >= last_digit; i--)
+            {
+                const int shift = 2 * i - (pow2_samples ? 1 : 0);
+                const uint32_t digit = static_cast<uint32_t>((m_morton_index >> shift) & 3u);
+                const uint64_t higher_digits = m_morton_index >> (shift + 2);
+                const uint32_t p = static_cast<uint32_t>((mixBits(higher_digits ^ (0x55555555ull * dim)) >> 24) % 24);
+                index |= static_cast<uint64_t>(permute4(p, digit)) << shift;
+            }
+            if (pow2_samples)
+            {
+                const uint32_t digit = static_cast<uint32_t>(m_morton_index & 1u);
+                index |= digit ^ (mixBits((m_morton_index >> 1) ^ (0x55555555ull * dim)) & 1u);
+            }
+            return static_cast<uint32_t>(index);
+        }
+
+        uint64_t m_morton_index;
+        uint32_t m_seed;
+        uint32_t m_log2_spp;
+        uint32_t m_num_base4_digits;
+        uint32_t m_dimension;
     };
 
-} // namespace prayground
\ No newline at end of file
+} // namespace prayground
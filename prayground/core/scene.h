@@ -1,5 +1,6 @@
 #pragma once 
 
+#include <optional>
 #include <unordered_map>
 
 #include <prayground/core/util.h>
@@ -8,6 +9,7 @@
 #include <prayground/core/texture.h>
 #include <prayground/core/camera.h>
 #include <prayground/core/bitmap.h>
+#include <prayground/core/parallel.h>
 
 #include <prayground/emitter/area.h>
 #include <prayground/emitter/envmap.h>
@@ -20,6 +22,10 @@
 #include <prayground/optix/transform.h>
 
 #include <prayground/shape/trianglemesh.h>
+#include <prayground/shape/meshopt.h>
+
+#include <prayground/cpu/cpu_accel.h>
+#include <prayground/cpu/launch.h>
 
 namespace prayground {
     template <class T>
@@ -40,6 +46,9 @@ namespace prayground {
             std::shared_ptr<Shape> shape;
             std::vector<std::shared_ptr<Material>> materials;
             ShapeInstance instance;
+
+            // Whether the shape or the SBT records of this object should be re-uploaded in updateSBT()
+            bool dirty { true };
         private:
             void free() {
                 shape->free();
@@ -55,11 +64,13 @@ namespace prayground {
             Instance instance;
             GeometryAccel gas;
             Transform matrix_transform;
+
+            bool dirty { true };
         private:
             void free() {
                 shape->free();
                 for (auto m : materials) m->free();
-                instance.free();
+                gas.free();
             }
         };
 
@@ -67,6 +78,8 @@ namespace prayground {
             std::shared_ptr<Shape> shape;
             std::vector<std::shared_ptr<AreaEmitter>> emitters;
             ShapeInstance instance;
+
+            bool dirty { true };
         private:
             void free() {
                 shape->free();
@@ -82,6 +95,8 @@ namespace prayground {
             Instance instance;
             GeometryAccel gas;
             Transform matrix_transform;
+
+            bool dirty { true };
         private:
             void free() {
                 shape->free();
@@ -154,8 +169,41 @@ namespace prayground {
 
         void updateObjectGAS(const std::string& name, const Context& ctx, CUstream stream);
 
+        // Request re-uploading the shape and materials of the object at the next updateSBT()
+        void markObjectDirty(const std::string& name);
+
         std::shared_ptr<Object> getObject(const std::string& name);
 
+        /**
+         * Level of detail: shapes of the object from the finest to the coarsest (e.g. generateLODs() in shape/meshopt.h).
+         * lods[i] is used while the distance from the camera is less than distances[i], and the last one beyond them.
+         * @note The shapes must be of the same type and have the same number of materials as the object.
+         */
+        void setObjectLODs(const std::string& name, const std::vector<std::shared_ptr<Shape>>& lods, const std::vector<float>& distances);
+        // Index of LOD for the distance from the camera, with the distance thresholds given to setObjectLODs()
+        static uint32_t selectLOD(float distance, const std::vector<float>& distances);
+        /**
+         * Select LODs of objects from the distance between the camera and the center of their world bounds.
+         * The GAS of the object whose LOD has switched is rebuilt and it's marked as dirty.
+         * @return Whether LODs of any objects have switched. If so, call updateAccel() and updateSBT() next.
+         */
+        bool updateObjectLODs(const Context& ctx, CUstream stream);
+
+        /**
+         * Split the mesh into clusters (see buildMeshClusters() in shape/meshopt.h) and add each part of up to
+         * max_faces_per_gas faces as an object with its own GAS under the IAS. This bounds the temporary memory
+         * of each GAS build, and an edited part only needs its own GAS rebuilt with updateObjectGAS().
+         * @return Names of the added objects, which are `name` followed by "/<index of the part>"
+         */
+        std::vector<std::string> addClusteredObject(const std::string& name, const std::shared_ptr<TriangleMesh>& mesh,
+            const std::vector<std::shared_ptr<Material>>& materials, std::array<ProgramGroup, _NRay>& hitgroup_prgs,
+            uint32_t max_faces_per_gas, const Matrix4f& transform = Matrix4f::identity(),
+            const AccelSettings& gas_settings = { true, true }, const MeshClusterSettings& cluster_settings = {});
+        std::vector<std::string> addClusteredObject(const std::string& name, const std::shared_ptr<TriangleMesh>& mesh,
+            const std::vector<std::shared_ptr<Material>>& materials, std::initializer_list<ProgramGroup> hitgroup_prgs,
+            uint32_t max_faces_per_gas, const Matrix4f& transform = Matrix4f::identity(),
+            const AccelSettings& gas_settings = { true, true }, const MeshClusterSettings& cluster_settings = {});
+
         // Light object
         void addLight(const std::string& name, std::shared_ptr<Shape> shape, std::shared_ptr<AreaEmitter> emitter,
             std::array<ProgramGroup, _NRay>& hitgroup_prgs, const Matrix4f& transform = Matrix4f::identity(), 
@@ -176,6 +224,8 @@ namespace prayground {
 
         void updateLightGAS(const std::string& name, const Context& ctx, CUstream stream);
 
+        void markLightDirty(const std::string& name);
+
         std::shared_ptr<Light> getLight(const std::string& name);
         std::vector<std::string> lightNames() const;
 
@@ -217,9 +267,53 @@ namespace prayground {
         void updateAccel(const Context& ctx, CUstream stream);
         OptixTraversableHandle accelHandle() const;
 
+        /**
+         * CPU backend: build a host BVH over objects and lights, and trace rays without OptiX.
+         * Instance IDs are same as those assigned in buildAccel(), so a kernel can look up
+         * objects in the same way as optixGetInstanceId() on the device.
+         * @note Moving objects/lights and shapes other than TriangleMesh, Sphere, Cylinder, Plane and Box are skipped.
+         */
+        void buildCpuAccel();
+        const CpuAccel& cpuAccel() const;
+
+        // Launch a kernel called as kernel(const Vec3ui& idx, const Vec3ui& dim) on host threads, in place of launchRay()
+        template <class Kernel>
+        void launchRayOnCpu(const Kernel& kernel, uint32_t w, uint32_t h, uint32_t d = 1);
+
+        /**
+         * Ray queries on the host (e.g. picking under the cursor, collision) without a round trip to the device.
+         * They use the BVH of the CPU backend, which is built at the first query. updateObjectTransform(),
+         * updateObjectGAS() and their light versions refit it incrementally, and adding or deleting
+         * objects/lights rebuilds it at the next query.
+         */
+        struct RayQueryHit {
+            std::string name;       // Name of the object or light
+            uint32_t prim_id;
+            Vec2f barycentrics;     // Same as optixGetTriangleBarycentrics() for triangles, texture coordinates for custom primitives
+            float t;
+            Vec3f position;
+            Vec3f normal;           // Geometric normal in world space
+        };
+
+        std::optional<RayQueryHit> queryClosestHit(const Ray& ray);
+        bool queryAnyHit(const Ray& ray);
+        // Batch of rays traced on host threads
+        std::vector<std::optional<RayQueryHit>> queryClosestHits(const std::vector<Ray>& rays);
+        std::vector<uint8_t> queryAnyHits(const std::vector<Ray>& rays);
+
         void buildSBT();
         void updateSBT(uint32_t record_type);
     private:
+        // Upload dirty shapes and surfaces, and gather the data of all hitgroup records
+        std::vector<pgHitgroupData> collectHitgroupData();
+
+        // Build or refit the CPU backend's BVH if the scene has been changed since the last build
+        void prepareCpuAccel();
+        // Update the transform/geometry of the instance in the CPU backend's BVH, if it has been built
+        void updateCpuInstanceTransform(const std::string& name, const Matrix4f& transform);
+        void updateCpuInstanceGeometry(const std::string& name);
+        RayQueryHit makeRayQueryHit(const Ray& ray, const CpuHit& hit) const;
+
         template <class T>
         static std::optional<Item<T>> findItem(const std::vector<Item<T>>& items, const std::string& name)
         {
@@ -235,24 +329,40 @@ namespace prayground {
         {
             for (auto it = items.begin(); it != items.end();) {
                 if (it->name == name) {
+                    Item<T> item = *it;
                     items.erase(it);
-                    return *it;
+                    return item;
                 } else {
                     it++;
                 }
             }
+            return std::nullopt;
         }
 
         AccelSettings m_ias_settings;
 
         SBT                         m_sbt;          // Shader binding table
+        std::vector<pgHitgroupData> m_hitgroup_data;// Hitgroup data which has been uploaded to the device
         uint32_t                    m_current_sbt_id;
         InstanceAccel               m_accel;        // m_accel[0] -> Top level
+        CpuAccel                    m_cpu_accel;    // Top level BVH for the CPU backend
+        std::vector<std::string>    m_cpu_instance_names;               // Names of objects/lights per instance of m_cpu_accel
+        std::unordered_map<std::string, uint32_t> m_cpu_instance_indices;
+        bool                        m_cpu_accel_should_refit { false };
+        bool                        m_cpu_accel_should_rebuild { false };
         CUDABuffer<void>            d_params;       // Data region on device side for OptixLaunchParams
 
         // Camera
         std::shared_ptr<CamT>       m_camera;
 
+        // Level of detail of objects
+        struct ObjectLOD {
+            std::vector<std::shared_ptr<Shape>> shapes;
+            std::vector<float> distances;
+            uint32_t current;
+        };
+        std::unordered_map<std::string, ObjectLOD> m_object_lods;
+
         // Environement emitter
         std::shared_ptr<EnvironmentEmitter> m_envmap;
 
@@ -476,6 +586,7 @@ namespace prayground {
             instance.allowUpdate();
 
         m_objects.emplace_back(Item<Object>{ name, m_current_sbt_id, std::make_shared<Object>( shape, materials, instance ) });
+        m_cpu_accel_should_rebuild = true;
 
         // Add hitgroup record data
         for ([[maybe_unused]] const auto& m : materials) {
@@ -503,6 +614,7 @@ namespace prayground {
         }
 
         m_objects.emplace_back(Item<Object>{name, m_current_sbt_id, std::make_shared<Object>( shape, materials, instance )});
+        m_cpu_accel_should_rebuild = true;
 
         // Add hitgroup record data
         for ([[maybe_unused]] const auto& m : materials) {
@@ -545,6 +657,7 @@ namespace prayground {
 
         // Update object's transform matrix.
         obj_val.value->instance.setTransform(transform);
+        updateCpuInstanceTransform(name, transform);
     }
 
     template<DerivedFromCamera _CamT, uint32_t _NRay>
@@ -554,6 +667,8 @@ namespace prayground {
         auto item = deleteItem(m_objects, name);
         if (!item)
             return false;
+        m_cpu_accel_should_rebuild = true;
+        m_object_lods.erase(name);
 
         auto object = item.value();
         uint32_t deleted_sbt_id = object.ID;
@@ -586,6 +701,20 @@ namespace prayground {
         auto& obj_val = obj.value();
 
         obj_val.value->instance.updateAccel(ctx, stream);
+        obj_val.value->dirty = true;
+        updateCpuInstanceGeometry(name);
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline void Scene<_CamT, _NRay>::markObjectDirty(const std::string& name)
+    {
+        auto obj = findItem(m_objects, name);
+        if (!obj) {
+            pgLogFatal("The object named with", name, "is not found.");
+            return;
+        }
+
+        obj.value().value->dirty = true;
     }
 
     template<DerivedFromCamera _CamT, uint32_t _NRay>
@@ -600,6 +729,97 @@ namespace prayground {
         return obj.value().value;
     }
 
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline void Scene<_CamT, _NRay>::setObjectLODs(const std::string& name, const std::vector<std::shared_ptr<Shape>>& lods, const std::vector<float>& distances)
+    {
+        auto obj = findItem(m_objects, name);
+        if (!obj) {
+            pgLogFatal("The object named with", name, "is not found.");
+            return;
+        }
+        ASSERT(!lods.empty(), "At least one LOD is required.");
+        ASSERT(distances.size() + 1 == lods.size(), "The number of distances must be the number of LODs minus one.");
+        ASSERT(std::is_sorted(distances.begin(), distances.end()), "Distances of LODs must be in ascending order.");
+
+        // The current shape stays until updateObjectLODs() if it's one of LODs
+        auto current = std::find(lods.begin(), lods.end(), obj.value().value->shape);
+        m_object_lods[name] = ObjectLOD{ lods, distances, current != lods.end() ? static_cast<uint32_t>(current - lods.begin()) : UINT32_MAX };
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline uint32_t Scene<_CamT, _NRay>::selectLOD(float distance, const std::vector<float>& distances)
+    {
+        return static_cast<uint32_t>(std::upper_bound(distances.begin(), distances.end(), distance) - distances.begin());
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline bool Scene<_CamT, _NRay>::updateObjectLODs(const Context& ctx, CUstream stream)
+    {
+        if (!m_camera) {
+            pgLogFatal("Camera must be set to select LODs of objects.");
+            return false;
+        }
+
+        bool switched = false;
+        for (auto& [name, lod] : m_object_lods)
+        {
+            auto obj = findItem(m_objects, name);
+            if (!obj)
+                continue;
+            auto object = obj.value().value;
+
+            // Bounds of the finest shape represent the object at every LOD
+            const AABB bound = transformBound(lod.shapes[0]->bound(), object->instance.transform());
+            const float distance = length((bound.min() + bound.max()) * 0.5f - m_camera->origin());
+            const uint32_t index = selectLOD(distance, lod.distances);
+            if (index == lod.current)
+                continue;
+
+            auto shape = lod.shapes[index];
+            if (!shape->devicePtr())
+                shape->copyToDevice();
+            object->shape = shape;
+            object->instance.setShape(0, shape);
+            object->instance.buildAccel(ctx, stream);
+            object->dirty = true;
+            lod.current = index;
+            m_cpu_accel_should_rebuild = true;
+            switched = true;
+        }
+        return switched;
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline std::vector<std::string> Scene<_CamT, _NRay>::addClusteredObject(const std::string& name, const std::shared_ptr<TriangleMesh>& mesh,
+        const std::vector<std::shared_ptr<Material>>& materials, std::array<ProgramGroup, _NRay>& hitgroup_prgs,
+        uint32_t max_faces_per_gas, const Matrix4f& transform,
+        const AccelSettings& gas_settings, const MeshClusterSettings& cluster_settings)
+    {
+        ASSERT(max_faces_per_gas > 0, "The number of faces per GAS must be greater than 0.");
+
+        const auto parts = splitMeshByClusters(*mesh, buildMeshClusters(*mesh, cluster_settings), max_faces_per_gas);
+        std::vector<std::string> names;
+        for (size_t i = 0; i < parts.size(); i++)
+        {
+            names.emplace_back(name + "/" + std::to_string(i));
+            addObject(names.back(), parts[i], materials, hitgroup_prgs, transform, gas_settings);
+        }
+        return names;
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline std::vector<std::string> Scene<_CamT, _NRay>::addClusteredObject(const std::string& name, const std::shared_ptr<TriangleMesh>& mesh,
+        const std::vector<std::shared_ptr<Material>>& materials, std::initializer_list<ProgramGroup> hitgroup_prgs,
+        uint32_t max_faces_per_gas, const Matrix4f& transform,
+        const AccelSettings& gas_settings, const MeshClusterSettings& cluster_settings)
+    {
+        ASSERT(hitgroup_prgs.size() == _NRay, "The number of hitgroup programs must be same with the number of ray types.");
+
+        std::array<ProgramGroup, _NRay> prgs;
+        std::copy(hitgroup_prgs.begin(), hitgroup_prgs.end(), prgs.begin());
+        return addClusteredObject(name, mesh, materials, prgs, max_faces_per_gas, transform, gas_settings, cluster_settings);
+    }
+
     // -------------------------------------------------------------------------------
     // Light
     // -------------------------------------------------------------------------------
@@ -628,6 +848,7 @@ namespace prayground {
     {
         ShapeInstance instance{ shape->type(), shape, transform };
         m_lights.emplace_back(Item<Light>{ name, m_current_sbt_id, std::make_shared<Light>( shape, emitters, instance ) });
+        m_cpu_accel_should_rebuild = true;
 
         // Add hitgroup record data
         for ([[maybe_unused]] const auto& e : emitters)
@@ -650,6 +871,7 @@ namespace prayground {
 
         ShapeInstance instance{ shape->type(), shape, transform };
         m_lights.emplace_back(Item<Light>{name, m_current_sbt_id, std::make_shared<Light>( shape, emitters, instance )});
+        m_cpu_accel_should_rebuild = true;
 
         // Add hitgroup record data
         for ([[maybe_unused]] const auto& m : emitters) {
@@ -694,6 +916,7 @@ namespace prayground {
 
         // Update object's transform matrix.
         obj_val.value->instance.setTransform(transform);
+        updateCpuInstanceTransform(name, transform);
     }
 
     template<DerivedFromCamera _CamT, uint32_t _NRay>
@@ -703,6 +926,7 @@ namespace prayground {
         auto item = deleteItem(m_lights, name);
         if (!item)
             return false;
+        m_cpu_accel_should_rebuild = true;
 
         auto light = item.value();
 
@@ -733,6 +957,20 @@ namespace prayground {
         auto& obj_val = obj.value();
 
         obj_val.value->instance.updateAccel(ctx, stream);
+        obj_val.value->dirty = true;
+        updateCpuInstanceGeometry(name);
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline void Scene<_CamT, _NRay>::markLightDirty(const std::string& name)
+    {
+        auto obj = findItem(m_lights, name);
+        if (!obj) {
+            pgLogFatal("The object named with", name, "is not found.");
+            return;
+        }
+
+        obj.value().value->dirty = true;
     }
 
     template<DerivedFromCamera _CamT, uint32_t _NRay>
@@ -1041,7 +1279,11 @@ namespace prayground {
 
                 shape->copyToDevice();
                 for (auto& m : materials)
+                {
                     m->copyToDevice();
+                    m->clearDirty();
+                }
+                object.value->dirty = false;
             }
         };
 
@@ -1051,7 +1293,11 @@ namespace prayground {
             {
                 light.value->shape->copyToDevice();
                 for (auto& e : light.value->emitters)
+                {
                     e->copyToDevice();
+                    e->clearDirty();
+                }
+                light.value->dirty = false;
             }
         };
 
@@ -1122,6 +1368,160 @@ namespace prayground {
         return m_accel.handle();
     }
 
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline void Scene<_CamT, _NRay>::buildCpuAccel()
+    {
+        m_cpu_accel.clear();
+        m_cpu_instance_names.clear();
+        m_cpu_instance_indices.clear();
+
+        // Geometries are shared between objects with the same shape (e.g. duplicated objects)
+        std::unordered_map<Shape*, std::shared_ptr<CpuGeometry>> geometries;
+
+        uint32_t instance_id = 0;
+        auto addInstance = [&](const std::string& name, auto object) -> void
+        {
+            auto it = geometries.find(object->shape.get());
+            if (it == geometries.end())
+                it = geometries.emplace(object->shape.get(), CpuGeometry::create(object->shape)).first;
+
+            if (it->second)
+            {
+                const uint32_t index = m_cpu_accel.addInstance(it->second, object->instance.transform(), instance_id);
+                m_cpu_instance_names.emplace_back(name);
+                m_cpu_instance_indices.emplace(name, index);
+            }
+            else
+                pgLogWarn("The shape of", name, "is not supported by the CPU backend, so it is skipped.");
+            instance_id++;
+        };
+
+        for (auto& obj : m_objects) addInstance(obj.name, obj.value);
+        for (auto& obj : m_lights)  addInstance(obj.name, obj.value);
+
+        // Motion transforms are not supported yet
+        if (!m_moving_objects.empty() || !m_moving_lights.empty())
+            pgLogWarn("Moving objects and lights are skipped by the CPU backend.");
+
+        m_cpu_accel.build();
+        m_cpu_accel_should_refit = false;
+        m_cpu_accel_should_rebuild = false;
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline const CpuAccel& Scene<_CamT, _NRay>::cpuAccel() const
+    {
+        return m_cpu_accel;
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    template <class Kernel>
+    inline void Scene<_CamT, _NRay>::launchRayOnCpu(const Kernel& kernel, uint32_t w, uint32_t h, uint32_t d)
+    {
+        prepareCpuAccel();
+        launchOnCpu(kernel, w, h, d);
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline std::optional<typename Scene<_CamT, _NRay>::RayQueryHit> Scene<_CamT, _NRay>::queryClosestHit(const Ray& ray)
+    {
+        prepareCpuAccel();
+
+        CpuHit hit;
+        if (!m_cpu_accel.intersect(ray, &hit))
+            return std::nullopt;
+        return makeRayQueryHit(ray, hit);
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline bool Scene<_CamT, _NRay>::queryAnyHit(const Ray& ray)
+    {
+        prepareCpuAccel();
+        return m_cpu_accel.occluded(ray);
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline std::vector<std::optional<typename Scene<_CamT, _NRay>::RayQueryHit>> Scene<_CamT, _NRay>::queryClosestHits(const std::vector<Ray>& rays)
+    {
+        prepareCpuAccel();
+
+        std::vector<std::optional<RayQueryHit>> hits(rays.size());
+        parallelFor(0, rays.size(), [&](size_t i)
+        {
+            CpuHit hit;
+            if (m_cpu_accel.intersect(rays[i], &hit))
+                hits[i] = makeRayQueryHit(rays[i], hit);
+        }, 256);
+        return hits;
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline std::vector<uint8_t> Scene<_CamT, _NRay>::queryAnyHits(const std::vector<Ray>& rays)
+    {
+        prepareCpuAccel();
+
+        // Not std::vector<bool>, since its elements can't be written from different threads
+        std::vector<uint8_t> hits(rays.size(), 0);
+        parallelFor(0, rays.size(), [&](size_t i)
+        {
+            hits[i] = m_cpu_accel.occluded(rays[i]) ? 1 : 0;
+        }, 256);
+        return hits;
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline void Scene<_CamT, _NRay>::prepareCpuAccel()
+    {
+        if (!m_cpu_accel.isBuilt() || m_cpu_accel_should_rebuild)
+            buildCpuAccel();
+        else if (m_cpu_accel_should_refit)
+        {
+            m_cpu_accel.refit();
+            m_cpu_accel_should_refit = false;
+        }
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline void Scene<_CamT, _NRay>::updateCpuInstanceTransform(const std::string& name, const Matrix4f& transform)
+    {
+        // The BVH is built lazily at the first query, so nothing to do before that
+        if (!m_cpu_accel.isBuilt() || m_cpu_accel_should_rebuild)
+            return;
+        auto it = m_cpu_instance_indices.find(name);
+        if (it == m_cpu_instance_indices.end())
+            return;
+
+        m_cpu_accel.setTransform(it->second, transform);
+        m_cpu_accel_should_refit = true;
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline void Scene<_CamT, _NRay>::updateCpuInstanceGeometry(const std::string& name)
+    {
+        if (!m_cpu_accel.isBuilt() || m_cpu_accel_should_rebuild)
+            return;
+        auto it = m_cpu_instance_indices.find(name);
+        if (it == m_cpu_instance_indices.end())
+            return;
+
+        // The geometry may be shared with other instances, which are also refitted by this
+        m_cpu_accel.instance(it->second).geometry->update();
+        m_cpu_accel_should_refit = true;
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline typename Scene<_CamT, _NRay>::RayQueryHit Scene<_CamT, _NRay>::makeRayQueryHit(const Ray& ray, const CpuHit& hit) const
+    {
+        RayQueryHit result;
+        result.name = m_cpu_instance_names[hit.instance_index];
+        result.prim_id = hit.prim_id;
+        result.barycentrics = hit.uv;
+        result.t = hit.t;
+        result.position = ray.at(hit.t);
+        result.normal = normalize(hit.normal);
+        return result;
+    }
+
     template <DerivedFromCamera _CamT, uint32_t _NRay>
     inline void Scene<_CamT, _NRay>::buildSBT()
     {
@@ -1137,60 +1537,10 @@ namespace prayground {
             ms_record.data.env_data = m_envmap->devicePtr();
         }
 
-        auto registerObjectSBTData = [&](auto& objects)
-        {
-            for (auto& object : objects)
-            {
-                auto shape = object.value->shape;
-                auto& materials = object.value->materials;
-
-                if (!shape->devicePtr())
-                    shape->copyToDevice();
-
-                uint32_t ID = object.ID;
-                for (auto& m : materials)
-                {
-                    if (!m->devicePtr())
-                        m->copyToDevice();
-                    for (uint32_t i = 0; i < _NRay; i++)
-                    {
-                        pgHitgroupRecord& record = m_sbt.hitgroupRecord(ID + i);
-                        record.data = { shape->devicePtr(), m->surfaceInfoDevicePtr() };
-                    }
-                    ID += _NRay;
-                }
-            }
-        };
-
-        auto registerLightSBTData = [&](auto& lights)
-        {
-            for (auto& light : lights)
-            {
-                auto shape = light.value->shape;
-                auto& emitters = light.value->emitters;
-
-                if (!shape->devicePtr())
-                    shape->copyToDevice();
-
-                uint32_t ID = light.ID;
-                for (auto& e : emitters)
-                {
-                    if (!e->devicePtr())
-                        e->copyToDevice();
-                    for (uint32_t i = 0; i < _NRay; i++)
-                    {
-                        pgHitgroupRecord& record = m_sbt.hitgroupRecord(ID + i);
-                        record.data = { shape->devicePtr(), e->surfaceInfoDevicePtr() };
-                    }
-                    ID += _NRay;
-                }
-            }
-        };
-
-        registerObjectSBTData(m_objects);
-        registerObjectSBTData(m_moving_objects);
-        registerLightSBTData(m_lights);
-        registerLightSBTData(m_moving_lights);
+        // Hitgroup
+        m_hitgroup_data = collectHitgroupData();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_hitgroup_data.size()); i++)
+            m_sbt.hitgroupRecord(i).data = m_hitgroup_data[i];
 
         // Build SBT on device
         m_sbt.createOnDevice();
@@ -1245,72 +1595,62 @@ namespace prayground {
         // Update hitgroup data on device
         if (+(record_type & SBTRecordType::Hitgroup))
         {
-            std::vector<pgHitgroupData> hitgroup_data(m_sbt.numHitgroupRecords());
-            auto collectObjectSBTData = [&](auto& objects)
+            std::vector<pgHitgroupData> hitgroup_data = collectHitgroupData();
+
+            if (hitgroup_data.size() != m_hitgroup_data.size())
             {
-                for (auto& object : objects)
-                {
-                    auto shape = object.value->shape;
-                    auto& materials = object.value->materials;
-
-                    shape->copyToDevice();
-
-                    uint32_t ID = object.ID;
-
-                    // Set hitgroup data to records
-                    for (auto& m : materials) {
-                        m->copyToDevice();
-                        pgHitgroupData hg_data;
-                        hg_data = { shape->devicePtr(), m->surfaceInfoDevicePtr() };
-                        for (uint32_t i = 0; i < _NRay; i++)
-                            hitgroup_data[ID + i] = hg_data;
-                        ID += _NRay;
-                    }
-                }
-            };
+                // Records have been added since the last build, so the whole table must be re-created.
+                m_hitgroup_data = std::move(hitgroup_data);
+                for (uint32_t i = 0; i < static_cast<uint32_t>(m_hitgroup_data.size()); i++)
+                    m_sbt.hitgroupRecord(i).data = m_hitgroup_data[i];
+                m_sbt.raygenRecord().data.camera = m_camera->getData();
+                m_sbt.createOnDevice();
+                return;
+            }
+
+            /* Upload only the records whose data has changed.
+             * Small gaps between changed records are uploaded together to reduce the number of copies. */
+            const std::vector<IndexRange> ranges = diffRecords(m_hitgroup_data, hitgroup_data, /* max_gap = */ _NRay);
+            if (!ranges.empty())
+                m_sbt.updateHitgroupDataOnDevice(hitgroup_data, ranges);
+            m_hitgroup_data = std::move(hitgroup_data);
+        }
+    }
+
+    template<DerivedFromCamera _CamT, uint32_t _NRay>
+    inline std::vector<pgHitgroupData> Scene<_CamT, _NRay>::collectHitgroupData()
+    {
+        std::vector<pgHitgroupData> hitgroup_data(m_sbt.numHitgroupRecords());
+
+        // 'surfaces' is an array of materials for objects, or of area emitters for lights
+        auto collectSBTData = [&](auto& object, uint32_t ID, auto& surfaces)
+        {
+            auto shape = object->shape;
+            if (object->dirty || !shape->devicePtr())
+                shape->copyToDevice();
+            object->dirty = false;
 
-            auto collectLightSBTData = [&](auto& lights)
+            for (auto& surface : surfaces)
             {
-                for (auto& light : lights)
+                // Materials shared by several objects are uploaded only once
+                if (surface->isDirty() || !surface->devicePtr())
                 {
-                    auto shape = light.value->shape;
-                    auto& emitters = light.value->emitters;
-
-                    shape->copyToDevice();
-
-                    uint32_t ID = light.ID;
-
-                    // Set hitgroup data to records
-                    for (auto& e : emitters) {
-                        e->copyToDevice();
-                        pgHitgroupData hg_data;
-                        hg_data = { shape->devicePtr(), e->surfaceInfoDevicePtr() };
-                        for (uint32_t i = 0; i < _NRay; i++)
-                            hitgroup_data[ID + i] = hg_data;
-                        ID += _NRay;
-                    }
+                    surface->copyToDevice();
+                    surface->clearDirty();
                 }
-            };
+                pgHitgroupData hg_data = { shape->devicePtr(), surface->surfaceInfoDevicePtr() };
+                for (uint32_t i = 0; i < _NRay; i++)
+                    hitgroup_data[ID + i] = hg_data;
+                ID += _NRay;
+            }
+        };
 
-            collectObjectSBTData(m_objects);
-            collectObjectSBTData(m_moving_objects);
-            collectLightSBTData(m_lights);
-            collectLightSBTData(m_moving_lights);
-            
-            /* Copy hitgroup data with the header-part stride.
-             * "+ OPTIX_SBT_RECORD_HEADER_SIZE" is for making dst a pointer to the 0th hitgroup data.
-             * 
-             * Array of pgHitgroupRecord ...
-             *                 | pgHitgroupRecord        | pgHitgroupRecord        | ...
-             * record inside : | header | pgHitgroupData | header | pgHitgroupData | ...
-             *                            ^ "+ OPTIX_SBT_RECORD_HEADER_SIZE" makes 'dst' start here */
-            CUDA_CHECK(cudaMemcpy2D(
-                /* dst = */ reinterpret_cast<void*>(m_sbt.deviceHitgroupRecordPtr() + OPTIX_SBT_RECORD_HEADER_SIZE), /* dpitch = */ sizeof(pgHitgroupRecord),
-                /* src = */ hitgroup_data.data(), /* spitch = */ sizeof(pgHitgroupData),
-                /* width = */ sizeof(pgHitgroupData), /* height = */ hitgroup_data.size(), 
-                /* kind = */ cudaMemcpyHostToDevice
-            ));
-        }
+        for (auto& obj : m_objects)        collectSBTData(obj.value, obj.ID, obj.value->materials);
+        for (auto& obj : m_moving_objects) collectSBTData(obj.value, obj.ID, obj.value->materials);
+        for (auto& obj : m_lights)         collectSBTData(obj.value, obj.ID, obj.value->emitters);
+        for (auto& obj : m_moving_lights)  collectSBTData(obj.value, obj.ID, obj.value->emitters);
+
+        return hitgroup_data;
     }
 
 } // namespace prayground
\ No newline at end of file
@@ -8,14 +8,23 @@
 #include <prayground/core/util.h>
 
 #ifndef __CUDACC__
+#include <prayground/cpu/simd.h>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
+#include <string_view>
+#include <vector>
 #endif
 
 namespace prayground {
 
     // Forward declaration
-    class SampledSpectrum;
+    struct SampledSpectrum;
+    struct SampledWavelengths;
+    struct HeroSpectrum;
     HOSTDEVICE INLINE Vec3f XYZToSRGB(const Vec3f& xyz);
     HOSTDEVICE INLINE void XYZToSRGB(float xyz2rgb[3]);
     HOSTDEVICE INLINE Vec3f sRGBToXYZ(const Vec3f& rgb);
@@ -45,6 +54,8 @@ namespace prayground {
         constexpr int max_lambda = 720;
         constexpr int num_spectrum_samples = 81;
         constexpr float CIE_Y_integral = 106.911594f;
+        // Number of wavelengths carried by a path in hero wavelength sampling
+        constexpr int num_hero_wavelengths = 4;
 
         constexpr float spectrum_lambda[num_spectrum_samples] = {
             380.00f, 384.25f, 388.50f, 392.75f, 397.00f, 401.25f, 405.50f, 409.75f, 414.00f, 418.25f,
@@ -59,6 +70,110 @@ namespace prayground {
         };
     }
 
+#ifndef __CUDACC__
+    namespace impl {
+        /**
+         * Host kernels of SampledSpectrum. Since the layout of SampledSpectrum is shared with the device,
+         * samples are loaded without alignment by SimdFloat<8> (one AVX or two SSE/NEON vectors), and the rest
+         * of nSamples is processed in scalar. Op is a generic lambda called with both SimdFloat<8> and float.
+         */
+        using SpectrumSimd = SimdFloat<8>;
+        constexpr int spectrum_simd_width = 8;
+
+        template <int N, class Op>
+        inline void spectrumMap(float* dst, const float* a, const float* b, const Op& op)
+        {
+            int i = 0;
+            for (; i + spectrum_simd_width <= N; i += spectrum_simd_width)
+                op(SpectrumSimd::loadu(a + i), SpectrumSimd::loadu(b + i)).storeu(dst + i);
+            for (; i < N; i++)
+                dst[i] = op(a[i], b[i]);
+        }
+
+        template <int N, class Op>
+        inline void spectrumMap(float* dst, const float* a, const float t, const Op& op)
+        {
+            const SpectrumSimd tv = SpectrumSimd::broadcast(t);
+            int i = 0;
+            for (; i + spectrum_simd_width <= N; i += spectrum_simd_width)
+                op(SpectrumSimd::loadu(a + i), tv).storeu(dst + i);
+            for (; i < N; i++)
+                dst[i] = op(a[i], t);
+        }
+
+        template <int N>
+        inline float spectrumDot(const float* a, const float* b)
+        {
+            SpectrumSimd acc = SpectrumSimd::broadcast(0.0f);
+            int i = 0;
+            for (; i + spectrum_simd_width <= N; i += spectrum_simd_width)
+                acc = acc + SpectrumSimd::loadu(a + i) * SpectrumSimd::loadu(b + i);
+            float sum = reduceAdd(acc);
+            for (; i < N; i++)
+                sum += a[i] * b[i];
+            return sum;
+        }
+
+        template <int N>
+        inline float spectrumSum(const float* a)
+        {
+            SpectrumSimd acc = SpectrumSimd::broadcast(0.0f);
+            int i = 0;
+            for (; i + spectrum_simd_width <= N; i += spectrum_simd_width)
+                acc = acc + SpectrumSimd::loadu(a + i);
+            float sum = reduceAdd(acc);
+            for (; i < N; i++)
+                sum += a[i];
+            return sum;
+        }
+
+        template <int N>
+        inline bool spectrumIsZero(const float* a)
+        {
+            constexpr uint32_t all = (1u << spectrum_simd_width) - 1u;
+            const SpectrumSimd zero = SpectrumSimd::broadcast(0.0f);
+            int i = 0;
+            for (; i + spectrum_simd_width <= N; i += spectrum_simd_width)
+                if (equalMask(SpectrumSimd::loadu(a + i), zero) != all) return false;
+            for (; i < N; i++)
+                if (a[i] != 0.0f) return false;
+            return true;
+        }
+
+        // Zero divisors are replaced with 1
+        inline float safeDivisor(const float b) { return b != 0.0f ? b : 1.0f; }
+        inline SpectrumSimd safeDivisor(const SpectrumSimd& b)
+        {
+            return selectEqual(b, SpectrumSimd::broadcast(0.0f), SpectrumSimd::broadcast(1.0f), b);
+        }
+
+        // CIE curves at the samples of SampledSpectrum, multiplied by the normalization of SampledSpectrum::toXYZ()
+        struct SpectrumCIETable {
+            float x[constants::num_spectrum_samples];
+            float y[constants::num_spectrum_samples];
+            float z[constants::num_spectrum_samples];
+        };
+
+        inline const SpectrumCIETable& spectrumCIETable()
+        {
+            static const SpectrumCIETable table = [] {
+                constexpr int n = constants::num_spectrum_samples;
+                const float scale = float(constants::max_lambda - constants::min_lambda) / (constants::CIE_Y_integral * n);
+                SpectrumCIETable t;
+                for (int i = 0; i < n; i++)
+                {
+                    const float lambda = lerp(constants::min_lambda, constants::max_lambda, float(i) / n);
+                    t.x[i] = CIE_X(lambda) * scale;
+                    t.y[i] = CIE_Y(lambda) * scale;
+                    t.z[i] = CIE_Z(lambda) * scale;
+                }
+                return t;
+            }();
+            return table;
+        }
+    } // namespace impl
+#endif
+
     // SampledSpectrum ---------------------------------------------------------------
     struct SampledSpectrum {
         static constexpr int nSamples = constants::num_spectrum_samples;
@@ -84,28 +199,7 @@ namespace prayground {
             return ss;
         }
 
-        static HOST SampledSpectrum fromFile(const std::filesystem::path& filepath)
-        {
-            std::vector<float> lambda;
-            std::vector<float> value;
-
-            std::ifstream ifs(filepath, std::ios::in);
-            ASSERT(ifs.is_open(), "The SPD file '" + filepath.string() + "' is not found.");
-
-            while (!ifs.eof())
-            {
-                std::string line;
-                if (!std::getline(ifs, line)) continue;
-
-                std::istringstream iss(line);
-                float l, v;
-                iss >> l >> v;
-                lambda.emplace_back(l);
-                value.emplace_back(v);
-            }
-
-            return fromSample(lambda.data(), value.data(), static_cast<int>(lambda.size()));
-        }
+        static HOST SampledSpectrum fromFile(const std::filesystem::path& filepath);
 #endif
         static HOSTDEVICE SampledSpectrum zero()
         {
@@ -135,59 +229,67 @@ namespace prayground {
         /* Addition */
         HOSTDEVICE SampledSpectrum& operator+=(const SampledSpectrum& s2)
         {
+#ifndef __CUDACC__
+            impl::spectrumMap<nSamples>(c, c, s2.c, [](auto a, auto b) { return a + b; });
+#else
             for (int i = 0; i < nSamples; i++)
                 c[i] += s2.c[i];
+#endif
             return *this;
         }
         HOSTDEVICE SampledSpectrum operator+(const SampledSpectrum& s2) const
         {
             SampledSpectrum ret = *this;
-            for (int i = 0; i < nSamples; i++)
-                ret.c[i] += s2.c[i];
-            return ret;
+            return ret += s2;
         }
 
         /* Subtraction */
         HOSTDEVICE SampledSpectrum& operator-=(const SampledSpectrum& s2)
         {
+#ifndef __CUDACC__
+            impl::spectrumMap<nSamples>(c, c, s2.c, [](auto a, auto b) { return a - b; });
+#else
             for (int i = 0; i < nSamples; i++)
                 c[i] -= s2.c[i];
+#endif
             return *this;
         }
         HOSTDEVICE SampledSpectrum operator-(const SampledSpectrum& s2) const
         {
             SampledSpectrum ret = *this;
-            for (int i = 0; i < nSamples; i++)
-                ret.c[i] -= s2.c[i];
-            return ret;
+            return ret -= s2;
         }
 
         /* Multiplication */
         HOSTDEVICE SampledSpectrum& operator*=(const SampledSpectrum& s2)
         {
+#ifndef __CUDACC__
+            impl::spectrumMap<nSamples>(c, c, s2.c, [](auto a, auto b) { return a * b; });
+#else
             for (int i = 0; i < nSamples; i++)
                 c[i] *= s2.c[i];
+#endif
             return *this;
         }
         HOSTDEVICE SampledSpectrum operator*(const SampledSpectrum& s2) const
         {
             SampledSpectrum ret = *this;
-            for (int i = 0; i < nSamples; i++)
-                ret.c[i] *= s2.c[i];
-            return ret;
+            return ret *= s2;
         }
         HOSTDEVICE SampledSpectrum& operator*=(const float& t)
         {
+#ifndef __CUDACC__
+            impl::spectrumMap<nSamples>(c, c, t, [](auto a, auto b) { return a * b; });
+#else
             for (int i = 0; i < nSamples; i++)
                 c[i] *= t;
+#endif
             return *this;
         }
         HOSTDEVICE SampledSpectrum operator*(const float& t) const
         {
             SampledSpectrum ret = *this;
-            for (int i = 0; i < nSamples; i++)
-                ret.c[i] *= t;
-            return ret;
+            return ret *= t;
         }
         HOSTDEVICE friend inline SampledSpectrum operator*(const float& t, const SampledSpectrum& s)
         {
@@ -198,29 +300,33 @@ namespace prayground {
         /* Division */
         HOSTDEVICE SampledSpectrum& operator/=(const SampledSpectrum& s2)
         {
+#ifndef __CUDACC__
+            impl::spectrumMap<nSamples>(c, c, s2.c, [](auto a, auto b) { return a / impl::safeDivisor(b); });
+#else
             for (int i = 0; i < nSamples; i++)
                 c[i] /= s2.c[i] != 0.0f ? s2.c[i] : 1.0f;
+#endif
             return *this;
         }
         HOSTDEVICE SampledSpectrum operator/(const SampledSpectrum& s2) const
         {
             SampledSpectrum ret = *this;
-            for (int i = 0; i < nSamples; i++)
-                ret.c[i] /= s2.c[i] != 0.0f ? s2.c[i] : 1.0f;
-            return ret;
+            return ret /= s2;
         }
         HOSTDEVICE SampledSpectrum& operator/=(const float& t)
         {
+#ifndef __CUDACC__
+            impl::spectrumMap<nSamples>(c, c, t, [](auto a, auto b) { return a / b; });
+#else
             for (int i = 0; i < nSamples; i++)
                 c[i] /= t;
+#endif
             return *this;
         }
         HOSTDEVICE SampledSpectrum operator/(const float& t) const
         {
             SampledSpectrum ret = *this;
-            for (int i = 0; i < nSamples; i++)
-                ret.c[i] /= t;
-            return ret;
+            return ret /= t;
         }
         HOSTDEVICE friend inline SampledSpectrum operator/(const float& t, const SampledSpectrum& s)
         {
@@ -230,13 +336,24 @@ namespace prayground {
 
         HOSTDEVICE bool isBlack() const
         {
+#ifndef __CUDACC__
+            return impl::spectrumIsZero<nSamples>(c);
+#else
             for (int i = 0; i < nSamples; i++)
                 if (c[i] != 0.0f) return false;
             return true;
+#endif
         }
 
         HOSTDEVICE Vec3f toXYZ() const
         {
+#ifndef __CUDACC__
+            const impl::SpectrumCIETable& cie = impl::spectrumCIETable();
+            return Vec3f(
+                impl::spectrumDot<nSamples>(c, cie.x),
+                impl::spectrumDot<nSamples>(c, cie.y),
+                impl::spectrumDot<nSamples>(c, cie.z));
+#else
             Vec3f ret{ 0.0f, 0.0f, 0.0f };
             for (int i = 0; i < nSamples; i++)
             {
@@ -248,6 +365,7 @@ namespace prayground {
             const float scale = float(constants::max_lambda - constants::min_lambda) / (constants::CIE_Y_integral * nSamples);
 
             return ret * scale;
+#endif
         }
 
         HOSTDEVICE Vec3f toRGB() const
@@ -258,17 +376,27 @@ namespace prayground {
 
         HOSTDEVICE float getSpectrumFromWavelength(const float& lambda) const
         {
-            return linearInterpSpectrumSamples(constants::spectrum_lambda, c, nSamples, lambda);
+            // Same as linearInterpSpectrumSamples() with constants::spectrum_lambda, whose interval is uniform
+            constexpr float interval = float(constants::max_lambda - constants::min_lambda) / (nSamples - 1);
+            const float t = (lambda - constants::min_lambda) / interval;
+            if (!(t > 0.0f)) return c[0];
+            if (t >= float(nSamples - 1)) return c[nSamples - 1];
+            const int i = static_cast<int>(t);
+            return lerp(c[i], c[i + 1], t - float(i));
         }
 
         HOSTDEVICE float y() const
         {
+#ifndef __CUDACC__
+            return impl::spectrumSum<nSamples>(c);
+#else
             float sum = 0.0f;
             for (int i = 0; i < nSamples; i++)
             {
                 sum += c[i];
             }
             return sum;
+#endif
         }
 
         //friend SampledSpectrum sqrtf(const SampledSpectrum& s)
@@ -562,13 +690,14 @@ namespace prayground {
 
         if (l <= lambda[0]) return v[0];
         if (l >= lambda[n - 1]) return v[n - 1];
-        int offset = 0;
-        for (int i = 0; i < n - 1; i++) {
-            /// @note Assumption: all lambda values are different
-            if (lambda[i] <= l && lambda[i + 1] > l) {
-                offset = i;
-                break;
-            }
+        // Binary search of the last sample that lambda[offset] <= l
+        /// @note Assumption: all lambda values are different
+        int offset = 0, last = n - 1;
+        while (last - offset > 1)
+        {
+            const int mid = (offset + last) / 2;
+            if (lambda[mid] <= l) offset = mid;
+            else                  last = mid;
         }
         const float t = fminf((l - lambda[offset]) / (lambda[offset + 1] - lambda[offset]), 1.0f);
         return lerp(v[offset], v[offset + 1], t);
@@ -579,56 +708,424 @@ namespace prayground {
         return a + t * (b - a);
     }
 
+    namespace impl {
+        /**
+         * Smits' reconstruction as a sum of white and two of the basis spectra weighted with differences
+         * between RGB components. basis(table) converts a table in constants to Spectrum.
+         */
+        template <class Spectrum, class Basis>
+        HOSTDEVICE INLINE Spectrum rgb2spectrum(const Vec3f& rgb, const Basis& basis)
+        {
+            Spectrum ret = Spectrum::zero();
+            const float r = rgb[0];
+            const float g = rgb[1];
+            const float b = rgb[2];
+
+            if (r <= g && r <= b)
+            {
+                ret += basis(constants::rgb2spectrum_white) * r;
+                if (g <= b)
+                {
+                    ret += basis(constants::rgb2spectrum_cyan) * (g - r);
+                    ret += basis(constants::rgb2spectrum_blue) * (b - g);
+                }
+                else
+                {
+                    ret += basis(constants::rgb2spectrum_cyan) * (b - r);
+                    ret += basis(constants::rgb2spectrum_green) * (g - b);
+                }
+            }
+            else if (g <= r && g <= b)
+            {
+                ret += basis(constants::rgb2spectrum_white) * g;
+                if (r <= b)
+                {
+                    ret += basis(constants::rgb2spectrum_magenta) * (r - g);
+                    ret += basis(constants::rgb2spectrum_blue) * (b - r);
+                }
+                else
+                {
+                    ret += basis(constants::rgb2spectrum_magenta) * (b - g);
+                    ret += basis(constants::rgb2spectrum_red) * (r - b);
+                }
+            }
+            else // blue <= red && blue <= green
+            {
+                ret += basis(constants::rgb2spectrum_white) * b;
+                if (r <= g)
+                {
+                    ret += basis(constants::rgb2spectrum_yellow) * (r - b);
+                    ret += basis(constants::rgb2spectrum_green) * (g - r);
+                }
+                else
+                {
+                    ret += basis(constants::rgb2spectrum_yellow) * (g - b);
+                    ret += basis(constants::rgb2spectrum_red) * (r - g);
+                }
+            }
+            return ret;
+        }
+
+        struct FullBasis {
+            HOSTDEVICE const SampledSpectrum& operator()(const SampledSpectrum& table) const { return table; }
+        };
+    } // namespace impl
+
     HOSTDEVICE INLINE SampledSpectrum rgb2spectrum(const Vec3f& rgb)
     {
-        SampledSpectrum ret = SampledSpectrum::zero();
-        const float r = rgb[0];
-        const float g = rgb[1];
-        const float b = rgb[2];
+        return impl::rgb2spectrum<SampledSpectrum>(rgb, impl::FullBasis{});
+    }
 
-        if (r <= g && r <= b)
+#ifndef __CUDACC__
+    /**
+     * Parse "lambda value" lines of SPD text. Numbers may be separated by spaces, tabs, commas or semicolons,
+     * and lines that don't start with two numbers (comments, headers) are skipped.
+     * The parsed samples are sorted by lambda if they are not.
+     */
+    HOST inline void parseSPD(std::string_view text, std::vector<float>& lambda, std::vector<float>& value)
+    {
+        auto isSeparator = [](char c) { return c == ' ' || c == '\t' || c == ',' || c == ';'; };
+
+        const size_t first = lambda.size();
+        bool sorted = true;
+        const char* p = text.data();
+        const char* const end = p + text.size();
+        while (p < end)
         {
-            ret += constants::rgb2spectrum_white * r;
-            if (g <= b)
-            {
-                ret += constants::rgb2spectrum_cyan * (g - r);
-                ret += constants::rgb2spectrum_blue * (b - g);
-            }
-            else
+            const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+            if (!eol) eol = end;
+
+            float l, v;
+            while (p < eol && isSeparator(*p)) p++;
+            auto [next, ec] = std::from_chars(p, eol, l);
+            if (ec == std::errc())
             {
-                ret += constants::rgb2spectrum_cyan * (b - r);
-                ret += constants::rgb2spectrum_green * (g - b);
+                p = next;
+                while (p < eol && isSeparator(*p)) p++;
+                if (std::from_chars(p, eol, v).ec == std::errc())
+                {
+                    sorted &= lambda.size() == first || lambda.back() <= l;
+                    lambda.emplace_back(l);
+                    value.emplace_back(v);
+                }
             }
+            p = eol + 1;
         }
-        else if (g <= r && g <= b)
+
+        if (!sorted)
         {
-            ret += constants::rgb2spectrum_white * g;
-            if (r <= g)
+            std::vector<std::pair<float, float>> samples;
+            samples.reserve(lambda.size() - first);
+            for (size_t i = first; i < lambda.size(); i++)
+                samples.emplace_back(lambda[i], value[i]);
+            std::stable_sort(samples.begin(), samples.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (size_t i = 0; i < samples.size(); i++)
             {
-                ret += constants::rgb2spectrum_magenta * (r - g);
-                ret += constants::rgb2spectrum_blue * (b - r);
+                lambda[first + i] = samples[i].first;
+                value[first + i] = samples[i].second;
             }
-            else
+        }
+    }
+
+    /* Read samples of SPD file with parseSPD() */
+    HOST inline void loadSPDFile(const std::filesystem::path& filepath, std::vector<float>& lambda, std::vector<float>& value)
+    {
+        std::ifstream ifs(filepath, std::ios::in | std::ios::binary | std::ios::ate);
+        ASSERT(ifs.is_open(), "The SPD file '" + filepath.string() + "' is not found.");
+
+        std::string text(static_cast<size_t>(ifs.tellg()), '\0');
+        ifs.seekg(0);
+        ifs.read(text.data(), static_cast<std::streamsize>(text.size()));
+        parseSPD(text, lambda, value);
+    }
+
+    HOST inline SampledSpectrum SampledSpectrum::fromFile(const std::filesystem::path& filepath)
+    {
+        std::vector<float> lambda;
+        std::vector<float> value;
+        loadSPDFile(filepath, lambda, value);
+        ASSERT(!lambda.empty(), "The SPD file '" + filepath.string() + "' doesn't have samples.");
+        return fromSample(lambda.data(), value.data(), static_cast<int>(lambda.size()));
+    }
+#endif
+
+    // SampledWavelengths ------------------------------------------------------------
+    /**
+     * @brief Wavelengths traced together by a path in hero wavelength sampling [Wilkie et al. 2014].
+     * lambda[0] is the hero wavelength, and the others are rotated from it by 1/nSamples of the visible
+     * range, so they stratify the range with one random number.
+     */
+    struct SampledWavelengths {
+        static constexpr int nSamples = constants::num_hero_wavelengths;
+
+        float lambda[nSamples];
+        float pdf[nSamples];
+
+        /* Uniform distribution in [min_lambda, max_lambda] */
+        static HOSTDEVICE SampledWavelengths sampleUniform(const float u)
+        {
+            constexpr float range = float(constants::max_lambda - constants::min_lambda);
+            SampledWavelengths wl;
+            for (int i = 0; i < nSamples; i++)
             {
-                ret += constants::rgb2spectrum_magenta * (b - g);
-                ret += constants::rgb2spectrum_red * (r - b);
+                float ui = u + float(i) / nSamples;
+                ui -= ui >= 1.0f ? 1.0f : 0.0f;
+                wl.lambda[i] = constants::min_lambda + range * ui;
+                wl.pdf[i] = 1.0f / range;
             }
+            return wl;
         }
-        else // blue <= red && blue <= green
+
+        /**
+         * Distribution proportional to 1/cosh^2(0.0072 (lambda - 538)), which roughly follows the sum of CIE curves
+         * [Radziszewski et al. 2009], truncated to [min_lambda, max_lambda]. Less noise than uniform for most spectra.
+         */
+        static HOSTDEVICE SampledWavelengths sampleVisible(const float u)
         {
-            ret += constants::rgb2spectrum_white * b;
-            if (r <= g)
+            constexpr float a = 0.0072f;
+            const float cdf_min = tanhf(a * (constants::min_lambda - 538.0f));
+            const float cdf_max = tanhf(a * (constants::max_lambda - 538.0f));
+
+            SampledWavelengths wl;
+            for (int i = 0; i < nSamples; i++)
             {
-                ret += constants::rgb2spectrum_yellow * (r - b);
-                ret += constants::rgb2spectrum_green * (g - r);
+                float ui = u + float(i) / nSamples;
+                ui -= ui >= 1.0f ? 1.0f : 0.0f;
+                const float l = 538.0f + atanhf(lerp(cdf_min, cdf_max, ui)) / a;
+                wl.lambda[i] = fminf(fmaxf(l, float(constants::min_lambda)), float(constants::max_lambda));
+                wl.pdf[i] = visiblePdf(wl.lambda[i]);
             }
-            else
+            return wl;
+        }
+
+        static HOSTDEVICE float visiblePdf(const float lambda)
+        {
+            if (lambda < constants::min_lambda || lambda > constants::max_lambda)
+                return 0.0f;
+            constexpr float a = 0.0072f;
+            const float norm = tanhf(a * (constants::max_lambda - 538.0f)) - tanhf(a * (constants::min_lambda - 538.0f));
+            const float ch = coshf(a * (lambda - 538.0f));
+            return a / (norm * ch * ch);
+        }
+
+        HOSTDEVICE float operator[](int i) const
+        {
+            return lambda[i];
+        }
+
+        /**
+         * Trace only the hero wavelength after wavelength-dependent scattering such as dispersion.
+         * The PDF of hero wavelength is divided so that toXYZ() keeps being unbiased.
+         */
+        HOSTDEVICE void terminateSecondary()
+        {
+            if (secondaryTerminated())
+                return;
+            for (int i = 1; i < nSamples; i++)
+                pdf[i] = 0.0f;
+            pdf[0] /= nSamples;
+        }
+
+        HOSTDEVICE bool secondaryTerminated() const
+        {
+            for (int i = 1; i < nSamples; i++)
+                if (pdf[i] != 0.0f) return false;
+            return true;
+        }
+    };
+
+    // HeroSpectrum ------------------------------------------------------------------
+    /**
+     * @brief Spectrum values at SampledWavelengths.
+     * This is 16 bytes against 324 bytes of SampledSpectrum, so it can be carried through a path instead.
+     */
+    struct HeroSpectrum {
+        static constexpr int nSamples = constants::num_hero_wavelengths;
+
+        float c[nSamples];
+
+        static HOSTDEVICE HeroSpectrum zero()
+        {
+            return constant(0.0f);
+        }
+
+        static HOSTDEVICE HeroSpectrum constant(const float t)
+        {
+            HeroSpectrum ret;
+            for (int i = 0; i < nSamples; i++)
+                ret.c[i] = t;
+            return ret;
+        }
+
+        static HOSTDEVICE HeroSpectrum fromSampledSpectrum(const SampledSpectrum& s, const SampledWavelengths& wl)
+        {
+            HeroSpectrum ret;
+            for (int i = 0; i < nSamples; i++)
+                ret.c[i] = s.getSpectrumFromWavelength(wl.lambda[i]);
+            return ret;
+        }
+
+        /* Piecewise linear spectrum given by samples sorted with lambda, e.g. read by loadSPDFile() */
+        static HOSTDEVICE HeroSpectrum fromSample(const float* lambda, const float* v, int n, const SampledWavelengths& wl)
+        {
+            HeroSpectrum ret;
+            for (int i = 0; i < nSamples; i++)
+                ret.c[i] = linearInterpSpectrumSamples(lambda, v, n, wl.lambda[i]);
+            return ret;
+        }
+
+        HOSTDEVICE float& operator[](int i)
+        {
+            return c[i];
+        }
+
+        HOSTDEVICE const float& operator[](int i) const
+        {
+            return c[i];
+        }
+
+        /* Addition */
+        HOSTDEVICE HeroSpectrum& operator+=(const HeroSpectrum& s2)
+        {
+            for (int i = 0; i < nSamples; i++)
+                c[i] += s2.c[i];
+            return *this;
+        }
+        HOSTDEVICE HeroSpectrum operator+(const HeroSpectrum& s2) const
+        {
+            HeroSpectrum ret = *this;
+            return ret += s2;
+        }
+
+        /* Subtraction */
+        HOSTDEVICE HeroSpectrum& operator-=(const HeroSpectrum& s2)
+        {
+            for (int i = 0; i < nSamples; i++)
+                c[i] -= s2.c[i];
+            return *this;
+        }
+        HOSTDEVICE HeroSpectrum operator-(const HeroSpectrum& s2) const
+        {
+            HeroSpectrum ret = *this;
+            return ret -= s2;
+        }
+
+        /* Multiplication */
+        HOSTDEVICE HeroSpectrum& operator*=(const HeroSpectrum& s2)
+        {
+            for (int i = 0; i < nSamples; i++)
+                c[i] *= s2.c[i];
+            return *this;
+        }
+        HOSTDEVICE HeroSpectrum operator*(const HeroSpectrum& s2) const
+        {
+            HeroSpectrum ret = *this;
+            return ret *= s2;
+        }
+        HOSTDEVICE HeroSpectrum& operator*=(const float& t)
+        {
+            for (int i = 0; i < nSamples; i++)
+                c[i] *= t;
+            return *this;
+        }
+        HOSTDEVICE HeroSpectrum operator*(const float& t) const
+        {
+            HeroSpectrum ret = *this;
+            return ret *= t;
+        }
+        HOSTDEVICE friend inline HeroSpectrum operator*(const float& t, const HeroSpectrum& s)
+        {
+            return s * t;
+        }
+
+        /* Division. Zero components of the divisor are treated as 1 like SampledSpectrum. */
+        HOSTDEVICE HeroSpectrum& operator/=(const HeroSpectrum& s2)
+        {
+            for (int i = 0; i < nSamples; i++)
+                c[i] /= s2.c[i] != 0.0f ? s2.c[i] : 1.0f;
+            return *this;
+        }
+        HOSTDEVICE HeroSpectrum operator/(const HeroSpectrum& s2) const
+        {
+            HeroSpectrum ret = *this;
+            return ret /= s2;
+        }
+        HOSTDEVICE HeroSpectrum& operator/=(const float& t)
+        {
+            for (int i = 0; i < nSamples; i++)
+                c[i] /= t;
+            return *this;
+        }
+        HOSTDEVICE HeroSpectrum operator/(const float& t) const
+        {
+            HeroSpectrum ret = *this;
+            return ret /= t;
+        }
+
+        HOSTDEVICE bool isBlack() const
+        {
+            for (int i = 0; i < nSamples; i++)
+                if (c[i] != 0.0f) return false;
+            return true;
+        }
+
+        HOSTDEVICE float average() const
+        {
+            float sum = 0.0f;
+            for (int i = 0; i < nSamples; i++)
+                sum += c[i];
+            return sum / nSamples;
+        }
+
+        HOSTDEVICE float maxValue() const
+        {
+            float ret = c[0];
+            for (int i = 1; i < nSamples; i++)
+                ret = fmaxf(ret, c[i]);
+            return ret;
+        }
+
+        /**
+         * One-sample estimate of the XYZ integral of the spectrum. The average of estimates over paths
+         * converges to SampledSpectrum::toXYZ() of the same spectrum.
+         */
+        HOSTDEVICE Vec3f toXYZ(const SampledWavelengths& wl) const
+        {
+            Vec3f ret{ 0.0f, 0.0f, 0.0f };
+            for (int i = 0; i < nSamples; i++)
             {
-                ret += constants::rgb2spectrum_yellow * (g - b);
-                ret += constants::rgb2spectrum_red * (r - g);
+                if (wl.pdf[i] == 0.0f)
+                    continue;
+                const float w = c[i] / wl.pdf[i];
+                ret[0] += w * CIE_X(wl.lambda[i]);
+                ret[1] += w * CIE_Y(wl.lambda[i]);
+                ret[2] += w * CIE_Z(wl.lambda[i]);
             }
+            return ret / (constants::CIE_Y_integral * nSamples);
+        }
+
+        HOSTDEVICE Vec3f toRGB(const SampledWavelengths& wl) const
+        {
+            return XYZToSRGB(toXYZ(wl));
+        }
+
+        HOSTDEVICE float y(const SampledWavelengths& wl) const
+        {
+            return toXYZ(wl)[1];
         }
-        return ret;
+    };
+
+    namespace impl {
+        struct HeroBasis {
+            const SampledWavelengths& wl;
+            HOSTDEVICE HeroSpectrum operator()(const SampledSpectrum& table) const { return HeroSpectrum::fromSampledSpectrum(table, wl); }
+        };
+    } // namespace impl
+
+    /* Evaluate rgb2spectrum(rgb) only at the sampled wavelengths */
+    HOSTDEVICE INLINE HeroSpectrum rgb2spectrum(const Vec3f& rgb, const SampledWavelengths& wl)
+    {
+        return impl::rgb2spectrum<HeroSpectrum>(rgb, impl::HeroBasis{ wl });
     }
 
 } // namespace prayground
@@ -0,0 +1,382 @@
+#include "spectrum_library.h"
+#include <prayground/core/parallel.h>
+#include <prayground/core/util.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+
+namespace prayground {
+
+    namespace fs = std::filesystem;
+
+    namespace {
+        // "PGSL" in little endian
+        constexpr uint32_t archive_magic = 0x4c534750;
+        constexpr uint32_t archive_version = 1;
+        constexpr uint32_t empty_slot = 0xffffffff;
+        constexpr uint64_t spectra_alignment = 64;
+
+        /**
+         * Layout of the archive (little endian):
+         * Header | Slot[table_size] | SampledSpectrum[count] (64 bytes aligned) | names
+         * Slots are an open addressing hash table with linear probing.
+         */
+        struct ArchiveHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t num_samples;
+            uint32_t count;
+            uint32_t table_size;
+            uint32_t num_sources;
+            uint64_t table_offset;
+            uint64_t spectra_offset;
+            uint64_t names_offset;
+            uint64_t names_size;
+        };
+
+        struct ArchiveSlot {
+            uint64_t hash;
+            uint32_t name_offset;
+            uint32_t name_length;
+            uint32_t index;
+            uint32_t padding;
+        };
+
+        static_assert(sizeof(ArchiveHeader) == 56);
+        static_assert(sizeof(ArchiveSlot) == 24);
+
+        uint64_t alignUp(uint64_t v, uint64_t alignment)
+        {
+            return (v + alignment - 1) / alignment * alignment;
+        }
+
+        std::string toLower(std::string s)
+        {
+            std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return s;
+        }
+
+        fs::path findDirectory(const fs::path& directory)
+        {
+            std::optional<fs::path> dir = pgFindDataPath(directory);
+            ASSERT(dir && fs::is_directory(dir.value()), "The SPD directory '" + directory.string() + "' is not found.");
+            return dir.value();
+        }
+
+        // Sorted so that names and indices don't depend on the order of the file system
+        std::vector<fs::path> findSPDFiles(const fs::path& directory, const std::vector<std::string>& extensions)
+        {
+            std::vector<std::string> exts;
+            for (const auto& ext : extensions)
+                exts.push_back(toLower(ext));
+
+            std::vector<fs::path> files;
+            for (const auto& entry : fs::recursive_directory_iterator(directory))
+            {
+                if (!entry.is_regular_file())
+                    continue;
+                const std::string ext = toLower(pgGetExtension(entry.path()));
+                if (std::find(exts.begin(), exts.end(), ext) != exts.end())
+                    files.push_back(entry.path());
+            }
+            std::sort(files.begin(), files.end());
+            return files;
+        }
+
+        const ArchiveHeader& header(const MappedFile& archive)
+        {
+            return *reinterpret_cast<const ArchiveHeader*>(archive.data());
+        }
+
+        const ArchiveSlot* slots(const MappedFile& archive)
+        {
+            return reinterpret_cast<const ArchiveSlot*>(archive.data() + header(archive).table_offset);
+        }
+
+        const SampledSpectrum* spectra(const MappedFile& archive)
+        {
+            return reinterpret_cast<const SampledSpectrum*>(archive.data() + header(archive).spectra_offset);
+        }
+
+        std::string_view slotName(const MappedFile& archive, const ArchiveSlot& slot)
+        {
+            const char* names = reinterpret_cast<const char*>(archive.data() + header(archive).names_offset);
+            return std::string_view(names + slot.name_offset, slot.name_length);
+        }
+    } // nonamed namespace
+
+    // --------------------------------------------------------------------
+    void SpectrumLibrary::loadDirectory(const fs::path& directory, const std::vector<std::string>& extensions)
+    {
+        const fs::path dir = findDirectory(directory);
+        const std::vector<fs::path> files = findSPDFiles(dir, extensions);
+
+        std::vector<SampledSpectrum> spectra(files.size());
+        std::vector<std::string> errors(files.size());
+        parallelFor(0, files.size(), [&](size_t i)
+        {
+            try
+            {
+                MappedFile file(files[i]);
+                std::vector<float> lambda, value;
+                parseSPD(std::string_view(reinterpret_cast<const char*>(file.data()), file.size()), lambda, value);
+                if (lambda.empty())
+                    errors[i] = "The file doesn't have samples.";
+                else
+                    spectra[i] = SampledSpectrum::fromSample(lambda.data(), value.data(), static_cast<int>(lambda.size()));
+            }
+            catch (const std::exception& e)
+            {
+                errors[i] = e.what();
+            }
+        }, 1);
+
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            if (!errors[i].empty())
+            {
+                pgLogWarn("Failed to load the SPD file '" + files[i].string() + "':", errors[i]);
+                continue;
+            }
+            fs::path name = fs::relative(files[i], dir);
+            name.replace_extension();
+            add(name.generic_string(), spectra[i]);
+        }
+        m_num_sources = static_cast<uint32_t>(files.size());
+    }
+
+    void SpectrumLibrary::loadCached(const fs::path& directory, const fs::path& archive, const std::vector<std::string>& extensions)
+    {
+        const fs::path dir = findDirectory(directory);
+        const std::vector<fs::path> files = findSPDFiles(dir, extensions);
+
+        std::error_code ec;
+        const fs::file_time_type archive_time = fs::last_write_time(archive, ec);
+        bool up_to_date = !ec;
+        for (size_t i = 0; i < files.size() && up_to_date; i++)
+            up_to_date = fs::last_write_time(files[i]) <= archive_time;
+
+        if (up_to_date)
+        {
+            try
+            {
+                clear();
+                openArchive(archive);
+                if (m_num_sources == files.size())
+                    return;
+            }
+            catch (const std::exception& e)
+            {
+                pgLogWarn("The SPD archive '" + archive.string() + "' is rebuilt:", e.what());
+            }
+        }
+
+        clear();
+        loadDirectory(dir, extensions);
+        save(archive);
+    }
+
+    // --------------------------------------------------------------------
+    void SpectrumLibrary::save(const fs::path& archive) const
+    {
+        // Entries in the order of indices
+        std::vector<std::string_view> names;
+        std::vector<const SampledSpectrum*> entries;
+        if (m_archive.isOpen())
+        {
+            const ArchiveHeader& h = header(m_archive);
+            names.resize(h.count);
+            entries.resize(h.count);
+            for (uint32_t i = 0; i < h.table_size; i++)
+            {
+                const ArchiveSlot& slot = slots(m_archive)[i];
+                if (slot.index == empty_slot)
+                    continue;
+                names[slot.index] = slotName(m_archive, slot);
+                entries[slot.index] = &spectra(m_archive)[slot.index];
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < m_spectra.size(); i++)
+            {
+                names.emplace_back(m_names[i]);
+                entries.emplace_back(&m_spectra[i]);
+            }
+        }
+
+        const uint32_t count = static_cast<uint32_t>(entries.size());
+        // Load factor is at most 0.5
+        uint32_t table_size = 1;
+        while (table_size < count * 2)
+            table_size <<= 1;
+
+        std::vector<ArchiveSlot> table(table_size, ArchiveSlot{ 0, 0, 0, empty_slot, 0 });
+        std::string name_blob;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const uint64_t h = fnv1a(names[i]);
+            uint32_t s = static_cast<uint32_t>(h) & (table_size - 1);
+            while (table[s].index != empty_slot)
+                s = (s + 1) & (table_size - 1);
+            table[s] = ArchiveSlot{ h, static_cast<uint32_t>(name_blob.size()), static_cast<uint32_t>(names[i].size()), i, 0 };
+            name_blob.append(names[i]);
+        }
+
+        ArchiveHeader h{};
+        h.magic = archive_magic;
+        h.version = archive_version;
+        h.num_samples = SampledSpectrum::nSamples;
+        h.count = count;
+        h.table_size = table_size;
+        h.num_sources = m_num_sources;
+        h.table_offset = sizeof(ArchiveHeader);
+        h.spectra_offset = alignUp(h.table_offset + sizeof(ArchiveSlot) * table_size, spectra_alignment);
+        h.names_offset = h.spectra_offset + sizeof(SampledSpectrum) * count;
+        h.names_size = name_blob.size();
+
+        std::ofstream ofs(archive, std::ios::binary);
+        ASSERT(ofs.is_open(), "Failed to open '" + archive.string() + "' to write the SPD archive.");
+        ofs.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        ofs.write(reinterpret_cast<const char*>(table.data()), sizeof(ArchiveSlot) * table.size());
+        const std::vector<char> padding(h.spectra_offset - (h.table_offset + sizeof(ArchiveSlot) * table_size), 0);
+        ofs.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        for (const SampledSpectrum* spectrum : entries)
+            ofs.write(reinterpret_cast<const char*>(spectrum), sizeof(SampledSpectrum));
+        ofs.write(name_blob.data(), static_cast<std::streamsize>(name_blob.size()));
+        ASSERT(ofs.good(), "Failed to write the SPD archive to '" + archive.string() + "'.");
+    }
+
+    void SpectrumLibrary::openArchive(const fs::path& archive)
+    {
+        std::optional<fs::path> path = pgFindDataPath(archive);
+        ASSERT(path, "The SPD archive '" + archive.string() + "' is not found.");
+
+        MappedFile file(path.value());
+        auto invalid = [&](const std::string& msg) { THROW("Invalid SPD archive '" + path.value().string() + "': " + msg); };
+
+        if (file.size() < sizeof(ArchiveHeader))
+            invalid("The file is too small.");
+        const ArchiveHeader& h = header(file);
+        if (h.magic != archive_magic)
+            invalid("Magic number mismatch.");
+        if (h.version != archive_version)
+            invalid("Unsupported version " + std::to_string(h.version) + ".");
+        if (h.num_samples != SampledSpectrum::nSamples)
+            invalid("The number of samples " + std::to_string(h.num_samples) + " differs from SampledSpectrum.");
+        if (h.table_size == 0 || (h.table_size & (h.table_size - 1)) != 0 || h.count > h.table_size / 2)
+            invalid("Broken hash table.");
+        if (h.table_offset != sizeof(ArchiveHeader) || h.spectra_offset % spectra_alignment != 0
+            || h.spectra_offset < h.table_offset + sizeof(ArchiveSlot) * uint64_t(h.table_size)
+            || h.names_offset != h.spectra_offset + sizeof(SampledSpectrum) * uint64_t(h.count)
+            || h.names_offset + h.names_size != file.size())
+            invalid("Section sizes don't match the file.");
+
+        uint32_t num_entries = 0;
+        for (uint32_t i = 0; i < h.table_size; i++)
+        {
+            const ArchiveSlot& slot = slots(file)[i];
+            if (slot.index == empty_slot)
+                continue;
+            if (slot.index >= h.count || uint64_t(slot.name_offset) + slot.name_length > h.names_size)
+                invalid("Broken entry.");
+            num_entries++;
+        }
+        if (num_entries != h.count)
+            invalid("Broken entry.");
+
+        clear();
+        m_num_sources = h.num_sources;
+        m_archive = std::move(file);
+    }
+
+    // --------------------------------------------------------------------
+    void SpectrumLibrary::add(const std::string& name, const SampledSpectrum& spectrum)
+    {
+        detachArchive();
+        if (auto it = m_index.find(name); it != m_index.end())
+        {
+            m_spectra[it->second] = spectrum;
+            return;
+        }
+        m_index.emplace(name, static_cast<uint32_t>(m_spectra.size()));
+        m_names.emplace_back(name);
+        m_spectra.emplace_back(spectrum);
+    }
+
+    const SampledSpectrum* SpectrumLibrary::find(std::string_view name) const
+    {
+        if (!m_archive.isOpen())
+        {
+            auto it = m_index.find(name);
+            return it != m_index.end() ? &m_spectra[it->second] : nullptr;
+        }
+
+        const ArchiveHeader& h = header(m_archive);
+        const ArchiveSlot* table = slots(m_archive);
+        const uint64_t hash = fnv1a(name);
+        for (uint32_t s = static_cast<uint32_t>(hash) & (h.table_size - 1); ; s = (s + 1) & (h.table_size - 1))
+        {
+            const ArchiveSlot& slot = table[s];
+            if (slot.index == empty_slot)
+                return nullptr;
+            if (slot.hash == hash && slotName(m_archive, slot) == name)
+                return &spectra(m_archive)[slot.index];
+        }
+    }
+
+    const SampledSpectrum& SpectrumLibrary::at(std::string_view name) const
+    {
+        const SampledSpectrum* spectrum = find(name);
+        ASSERT(spectrum, "The spectrum '" + std::string(name) + "' is not found in the library.");
+        return *spectrum;
+    }
+
+    size_t SpectrumLibrary::size() const
+    {
+        return m_archive.isOpen() ? header(m_archive).count : m_spectra.size();
+    }
+
+    std::vector<std::string> SpectrumLibrary::names() const
+    {
+        if (!m_archive.isOpen())
+            return m_names;
+
+        const ArchiveHeader& h = header(m_archive);
+        std::vector<std::string> ret(h.count);
+        for (uint32_t i = 0; i < h.table_size; i++)
+        {
+            const ArchiveSlot& slot = slots(m_archive)[i];
+            if (slot.index != empty_slot)
+                ret[slot.index] = std::string(slotName(m_archive, slot));
+        }
+        return ret;
+    }
+
+    void SpectrumLibrary::clear()
+    {
+        m_spectra.clear();
+        m_names.clear();
+        m_index.clear();
+        m_archive.close();
+        m_num_sources = 0;
+    }
+
+    // --------------------------------------------------------------------
+    void SpectrumLibrary::detachArchive()
+    {
+        if (!m_archive.isOpen())
+            return;
+
+        const std::vector<std::string> archived_names = names();
+        const SampledSpectrum* archived = spectra(m_archive);
+        m_spectra.assign(archived, archived + archived_names.size());
+        m_names = archived_names;
+        m_index.clear();
+        for (uint32_t i = 0; i < m_names.size(); i++)
+            m_index.emplace(m_names[i], i);
+        m_archive.close();
+    }
+
+} // namespace prayground
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <prayground/core/file_util.h>
+#include <prayground/core/spectrum.h>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace prayground {
+
+    /**
+     * @brief Named SampledSpectrum collection for measured data such as IOR, absorption and reflectance curves.
+     *
+     * - loadDirectory() parses and resamples all SPD files of a directory in parallel.
+     * - save() writes a single binary archive, and openArchive() memory maps it without parsing.
+     *   The archive has a hash table of names, so find() is O(1) and spectra are read in place.
+     * - loadCached() uses the archive while it is newer than every SPD file of the directory.
+     *
+     * Names are paths relative to the directory without extension, separated by '/' (e.g. "metal/Au_eta").
+     */
+    class SpectrumLibrary {
+    public:
+        SpectrumLibrary() = default;
+
+        /* Load SPD files with the extensions under the directory recursively. Files failed to be parsed are skipped with warnings. */
+        void loadDirectory(const std::filesystem::path& directory, const std::vector<std::string>& extensions = { ".spd" });
+
+        /* Open the archive if it is up to date with the directory. Otherwise, load the directory and rewrite the archive. */
+        void loadCached(const std::filesystem::path& directory, const std::filesystem::path& archive,
+            const std::vector<std::string>& extensions = { ".spd" });
+
+        void save(const std::filesystem::path& archive) const;
+        void openArchive(const std::filesystem::path& archive);
+
+        // Add or replace the spectrum. The library is copied into memory if it refers an archive.
+        void add(const std::string& name, const SampledSpectrum& spectrum);
+
+        // nullptr if the library doesn't have the name
+        const SampledSpectrum* find(std::string_view name) const;
+        // Throw an exception if the library doesn't have the name
+        const SampledSpectrum& at(std::string_view name) const;
+        bool contains(std::string_view name) const { return find(name) != nullptr; }
+
+        size_t size() const;
+        std::vector<std::string> names() const;
+
+        void clear();
+    private:
+        struct NameHash {
+            using is_transparent = void;
+            size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+        };
+
+        void detachArchive();
+
+        // In memory
+        std::vector<SampledSpectrum> m_spectra;
+        std::vector<std::string> m_names;
+        std::unordered_map<std::string, uint32_t, NameHash, std::equal_to<>> m_index;
+
+        // Memory mapped archive
+        MappedFile m_archive;
+
+        // Number of SPD files found by the last loadDirectory(), which is saved to detect removed files in loadCached()
+        uint32_t m_num_sources{ 0 };
+    };
+
+} // namespace prayground
@@ -0,0 +1,381 @@
+#include "spectrum_table.h"
+#include <prayground/core/file_util.h>
+#include <prayground/core/parallel.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+
+namespace prayground {
+
+    namespace fs = std::filesystem;
+
+    namespace {
+        // "PGRS" in little endian
+        constexpr uint32_t table_magic = 0x53524750;
+        constexpr uint32_t table_version = 1;
+
+        // Simpson's rule over the visible range at 2nm interval
+        constexpr int num_quadrature = (constants::max_lambda - constants::min_lambda) / 2 + 1;
+
+        using Mat3 = std::array<double, 9>;
+
+        Mat3 rgbToXYZMatrix(RGBColorSpace color_space)
+        {
+            switch (color_space)
+            {
+            case RGBColorSpace::sRGB:
+                return { 0.4124564, 0.3575761, 0.1804375,
+                         0.2126729, 0.7151522, 0.0721750,
+                         0.0193339, 0.1191920, 0.9503041 };
+            case RGBColorSpace::ACEScg:
+                return { 0.6624541811, 0.1340042065, 0.1561876870,
+                         0.2722287168, 0.6740817658, 0.0536895174,
+                        -0.0055746495, 0.0040607335, 1.0103391003 };
+            default:
+                THROW("Invalid RGB color space " + std::to_string(static_cast<uint32_t>(color_space)));
+            }
+        }
+
+        double det(const Mat3& m)
+        {
+            return m[0] * (m[4] * m[8] - m[5] * m[7])
+                 - m[1] * (m[3] * m[8] - m[5] * m[6])
+                 + m[2] * (m[3] * m[7] - m[4] * m[6]);
+        }
+
+        Mat3 inverse(const Mat3& m)
+        {
+            const double inv_det = 1.0 / det(m);
+            return { (m[4] * m[8] - m[5] * m[7]) * inv_det, (m[2] * m[7] - m[1] * m[8]) * inv_det, (m[1] * m[5] - m[2] * m[4]) * inv_det,
+                     (m[5] * m[6] - m[3] * m[8]) * inv_det, (m[0] * m[8] - m[2] * m[6]) * inv_det, (m[2] * m[3] - m[0] * m[5]) * inv_det,
+                     (m[3] * m[7] - m[4] * m[6]) * inv_det, (m[1] * m[6] - m[0] * m[7]) * inv_det, (m[0] * m[4] - m[1] * m[3]) * inv_det };
+        }
+
+        void mul(const Mat3& m, const double v[3], double out[3])
+        {
+            for (int i = 0; i < 3; i++)
+                out[i] = m[i * 3 + 0] * v[0] + m[i * 3 + 1] * v[1] + m[i * 3 + 2] * v[2];
+        }
+
+        double sigmoid(const double x)
+        {
+            return 0.5 + x / (2.0 * std::sqrt(1.0 + x * x));
+        }
+
+        double smoothstep(const double x)
+        {
+            return x * x * (3.0 - 2.0 * x);
+        }
+
+        /**
+         * Forward model of the table. The spectrum is integrated with CIE_X/Y/Z() under an equal-energy illuminant,
+         * and RGB is divided by the RGB of the constant 1 spectrum.
+         * Coefficients in the optimization are of the polynomial in lambda normalized to [0, 1], which is
+         * much better conditioned than the one in nanometers.
+         */
+        struct SpectrumFitter {
+            Mat3 rgb2xyz;
+            Mat3 xyz2rgb;
+            double t[num_quadrature];
+            double weight_xyz[num_quadrature][3];
+            double white_xyz[3];
+            double white_rgb[3];
+
+            explicit SpectrumFitter(RGBColorSpace color_space)
+                : rgb2xyz(rgbToXYZMatrix(color_space)), xyz2rgb(inverse(rgbToXYZMatrix(color_space)))
+            {
+                constexpr double h = double(constants::max_lambda - constants::min_lambda) / (num_quadrature - 1);
+                white_xyz[0] = white_xyz[1] = white_xyz[2] = 0.0;
+                for (int i = 0; i < num_quadrature; i++)
+                {
+                    t[i] = double(i) / (num_quadrature - 1);
+                    const float lambda = static_cast<float>(constants::min_lambda + h * i);
+                    const double w = (i == 0 || i == num_quadrature - 1 ? 1.0 : (i % 2 == 1 ? 4.0 : 2.0)) * h / 3.0;
+                    weight_xyz[i][0] = w * CIE_X(lambda) / constants::CIE_Y_integral;
+                    weight_xyz[i][1] = w * CIE_Y(lambda) / constants::CIE_Y_integral;
+                    weight_xyz[i][2] = w * CIE_Z(lambda) / constants::CIE_Y_integral;
+                    for (int c = 0; c < 3; c++)
+                        white_xyz[c] += weight_xyz[i][c];
+                }
+                mul(xyz2rgb, white_xyz, white_rgb);
+            }
+
+            template <typename Spectrum>
+            void toXYZ(const Spectrum& spectrum, double xyz[3]) const
+            {
+                xyz[0] = xyz[1] = xyz[2] = 0.0;
+                for (int i = 0; i < num_quadrature; i++)
+                {
+                    const double s = spectrum(i);
+                    for (int c = 0; c < 3; c++)
+                        xyz[c] += s * weight_xyz[i][c];
+                }
+            }
+
+            void toLab(const double xyz[3], double lab[3]) const
+            {
+                auto f = [](double v) {
+                    constexpr double delta = 6.0 / 29.0;
+                    return v > delta * delta * delta ? std::cbrt(v) : v / (3.0 * delta * delta) + 4.0 / 29.0;
+                };
+                const double fx = f(xyz[0] / white_xyz[0]);
+                const double fy = f(xyz[1] / white_xyz[1]);
+                const double fz = f(xyz[2] / white_xyz[2]);
+                lab[0] = 116.0 * fy - 16.0;
+                lab[1] = 500.0 * (fx - fy);
+                lab[2] = 200.0 * (fy - fz);
+            }
+
+            void residual(const double coeffs[3], const double target_lab[3], double r[3]) const
+            {
+                double xyz[3], lab[3];
+                toXYZ([&](int i) { return sigmoid((coeffs[0] * t[i] + coeffs[1]) * t[i] + coeffs[2]); }, xyz);
+                toLab(xyz, lab);
+                for (int c = 0; c < 3; c++)
+                    r[c] = lab[c] - target_lab[c];
+            }
+
+            /* Fit the coefficients to rgb, starting from the current coefficients */
+            void gaussNewton(const double rgb[3], double coeffs[3]) const
+            {
+                double balanced[3], target_xyz[3], target_lab[3];
+                for (int c = 0; c < 3; c++)
+                    balanced[c] = rgb[c] * white_rgb[c];
+                mul(rgb2xyz, balanced, target_xyz);
+                toLab(target_xyz, target_lab);
+
+                auto norm2 = [](const double r[3]) { return r[0] * r[0] + r[1] * r[1] + r[2] * r[2]; };
+
+                double r[3];
+                residual(coeffs, target_lab, r);
+
+                constexpr int max_iterations = 15;
+                for (int it = 0; it < max_iterations && norm2(r) > 1e-12; it++)
+                {
+                    // Jacobian by central differences
+                    Mat3 J;
+                    constexpr double eps = 1e-5;
+                    for (int j = 0; j < 3; j++)
+                    {
+                        double c0[3] = { coeffs[0], coeffs[1], coeffs[2] };
+                        double c1[3] = { coeffs[0], coeffs[1], coeffs[2] };
+                        c0[j] -= eps;
+                        c1[j] += eps;
+                        double r0[3], r1[3];
+                        residual(c0, target_lab, r0);
+                        residual(c1, target_lab, r1);
+                        for (int i = 0; i < 3; i++)
+                            J[i * 3 + j] = (r1[i] - r0[i]) / (2.0 * eps);
+                    }
+
+                    if (std::abs(det(J)) < 1e-15)
+                        break;
+                    double dx[3];
+                    mul(inverse(J), r, dx);
+
+                    // Halve the step until the residual decreases, since the full step diverges for dark colors
+                    bool improved = false;
+                    for (double step = 1.0; step > 1e-3 && !improved; step *= 0.5)
+                    {
+                        double next[3] = { coeffs[0] - step * dx[0], coeffs[1] - step * dx[1], coeffs[2] - step * dx[2] };
+
+                        // Keep the spectrum finite for colors on the boundary of the gamut
+                        const double max_coeff = std::max({ std::abs(next[0]), std::abs(next[1]), std::abs(next[2]) });
+                        if (max_coeff > 200.0)
+                        {
+                            for (int j = 0; j < 3; j++)
+                                next[j] *= 200.0 / max_coeff;
+                        }
+
+                        double next_r[3];
+                        residual(next, target_lab, next_r);
+                        if (norm2(next_r) < norm2(r))
+                        {
+                            for (int j = 0; j < 3; j++)
+                            {
+                                coeffs[j] = next[j];
+                                r[j] = next_r[j];
+                            }
+                            improved = true;
+                        }
+                    }
+                    if (!improved)
+                        break;
+                }
+            }
+        };
+
+        /* Coefficients of the polynomial in normalized lambda to those in nanometers */
+        void denormalize(const double c[3], float out[3])
+        {
+            constexpr double a = constants::min_lambda;
+            constexpr double w = constants::max_lambda - constants::min_lambda;
+            out[0] = static_cast<float>(c[0] / (w * w));
+            out[1] = static_cast<float>(c[1] / w - 2.0 * a * c[0] / (w * w));
+            out[2] = static_cast<float>(c[2] - c[1] * a / w + c[0] * a * a / (w * w));
+        }
+
+        template <typename T>
+        void writeBinary(std::ofstream& ofs, const T* data, size_t count)
+        {
+            ofs.write(reinterpret_cast<const char*>(data), sizeof(T) * count);
+        }
+
+        template <typename T>
+        void readBinary(std::ifstream& ifs, T* data, size_t count)
+        {
+            ifs.read(reinterpret_cast<char*>(data), sizeof(T) * count);
+        }
+    } // nonamed namespace
+
+    // --------------------------------------------------------------------
+    RGBToSpectrumTable RGBToSpectrumTable::optimize(RGBColorSpace color_space, int resolution)
+    {
+        ASSERT(resolution >= 2, "The resolution of RGBToSpectrumTable must be at least 2.");
+
+        const SpectrumFitter fitter(color_space);
+
+        RGBToSpectrumTable table;
+        table.m_color_space = color_space;
+        table.m_resolution = resolution;
+        table.m_z_nodes.resize(resolution);
+        for (int k = 0; k < resolution; k++)
+            table.m_z_nodes[k] = static_cast<float>(smoothstep(smoothstep(double(k) / (resolution - 1))));
+        table.m_coefficients.resize(size_t(3) * resolution * resolution * resolution * 3);
+
+        // Each row of (max component, y) is independent. Along z, the result of the neighbor is the initial guess,
+        // starting from the moderate brightness where the spectrum is close to constant.
+        parallelFor(0, size_t(3) * resolution, [&](size_t row)
+        {
+            const int l = static_cast<int>(row / resolution);
+            const int j = static_cast<int>(row % resolution);
+            const int start = resolution / 5;
+
+            auto fit = [&](int i, int k, double coeffs[3])
+            {
+                const double z = table.m_z_nodes[k];
+                double rgb[3];
+                rgb[l] = z;
+                rgb[(l + 1) % 3] = double(i) / (resolution - 1) * z;
+                rgb[(l + 2) % 3] = double(j) / (resolution - 1) * z;
+                // Black is the limit of c2 -> -inf, which can't be reached by the iterations
+                if (z == 0.0)
+                {
+                    coeffs[0] = coeffs[1] = 0.0;
+                    coeffs[2] = -200.0;
+                }
+                else
+                {
+                    fitter.gaussNewton(rgb, coeffs);
+                }
+
+                const size_t idx = ((((size_t)l * resolution + k) * resolution + j) * resolution + i) * 3;
+                denormalize(coeffs, &table.m_coefficients[idx]);
+            };
+
+            for (int i = 0; i < resolution; i++)
+            {
+                double coeffs[3] = { 0.0, 0.0, 0.0 };
+                for (int k = start; k < resolution; k++)
+                    fit(i, k, coeffs);
+
+                coeffs[0] = coeffs[1] = coeffs[2] = 0.0;
+                for (int k = start; k >= 0; k--)
+                    fit(i, k, coeffs);
+            }
+        }, 1);
+
+        return table;
+    }
+
+    // --------------------------------------------------------------------
+    void RGBToSpectrumTable::load(const fs::path& filepath)
+    {
+        std::optional<fs::path> path = pgFindDataPath(filepath);
+        ASSERT(path, "The RGB to spectrum table '" + filepath.string() + "' is not found.");
+
+        std::ifstream ifs(path.value(), std::ios::binary);
+        ASSERT(ifs.is_open(), "Failed to open the RGB to spectrum table '" + path.value().string() + "'.");
+
+        uint32_t header[4];
+        readBinary(ifs, header, 4);
+        if (!ifs || header[0] != table_magic)
+            THROW("'" + path.value().string() + "' is not an RGB to spectrum table.");
+        if (header[1] != table_version)
+            THROW("Unsupported version " + std::to_string(header[1]) + " of RGB to spectrum table.");
+        if (header[2] > static_cast<uint32_t>(RGBColorSpace::ACEScg) || header[3] < 2 || header[3] > 1024)
+            THROW("Invalid header of RGB to spectrum table '" + path.value().string() + "'.");
+
+        const int resolution = static_cast<int>(header[3]);
+        std::vector<float> z_nodes(resolution);
+        std::vector<float> coefficients(size_t(3) * resolution * resolution * resolution * 3);
+        readBinary(ifs, z_nodes.data(), z_nodes.size());
+        readBinary(ifs, coefficients.data(), coefficients.size());
+        if (!ifs)
+            THROW("The RGB to spectrum table '" + path.value().string() + "' is truncated.");
+
+        m_color_space = static_cast<RGBColorSpace>(header[2]);
+        m_resolution = resolution;
+        m_z_nodes = std::move(z_nodes);
+        m_coefficients = std::move(coefficients);
+    }
+
+    void RGBToSpectrumTable::save(const fs::path& filepath) const
+    {
+        ASSERT(m_resolution >= 2, "The RGB to spectrum table is empty.");
+
+        std::ofstream ofs(filepath, std::ios::binary);
+        ASSERT(ofs.is_open(), "Failed to open '" + filepath.string() + "' to write the RGB to spectrum table.");
+
+        const uint32_t header[4] = { table_magic, table_version, static_cast<uint32_t>(m_color_space), static_cast<uint32_t>(m_resolution) };
+        writeBinary(ofs, header, 4);
+        writeBinary(ofs, m_z_nodes.data(), m_z_nodes.size());
+        writeBinary(ofs, m_coefficients.data(), m_coefficients.size());
+        ASSERT(ofs.good(), "Failed to write the RGB to spectrum table to '" + filepath.string() + "'.");
+    }
+
+    // --------------------------------------------------------------------
+    Vec3f RGBToSpectrumTable::toRGB(const RGBSigmoidPolynomial& spectrum) const
+    {
+        const SpectrumFitter fitter(m_color_space);
+        constexpr double h = double(constants::max_lambda - constants::min_lambda) / (num_quadrature - 1);
+
+        double xyz[3], rgb[3];
+        fitter.toXYZ([&](int i) { return spectrum(static_cast<float>(constants::min_lambda + h * i)); }, xyz);
+        mul(fitter.xyz2rgb, xyz, rgb);
+        return Vec3f(
+            static_cast<float>(rgb[0] / fitter.white_rgb[0]),
+            static_cast<float>(rgb[1] / fitter.white_rgb[1]),
+            static_cast<float>(rgb[2] / fitter.white_rgb[2]));
+    }
+
+    // --------------------------------------------------------------------
+    RGBToSpectrumTable::Data RGBToSpectrumTable::getData() const
+    {
+        return Data{ m_resolution, m_z_nodes.data(), m_coefficients.data() };
+    }
+
+    void RGBToSpectrumTable::copyToDevice()
+    {
+        ASSERT(m_resolution >= 2, "The RGB to spectrum table is empty.");
+        d_z_nodes.copyToDevice(m_z_nodes);
+        d_coefficients.copyToDevice(m_coefficients);
+    }
+
+    void RGBToSpectrumTable::free()
+    {
+        d_z_nodes.free();
+        d_coefficients.free();
+    }
+
+    RGBToSpectrumTable::Data RGBToSpectrumTable::getDeviceData() const
+    {
+        return Data{
+            m_resolution,
+            reinterpret_cast<const float*>(d_z_nodes.devicePtr()),
+            reinterpret_cast<const float*>(d_coefficients.devicePtr())
+        };
+    }
+
+} // namespace prayground
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <prayground/core/spectrum.h>
+
+#ifndef __CUDACC__
+#include <prayground/core/cudabuffer.h>
+#include <filesystem>
+#include <vector>
+#endif
+
+namespace prayground {
+
+    /**
+     * Spectrum of sigmoid(c0 * lambda^2 + c1 * lambda + c2), where lambda is in nanometers.
+     * This is smooth and bounded in [0, 1] at any wavelength, so reflectances can be evaluated in O(1).
+     * @ref A Low-Dimensional Function Space for Efficient Spectral Upsampling, Jakob and Hanika 2019
+     */
+    struct RGBSigmoidPolynomial {
+        float c0, c1, c2;
+
+        static HOSTDEVICE float sigmoid(const float x)
+        {
+            if (isinf(x))
+                return x > 0.0f ? 1.0f : 0.0f;
+            return 0.5f + x / (2.0f * sqrtf(1.0f + x * x));
+        }
+
+        HOSTDEVICE float operator()(const float lambda) const
+        {
+            return sigmoid(fmaf(fmaf(c0, lambda, c1), lambda, c2));
+        }
+
+        HOSTDEVICE HeroSpectrum sample(const SampledWavelengths& wl) const
+        {
+            HeroSpectrum ret;
+            for (int i = 0; i < HeroSpectrum::nSamples; i++)
+                ret[i] = (*this)(wl[i]);
+            return ret;
+        }
+
+        HOSTDEVICE SampledSpectrum toSampledSpectrum() const
+        {
+            SampledSpectrum ret;
+            for (int i = 0; i < SampledSpectrum::nSamples; i++)
+                ret[i] = (*this)(constants::spectrum_lambda[i]);
+            return ret;
+        }
+    };
+
+    enum class RGBColorSpace : uint32_t {
+        sRGB = 0,
+        ACEScg = 1
+    };
+
+    /**
+     * @brief Table of RGBSigmoidPolynomial coefficients for RGB values in [0, 1]^3, replacing branches on Smits' basis
+     * spectra with a lookup of 8 neighbors.
+     *
+     * The table is indexed by the largest component z of RGB and the other two divided by z. Coefficients
+     * are optimized by optimize() with Gauss-Newton iterations so that the spectrum reproduces the RGB
+     * in CIELAB under an equal-energy illuminant, which is the white of SampledSpectrum::toXYZ().
+     * RGB is white balanced, so RGB(1, 1, 1) is the constant 1 spectrum.
+     * Since optimization takes a while, tables are generated offline (apps/rgb2spectrum_opt) and loaded with load().
+     */
+    class RGBToSpectrumTable {
+    public:
+        struct Data {
+            int resolution;
+            // Nodes of z in [0, 1], dense around 0 and 1
+            const float* z_nodes;
+            // [max component][z][y][x][coefficient]
+            const float* coefficients;
+
+            HOSTDEVICE RGBSigmoidPolynomial operator()(const Vec3f& rgb) const
+            {
+                // Gray has the constant spectrum, and the polynomial reduces to the constant term
+                if (rgb[0] == rgb[1] && rgb[1] == rgb[2])
+                {
+                    const float v = fminf(fmaxf(rgb[0], 0.0f), 1.0f);
+                    return RGBSigmoidPolynomial{ 0.0f, 0.0f, (v - 0.5f) / sqrtf(v * (1.0f - v)) };
+                }
+
+                const int maxc = (rgb[0] > rgb[1]) ? (rgb[0] > rgb[2] ? 0 : 2) : (rgb[1] > rgb[2] ? 1 : 2);
+                const float z = fminf(rgb[maxc], 1.0f);
+                const float scale = float(resolution - 1) / z;
+                const float x = fminf(fmaxf(rgb[(maxc + 1) % 3] * scale, 0.0f), float(resolution - 1));
+                const float y = fminf(fmaxf(rgb[(maxc + 2) % 3] * scale, 0.0f), float(resolution - 1));
+
+                const int xi = min(static_cast<int>(x), resolution - 2);
+                const int yi = min(static_cast<int>(y), resolution - 2);
+                // Binary search of the z interval
+                int zi = 0, last = resolution - 1;
+                while (last - zi > 1)
+                {
+                    const int mid = (zi + last) / 2;
+                    if (z_nodes[mid] <= z) zi = mid;
+                    else                   last = mid;
+                }
+                const float dx = x - float(xi);
+                const float dy = y - float(yi);
+                const float dz = fminf(fmaxf((z - z_nodes[zi]) / (z_nodes[zi + 1] - z_nodes[zi]), 0.0f), 1.0f);
+
+                float c[3];
+                for (int i = 0; i < 3; i++)
+                {
+                    auto co = [&](int ox, int oy, int oz) {
+                        const size_t idx = ((((size_t)maxc * resolution + zi + oz) * resolution + yi + oy) * resolution + xi + ox) * 3 + i;
+                        return coefficients[idx];
+                    };
+                    c[i] = lerp(lerp(lerp(co(0, 0, 0), co(1, 0, 0), dx), lerp(co(0, 1, 0), co(1, 1, 0), dx), dy),
+                                lerp(lerp(co(0, 0, 1), co(1, 0, 1), dx), lerp(co(0, 1, 1), co(1, 1, 1), dx), dy), dz);
+                }
+                return RGBSigmoidPolynomial{ c[0], c[1], c[2] };
+            }
+
+            /* Reflectance for RGB in [0, 1]. Components outside of it are clamped. */
+            HOSTDEVICE HeroSpectrum albedo(const Vec3f& rgb, const SampledWavelengths& wl) const
+            {
+                return (*this)(clamp(rgb, 0.0f, 1.0f)).sample(wl);
+            }
+
+            /* Spectrum for any non-negative RGB (e.g. emission), scaling the table spectrum of rgb / (2 * max component) */
+            HOSTDEVICE HeroSpectrum unbounded(const Vec3f& rgb, const SampledWavelengths& wl) const
+            {
+                const float m = fmaxf(rgb[0], fmaxf(rgb[1], rgb[2]));
+                if (m <= 0.0f)
+                    return HeroSpectrum::zero();
+                const float scale = 2.0f * m;
+                return (*this)(rgb / scale).sample(wl) * scale;
+            }
+        };
+
+#ifndef __CUDACC__
+        RGBToSpectrumTable() = default;
+
+        /* Optimize coefficients for all entries of resolution^3 grid for each of max components */
+        static RGBToSpectrumTable optimize(RGBColorSpace color_space, int resolution = 64);
+
+        void load(const std::filesystem::path& filepath);
+        void save(const std::filesystem::path& filepath) const;
+
+        /* RGB reproduced by the spectrum, which optimize() fits to the target */
+        Vec3f toRGB(const RGBSigmoidPolynomial& spectrum) const;
+
+        RGBColorSpace colorSpace() const { return m_color_space; }
+        int resolution() const { return m_resolution; }
+
+        // Data with host pointers
+        Data getData() const;
+
+        void copyToDevice();
+        void free();
+        // Data with device pointers. copyToDevice() must be called before.
+        Data getDeviceData() const;
+
+    private:
+        RGBColorSpace m_color_space{ RGBColorSpace::sRGB };
+        int m_resolution{ 0 };
+        std::vector<float> m_z_nodes;
+        std::vector<float> m_coefficients;
+
+        CUDABuffer<float> d_z_nodes;
+        CUDABuffer<float> d_coefficients;
+#endif
+    };
+
+    /* O(1) evaluation of RGB reflectance at the sampled wavelengths */
+    HOSTDEVICE INLINE HeroSpectrum rgb2spectrum(const Vec3f& rgb, const SampledWavelengths& wl, const RGBToSpectrumTable::Data& table)
+    {
+        return table.albedo(rgb, wl);
+    }
+
+} // namespace prayground
@@ -66,9 +66,25 @@ namespace prayground {
         void setProgramId(const int32_t prg_id) { m_prg_id = prg_id; }
         int32_t programId() const { return m_prg_id; }
 
+        // Dirty flag to tell the owners that the texture data on device is outdated.
+        // Setters of derived classes mark the texture dirty. Materials and emitters
+        // are dirty while one of their textures is, and re-upload it with copyToDeviceIfDirty().
+        void markDirty() { m_dirty = true; }
+        void clearDirty() { m_dirty = false; }
+        bool isDirty() const { return m_dirty; }
+
+        void copyToDeviceIfDirty()
+        {
+            if (m_dirty || !d_data)
+                copyToDevice();
+            m_dirty = false;
+        }
+
     protected:
         void* d_data{ nullptr };
         int32_t m_prg_id;
+
+        bool m_dirty { true };
 #endif
     };
 
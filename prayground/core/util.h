@@ -2,6 +2,7 @@
 
 #ifndef __CUDACC__
 #include <string>
+#include <string_view>
 #include <cuda_runtime.h>
 #include <stdexcept>
 #include <cstring>
@@ -141,6 +142,21 @@ inline void pgLogWarn(Head head, Args... args) { Message(MSG_WARNING, "[Warning]
 template <typename Head, typename... Args>
 inline void pgLogFatal(Head head, Args... args) { Message(MSG_FATAL, "[Fatal]", head, args...); }
 
+// FNV-1a hash, which is stable across platforms and runs unlike std::hash.
+// Pass the hash of the preceding data as h to hash data in pieces.
+constexpr uint64_t kFnv1aOffsetBasis = 0xcbf29ce484222325ull;
+constexpr uint64_t kFnv1aPrime = 0x100000001b3ull;
+
+constexpr uint64_t fnv1a(std::string_view str, uint64_t h = kFnv1aOffsetBasis)
+{
+    for (const char c : str)
+    {
+        h ^= static_cast<unsigned char>(c);
+        h *= kFnv1aPrime;
+    }
+    return h;
+}
+
 #define UNIMPLEMENTED()                                                     \
     do {                                                                    \
         std::stringstream ss;                                               \
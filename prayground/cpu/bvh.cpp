@@ -0,0 +1,221 @@
+#include "bvh.h"
+#include <prayground/core/util.h>
+#include <algorithm>
+#include <limits>
+
+namespace prayground {
+
+    namespace {
+        constexpr uint32_t kMaxBins = 64;
+
+        struct Bin {
+            AABB bounds { AABB::empty() };
+            uint32_t count { 0 };
+        };
+    } // nonamed namespace
+
+    // ---------------------------------------------------------------------------
+    void BVH::build(const std::vector<AABB>& bounds, const BVHBuildSettings& settings)
+    {
+        ASSERT(settings.num_bins >= 2 && settings.num_bins <= kMaxBins, "The number of bins must be in [2, 64].");
+        ASSERT(settings.max_leaf_size >= 1, "The maximum leaf size must be greater than 0.");
+
+        m_settings = settings;
+        m_nodes.clear();
+        m_prim_indices.clear();
+        if (bounds.empty())
+            return;
+
+        const uint32_t num_prims = static_cast<uint32_t>(bounds.size());
+        std::vector<BuildPrim> prims(num_prims);
+        for (uint32_t i = 0; i < num_prims; i++)
+        {
+            prims[i].bound = bounds[i];
+            prims[i].center = (bounds[i].min() + bounds[i].max()) * 0.5f;
+            prims[i].id = i;
+        }
+
+        // A binary tree has 2N - 1 nodes at most
+        m_nodes.reserve(num_prims * 2 - 1);
+        m_nodes.emplace_back();
+        buildRecursive(0, prims, 0, num_prims, 0);
+
+        // Leaves refer to the primitives in the order they have been partitioned
+        m_prim_indices.resize(num_prims);
+        for (uint32_t i = 0; i < num_prims; i++)
+            m_prim_indices[i] = prims[i].id;
+    }
+
+    void BVH::buildRecursive(uint32_t node_idx, std::vector<BuildPrim>& prims, uint32_t begin, uint32_t end, uint32_t depth)
+    {
+        AABB node_bounds = AABB::empty(), center_bounds = AABB::empty();
+        for (uint32_t i = begin; i < end; i++)
+        {
+            node_bounds.expand(prims[i].bound);
+            center_bounds.expand(prims[i].center);
+        }
+
+        const uint32_t count = end - begin;
+        auto makeLeaf = [&]()
+        {
+            BVHNode& node = m_nodes[node_idx];
+            node.bmin = node_bounds.min();
+            node.bmax = node_bounds.max();
+            node.offset = begin;
+            node.count = static_cast<uint16_t>(count);
+            node.axis = 0;
+        };
+
+        // Leave room in the traversal stack, which pushes two children per node
+        const bool can_be_leaf = count <= std::numeric_limits<uint16_t>::max();
+        if ((count <= m_settings.max_leaf_size || depth + 2 >= kMaxDepth) && can_be_leaf)
+        {
+            makeLeaf();
+            return;
+        }
+
+        // Find the cheapest split among bins of all axes
+        const uint32_t num_bins = m_settings.num_bins;
+        float best_cost = std::numeric_limits<float>::max();
+        int best_axis = -1;
+        uint32_t best_split = 0;
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const float cmin = center_bounds.min()[axis];
+            const float cmax = center_bounds.max()[axis];
+            if (cmax <= cmin)
+                continue;
+
+            const float scale = static_cast<float>(num_bins) / (cmax - cmin);
+            Bin bins[kMaxBins];
+            for (uint32_t i = begin; i < end; i++)
+            {
+                const uint32_t b = std::min(num_bins - 1, static_cast<uint32_t>((prims[i].center[axis] - cmin) * scale));
+                bins[b].count++;
+                bins[b].bounds.expand(prims[i].bound);
+            }
+
+            // Sweep from the right to get costs of the right sides, then from the left
+            float right_area[kMaxBins];
+            uint32_t right_count[kMaxBins];
+            AABB acc = AABB::empty();
+            uint32_t acc_count = 0;
+            for (uint32_t b = num_bins - 1; b > 0; b--)
+            {
+                acc.expand(bins[b].bounds);
+                acc_count += bins[b].count;
+                right_area[b] = acc.halfArea();
+                right_count[b] = acc_count;
+            }
+
+            acc = AABB::empty();
+            acc_count = 0;
+            for (uint32_t split = 1; split < num_bins; split++)
+            {
+                acc.expand(bins[split - 1].bounds);
+                acc_count += bins[split - 1].count;
+                if (acc_count == 0 || right_count[split] == 0)
+                    continue;
+
+                const float cost = acc.halfArea() * acc_count + right_area[split] * right_count[split];
+                if (cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_split = split;
+                }
+            }
+        }
+
+        uint32_t mid;
+        if (best_axis < 0)
+        {
+            // All centers are at the same position, so the SAH can't separate them
+            if (can_be_leaf)
+            {
+                makeLeaf();
+                return;
+            }
+            mid = begin + count / 2;
+            best_axis = 0;
+        }
+        else
+        {
+            // Compare with the cost of making this node a leaf
+            const float leaf_cost = static_cast<float>(count);
+            const float split_cost = m_settings.traversal_cost + best_cost / std::max(node_bounds.halfArea(), std::numeric_limits<float>::min());
+            if (split_cost >= leaf_cost && can_be_leaf)
+            {
+                makeLeaf();
+                return;
+            }
+
+            const float cmin = center_bounds.min()[best_axis];
+            const float scale = static_cast<float>(num_bins) / (center_bounds.max()[best_axis] - cmin);
+            auto it = std::partition(prims.begin() + begin, prims.begin() + end, [&](const BuildPrim& prim)
+            {
+                const uint32_t b = std::min(num_bins - 1, static_cast<uint32_t>((prim.center[best_axis] - cmin) * scale));
+                return b < best_split;
+            });
+            mid = static_cast<uint32_t>(it - prims.begin());
+            if (mid == begin || mid == end)
+                mid = begin + count / 2;
+        }
+
+        const uint32_t left_idx = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+        buildRecursive(left_idx, prims, begin, mid, depth + 1);
+        const uint32_t right_idx = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+        buildRecursive(right_idx, prims, mid, end, depth + 1);
+
+        BVHNode& node = m_nodes[node_idx];
+        node.bmin = node_bounds.min();
+        node.bmax = node_bounds.max();
+        node.offset = right_idx;
+        node.count = 0;
+        node.axis = static_cast<uint16_t>(best_axis);
+    }
+
+    // ---------------------------------------------------------------------------
+    void BVH::refit(const std::vector<AABB>& bounds)
+    {
+        ASSERT(bounds.size() == m_prim_indices.size(), "The number of primitives has been changed since the last build.");
+
+        // Children are always stored after their parent, so a reverse sweep visits children first
+        for (size_t i = m_nodes.size(); i-- > 0;)
+        {
+            BVHNode& node = m_nodes[i];
+            AABB b = AABB::empty();
+            if (node.isLeaf())
+            {
+                for (uint32_t j = 0; j < node.count; j++)
+                    b.expand(bounds[m_prim_indices[node.offset + j]]);
+            }
+            else
+            {
+                const BVHNode& left = m_nodes[i + 1];
+                const BVHNode& right = m_nodes[node.offset];
+                b.expand(AABB(left.bmin, left.bmax));
+                b.expand(AABB(right.bmin, right.bmax));
+            }
+            node.bmin = b.min();
+            node.bmax = b.max();
+        }
+    }
+
+    void BVH::clear()
+    {
+        m_nodes.clear();
+        m_prim_indices.clear();
+    }
+
+    AABB BVH::bound() const
+    {
+        if (m_nodes.empty())
+            return AABB{};
+        return AABB(m_nodes[0].bmin, m_nodes[0].bmax);
+    }
+
+} // namespace prayground
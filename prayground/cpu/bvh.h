@@ -0,0 +1,233 @@
+#pragma once
+
+#include <prayground/core/aabb.h>
+#include <prayground/core/ray.h>
+#include <prayground/math/vec.h>
+#include <vector>
+
+namespace prayground {
+
+    /**
+     * @brief Node of the binary BVH. 32 bytes, so that two nodes fit in a cache line.
+     * Leaf (count > 0)      : primitives are primIndices()[offset, offset + count)
+     * Internal (count == 0) : the left child is the next node and the right child is nodes()[offset]
+     */
+    struct BVHNode {
+        Vec3f bmin;
+        uint32_t offset;
+        Vec3f bmax;
+        uint16_t count;
+        // Split axis. Used to visit the nearer child first.
+        uint16_t axis;
+
+        bool isLeaf() const { return count > 0; }
+    };
+    static_assert(sizeof(BVHNode) == 32);
+
+    /**
+     * @brief Slab test of a ray against a box
+     * @param inv_d Reciprocal of the ray direction
+     * @param tmax  Upper limit of the ray. The entry distance is stored to \c tnear on hit.
+     */
+    inline bool intersectBox(const Vec3f& bmin, const Vec3f& bmax, const Vec3f& o, const Vec3f& inv_d, float tmin, float tmax, float* tnear)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            float t0 = (bmin[i] - o[i]) * inv_d[i];
+            float t1 = (bmax[i] - o[i]) * inv_d[i];
+            if (t0 > t1)
+            {
+                const float tmp = t0;
+                t0 = t1;
+                t1 = tmp;
+            }
+            // Written so that NaN (0 * inf) never shrinks the interval
+            tmin = t0 > tmin ? t0 : tmin;
+            tmax = t1 < tmax ? t1 : tmax;
+            if (tmin > tmax)
+                return false;
+        }
+        *tnear = tmin;
+        return true;
+    }
+
+    struct BVHBuildSettings {
+        uint32_t num_bins         { 16 };
+        uint32_t max_leaf_size    { 4 };
+        // Relative cost of traversing a node against intersecting a primitive
+        float    traversal_cost   { 1.0f };
+    };
+
+    /**
+     * @brief
+     * Binary bounding volume hierarchy over axis-aligned boxes, built with the binned SAH.
+     * The BVH only knows the bounds of primitives; intersection with the primitives themselves
+     * is delegated to the callback given to intersect()/occluded(), so the same class is used
+     * for triangles, custom primitives and instances.
+     */
+    class BVH {
+    public:
+        static constexpr uint32_t kMaxDepth = 64;
+
+        BVH() = default;
+
+        void build(const std::vector<AABB>& bounds, const BVHBuildSettings& settings = {});
+
+        /**
+         * @brief Update the node bounds for moved primitives while keeping the topology.
+         * The number of primitives must be same as the last build().
+         * Quality of the tree degrades with large motions, so rebuild it in such a case.
+         */
+        void refit(const std::vector<AABB>& bounds);
+
+        void clear();
+
+        bool empty() const { return m_nodes.empty(); }
+        uint32_t numPrimitives() const { return static_cast<uint32_t>(m_prim_indices.size()); }
+        AABB bound() const;
+
+        const std::vector<BVHNode>& nodes() const { return m_nodes; }
+        const std::vector<uint32_t>& primIndices() const { return m_prim_indices; }
+
+        /**
+         * @brief Find the closest intersection.
+         * @param intersect_prim Called as bool(uint32_t prim_id, Ray& ray). It must return true
+         *        and shorten ray.tmax to the hit distance when the primitive is hit.
+         */
+        template <class IntersectPrim>
+        bool intersect(Ray& ray, const IntersectPrim& intersect_prim) const;
+
+        /**
+         * @brief Return true as soon as any intersection is found.
+         * @param occluded_prim Called as bool(uint32_t prim_id, const Ray& ray)
+         */
+        template <class OccludedPrim>
+        bool occluded(const Ray& ray, const OccludedPrim& occluded_prim) const;
+    private:
+        struct BuildPrim {
+            AABB bound;
+            Vec3f center;
+            uint32_t id;
+        };
+
+        void buildRecursive(uint32_t node_idx, std::vector<BuildPrim>& prims, uint32_t begin, uint32_t end, uint32_t depth);
+
+        BVHBuildSettings m_settings;
+        std::vector<BVHNode> m_nodes;
+        std::vector<uint32_t> m_prim_indices;
+    };
+
+    // ---------------------------------------------------------------------------
+    template <class IntersectPrim>
+    inline bool BVH::intersect(Ray& ray, const IntersectPrim& intersect_prim) const
+    {
+        if (m_nodes.empty())
+            return false;
+
+        const Vec3f inv_d(1.0f / ray.d.x(), 1.0f / ray.d.y(), 1.0f / ray.d.z());
+        const bool dir_neg[3] = { ray.d.x() < 0.0f, ray.d.y() < 0.0f, ray.d.z() < 0.0f };
+
+        // Entry distances are kept with the deferred nodes to skip them once a closer hit is found
+        uint32_t stack[kMaxDepth];
+        float stack_tnear[kMaxDepth];
+        uint32_t stack_size = 0;
+        uint32_t node_idx = 0;
+        bool hit = false;
+
+        float tnear;
+        if (!intersectBox(m_nodes[0].bmin, m_nodes[0].bmax, ray.o, inv_d, ray.tmin, ray.tmax, &tnear))
+            return false;
+
+        while (true)
+        {
+            const BVHNode& node = m_nodes[node_idx];
+            if (node.isLeaf())
+            {
+                for (uint32_t i = 0; i < node.count; i++)
+                    hit |= intersect_prim(m_prim_indices[node.offset + i], ray);
+            }
+            else
+            {
+                // Visit the child on the side the ray comes from first
+                uint32_t first = node_idx + 1;
+                uint32_t second = node.offset;
+                if (dir_neg[node.axis])
+                {
+                    first = node.offset;
+                    second = node_idx + 1;
+                }
+
+                float t_first, t_second;
+                const bool hit_first = intersectBox(m_nodes[first].bmin, m_nodes[first].bmax, ray.o, inv_d, ray.tmin, ray.tmax, &t_first);
+                const bool hit_second = intersectBox(m_nodes[second].bmin, m_nodes[second].bmax, ray.o, inv_d, ray.tmin, ray.tmax, &t_second);
+                if (hit_first && hit_second)
+                {
+                    stack[stack_size] = second;
+                    stack_tnear[stack_size] = t_second;
+                    stack_size++;
+                    node_idx = first;
+                    continue;
+                }
+                if (hit_first || hit_second)
+                {
+                    node_idx = hit_first ? first : second;
+                    continue;
+                }
+            }
+
+            // Pop the next node that can still contain a closer hit
+            bool found = false;
+            while (stack_size > 0)
+            {
+                stack_size--;
+                if (stack_tnear[stack_size] <= ray.tmax)
+                {
+                    node_idx = stack[stack_size];
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+                break;
+        }
+        return hit;
+    }
+
+    template <class OccludedPrim>
+    inline bool BVH::occluded(const Ray& ray, const OccludedPrim& occluded_prim) const
+    {
+        if (m_nodes.empty())
+            return false;
+
+        const Vec3f inv_d(1.0f / ray.d.x(), 1.0f / ray.d.y(), 1.0f / ray.d.z());
+
+        uint32_t stack[kMaxDepth];
+        uint32_t stack_size = 0;
+        stack[stack_size++] = 0;
+
+        while (stack_size > 0)
+        {
+            const BVHNode& node = m_nodes[stack[--stack_size]];
+            float tnear;
+            if (!intersectBox(node.bmin, node.bmax, ray.o, inv_d, ray.tmin, ray.tmax, &tnear))
+                continue;
+
+            if (node.isLeaf())
+            {
+                for (uint32_t i = 0; i < node.count; i++)
+                {
+                    if (occluded_prim(m_prim_indices[node.offset + i], ray))
+                        return true;
+                }
+            }
+            else
+            {
+                const uint32_t node_idx = static_cast<uint32_t>(&node - m_nodes.data());
+                stack[stack_size++] = node.offset;
+                stack[stack_size++] = node_idx + 1;
+            }
+        }
+        return false;
+    }
+
+} // namespace prayground
@@ -0,0 +1,350 @@
+#include "cpu_accel.h"
+#include <prayground/core/bounds.h>
+#include <prayground/core/util.h>
+#include <prayground/shape/trianglemesh.h>
+#include <prayground/shape/intersection.h>
+#include <algorithm>
+#include <limits>
+
+namespace prayground {
+
+    namespace {
+        std::vector<AABB> triangleBounds(const std::vector<Vec3f>& vertices, const std::vector<Vec3i>& indices)
+        {
+            std::vector<AABB> bounds(indices.size());
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                const Vec3f& p0 = vertices[indices[i].x()];
+                const Vec3f& p1 = vertices[indices[i].y()];
+                const Vec3f& p2 = vertices[indices[i].z()];
+                bounds[i] = AABB(
+                    Vec3f(std::min({ p0.x(), p1.x(), p2.x() }), std::min({ p0.y(), p1.y(), p2.y() }), std::min({ p0.z(), p1.z(), p2.z() })),
+                    Vec3f(std::max({ p0.x(), p1.x(), p2.x() }), std::max({ p0.y(), p1.y(), p2.y() }), std::max({ p0.z(), p1.z(), p2.z() })));
+            }
+            return bounds;
+        }
+
+        // Intersection of a custom primitive. Returns the texture coordinate and the normal in object space.
+        template <class ShapeData, class IntersectFunc>
+        inline bool intersectCustom(const ShapeData& data, const IntersectFunc& func, Ray& ray, Vec2f* uv, Vec3f* normal)
+        {
+            Shading shading;
+            float t;
+            if (!func(&data, ray, &shading, &t) || t < ray.tmin || t > ray.tmax)
+                return false;
+            ray.tmax = t;
+            *uv = shading.uv;
+            *normal = shading.n;
+            return true;
+        }
+
+        inline bool intersectShape(const Sphere::Data& data, Ray& ray, Vec2f* uv, Vec3f* normal)
+        {
+            return intersectCustom(data, pgIntersectionSphere, ray, uv, normal);
+        }
+        inline bool intersectShape(const Cylinder::Data& data, Ray& ray, Vec2f* uv, Vec3f* normal)
+        {
+            return intersectCustom(data, pgIntersectionCylinder, ray, uv, normal);
+        }
+        inline bool intersectShape(const Plane::Data& data, Ray& ray, Vec2f* uv, Vec3f* normal)
+        {
+            return intersectCustom(data, pgIntersectionPlane, ray, uv, normal);
+        }
+        inline bool intersectShape(const Box::Data& data, Ray& ray, Vec2f* uv, Vec3f* normal)
+        {
+            return intersectCustom(data, pgIntersectionBox, ray, uv, normal);
+        }
+    } // nonamed namespace
+
+    // ---------------------------------------------------------------------------
+    Matrix4f affineInverse(const Matrix4f& m)
+    {
+        // Inverse of the upper-left 3x3 part by cofactors
+        const float a = m[0], b = m[1], c = m[2];
+        const float d = m[4], e = m[5], f = m[6];
+        const float g = m[8], h = m[9], i = m[10];
+
+        const float A = e * i - f * h;
+        const float B = f * g - d * i;
+        const float C = d * h - e * g;
+        const float det = a * A + b * B + c * C;
+        ASSERT(det != 0.0f, "The transform matrix is singular.");
+        const float inv_det = 1.0f / det;
+
+        Matrix4f inv = Matrix4f::identity();
+        inv[0] = A * inv_det;  inv[1] = (c * h - b * i) * inv_det;  inv[2]  = (b * f - c * e) * inv_det;
+        inv[4] = B * inv_det;  inv[5] = (a * i - c * g) * inv_det;  inv[6]  = (c * d - a * f) * inv_det;
+        inv[8] = C * inv_det;  inv[9] = (b * g - a * h) * inv_det;  inv[10] = (a * e - b * d) * inv_det;
+
+        // Inverse translation
+        const Vec3f t(m[3], m[7], m[11]);
+        const Vec3f inv_t = -inv.vectorMul(t);
+        inv[3] = inv_t.x();
+        inv[7] = inv_t.y();
+        inv[11] = inv_t.z();
+        return inv;
+    }
+
+    AABB transformBound(const AABB& bound, const Matrix4f& m)
+    {
+        Vec3f corners[8];
+        for (int corner = 0; corner < 8; corner++)
+        {
+            corners[corner] = Vec3f(
+                (corner & 1) ? bound.max().x() : bound.min().x(),
+                (corner & 2) ? bound.max().y() : bound.min().y(),
+                (corner & 4) ? bound.max().z() : bound.min().z());
+        }
+        transformPoints(m, corners, corners, 8);
+        return boundPoints(corners, 8);
+    }
+
+    // ---------------------------------------------------------------------------
+    std::shared_ptr<CpuGeometry> CpuGeometry::create(const std::shared_ptr<Shape>& shape)
+    {
+        if (dynamic_cast<TriangleMesh*>(shape.get()) ||
+            dynamic_cast<Sphere*>(shape.get()) ||
+            dynamic_cast<Cylinder*>(shape.get()) ||
+            dynamic_cast<Plane*>(shape.get()) ||
+            dynamic_cast<Box*>(shape.get()))
+        {
+            return std::make_shared<CpuGeometry>(shape);
+        }
+        return nullptr;
+    }
+
+    CpuGeometry::CpuGeometry(const std::shared_ptr<Shape>& shape)
+        : m_shape(shape)
+    {
+        update();
+    }
+
+    void CpuGeometry::update()
+    {
+        Shape* shape = m_shape.get();
+        if (dynamic_cast<TriangleMesh*>(shape))
+        {
+            Triangles triangles;
+            loadTriangles(triangles);
+            const std::vector<AABB> bounds = triangleBounds(triangles.vertices, triangles.indices);
+
+            // Deformation keeping the topology only needs refitting
+            auto* current = std::get_if<Triangles>(&m_data);
+            if (current && current->bvh.numPrimitives() == bounds.size() && !bounds.empty())
+            {
+                triangles.bvh = std::move(current->bvh);
+                triangles.bvh.refit(bounds);
+            }
+            else
+            {
+                triangles.bvh.build(bounds);
+            }
+            triangles.wide_bvh.build(triangles.bvh);
+            m_bound = triangles.bvh.bound();
+            m_data = std::move(triangles);
+            return;
+        }
+
+        if (auto sphere = dynamic_cast<Sphere*>(shape))
+            m_data = sphere->getData();
+        else if (auto cylinder = dynamic_cast<Cylinder*>(shape))
+            m_data = cylinder->getData();
+        else if (auto plane = dynamic_cast<Plane*>(shape))
+            m_data = plane->getData();
+        else if (auto box = dynamic_cast<Box*>(shape))
+            m_data = box->getData();
+        else
+            THROW("The shape is not supported by the CPU backend.");
+        m_bound = shape->bound();
+    }
+
+    void CpuGeometry::loadTriangles(Triangles& triangles) const
+    {
+        auto mesh = std::static_pointer_cast<TriangleMesh>(m_shape);
+        triangles.vertices = mesh->vertices();
+        triangles.indices.resize(mesh->numFaces());
+        const uint32_t num_vertices = mesh->numVertices();
+        for (uint32_t i = 0; i < mesh->numFaces(); i++)
+        {
+            const Vec3i& idx = mesh->faceAt(i).vertex_id;
+            ASSERT(static_cast<uint32_t>(idx.x()) < num_vertices &&
+                   static_cast<uint32_t>(idx.y()) < num_vertices &&
+                   static_cast<uint32_t>(idx.z()) < num_vertices, "The vertex index of the face " + std::to_string(i) + " is out of range.");
+            triangles.indices[i] = idx;
+        }
+    }
+
+    bool CpuGeometry::intersect(Ray& ray, uint32_t* prim_id, Vec2f* uv, Vec3f* normal) const
+    {
+        if (const auto* triangles = std::get_if<Triangles>(&m_data))
+        {
+            return triangles->wide_bvh.intersect(ray, [&](uint32_t id, Ray& r)
+            {
+                const Vec3i& idx = triangles->indices[id];
+                const Vec3f& p0 = triangles->vertices[idx.x()];
+                const Vec3f& p1 = triangles->vertices[idx.y()];
+                const Vec3f& p2 = triangles->vertices[idx.z()];
+                Vec2f bc;
+                float t;
+                if (!pgIntersectionTriangle(p0, p1, p2, r, &bc, &t))
+                    return false;
+                r.tmax = t;
+                *prim_id = id;
+                *uv = bc;
+                *normal = cross(p1 - p0, p2 - p0);
+                return true;
+            });
+        }
+
+        // Custom shapes consist of a single primitive
+        return std::visit([&](const auto& data) -> bool
+        {
+            if constexpr (std::is_same_v<std::decay_t<decltype(data)>, Triangles>)
+                return false;
+            else
+            {
+                if (!intersectShape(data, ray, uv, normal))
+                    return false;
+                *prim_id = 0;
+                return true;
+            }
+        }, m_data);
+    }
+
+    bool CpuGeometry::occluded(const Ray& ray) const
+    {
+        if (const auto* triangles = std::get_if<Triangles>(&m_data))
+        {
+            return triangles->wide_bvh.occluded(ray, [&](uint32_t id, const Ray& r)
+            {
+                const Vec3i& idx = triangles->indices[id];
+                Vec2f bc;
+                float t;
+                return pgIntersectionTriangle(triangles->vertices[idx.x()], triangles->vertices[idx.y()], triangles->vertices[idx.z()], r, &bc, &t);
+            });
+        }
+
+        Ray r = ray;
+        uint32_t prim_id;
+        Vec2f uv;
+        Vec3f normal;
+        return intersect(r, &prim_id, &uv, &normal);
+    }
+
+    AABB CpuGeometry::bound() const
+    {
+        return m_bound;
+    }
+
+    uint32_t CpuGeometry::numPrimitives() const
+    {
+        if (const auto* triangles = std::get_if<Triangles>(&m_data))
+            return static_cast<uint32_t>(triangles->indices.size());
+        return 1;
+    }
+
+    // ---------------------------------------------------------------------------
+    uint32_t CpuAccel::addInstance(const std::shared_ptr<CpuGeometry>& geometry, const Matrix4f& transform, uint32_t id)
+    {
+        ASSERT(geometry, "The geometry is null.");
+        m_instances.push_back({ geometry, transform, affineInverse(transform), id });
+        return static_cast<uint32_t>(m_instances.size() - 1);
+    }
+
+    void CpuAccel::setTransform(uint32_t index, const Matrix4f& transform)
+    {
+        ASSERT(index < m_instances.size(), "The index out of range.");
+        m_instances[index].transform = transform;
+        m_instances[index].inverse = affineInverse(transform);
+    }
+
+    void CpuAccel::build(const BVHBuildSettings& settings)
+    {
+        // Instances are few and often large, so they are split down to a single instance per leaf
+        BVHBuildSettings tlas_settings = settings;
+        tlas_settings.max_leaf_size = 1;
+        m_bvh.build(instanceBounds(), tlas_settings);
+    }
+
+    void CpuAccel::refit()
+    {
+        if (m_bvh.numPrimitives() != numInstances())
+        {
+            build();
+            return;
+        }
+        m_bvh.refit(instanceBounds());
+    }
+
+    void CpuAccel::clear()
+    {
+        m_instances.clear();
+        m_bvh.clear();
+    }
+
+    bool CpuAccel::isBuilt() const
+    {
+        return !m_bvh.empty();
+    }
+
+    uint32_t CpuAccel::numInstances() const
+    {
+        return static_cast<uint32_t>(m_instances.size());
+    }
+
+    const CpuAccel::Instance& CpuAccel::instance(uint32_t index) const
+    {
+        ASSERT(index < m_instances.size(), "The index out of range.");
+        return m_instances[index];
+    }
+
+    std::vector<AABB> CpuAccel::instanceBounds() const
+    {
+        std::vector<AABB> bounds(m_instances.size());
+        for (size_t i = 0; i < m_instances.size(); i++)
+            bounds[i] = transformBound(m_instances[i].geometry->bound(), m_instances[i].transform);
+        return bounds;
+    }
+
+    bool CpuAccel::intersect(const Ray& ray, CpuHit* hit) const
+    {
+        Ray world_ray = ray;
+        return m_bvh.intersect(world_ray, [&](uint32_t index, Ray& r)
+        {
+            const Instance& instance = m_instances[index];
+
+            // The direction is not normalized, so the distance is same in both spaces
+            Ray local_ray(instance.inverse.pointMul(r.o), instance.inverse.vectorMul(r.d), r.tmin, r.tmax, r.t);
+            uint32_t prim_id;
+            Vec2f uv;
+            Vec3f normal;
+            if (!instance.geometry->intersect(local_ray, &prim_id, &uv, &normal))
+                return false;
+
+            r.tmax = local_ray.tmax;
+            hit->t = local_ray.tmax;
+            hit->instance_index = index;
+            hit->instance_id = instance.id;
+            hit->prim_id = prim_id;
+            hit->uv = uv;
+            // Normals are transformed by the inverse transpose
+            const Matrix4f& inv = instance.inverse;
+            hit->normal = Vec3f(
+                inv[0] * normal.x() + inv[4] * normal.y() + inv[8] * normal.z(),
+                inv[1] * normal.x() + inv[5] * normal.y() + inv[9] * normal.z(),
+                inv[2] * normal.x() + inv[6] * normal.y() + inv[10] * normal.z());
+            return true;
+        });
+    }
+
+    bool CpuAccel::occluded(const Ray& ray) const
+    {
+        return m_bvh.occluded(ray, [&](uint32_t index, const Ray& r)
+        {
+            const Instance& instance = m_instances[index];
+            const Ray local_ray(instance.inverse.pointMul(r.o), instance.inverse.vectorMul(r.d), r.tmin, r.tmax, r.t);
+            return instance.geometry->occluded(local_ray);
+        });
+    }
+
+} // namespace prayground
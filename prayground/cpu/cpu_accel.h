@@ -0,0 +1,118 @@
+#pragma once
+
+#include <prayground/core/shape.h>
+#include <prayground/cpu/bvh.h>
+#include <prayground/cpu/wide_bvh.h>
+#include <prayground/math/matrix.h>
+#include <prayground/shape/box.h>
+#include <prayground/shape/cylinder.h>
+#include <prayground/shape/plane.h>
+#include <prayground/shape/sphere.h>
+#include <memory>
+#include <variant>
+#include <vector>
+
+namespace prayground {
+
+    /**
+     * @brief
+     * Ray tracing on the host without OptiX.
+     *
+     * CpuGeometry corresponds to a geometry acceleration structure and CpuAccel to an
+     * instance acceleration structure, both backed by the binned-SAH BVH in cpu/bvh.h.
+     * Triangles are intersected with pgIntersectionTriangle() and custom primitives with
+     * the same routines as the intersection programs on OptiX (see shape/intersection.h),
+     * so the CPU backend can be used as a reference of the device renderer.
+     */
+
+    struct CpuHit {
+        float t;
+        // Index of the instance in CpuAccel, and user ID given at addInstance() (same as optixGetInstanceId() on Scene)
+        uint32_t instance_index;
+        uint32_t instance_id;
+        uint32_t prim_id;
+        // Barycentrics with the convention of optixGetTriangleBarycentrics() for triangles,
+        // texture coordinates computed by the intersector for custom primitives.
+        Vec2f uv;
+        // Geometric normal in world space. Not normalized.
+        Vec3f normal;
+    };
+
+    class CpuGeometry {
+    public:
+        /**
+         * @brief Create a geometry from the host data of the shape.
+         * Supported shapes are TriangleMesh (and classes derived from it), Sphere, Cylinder, Plane and Box.
+         * @return nullptr for unsupported shapes.
+         */
+        static std::shared_ptr<CpuGeometry> create(const std::shared_ptr<Shape>& shape);
+
+        explicit CpuGeometry(const std::shared_ptr<Shape>& shape);
+
+        // Read the data of the shape again. The BVH is refitted when the number of primitives is unchanged.
+        void update();
+
+        bool intersect(Ray& ray, uint32_t* prim_id, Vec2f* uv, Vec3f* normal) const;
+        bool occluded(const Ray& ray) const;
+
+        AABB bound() const;
+        uint32_t numPrimitives() const;
+        const std::shared_ptr<Shape>& shape() const { return m_shape; }
+    private:
+        struct Triangles {
+            std::vector<Vec3f> vertices;
+            std::vector<Vec3i> indices;
+            // The binary BVH is kept for refitting, and traversal uses the 8-wide BVH collapsed from it
+            BVH bvh;
+            BVH8 wide_bvh;
+        };
+        using Data = std::variant<Triangles, Sphere::Data, Cylinder::Data, Plane::Data, Box::Data>;
+
+        void loadTriangles(Triangles& triangles) const;
+
+        std::shared_ptr<Shape> m_shape;
+        Data m_data;
+        AABB m_bound;
+    };
+
+    class CpuAccel {
+    public:
+        struct Instance {
+            std::shared_ptr<CpuGeometry> geometry;
+            Matrix4f transform;
+            Matrix4f inverse;
+            uint32_t id;
+        };
+
+        CpuAccel() = default;
+
+        // Return the index of the instance
+        uint32_t addInstance(const std::shared_ptr<CpuGeometry>& geometry, const Matrix4f& transform, uint32_t id);
+        void setTransform(uint32_t index, const Matrix4f& transform);
+
+        void build(const BVHBuildSettings& settings = {});
+        // Update the bounds of instances after setTransform() or CpuGeometry::update()
+        void refit();
+        void clear();
+
+        bool isBuilt() const;
+        uint32_t numInstances() const;
+        const Instance& instance(uint32_t index) const;
+        const BVH& bvh() const { return m_bvh; }
+
+        bool intersect(const Ray& ray, CpuHit* hit) const;
+        bool occluded(const Ray& ray) const;
+    private:
+        std::vector<AABB> instanceBounds() const;
+
+        std::vector<Instance> m_instances;
+        BVH m_bvh;
+    };
+
+    // Inverse of an affine transform. Unlike Matrix4f::inverse(), it doesn't fail on zero diagonal elements (e.g. 90 degree rotations).
+    Matrix4f affineInverse(const Matrix4f& m);
+
+    // Bounding box of the transformed box
+    AABB transformBound(const AABB& bound, const Matrix4f& m);
+
+} // namespace prayground
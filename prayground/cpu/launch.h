@@ -0,0 +1,81 @@
+#pragma once
+
+#include <prayground/core/parallel.h>
+#include <prayground/math/vec.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace prayground {
+
+    /**
+     * @brief Launch a kernel over the w x h x d grid on host threads, as optixLaunch() does on the device.
+     * @param kernel Called as kernel(const Vec3ui& idx, const Vec3ui& dim), where \c idx corresponds to
+     *               optixGetLaunchIndex() and \c dim to optixGetLaunchDimensions().
+     * @param tile_size Size of square tiles distributed to threads. Threads take the next tile when
+     *                  they finish one, so the load is balanced even if the cost varies over the image.
+     * @note  The first exception thrown by the kernel is re-thrown after all threads finished.
+     */
+    template <class Kernel>
+    inline void launchOnCpu(const Kernel& kernel, uint32_t w, uint32_t h, uint32_t d = 1, uint32_t tile_size = 16)
+    {
+        if (w == 0 || h == 0 || d == 0)
+            return;
+
+        const Vec3ui dim(w, h, d);
+        const uint32_t tiles_x = (w + tile_size - 1) / tile_size;
+        const uint32_t tiles_y = (h + tile_size - 1) / tile_size;
+        const uint64_t num_tiles = static_cast<uint64_t>(tiles_x) * tiles_y * d;
+
+        std::atomic<uint64_t> next_tile{ 0 };
+        std::atomic<bool> failed{ false };
+        std::exception_ptr exception = nullptr;
+        std::mutex exception_mutex;
+
+        auto worker = [&]()
+        {
+            try
+            {
+                for (uint64_t tile = next_tile++; tile < num_tiles && !failed; tile = next_tile++)
+                {
+                    const uint32_t z = static_cast<uint32_t>(tile / (static_cast<uint64_t>(tiles_x) * tiles_y));
+                    const uint32_t tile_xy = static_cast<uint32_t>(tile % (static_cast<uint64_t>(tiles_x) * tiles_y));
+                    const uint32_t x0 = (tile_xy % tiles_x) * tile_size;
+                    const uint32_t y0 = (tile_xy / tiles_x) * tile_size;
+                    const uint32_t x1 = std::min(x0 + tile_size, w);
+                    const uint32_t y1 = std::min(y0 + tile_size, h);
+                    for (uint32_t y = y0; y < y1; y++)
+                    {
+                        for (uint32_t x = x0; x < x1; x++)
+                            kernel(Vec3ui(x, y, z), dim);
+                    }
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(exception_mutex);
+                if (!exception)
+                    exception = std::current_exception();
+                failed = true;
+            }
+        };
+
+        const uint32_t num_threads = static_cast<uint32_t>(std::min<uint64_t>(numHostThreads(), num_tiles));
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads - 1);
+        for (uint32_t i = 1; i < num_threads; i++)
+            threads.emplace_back(worker);
+        // The calling thread also renders tiles
+        worker();
+
+        for (auto& t : threads)
+            t.join();
+
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+
+} // namespace prayground
@@ -0,0 +1,381 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief
+ * Minimal SIMD float vectors used by the wide BVH traversal and the spectrum arithmetic on the host.
+ * SimdFloat<4> maps to SSE or NEON, SimdFloat<8> to AVX and SimdFloat<16> to AVX-512 when the
+ * compiler targets them (e.g. -march=native, /arch:AVX2); otherwise they are composed of
+ * narrower vectors or plain arrays, so the same code builds on every platform.
+ * load()/store() require alignment of the vector width, and loadu()/storeu() don't.
+ * SimdInt<4> holds 32-bit integer lanes for bit manipulation of SimdFloat<4> (e.g. float/half conversion).
+ */
+
+#if defined(__AVX512F__)
+#define PRAYGROUND_CPU_AVX512 1
+#endif
+#if defined(__AVX__)
+#define PRAYGROUND_CPU_AVX 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PRAYGROUND_CPU_SSE 1
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define PRAYGROUND_CPU_NEON 1
+#endif
+
+#if defined(PRAYGROUND_CPU_SSE) || defined(PRAYGROUND_CPU_AVX) || defined(PRAYGROUND_CPU_AVX512)
+#include <immintrin.h>
+#elif defined(PRAYGROUND_CPU_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace prayground {
+
+    template <uint32_t W> struct SimdFloat;
+
+    // ---------------------------------------------------------------------------
+    template <>
+    struct SimdFloat<4> {
+#if defined(PRAYGROUND_CPU_SSE)
+        __m128 v;
+
+        static SimdFloat load(const float* p) { return { _mm_load_ps(p) }; }
+        static SimdFloat loadu(const float* p) { return { _mm_loadu_ps(p) }; }
+        static SimdFloat broadcast(float f) { return { _mm_set1_ps(f) }; }
+        void store(float* p) const { _mm_store_ps(p, v); }
+        void storeu(float* p) const { _mm_storeu_ps(p, v); }
+
+        friend SimdFloat operator+(const SimdFloat& a, const SimdFloat& b) { return { _mm_add_ps(a.v, b.v) }; }
+        friend SimdFloat operator-(const SimdFloat& a, const SimdFloat& b) { return { _mm_sub_ps(a.v, b.v) }; }
+        friend SimdFloat operator*(const SimdFloat& a, const SimdFloat& b) { return { _mm_mul_ps(a.v, b.v) }; }
+        friend SimdFloat operator/(const SimdFloat& a, const SimdFloat& b) { return { _mm_div_ps(a.v, b.v) }; }
+        friend SimdFloat vmin(const SimdFloat& a, const SimdFloat& b) { return { _mm_min_ps(a.v, b.v) }; }
+        friend SimdFloat vmax(const SimdFloat& a, const SimdFloat& b) { return { _mm_max_ps(a.v, b.v) }; }
+        friend SimdFloat vsqrt(const SimdFloat& a) { return { _mm_sqrt_ps(a.v) }; }
+        // Bit i is set when a[i] <= b[i]
+        friend uint32_t lessEqualMask(const SimdFloat& a, const SimdFloat& b) { return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(a.v, b.v))); }
+        friend uint32_t equalMask(const SimdFloat& a, const SimdFloat& b) { return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpeq_ps(a.v, b.v))); }
+        // a[i] == b[i] ? x[i] : y[i]
+        friend SimdFloat selectEqual(const SimdFloat& a, const SimdFloat& b, const SimdFloat& x, const SimdFloat& y)
+        {
+            const __m128 m = _mm_cmpeq_ps(a.v, b.v);
+            return { _mm_or_ps(_mm_and_ps(m, x.v), _mm_andnot_ps(m, y.v)) };
+        }
+        friend float reduceAdd(const SimdFloat& a)
+        {
+            const __m128 s = _mm_add_ps(a.v, _mm_movehl_ps(a.v, a.v));
+            return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+        }
+        // (a[i0], a[i1], b[i2], b[i3]) as _mm_shuffle_ps
+        template <int i0, int i1, int i2, int i3>
+        friend SimdFloat shuffle(const SimdFloat& a, const SimdFloat& b) { return { _mm_shuffle_ps(a.v, b.v, _MM_SHUFFLE(i3, i2, i1, i0)) }; }
+#elif defined(PRAYGROUND_CPU_NEON)
+        float32x4_t v;
+
+        static SimdFloat load(const float* p) { return { vld1q_f32(p) }; }
+        static SimdFloat loadu(const float* p) { return { vld1q_f32(p) }; }
+        static SimdFloat broadcast(float f) { return { vdupq_n_f32(f) }; }
+        void store(float* p) const { vst1q_f32(p, v); }
+        void storeu(float* p) const { vst1q_f32(p, v); }
+
+        friend SimdFloat operator+(const SimdFloat& a, const SimdFloat& b) { return { vaddq_f32(a.v, b.v) }; }
+        friend SimdFloat operator-(const SimdFloat& a, const SimdFloat& b) { return { vsubq_f32(a.v, b.v) }; }
+        friend SimdFloat operator*(const SimdFloat& a, const SimdFloat& b) { return { vmulq_f32(a.v, b.v) }; }
+        friend SimdFloat operator/(const SimdFloat& a, const SimdFloat& b) { return { vdivq_f32(a.v, b.v) }; }
+        // Selection instead of vminq/vmaxq to keep the NaN handling of minps/maxps
+        friend SimdFloat vmin(const SimdFloat& a, const SimdFloat& b) { return { vbslq_f32(vcltq_f32(a.v, b.v), a.v, b.v) }; }
+        friend SimdFloat vmax(const SimdFloat& a, const SimdFloat& b) { return { vbslq_f32(vcgtq_f32(a.v, b.v), a.v, b.v) }; }
+        friend SimdFloat vsqrt(const SimdFloat& a) { return { vsqrtq_f32(a.v) }; }
+        friend uint32_t lessEqualMask(const SimdFloat& a, const SimdFloat& b) { return toMask(vcleq_f32(a.v, b.v)); }
+        friend uint32_t equalMask(const SimdFloat& a, const SimdFloat& b) { return toMask(vceqq_f32(a.v, b.v)); }
+        friend SimdFloat selectEqual(const SimdFloat& a, const SimdFloat& b, const SimdFloat& x, const SimdFloat& y)
+        {
+            return { vbslq_f32(vceqq_f32(a.v, b.v), x.v, y.v) };
+        }
+        friend float reduceAdd(const SimdFloat& a) { return vaddvq_f32(a.v); }
+        template <int i0, int i1, int i2, int i3>
+        friend SimdFloat shuffle(const SimdFloat& a, const SimdFloat& b)
+        {
+            float32x4_t r = vdupq_n_f32(vgetq_lane_f32(a.v, i0));
+            r = vsetq_lane_f32(vgetq_lane_f32(a.v, i1), r, 1);
+            r = vsetq_lane_f32(vgetq_lane_f32(b.v, i2), r, 2);
+            r = vsetq_lane_f32(vgetq_lane_f32(b.v, i3), r, 3);
+            return { r };
+        }
+
+    private:
+        static uint32_t toMask(const uint32x4_t m)
+        {
+            const uint32x4_t bits = { 1u, 2u, 4u, 8u };
+            return vaddvq_u32(vandq_u32(m, bits));
+        }
+#else
+        float v[4];
+
+        static SimdFloat load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+        static SimdFloat loadu(const float* p) { return load(p); }
+        static SimdFloat broadcast(float f) { return { { f, f, f, f } }; }
+        void store(float* p) const { for (int i = 0; i < 4; i++) p[i] = v[i]; }
+        void storeu(float* p) const { store(p); }
+
+        template <class Op>
+        static SimdFloat apply(const SimdFloat& a, const SimdFloat& b, const Op& op)
+        {
+            SimdFloat r;
+            for (int i = 0; i < 4; i++) r.v[i] = op(a.v[i], b.v[i]);
+            return r;
+        }
+        friend SimdFloat operator+(const SimdFloat& a, const SimdFloat& b) { return apply(a, b, [](float x, float y) { return x + y; }); }
+        friend SimdFloat operator-(const SimdFloat& a, const SimdFloat& b) { return apply(a, b, [](float x, float y) { return x - y; }); }
+        friend SimdFloat operator*(const SimdFloat& a, const SimdFloat& b) { return apply(a, b, [](float x, float y) { return x * y; }); }
+        friend SimdFloat operator/(const SimdFloat& a, const SimdFloat& b) { return apply(a, b, [](float x, float y) { return x / y; }); }
+        // Same NaN handling as minps/maxps: the second operand is returned when either is NaN
+        friend SimdFloat vmin(const SimdFloat& a, const SimdFloat& b) { return apply(a, b, [](float x, float y) { return x < y ? x : y; }); }
+        friend SimdFloat vmax(const SimdFloat& a, const SimdFloat& b) { return apply(a, b, [](float x, float y) { return x > y ? x : y; }); }
+        friend SimdFloat vsqrt(const SimdFloat& a) { return apply(a, a, [](float x, float) { return sqrtf(x); }); }
+        friend uint32_t lessEqualMask(const SimdFloat& a, const SimdFloat& b)
+        {
+            uint32_t mask = 0;
+            for (int i = 0; i < 4; i++) mask |= (a.v[i] <= b.v[i] ? 1u : 0u) << i;
+            return mask;
+        }
+        friend uint32_t equalMask(const SimdFloat& a, const SimdFloat& b)
+        {
+            uint32_t mask = 0;
+            for (int i = 0; i < 4; i++) mask |= (a.v[i] == b.v[i] ? 1u : 0u) << i;
+            return mask;
+        }
+        friend SimdFloat selectEqual(const SimdFloat& a, const SimdFloat& b, const SimdFloat& x, const SimdFloat& y)
+        {
+            SimdFloat r;
+            for (int i = 0; i < 4; i++) r.v[i] = a.v[i] == b.v[i] ? x.v[i] : y.v[i];
+            return r;
+        }
+        friend float reduceAdd(const SimdFloat& a) { return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]); }
+        template <int i0, int i1, int i2, int i3>
+        friend SimdFloat shuffle(const SimdFloat& a, const SimdFloat& b) { return { { a.v[i0], a.v[i1], b.v[i2], b.v[i3] } }; }
+#endif
+    };
+
+    // ---------------------------------------------------------------------------
+    template <uint32_t W> struct SimdInt;
+
+    // Comparisons are signed and set all bits of the lanes where they hold, to be used with select().
+    // shiftRight() is logical and shiftRightArithmetic() keeps the sign.
+    template <>
+    struct SimdInt<4> {
+#if defined(PRAYGROUND_CPU_SSE)
+        __m128i v;
+
+        static SimdInt loadu(const uint32_t* p) { return { _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)) }; }
+        static SimdInt broadcast(uint32_t i) { return { _mm_set1_epi32(static_cast<int>(i)) }; }
+        static SimdInt bitcast(const SimdFloat<4>& f) { return { _mm_castps_si128(f.v) }; }
+        void storeu(uint32_t* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+        SimdFloat<4> asFloat() const { return { _mm_castsi128_ps(v) }; }
+        // Nearest integers with ties to even as rintf(), and back to floats
+        static SimdInt roundFrom(const SimdFloat<4>& f) { return { _mm_cvtps_epi32(f.v) }; }
+        SimdFloat<4> toFloat() const { return { _mm_cvtepi32_ps(v) }; }
+
+        friend SimdInt operator+(const SimdInt& a, const SimdInt& b) { return { _mm_add_epi32(a.v, b.v) }; }
+        friend SimdInt operator-(const SimdInt& a, const SimdInt& b) { return { _mm_sub_epi32(a.v, b.v) }; }
+        friend SimdInt operator&(const SimdInt& a, const SimdInt& b) { return { _mm_and_si128(a.v, b.v) }; }
+        friend SimdInt operator|(const SimdInt& a, const SimdInt& b) { return { _mm_or_si128(a.v, b.v) }; }
+        friend SimdInt operator^(const SimdInt& a, const SimdInt& b) { return { _mm_xor_si128(a.v, b.v) }; }
+        friend SimdInt greaterThan(const SimdInt& a, const SimdInt& b) { return { _mm_cmpgt_epi32(a.v, b.v) }; }
+        // m[i] ? a[i] : b[i]
+        friend SimdInt select(const SimdInt& m, const SimdInt& a, const SimdInt& b) { return { _mm_or_si128(_mm_and_si128(m.v, a.v), _mm_andnot_si128(m.v, b.v)) }; }
+        template <int n>
+        friend SimdInt shiftLeft(const SimdInt& a) { return { _mm_slli_epi32(a.v, n) }; }
+        template <int n>
+        friend SimdInt shiftRight(const SimdInt& a) { return { _mm_srli_epi32(a.v, n) }; }
+        template <int n>
+        friend SimdInt shiftRightArithmetic(const SimdInt& a) { return { _mm_srai_epi32(a.v, n) }; }
+#elif defined(PRAYGROUND_CPU_NEON)
+        uint32x4_t v;
+
+        static SimdInt loadu(const uint32_t* p) { return { vld1q_u32(p) }; }
+        static SimdInt broadcast(uint32_t i) { return { vdupq_n_u32(i) }; }
+        static SimdInt bitcast(const SimdFloat<4>& f) { return { vreinterpretq_u32_f32(f.v) }; }
+        void storeu(uint32_t* p) const { vst1q_u32(p, v); }
+        SimdFloat<4> asFloat() const { return { vreinterpretq_f32_u32(v) }; }
+        static SimdInt roundFrom(const SimdFloat<4>& f) { return { vreinterpretq_u32_s32(vcvtnq_s32_f32(f.v)) }; }
+        SimdFloat<4> toFloat() const { return { vcvtq_f32_s32(vreinterpretq_s32_u32(v)) }; }
+
+        friend SimdInt operator+(const SimdInt& a, const SimdInt& b) { return { vaddq_u32(a.v, b.v) }; }
+        friend SimdInt operator-(const SimdInt& a, const SimdInt& b) { return { vsubq_u32(a.v, b.v) }; }
+        friend SimdInt operator&(const SimdInt& a, const SimdInt& b) { return { vandq_u32(a.v, b.v) }; }
+        friend SimdInt operator|(const SimdInt& a, const SimdInt& b) { return { vorrq_u32(a.v, b.v) }; }
+        friend SimdInt operator^(const SimdInt& a, const SimdInt& b) { return { veorq_u32(a.v, b.v) }; }
+        friend SimdInt greaterThan(const SimdInt& a, const SimdInt& b) { return { vcgtq_s32(vreinterpretq_s32_u32(a.v), vreinterpretq_s32_u32(b.v)) }; }
+        friend SimdInt select(const SimdInt& m, const SimdInt& a, const SimdInt& b) { return { vbslq_u32(m.v, a.v, b.v) }; }
+        template <int n>
+        friend SimdInt shiftLeft(const SimdInt& a) { return { vshlq_n_u32(a.v, n) }; }
+        template <int n>
+        friend SimdInt shiftRight(const SimdInt& a) { return { vshrq_n_u32(a.v, n) }; }
+        template <int n>
+        friend SimdInt shiftRightArithmetic(const SimdInt& a) { return { vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(a.v), n)) }; }
+#else
+        uint32_t v[4];
+
+        static SimdInt loadu(const uint32_t* p) { return { { p[0], p[1], p[2], p[3] } }; }
+        static SimdInt broadcast(uint32_t i) { return { { i, i, i, i } }; }
+        static SimdInt bitcast(const SimdFloat<4>& f)
+        {
+            SimdInt r;
+            std::memcpy(r.v, f.v, sizeof(r.v));
+            return r;
+        }
+        void storeu(uint32_t* p) const { for (int i = 0; i < 4; i++) p[i] = v[i]; }
+        SimdFloat<4> asFloat() const
+        {
+            SimdFloat<4> r;
+            std::memcpy(r.v, v, sizeof(v));
+            return r;
+        }
+        static SimdInt roundFrom(const SimdFloat<4>& f)
+        {
+            SimdInt r;
+            for (int i = 0; i < 4; i++) r.v[i] = static_cast<uint32_t>(static_cast<int32_t>(rintf(f.v[i])));
+            return r;
+        }
+        SimdFloat<4> toFloat() const { return { { static_cast<float>(static_cast<int32_t>(v[0])), static_cast<float>(static_cast<int32_t>(v[1])), static_cast<float>(static_cast<int32_t>(v[2])), static_cast<float>(static_cast<int32_t>(v[3])) } }; }
+
+        template <class Op>
+        static SimdInt apply(const SimdInt& a, const SimdInt& b, const Op& op)
+        {
+            SimdInt r;
+            for (int i = 0; i < 4; i++) r.v[i] = op(a.v[i], b.v[i]);
+            return r;
+        }
+        friend SimdInt operator+(const SimdInt& a, const SimdInt& b) { return apply(a, b, [](uint32_t x, uint32_t y) { return x + y; }); }
+        friend SimdInt operator-(const SimdInt& a, const SimdInt& b) { return apply(a, b, [](uint32_t x, uint32_t y) { return x - y; }); }
+        friend SimdInt operator&(const SimdInt& a, const SimdInt& b) { return apply(a, b, [](uint32_t x, uint32_t y) { return x & y; }); }
+        friend SimdInt operator|(const SimdInt& a, const SimdInt& b) { return apply(a, b, [](uint32_t x, uint32_t y) { return x | y; }); }
+        friend SimdInt operator^(const SimdInt& a, const SimdInt& b) { return apply(a, b, [](uint32_t x, uint32_t y) { return x ^ y; }); }
+        friend SimdInt greaterThan(const SimdInt& a, const SimdInt& b)
+        {
+            return apply(a, b, [](uint32_t x, uint32_t y) { return static_cast<int32_t>(x) > static_cast<int32_t>(y) ? ~0u : 0u; });
+        }
+        friend SimdInt select(const SimdInt& m, const SimdInt& a, const SimdInt& b) { return (m & a) | apply(m, b, [](uint32_t x, uint32_t y) { return ~x & y; }); }
+        template <int n>
+        friend SimdInt shiftLeft(const SimdInt& a) { return apply(a, a, [](uint32_t x, uint32_t) { return x << n; }); }
+        template <int n>
+        friend SimdInt shiftRight(const SimdInt& a) { return apply(a, a, [](uint32_t x, uint32_t) { return x >> n; }); }
+        template <int n>
+        friend SimdInt shiftRightArithmetic(const SimdInt& a) { return apply(a, a, [](uint32_t x, uint32_t) { return static_cast<uint32_t>(static_cast<int32_t>(x) >> n); }); }
+#endif
+    };
+
+    // ---------------------------------------------------------------------------
+    template <>
+    struct SimdFloat<8> {
+#if defined(PRAYGROUND_CPU_AVX)
+        __m256 v;
+
+        static SimdFloat load(const float* p) { return { _mm256_load_ps(p) }; }
+        static SimdFloat loadu(const float* p) { return { _mm256_loadu_ps(p) }; }
+        static SimdFloat broadcast(float f) { return { _mm256_set1_ps(f) }; }
+        void store(float* p) const { _mm256_store_ps(p, v); }
+        void storeu(float* p) const { _mm256_storeu_ps(p, v); }
+
+        friend SimdFloat operator+(const SimdFloat& a, const SimdFloat& b) { return { _mm256_add_ps(a.v, b.v) }; }
+        friend SimdFloat operator-(const SimdFloat& a, const SimdFloat& b) { return { _mm256_sub_ps(a.v, b.v) }; }
+        friend SimdFloat operator*(const SimdFloat& a, const SimdFloat& b) { return { _mm256_mul_ps(a.v, b.v) }; }
+        friend SimdFloat operator/(const SimdFloat& a, const SimdFloat& b) { return { _mm256_div_ps(a.v, b.v) }; }
+        friend SimdFloat vmin(const SimdFloat& a, const SimdFloat& b) { return { _mm256_min_ps(a.v, b.v) }; }
+        friend SimdFloat vmax(const SimdFloat& a, const SimdFloat& b) { return { _mm256_max_ps(a.v, b.v) }; }
+        friend SimdFloat vsqrt(const SimdFloat& a) { return { _mm256_sqrt_ps(a.v) }; }
+        friend uint32_t lessEqualMask(const SimdFloat& a, const SimdFloat& b) { return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ))); }
+        friend uint32_t equalMask(const SimdFloat& a, const SimdFloat& b) { return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ))); }
+        friend SimdFloat selectEqual(const SimdFloat& a, const SimdFloat& b, const SimdFloat& x, const SimdFloat& y)
+        {
+            return { _mm256_blendv_ps(y.v, x.v, _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ)) };
+        }
+        friend float reduceAdd(const SimdFloat& a)
+        {
+            return reduceAdd(SimdFloat<4>{ _mm_add_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1)) });
+        }
+#else
+        SimdFloat<4> lo, hi;
+
+        static SimdFloat load(const float* p) { return { SimdFloat<4>::load(p), SimdFloat<4>::load(p + 4) }; }
+        static SimdFloat loadu(const float* p) { return { SimdFloat<4>::loadu(p), SimdFloat<4>::loadu(p + 4) }; }
+        static SimdFloat broadcast(float f) { return { SimdFloat<4>::broadcast(f), SimdFloat<4>::broadcast(f) }; }
+        void store(float* p) const { lo.store(p); hi.store(p + 4); }
+        void storeu(float* p) const { lo.storeu(p); hi.storeu(p + 4); }
+
+        friend SimdFloat operator+(const SimdFloat& a, const SimdFloat& b) { return { a.lo + b.lo, a.hi + b.hi }; }
+        friend SimdFloat operator-(const SimdFloat& a, const SimdFloat& b) { return { a.lo - b.lo, a.hi - b.hi }; }
+        friend SimdFloat operator*(const SimdFloat& a, const SimdFloat& b) { return { a.lo * b.lo, a.hi * b.hi }; }
+        friend SimdFloat operator/(const SimdFloat& a, const SimdFloat& b) { return { a.lo / b.lo, a.hi / b.hi }; }
+        friend SimdFloat vmin(const SimdFloat& a, const SimdFloat& b) { return { vmin(a.lo, b.lo), vmin(a.hi, b.hi) }; }
+        friend SimdFloat vmax(const SimdFloat& a, const SimdFloat& b) { return { vmax(a.lo, b.lo), vmax(a.hi, b.hi) }; }
+        friend SimdFloat vsqrt(const SimdFloat& a) { return { vsqrt(a.lo), vsqrt(a.hi) }; }
+        friend uint32_t lessEqualMask(const SimdFloat& a, const SimdFloat& b) { return lessEqualMask(a.lo, b.lo) | (lessEqualMask(a.hi, b.hi) << 4); }
+        friend uint32_t equalMask(const SimdFloat& a, const SimdFloat& b) { return equalMask(a.lo, b.lo) | (equalMask(a.hi, b.hi) << 4); }
+        friend SimdFloat selectEqual(const SimdFloat& a, const SimdFloat& b, const SimdFloat& x, const SimdFloat& y)
+        {
+            return { selectEqual(a.lo, b.lo, x.lo, y.lo), selectEqual(a.hi, b.hi, x.hi, y.hi) };
+        }
+        friend float reduceAdd(const SimdFloat& a) { return reduceAdd(a.lo + a.hi); }
+#endif
+    };
+
+    // ---------------------------------------------------------------------------
+    template <>
+    struct SimdFloat<16> {
+#if defined(PRAYGROUND_CPU_AVX512)
+        __m512 v;
+
+        static SimdFloat load(const float* p) { return { _mm512_load_ps(p) }; }
+        static SimdFloat loadu(const float* p) { return { _mm512_loadu_ps(p) }; }
+        static SimdFloat broadcast(float f) { return { _mm512_set1_ps(f) }; }
+        void store(float* p) const { _mm512_store_ps(p, v); }
+        void storeu(float* p) const { _mm512_storeu_ps(p, v); }
+
+        friend SimdFloat operator+(const SimdFloat& a, const SimdFloat& b) { return { _mm512_add_ps(a.v, b.v) }; }
+        friend SimdFloat operator-(const SimdFloat& a, const SimdFloat& b) { return { _mm512_sub_ps(a.v, b.v) }; }
+        friend SimdFloat operator*(const SimdFloat& a, const SimdFloat& b) { return { _mm512_mul_ps(a.v, b.v) }; }
+        friend SimdFloat operator/(const SimdFloat& a, const SimdFloat& b) { return { _mm512_div_ps(a.v, b.v) }; }
+        friend SimdFloat vmin(const SimdFloat& a, const SimdFloat& b) { return { _mm512_min_ps(a.v, b.v) }; }
+        friend SimdFloat vmax(const SimdFloat& a, const SimdFloat& b) { return { _mm512_max_ps(a.v, b.v) }; }
+        friend SimdFloat vsqrt(const SimdFloat& a) { return { _mm512_sqrt_ps(a.v) }; }
+        friend uint32_t lessEqualMask(const SimdFloat& a, const SimdFloat& b) { return static_cast<uint32_t>(_mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ)); }
+        friend uint32_t equalMask(const SimdFloat& a, const SimdFloat& b) { return static_cast<uint32_t>(_mm512_cmp_ps_mask(a.v, b.v, _CMP_EQ_OQ)); }
+        friend SimdFloat selectEqual(const SimdFloat& a, const SimdFloat& b, const SimdFloat& x, const SimdFloat& y)
+        {
+            return { _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a.v, b.v, _CMP_EQ_OQ), y.v, x.v) };
+        }
+        friend float reduceAdd(const SimdFloat& a) { return _mm512_reduce_add_ps(a.v); }
+#else
+        SimdFloat<8> lo, hi;
+
+        static SimdFloat load(const float* p) { return { SimdFloat<8>::load(p), SimdFloat<8>::load(p + 8) }; }
+        static SimdFloat loadu(const float* p) { return { SimdFloat<8>::loadu(p), SimdFloat<8>::loadu(p + 8) }; }
+        static SimdFloat broadcast(float f) { return { SimdFloat<8>::broadcast(f), SimdFloat<8>::broadcast(f) }; }
+        void store(float* p) const { lo.store(p); hi.store(p + 8); }
+        void storeu(float* p) const { lo.storeu(p); hi.storeu(p + 8); }
+
+        friend SimdFloat operator+(const SimdFloat& a, const SimdFloat& b) { return { a.lo + b.lo, a.hi + b.hi }; }
+        friend SimdFloat operator-(const SimdFloat& a, const SimdFloat& b) { return { a.lo - b.lo, a.hi - b.hi }; }
+        friend SimdFloat operator*(const SimdFloat& a, const SimdFloat& b) { return { a.lo * b.lo, a.hi * b.hi }; }
+        friend SimdFloat operator/(const SimdFloat& a, const SimdFloat& b) { return { a.lo / b.lo, a.hi / b.hi }; }
+        friend SimdFloat vmin(const SimdFloat& a, const SimdFloat& b) { return { vmin(a.lo, b.lo), vmin(a.hi, b.hi) }; }
+        friend SimdFloat vmax(const SimdFloat& a, const SimdFloat& b) { return { vmax(a.lo, b.lo), vmax(a.hi, b.hi) }; }
+        friend SimdFloat vsqrt(const SimdFloat& a) { return { vsqrt(a.lo), vsqrt(a.hi) }; }
+        friend uint32_t lessEqualMask(const SimdFloat& a, const SimdFloat& b) { return lessEqualMask(a.lo, b.lo) | (lessEqualMask(a.hi, b.hi) << 8); }
+        friend uint32_t equalMask(const SimdFloat& a, const SimdFloat& b) { return equalMask(a.lo, b.lo) | (equalMask(a.hi, b.hi) << 8); }
+        friend SimdFloat selectEqual(const SimdFloat& a, const SimdFloat& b, const SimdFloat& x, const SimdFloat& y)
+        {
+            return { selectEqual(a.lo, b.lo, x.lo, y.lo), selectEqual(a.hi, b.hi, x.hi, y.hi) };
+        }
+        friend float reduceAdd(const SimdFloat& a) { return reduceAdd(a.lo + a.hi); }
+#endif
+    };
+
+} // namespace prayground
@@ -0,0 +1,486 @@
+#pragma once
+
+#include <prayground/cpu/bvh.h>
+#include <prayground/cpu/simd.h>
+#include <bit>
+#include <limits>
+
+namespace prayground {
+
+    /**
+     * @brief Node of the N-wide BVH (N = 4 or 8).
+     * Bounds of the children are stored in SoA order, so one ray is tested against all children
+     * with a few SIMD instructions. Children are packed to the front of the arrays.
+     * Internal child (count[i] == 0) : child[i] is the index of the child node
+     * Leaf child     (count[i] > 0)  : primitives are primIndices()[child[i], child[i] + count[i])
+     */
+    template <uint32_t N>
+    struct alignas(64) WideBVHNode {
+        float bmin[3][N];
+        float bmax[3][N];
+        uint32_t child[N];
+        uint32_t count[N];
+        uint32_t num_children;
+    };
+
+    /**
+     * @brief Coherent rays in SoA layout, traversed together by WideBVH::intersect() with K = 8 or 16.
+     * Rays with tmin > tmax are treated as inactive.
+     */
+    template <uint32_t K>
+    struct alignas(64) RayPacket {
+        float ox[K], oy[K], oz[K];
+        float dx[K], dy[K], dz[K];
+        float tmin[K], tmax[K];
+
+        void set(uint32_t i, const Ray& ray)
+        {
+            ox[i] = ray.o.x(); oy[i] = ray.o.y(); oz[i] = ray.o.z();
+            dx[i] = ray.d.x(); dy[i] = ray.d.y(); dz[i] = ray.d.z();
+            tmin[i] = ray.tmin;
+            tmax[i] = ray.tmax;
+        }
+
+        Ray get(uint32_t i) const
+        {
+            return Ray(Vec3f(ox[i], oy[i], oz[i]), Vec3f(dx[i], dy[i], dz[i]), tmin[i], tmax[i]);
+        }
+
+        uint32_t activeMask() const
+        {
+            uint32_t mask = 0;
+            for (uint32_t i = 0; i < K; i++)
+                mask |= (tmin[i] <= tmax[i] ? 1u : 0u) << i;
+            return mask;
+        }
+    };
+
+    /**
+     * @brief
+     * N-wide BVH collapsed from the binary BVH. It trades the deeper binary tree for fewer,
+     * wider nodes whose boxes are tested in parallel, which keeps SIMD lanes busy for
+     * single rays. Packets of coherent rays are also supported, in which the lanes are
+     * used across rays instead.
+     * The primitive callbacks are same as BVH::intersect()/occluded().
+     */
+    template <uint32_t N>
+    class WideBVH {
+    public:
+        static_assert(N == 4 || N == 8, "WideBVH supports 4 or 8 children per node.");
+        using Node = WideBVHNode<N>;
+
+        // Worst case of deferred nodes: (N - 1) siblings at each level of the tree
+        static constexpr uint32_t kStackSize = BVH::kMaxDepth * (N - 1) + 1;
+
+        WideBVH() = default;
+
+        void build(const BVH& bvh);
+        void build(const std::vector<AABB>& bounds, const BVHBuildSettings& settings = {});
+
+        bool empty() const { return m_nodes.empty(); }
+        const std::vector<Node>& nodes() const { return m_nodes; }
+        const std::vector<uint32_t>& primIndices() const { return m_prim_indices; }
+
+        template <class IntersectPrim>
+        bool intersect(Ray& ray, const IntersectPrim& intersect_prim) const;
+
+        template <class OccludedPrim>
+        bool occluded(const Ray& ray, const OccludedPrim& occluded_prim) const;
+
+        /**
+         * @brief Find the closest intersections of all active rays in the packet.
+         * @param intersect_prim Called as bool(uint32_t prim_id, uint32_t ray_index, Ray& ray). The hit distance
+         *        of each ray is written back to packet.tmax.
+         * @return Mask of the rays that hit something
+         */
+        template <uint32_t K, class IntersectPrim>
+        uint32_t intersect(RayPacket<K>& packet, const IntersectPrim& intersect_prim) const;
+
+        // Return the mask of the rays which are occluded. occluded_prim is called as bool(uint32_t prim_id, uint32_t ray_index, const Ray& ray).
+        template <uint32_t K, class OccludedPrim>
+        uint32_t occluded(const RayPacket<K>& packet, const OccludedPrim& occluded_prim) const;
+    private:
+        // Test the ray against all children. Returns the mask of hit children and the entry distances.
+        uint32_t intersectChildren(const Node& node, const SimdFloat<N> o[3], const SimdFloat<N> inv_d[3],
+            float tmin, float tmax, float* tnear) const;
+
+        template <bool AnyHit, uint32_t K, class PrimFunc>
+        uint32_t traversePacket(RayPacket<K>& packet, const PrimFunc& prim_func) const;
+
+        uint32_t collapse(const BVH& bvh, uint32_t binary_idx);
+
+        std::vector<Node> m_nodes;
+        std::vector<uint32_t> m_prim_indices;
+    };
+
+    using BVH4 = WideBVH<4>;
+    using BVH8 = WideBVH<8>;
+
+    // ---------------------------------------------------------------------------
+    template <uint32_t N>
+    inline void WideBVH<N>::build(const BVH& bvh)
+    {
+        m_nodes.clear();
+        m_prim_indices = bvh.primIndices();
+        if (bvh.empty())
+            return;
+
+        const BVHNode& root = bvh.nodes()[0];
+        if (root.isLeaf())
+        {
+            // Wrap the single leaf with a node
+            Node node{};
+            for (int a = 0; a < 3; a++)
+            {
+                node.bmin[a][0] = root.bmin[a];
+                node.bmax[a][0] = root.bmax[a];
+            }
+            node.child[0] = root.offset;
+            node.count[0] = root.count;
+            node.num_children = 1;
+            m_nodes.push_back(node);
+            return;
+        }
+        collapse(bvh, 0);
+    }
+
+    template <uint32_t N>
+    inline void WideBVH<N>::build(const std::vector<AABB>& bounds, const BVHBuildSettings& settings)
+    {
+        BVH bvh;
+        bvh.build(bounds, settings);
+        build(bvh);
+    }
+
+    template <uint32_t N>
+    inline uint32_t WideBVH<N>::collapse(const BVH& bvh, uint32_t binary_idx)
+    {
+        const auto& bnodes = bvh.nodes();
+        auto halfArea = [](const BVHNode& n)
+        {
+            const Vec3f e = n.bmax - n.bmin;
+            return e.x() * e.y() + e.y() * e.z() + e.z() * e.x();
+        };
+
+        // Open the internal child with the largest surface area until N children are gathered
+        uint32_t children[N];
+        uint32_t num_children = 2;
+        children[0] = binary_idx + 1;
+        children[1] = bnodes[binary_idx].offset;
+        while (num_children < N)
+        {
+            int largest = -1;
+            float largest_area = -1.0f;
+            for (uint32_t i = 0; i < num_children; i++)
+            {
+                const BVHNode& c = bnodes[children[i]];
+                if (!c.isLeaf() && halfArea(c) > largest_area)
+                {
+                    largest = static_cast<int>(i);
+                    largest_area = halfArea(c);
+                }
+            }
+            if (largest < 0)
+                break;
+            const uint32_t opened = children[largest];
+            children[largest] = opened + 1;
+            children[num_children++] = bnodes[opened].offset;
+        }
+
+        const uint32_t node_idx = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+        for (uint32_t i = 0; i < num_children; i++)
+        {
+            const BVHNode& c = bnodes[children[i]];
+            uint32_t child, count;
+            if (c.isLeaf())
+            {
+                child = c.offset;
+                count = c.count;
+            }
+            else
+            {
+                child = collapse(bvh, children[i]);
+                count = 0;
+            }
+
+            // m_nodes may be reallocated by the recursion above
+            Node& node = m_nodes[node_idx];
+            for (int a = 0; a < 3; a++)
+            {
+                node.bmin[a][i] = c.bmin[a];
+                node.bmax[a][i] = c.bmax[a];
+            }
+            node.child[i] = child;
+            node.count[i] = count;
+        }
+
+        Node& node = m_nodes[node_idx];
+        for (uint32_t i = num_children; i < N; i++)
+        {
+            for (int a = 0; a < 3; a++)
+            {
+                node.bmin[a][i] = 0.0f;
+                node.bmax[a][i] = 0.0f;
+            }
+            node.child[i] = 0;
+            node.count[i] = 0;
+        }
+        node.num_children = num_children;
+        return node_idx;
+    }
+
+    // ---------------------------------------------------------------------------
+    template <uint32_t N>
+    inline uint32_t WideBVH<N>::intersectChildren(const Node& node, const SimdFloat<N> o[3], const SimdFloat<N> inv_d[3],
+        float tmin, float tmax, float* tnear) const
+    {
+        using F = SimdFloat<N>;
+        // The ray bounds are given as the second operands of vmin/vmax, which are returned when the first is NaN (0 * inf)
+        F t_enter = F::broadcast(tmin);
+        F t_exit = F::broadcast(tmax);
+        for (int a = 0; a < 3; a++)
+        {
+            const F t0 = (F::load(node.bmin[a]) - o[a]) * inv_d[a];
+            const F t1 = (F::load(node.bmax[a]) - o[a]) * inv_d[a];
+            t_enter = vmax(vmin(t0, t1), t_enter);
+            t_exit = vmin(vmax(t0, t1), t_exit);
+        }
+        t_enter.store(tnear);
+        return lessEqualMask(t_enter, t_exit) & ((1u << node.num_children) - 1u);
+    }
+
+    template <uint32_t N>
+    template <class IntersectPrim>
+    inline bool WideBVH<N>::intersect(Ray& ray, const IntersectPrim& intersect_prim) const
+    {
+        if (m_nodes.empty())
+            return false;
+
+        using F = SimdFloat<N>;
+        const Vec3f inv(1.0f / ray.d.x(), 1.0f / ray.d.y(), 1.0f / ray.d.z());
+        const F o[3] = { F::broadcast(ray.o.x()), F::broadcast(ray.o.y()), F::broadcast(ray.o.z()) };
+        const F inv_d[3] = { F::broadcast(inv.x()), F::broadcast(inv.y()), F::broadcast(inv.z()) };
+
+        uint32_t stack[kStackSize];
+        float stack_tnear[kStackSize];
+        uint32_t stack_size = 0;
+        stack[stack_size] = 0;
+        stack_tnear[stack_size] = ray.tmin;
+        stack_size++;
+
+        bool hit = false;
+        alignas(64) float tnear[N];
+        while (stack_size > 0)
+        {
+            stack_size--;
+            if (stack_tnear[stack_size] > ray.tmax)
+                continue;
+            const Node& node = m_nodes[stack[stack_size]];
+
+            uint32_t mask = intersectChildren(node, o, inv_d, ray.tmin, ray.tmax, tnear);
+            if (mask == 0)
+                continue;
+
+            // Sort hit children by the entry distance
+            uint32_t order[N];
+            uint32_t num_hits = 0;
+            while (mask)
+            {
+                const uint32_t c = static_cast<uint32_t>(std::countr_zero(mask));
+                mask &= mask - 1;
+                uint32_t j = num_hits++;
+                while (j > 0 && tnear[order[j - 1]] > tnear[c])
+                {
+                    order[j] = order[j - 1];
+                    j--;
+                }
+                order[j] = c;
+            }
+
+            // Leaves are intersected right away from the nearest, then internal nodes are deferred far to near
+            for (uint32_t k = 0; k < num_hits; k++)
+            {
+                const uint32_t c = order[k];
+                if (node.count[c] == 0 || tnear[c] > ray.tmax)
+                    continue;
+                for (uint32_t i = 0; i < node.count[c]; i++)
+                    hit |= intersect_prim(m_prim_indices[node.child[c] + i], ray);
+            }
+            for (uint32_t k = num_hits; k-- > 0;)
+            {
+                const uint32_t c = order[k];
+                if (node.count[c] != 0)
+                    continue;
+                stack[stack_size] = node.child[c];
+                stack_tnear[stack_size] = tnear[c];
+                stack_size++;
+            }
+        }
+        return hit;
+    }
+
+    template <uint32_t N>
+    template <class OccludedPrim>
+    inline bool WideBVH<N>::occluded(const Ray& ray, const OccludedPrim& occluded_prim) const
+    {
+        if (m_nodes.empty())
+            return false;
+
+        using F = SimdFloat<N>;
+        const Vec3f inv(1.0f / ray.d.x(), 1.0f / ray.d.y(), 1.0f / ray.d.z());
+        const F o[3] = { F::broadcast(ray.o.x()), F::broadcast(ray.o.y()), F::broadcast(ray.o.z()) };
+        const F inv_d[3] = { F::broadcast(inv.x()), F::broadcast(inv.y()), F::broadcast(inv.z()) };
+
+        uint32_t stack[kStackSize];
+        uint32_t stack_size = 0;
+        stack[stack_size++] = 0;
+
+        alignas(64) float tnear[N];
+        while (stack_size > 0)
+        {
+            const Node& node = m_nodes[stack[--stack_size]];
+            uint32_t mask = intersectChildren(node, o, inv_d, ray.tmin, ray.tmax, tnear);
+            while (mask)
+            {
+                const uint32_t c = static_cast<uint32_t>(std::countr_zero(mask));
+                mask &= mask - 1;
+                if (node.count[c] == 0)
+                {
+                    stack[stack_size++] = node.child[c];
+                    continue;
+                }
+                for (uint32_t i = 0; i < node.count[c]; i++)
+                {
+                    if (occluded_prim(m_prim_indices[node.child[c] + i], ray))
+                        return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // ---------------------------------------------------------------------------
+    template <uint32_t N>
+    template <bool AnyHit, uint32_t K, class PrimFunc>
+    inline uint32_t WideBVH<N>::traversePacket(RayPacket<K>& packet, const PrimFunc& prim_func) const
+    {
+        static_assert(K == 8 || K == 16, "Packets of 8 or 16 rays are supported.");
+        using F = SimdFloat<K>;
+
+        uint32_t active = packet.activeMask();
+        if (m_nodes.empty() || active == 0)
+            return 0;
+
+        alignas(64) float inv_x[K], inv_y[K], inv_z[K];
+        for (uint32_t i = 0; i < K; i++)
+        {
+            inv_x[i] = 1.0f / packet.dx[i];
+            inv_y[i] = 1.0f / packet.dy[i];
+            inv_z[i] = 1.0f / packet.dz[i];
+        }
+        const F o[3] = { F::load(packet.ox), F::load(packet.oy), F::load(packet.oz) };
+        const F inv_d[3] = { F::load(inv_x), F::load(inv_y), F::load(inv_z) };
+        const F tmin = F::load(packet.tmin);
+
+        // Children are ordered along the direction of the first active ray, assuming the rays are coherent
+        const uint32_t lead = static_cast<uint32_t>(std::countr_zero(active));
+        const Vec3f lead_o(packet.ox[lead], packet.oy[lead], packet.oz[lead]);
+        const Vec3f lead_d(packet.dx[lead], packet.dy[lead], packet.dz[lead]);
+
+        uint32_t stack[kStackSize];
+        uint32_t stack_size = 0;
+        stack[stack_size++] = 0;
+
+        uint32_t result = 0;
+        while (stack_size > 0 && active != 0)
+        {
+            const Node& node = m_nodes[stack[--stack_size]];
+            const F tmax = F::load(packet.tmax);
+
+            uint32_t order[N];
+            float dist[N];
+            uint32_t num_deferred = 0;
+            for (uint32_t c = 0; c < node.num_children; c++)
+            {
+                F t_enter = tmin;
+                F t_exit = tmax;
+                for (int a = 0; a < 3; a++)
+                {
+                    const F t0 = (F::broadcast(node.bmin[a][c]) - o[a]) * inv_d[a];
+                    const F t1 = (F::broadcast(node.bmax[a][c]) - o[a]) * inv_d[a];
+                    t_enter = vmax(vmin(t0, t1), t_enter);
+                    t_exit = vmin(vmax(t0, t1), t_exit);
+                }
+                const uint32_t hit_mask = lessEqualMask(t_enter, t_exit) & active;
+                if (hit_mask == 0)
+                    continue;
+
+                if (node.count[c] > 0)
+                {
+                    // Leaf: intersect its primitives with the rays that hit the box
+                    for (uint32_t p = 0; p < node.count[c]; p++)
+                    {
+                        const uint32_t prim_id = m_prim_indices[node.child[c] + p];
+                        uint32_t rays = hit_mask & active;
+                        while (rays)
+                        {
+                            const uint32_t r = static_cast<uint32_t>(std::countr_zero(rays));
+                            rays &= rays - 1;
+                            Ray ray = packet.get(r);
+                            if (prim_func(prim_id, r, ray))
+                            {
+                                result |= 1u << r;
+                                if constexpr (AnyHit)
+                                    active &= ~(1u << r);
+                                else
+                                    packet.tmax[r] = ray.tmax;
+                            }
+                        }
+                    }
+                    continue;
+                }
+
+                // Distance of the box center along the leading ray, used for the visiting order
+                const Vec3f center(
+                    (node.bmin[0][c] + node.bmax[0][c]) * 0.5f,
+                    (node.bmin[1][c] + node.bmax[1][c]) * 0.5f,
+                    (node.bmin[2][c] + node.bmax[2][c]) * 0.5f);
+                const float d = dot(center - lead_o, lead_d);
+                uint32_t j = num_deferred++;
+                while (j > 0 && dist[j - 1] < d)
+                {
+                    order[j] = order[j - 1];
+                    dist[j] = dist[j - 1];
+                    j--;
+                }
+                order[j] = node.child[c];
+                dist[j] = d;
+            }
+
+            // Far children are pushed first so that the nearest one is visited next
+            for (uint32_t k = 0; k < num_deferred; k++)
+                stack[stack_size++] = order[k];
+        }
+        return result;
+    }
+
+    template <uint32_t N>
+    template <uint32_t K, class IntersectPrim>
+    inline uint32_t WideBVH<N>::intersect(RayPacket<K>& packet, const IntersectPrim& intersect_prim) const
+    {
+        return traversePacket<false>(packet, intersect_prim);
+    }
+
+    template <uint32_t N>
+    template <uint32_t K, class OccludedPrim>
+    inline uint32_t WideBVH<N>::occluded(const RayPacket<K>& packet, const OccludedPrim& occluded_prim) const
+    {
+        RayPacket<K> copy = packet;
+        return traversePacket<true>(copy, [&](uint32_t prim_id, uint32_t ray_index, const Ray& ray)
+        {
+            return occluded_prim(prim_id, ray_index, ray);
+        });
+    }
+
+} // namespace prayground
@@ -18,8 +18,7 @@ namespace prayground {
     // ---------------------------------------------------------------------------
     void AreaEmitter::copyToDevice() 
     {
-        if (!m_texture->devicePtr())
-            m_texture->copyToDevice();
+        m_texture->copyToDeviceIfDirty();
 
         auto data = this->getData();
 
@@ -51,6 +50,7 @@ namespace prayground {
     void AreaEmitter::setTexture(const std::shared_ptr<Texture>& texture)
     {
         m_texture = texture;
+        markDirty();
     }
 
     std::shared_ptr<Texture> AreaEmitter::texture() const
@@ -61,6 +61,7 @@ namespace prayground {
     void AreaEmitter::setIntensity(float intensity)
     {
         m_intensity = intensity;
+        markDirty();
     }
 
     float AreaEmitter::intensity() const 
@@ -23,6 +23,7 @@ namespace prayground {
         SurfaceType surfaceType() const;
 
         void copyToDevice() override;
+        bool isDirty() const override { return m_dirty || m_texture->isDirty(); }
 
         EmitterType type() const override { return EmitterType::Area; }
         
@@ -4,8 +4,7 @@ namespace prayground {
 
     void EnvironmentEmitter::copyToDevice()
     {
-        if (!m_texture->devicePtr())
-            m_texture->copyToDevice();
+        m_texture->copyToDeviceIfDirty();
 
         auto data = this->getData();
 
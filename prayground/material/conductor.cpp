@@ -32,8 +32,7 @@ namespace prayground {
     void Conductor::copyToDevice()
     {
         Material::copyToDevice();
-        if (!m_texture->devicePtr())
-            m_texture->copyToDevice();
+        m_texture->copyToDeviceIfDirty();
 
         m_thinfilm.copyToDevice();
 
@@ -74,6 +73,7 @@ namespace prayground {
     void Conductor::setTexture(const std::shared_ptr<Texture>& texture)
     {
         m_texture = texture;
+        markDirty();
     }
 
     std::shared_ptr<Texture> Conductor::texture() const 
@@ -84,6 +84,7 @@ namespace prayground {
     void Conductor::setTwosided(bool twosided)
     {
         m_twosided = twosided;
+        markDirty();
     }
 
     bool Conductor::twosided() const
@@ -94,6 +95,7 @@ namespace prayground {
     void Conductor::setThinfilm(const Thinfilm& thinfilm)
     {
         m_thinfilm = thinfilm;
+        markDirty();
     }
     Thinfilm Conductor::thinfilm() const
     {
@@ -65,6 +65,7 @@ namespace prayground {
     void setData(const DataT& data)
     {
       m_data = data;
+      markDirty();
     }
 
     DataT data() const { 
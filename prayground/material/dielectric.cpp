@@ -37,8 +37,7 @@ namespace prayground {
     {
         Material::copyToDevice();
         
-        if (!m_texture->devicePtr())
-            m_texture->copyToDevice();
+        m_texture->copyToDeviceIfDirty();
         m_thinfilm.copyToDevice();
     
         Data data = this->getData();
@@ -78,6 +77,7 @@ namespace prayground {
     void Dielectric::setIor(const float ior)
     {
         m_ior = ior;
+        markDirty();
     }
 
     float Dielectric::ior() const 
@@ -88,6 +88,7 @@ namespace prayground {
     void Dielectric::setAbsorbCoeff(const float absorb_coeff)
     {
         m_absorb_coeff = absorb_coeff;
+        markDirty();
     }
 
     float Dielectric::absorbCoeff() const
@@ -98,6 +99,7 @@ namespace prayground {
     void Dielectric::setSellmeierType(Sellmeier sellmeier)
     {
         m_sellmeier = sellmeier;
+        markDirty();
     }
 
     Sellmeier Dielectric::sellmeierType() const
@@ -108,6 +110,7 @@ namespace prayground {
     void Dielectric::setThinfilm(const Thinfilm& thinfilm)
     {
         m_thinfilm = thinfilm;
+        markDirty();
     }
     Thinfilm Dielectric::thinfilm() const
     {
@@ -119,6 +122,7 @@ namespace prayground {
     void Dielectric::setTexture(const std::shared_ptr<Texture>& texture)
     {
         m_texture = texture;
+        markDirty();
     }
 
     std::shared_ptr<Texture> Dielectric::texture() const 
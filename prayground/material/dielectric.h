@@ -41,6 +41,7 @@ namespace prayground {
         SurfaceType surfaceType() const override;
 
         void copyToDevice() override;
+        bool isDirty() const override { return Material::isDirty() || m_thinfilm.isDirty(); }
         void free() override;
 
         void setIor(const float ior);
@@ -23,6 +23,7 @@ namespace prayground {
     void Diffuse::setTexture(const std::shared_ptr<Texture>& texture)
     {
         m_texture = texture;
+        markDirty();
     }
 
     std::shared_ptr<Texture> Diffuse::texture() const
@@ -34,8 +35,7 @@ namespace prayground {
     void Diffuse::copyToDevice()
     {
         Material::copyToDevice();
-        if (!m_texture->devicePtr())
-            m_texture->copyToDevice();
+        m_texture->copyToDeviceIfDirty();
 
         Data data = this->getData();
 
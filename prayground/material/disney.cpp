@@ -39,8 +39,7 @@ namespace prayground {
     void Disney::copyToDevice()
     {
         Material::copyToDevice();
-        if (!m_albedo->devicePtr())
-            m_albedo->copyToDevice();
+        m_albedo->copyToDeviceIfDirty();
 
         m_thinfilm.copyToDevice();
 
@@ -81,6 +80,7 @@ namespace prayground {
     void Disney::setTexture(const std::shared_ptr<Texture>& albedo)
     {
         m_albedo = albedo;
+        markDirty();
     }
     std::shared_ptr<Texture> Disney::texture() const 
     {
@@ -91,6 +91,7 @@ namespace prayground {
     void Disney::setSubsurface(float subsurface) 
     { 
         m_subsurface = subsurface; 
+        markDirty();
     }
     float Disney::subsurface() const 
     { 
@@ -101,6 +102,7 @@ namespace prayground {
     void Disney::setMetallic(float metallic) 
     { 
         m_metallic = metallic; 
+        markDirty();
     }
     float Disney::metallic() const 
     { 
@@ -111,6 +113,7 @@ namespace prayground {
     void Disney::setSpecular(float specular) 
     { 
         m_specular = specular; 
+        markDirty();
     }
     float Disney::specular() const 
     { 
@@ -121,6 +124,7 @@ namespace prayground {
     void Disney::setSpecularTint(float specular_tint) 
     { 
         m_specular_tint = specular_tint; 
+        markDirty();
     }
     float Disney::specularTint() const 
     { 
@@ -131,6 +135,7 @@ namespace prayground {
     void Disney::setRoughness(float roughness) 
     { 
         m_roughness = roughness; 
+        markDirty();
     }
     float Disney::roughness() const 
     { 
@@ -141,6 +146,7 @@ namespace prayground {
     void Disney::setAnisotropic(float anisotropic) 
     { 
         m_anisotropic = anisotropic; 
+        markDirty();
     }
     float Disney::anisotropic() const 
     { 
@@ -151,6 +157,7 @@ namespace prayground {
     void Disney::setSheen(float sheen) 
     { 
         m_sheen = sheen; 
+        markDirty();
     }
     float Disney::sheen() const 
     { 
@@ -161,6 +168,7 @@ namespace prayground {
     void Disney::setSheenTint(float sheen_tint) 
     { 
         m_sheen_tint = sheen_tint; 
+        markDirty();
     }
     float Disney::sheenTint() const 
     { 
@@ -171,6 +179,7 @@ namespace prayground {
     void Disney::setClearcoat(float clearcoat) 
     { 
         m_clearcoat = clearcoat; 
+        markDirty();
     }
     float Disney::clearcoat() const 
     { 
@@ -181,6 +190,7 @@ namespace prayground {
     void Disney::setClearcoatGloss(float clearcoat_gloss) 
     { 
         m_clearcoat_gloss = clearcoat_gloss; 
+        markDirty();
     }
     float Disney::clearcoatGloss() const 
     { 
@@ -190,6 +200,7 @@ namespace prayground {
     void Disney::setTwosided(bool twosided)
     {
         m_twosided = twosided;
+        markDirty();
     }
 
     bool Disney::twosided() const
@@ -200,6 +211,7 @@ namespace prayground {
     void Disney::setThinfilm(const Thinfilm& thinfilm)
     {
         m_thinfilm = thinfilm;
+        markDirty();
     }
     Thinfilm Disney::thinfilm() const
     {
@@ -43,6 +43,7 @@ namespace prayground {
         SurfaceType surfaceType() const override;
 
         void copyToDevice() override;
+        bool isDirty() const override { return Material::isDirty() || m_thinfilm.isDirty(); }
         void free() override;
 
         void setTexture(const std::shared_ptr<Texture>& base) override;
@@ -1,5 +1,6 @@
 #include "layered.h"
 #include <prayground/core/cudabuffer.h>
+#include <algorithm>
 
 namespace prayground {
     Layered::Layered(const SurfaceCallableID& surface_callable_id, std::vector<std::shared_ptr<Material>> materials)
@@ -11,10 +12,12 @@ namespace prayground {
     void Layered::addTopLayer(const std::shared_ptr<Material>& material)
     {
         m_materials.insert(m_materials.begin(), material);
+        markDirty();
     }
     void Layered::addBottomLayer(const std::shared_ptr<Material>& material)
     {
         m_materials.push_back(material);
+        markDirty();
     }
 
     SurfaceType Layered::surfaceType() const
@@ -46,7 +49,12 @@ namespace prayground {
             });
         for (auto& material : m_materials)
         {
-            material->copyToDevice();
+            // Layers shared with other objects may have been uploaded by the scene already
+            if (material->isDirty() || !material->devicePtr())
+            {
+                material->copyToDevice();
+                material->clearDirty();
+            }
             SurfaceInfo surface_info{
                 .data = material->devicePtr(),
                 .callable_id = material->surfaceCallableID(),
@@ -61,6 +69,13 @@ namespace prayground {
         this->d_surface_info = d_surface_infos.deviceData();
     }
 
+    bool Layered::isDirty() const
+    {
+        // Surface infos of the layers are re-created when one of them is changed
+        return Material::isDirty() || std::any_of(m_materials.begin(), m_materials.end(),
+            [](const std::shared_ptr<Material>& material) { return material->isDirty(); });
+    }
+
     void Layered::setLayerAt(const uint32_t& index, const std::shared_ptr<Material>& material)
     {
         if (index >= m_materials.size()) {
@@ -68,6 +83,7 @@ namespace prayground {
             return;
         }
         m_materials[index] = material;
+        markDirty();
     }
 
     std::shared_ptr<Material> Layered::layerAt(const uint32_t& index) const
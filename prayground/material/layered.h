@@ -25,6 +25,7 @@ namespace prayground {
 
         SurfaceType surfaceType() const override;
         void copyToDevice() override;
+        bool isDirty() const override;
 
         void setTexture(const std::shared_ptr<Texture>& texture) override {}
         std::shared_ptr<Texture> texture() const override { return nullptr; }
@@ -18,8 +18,7 @@ namespace prayground {
 
     void RoughConductor::copyToDevice()
     {
-        if (!m_texture->devicePtr())
-            m_texture->copyToDevice();
+        m_texture->copyToDeviceIfDirty();
 
         Data data = this->getData();
 
@@ -54,6 +53,7 @@ namespace prayground {
     void RoughConductor::setTexture(const std::shared_ptr<Texture>& texture)
     {
         m_texture = texture;
+        markDirty();
     }
 
     std::shared_ptr<Texture> RoughConductor::texture() const
@@ -63,6 +63,7 @@ namespace prayground {
     void RoughConductor::setRoughness(const float roughness)
     {
         m_roughness = roughness;
+        markDirty();
     }
 
     const float& RoughConductor::roughness() const
@@ -73,6 +74,7 @@ namespace prayground {
     void RoughConductor::setAnisotropic(const float anisotropic)
     {
         m_anisotropic = anisotropic;
+        markDirty();
     }
     const float& RoughConductor::anisotropic() const
     {
@@ -17,8 +17,7 @@ namespace prayground {
 
     void RoughDielectric::copyToDevice()
     {
-        if (!m_texture->devicePtr())
-            m_texture->copyToDevice();
+        m_texture->copyToDeviceIfDirty();
 
         Data data = this->getData();
 
@@ -53,6 +52,7 @@ namespace prayground {
     void RoughDielectric::setTexture(const std::shared_ptr<Texture>& texture)
     {
         m_texture = texture;
+        markDirty();
     }
 
     std::shared_ptr<Texture> RoughDielectric::texture() const
@@ -63,6 +63,7 @@ namespace prayground {
     void RoughDielectric::setRoughness(const float roughness)
     {
         m_roughness = roughness;
+        markDirty();
     }
 
     const float& RoughDielectric::roughness() const
@@ -73,6 +74,7 @@ namespace prayground {
     void RoughDielectric::setIor(const float ior)
     {
         m_ior = ior;
+        markDirty();
     }
 
     const float& RoughDielectric::ior() const
@@ -83,6 +85,7 @@ namespace prayground {
     void RoughDielectric::setAbsorbCoeff(const float absorb_coeff)
     {
         m_absorb_coeff = absorb_coeff;
+        markDirty();
     }
     const float& RoughDielectric::absorbCoeff() const
     {
@@ -24,8 +24,12 @@ namespace prayground {
             : m_ior(ior), m_thickness(thickness), m_thickness_scale(thickness_scale), m_tf_ior(tf_ior), m_extinction(extinction) {}
 
         void copyToDevice() {
-            if (m_thickness != nullptr && !m_thickness->devicePtr())
-                m_thickness->copyToDevice();
+            if (m_thickness != nullptr)
+                m_thickness->copyToDeviceIfDirty();
+        }
+
+        bool isDirty() const {
+            return m_thickness != nullptr && m_thickness->isDirty();
         }
 
         void free() {
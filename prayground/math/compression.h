@@ -0,0 +1,321 @@
+#pragma once
+
+#include <prayground/math/vec.h>
+#include <prayground/math/util.h>
+
+#ifdef __CUDACC__
+#include <cuda_fp16.h>
+#else
+#include <prayground/core/parallel.h>
+#include <prayground/cpu/simd.h>
+#include <cstring>
+#endif
+
+/**
+ * @brief
+ * Compact encodings of vertex attributes, e.g. for TriangleMesh::Storage::Compact.
+ *  - Unit vectors: octahedral mapping (Cigolle et al. 2014) with two 16-bit snorm values in 32 bits,
+ *    whose angular error is below 0.01 degrees.
+ *  - Floats: IEEE 754 half precision with round-to-nearest-even, two of them in 32 bits.
+ * Decoders are available on both host and device. Batch encoders/decoders on the host process
+ * four elements at a time with SimdFloat<4>/SimdInt<4> and give the same results as the scalar functions.
+ */
+
+namespace prayground {
+
+    HOSTDEVICE INLINE uint32_t floatAsUint(float f)
+    {
+#ifdef __CUDACC__
+        return __float_as_uint(f);
+#else
+        uint32_t u;
+        std::memcpy(&u, &f, sizeof(u));
+        return u;
+#endif
+    }
+
+    HOSTDEVICE INLINE float uintAsFloat(uint32_t u)
+    {
+#ifdef __CUDACC__
+        return __uint_as_float(u);
+#else
+        float f;
+        std::memcpy(&f, &u, sizeof(f));
+        return f;
+#endif
+    }
+
+    // ---------------------------------------------------------------------------
+    // Half precision
+    // ---------------------------------------------------------------------------
+    HOSTDEVICE INLINE uint16_t floatToHalf(float f)
+    {
+#ifdef __CUDA_ARCH__
+        return __half_as_ushort(__float2half_rn(f));
+#else
+        // Round to nearest even without FPU mode dependency (F. Giesen, "float->half variants")
+        uint32_t u = floatAsUint(f);
+        const uint32_t sign = u & 0x80000000u;
+        u ^= sign;
+
+        uint32_t h;
+        if (u >= (127u + 16u) << 23)
+        {
+            // Overflow to infinity, or NaN (quiet)
+            h = u > (255u << 23) ? 0x7e00u : 0x7c00u;
+        }
+        else if (u < (113u << 23))
+        {
+            // Subnormal or zero: let the float addition round the mantissa
+            const float magic = uintAsFloat(126u << 23);
+            h = floatAsUint(uintAsFloat(u) + magic) - (126u << 23);
+        }
+        else
+        {
+            const uint32_t mantissa_odd = (u >> 13) & 1u;
+            u += (static_cast<uint32_t>(15 - 127) << 23) + 0xfffu + mantissa_odd;
+            h = u >> 13;
+        }
+        return static_cast<uint16_t>(h | (sign >> 16));
+#endif
+    }
+
+    HOSTDEVICE INLINE float halfToFloat(uint16_t h)
+    {
+#ifdef __CUDA_ARCH__
+        return __half2float(__ushort_as_half(h));
+#else
+        const uint32_t exp_mantissa = h & 0x7fffu;
+        // Rescaling the exponent by multiplication also normalizes subnormals
+        float f = uintAsFloat(exp_mantissa << 13) * uintAsFloat((254u - 15u) << 23);
+        if (exp_mantissa >= 0x7c00u)
+            f = uintAsFloat(floatAsUint(f) | (255u << 23));
+        return uintAsFloat(floatAsUint(f) | (static_cast<uint32_t>(h & 0x8000u) << 16));
+#endif
+    }
+
+    HOSTDEVICE INLINE uint32_t packHalf2(const Vec2f& v)
+    {
+        return static_cast<uint32_t>(floatToHalf(v[0])) | (static_cast<uint32_t>(floatToHalf(v[1])) << 16);
+    }
+
+    HOSTDEVICE INLINE Vec2f unpackHalf2(uint32_t packed)
+    {
+        return Vec2f(halfToFloat(static_cast<uint16_t>(packed & 0xffff)), halfToFloat(static_cast<uint16_t>(packed >> 16)));
+    }
+
+    // ---------------------------------------------------------------------------
+    // Octahedral unit vectors
+    // ---------------------------------------------------------------------------
+    HOSTDEVICE INLINE float octSign(float v)
+    {
+        return v >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    // Zero vectors are encoded as +Z
+    HOSTDEVICE INLINE uint32_t octEncode(const Vec3f& n)
+    {
+        const float sum = fabsf(n[0]) + fabsf(n[1]) + fabsf(n[2]);
+        const float inv_sum = sum > 0.0f ? 1.0f / sum : 0.0f;
+        float x = n[0] * inv_sum;
+        float y = n[1] * inv_sum;
+        // Fold the lower hemisphere over the diagonals
+        if (n[2] < 0.0f)
+        {
+            const float fx = (1.0f - fabsf(y)) * octSign(x);
+            const float fy = (1.0f - fabsf(x)) * octSign(y);
+            x = fx;
+            y = fy;
+        }
+        const int32_t qx = static_cast<int32_t>(rintf(fminf(fmaxf(x, -1.0f), 1.0f) * 32767.0f));
+        const int32_t qy = static_cast<int32_t>(rintf(fminf(fmaxf(y, -1.0f), 1.0f) * 32767.0f));
+        return (static_cast<uint32_t>(qx) & 0xffffu) | (static_cast<uint32_t>(qy) << 16);
+    }
+
+    HOSTDEVICE INLINE Vec3f octDecode(uint32_t packed)
+    {
+        float x = fmaxf(static_cast<float>(static_cast<int16_t>(packed & 0xffff)) / 32767.0f, -1.0f);
+        float y = fmaxf(static_cast<float>(static_cast<int16_t>(packed >> 16)) / 32767.0f, -1.0f);
+        const float z = 1.0f - fabsf(x) - fabsf(y);
+        const float t = fmaxf(-z, 0.0f);
+        x -= octSign(x) * t;
+        y -= octSign(y) * t;
+        const float len = sqrtf(x * x + y * y + z * z);
+        return Vec3f(x / len, y / len, z / len);
+    }
+
+#ifndef __CUDACC__
+    // ---------------------------------------------------------------------------
+    // Batch conversion on the host
+    // ---------------------------------------------------------------------------
+    namespace impl {
+        using Simd4 = SimdFloat<4>;
+        using Int4 = SimdInt<4>;
+
+        inline Simd4 octAbs4(const Simd4& v)
+        {
+            return vmax(v, Simd4::broadcast(0.0f) - v);
+        }
+
+        // v >= 0 ? a : b
+        inline Simd4 selectNonNegative4(const Simd4& v, const Simd4& a, const Simd4& b)
+        {
+            const Simd4 zero = Simd4::broadcast(0.0f);
+            return selectEqual(vmin(v, zero), zero, a, b);
+        }
+
+        inline Simd4 octSign4(const Simd4& v)
+        {
+            return selectNonNegative4(v, Simd4::broadcast(1.0f), Simd4::broadcast(-1.0f));
+        }
+
+        // Same as octEncode() for four vectors given by their x, y and z
+        inline Int4 octEncode4(const Simd4& nx, const Simd4& ny, const Simd4& nz)
+        {
+            const Simd4 zero = Simd4::broadcast(0.0f);
+            const Simd4 one = Simd4::broadcast(1.0f);
+            const Simd4 sum = octAbs4(nx) + octAbs4(ny) + octAbs4(nz);
+            const Simd4 inv_sum = selectEqual(sum, zero, zero, one / sum);
+            const Simd4 x = nx * inv_sum;
+            const Simd4 y = ny * inv_sum;
+            const Simd4 fx = (one - octAbs4(y)) * octSign4(x);
+            const Simd4 fy = (one - octAbs4(x)) * octSign4(y);
+
+            const Simd4 scale = Simd4::broadcast(32767.0f);
+            const Simd4 minus_one = Simd4::broadcast(-1.0f);
+            const Int4 qx = Int4::roundFrom(vmin(vmax(selectNonNegative4(nz, x, fx), minus_one), one) * scale);
+            const Int4 qy = Int4::roundFrom(vmin(vmax(selectNonNegative4(nz, y, fy), minus_one), one) * scale);
+            return (qx & Int4::broadcast(0xffff)) | shiftLeft<16>(qy);
+        }
+
+        // Same as octDecode() for four packed vectors
+        inline void octDecode4(const Int4& packed, Simd4& nx, Simd4& ny, Simd4& nz)
+        {
+            const Simd4 zero = Simd4::broadcast(0.0f);
+            const Simd4 scale = Simd4::broadcast(32767.0f);
+            const Simd4 minus_one = Simd4::broadcast(-1.0f);
+            Simd4 x = vmax(shiftRightArithmetic<16>(shiftLeft<16>(packed)).toFloat() / scale, minus_one);
+            Simd4 y = vmax(shiftRightArithmetic<16>(packed).toFloat() / scale, minus_one);
+            const Simd4 z = Simd4::broadcast(1.0f) - octAbs4(x) - octAbs4(y);
+            const Simd4 t = vmax(zero - z, zero);
+            x = x - octSign4(x) * t;
+            y = y - octSign4(y) * t;
+            const Simd4 len = vsqrt(x * x + y * y + z * z);
+            nx = x / len;
+            ny = y / len;
+            nz = z / len;
+        }
+
+        // Same as floatToHalf() for four floats. The results are in the lower 16 bits of each lane.
+        inline Int4 floatToHalf4(const Simd4& f)
+        {
+            const Int4 bits = Int4::bitcast(f);
+            const Int4 sign = bits & Int4::broadcast(0x80000000u);
+            const Int4 u = bits ^ sign;
+
+            // Signed comparisons are safe since the sign bit has been cleared
+            const Int4 is_regular = greaterThan(Int4::broadcast((127 + 16) << 23), u);
+            const Int4 is_nan = greaterThan(u, Int4::broadcast(255u << 23));
+            const Int4 inf_or_nan = Int4::broadcast(0x7c00) | (is_nan & Int4::broadcast(0x200));
+
+            const Int4 is_subnormal = greaterThan(Int4::broadcast(113 << 23), u);
+            const Int4 magic = Int4::broadcast(126 << 23);
+            const Int4 subnormal = Int4::bitcast(u.asFloat() + magic.asFloat()) - magic;
+
+            const Int4 mantissa_odd = shiftRight<13>(u) & Int4::broadcast(1);
+            const Int4 normal = shiftRight<13>(u + Int4::broadcast((static_cast<uint32_t>(15 - 127) << 23) + 0xfffu) + mantissa_odd);
+
+            return select(is_regular, select(is_subnormal, subnormal, normal), inf_or_nan) | shiftRight<16>(sign);
+        }
+
+        // Same as halfToFloat() for halves in the lower 16 bits of each lane
+        inline Simd4 halfToFloat4(const Int4& h)
+        {
+            const Int4 exp_mantissa = h & Int4::broadcast(0x7fff);
+            const Int4 sign = shiftLeft<16>(h & Int4::broadcast(0x8000));
+            const Simd4 scaled = shiftLeft<13>(exp_mantissa).asFloat() * Int4::broadcast((254 - 15) << 23).asFloat();
+            const Int4 inf_nan_exp = greaterThan(exp_mantissa, Int4::broadcast(0x7bff)) & Int4::broadcast(255u << 23);
+            return (Int4::bitcast(scaled) | inf_nan_exp | sign).asFloat();
+        }
+
+        constexpr size_t kCompressionGrain = 4096;
+    } // namespace impl
+
+    inline void octEncode(const Vec3f* normals, uint32_t* packed, size_t n)
+    {
+        parallelForChunks(0, n, [&](size_t begin, size_t end)
+        {
+            size_t i = begin;
+            for (; i + 4 <= end; i += 4)
+            {
+                const Vec3f* v = normals + i;
+                alignas(16) float xs[4] = { v[0][0], v[1][0], v[2][0], v[3][0] };
+                alignas(16) float ys[4] = { v[0][1], v[1][1], v[2][1], v[3][1] };
+                alignas(16) float zs[4] = { v[0][2], v[1][2], v[2][2], v[3][2] };
+                impl::octEncode4(impl::Simd4::load(xs), impl::Simd4::load(ys), impl::Simd4::load(zs)).storeu(packed + i);
+            }
+            for (; i < end; i++)
+                packed[i] = octEncode(normals[i]);
+        }, impl::kCompressionGrain);
+    }
+
+    inline void octDecode(const uint32_t* packed, Vec3f* normals, size_t n)
+    {
+        parallelForChunks(0, n, [&](size_t begin, size_t end)
+        {
+            size_t i = begin;
+            for (; i + 4 <= end; i += 4)
+            {
+                impl::Simd4 x, y, z;
+                impl::octDecode4(impl::Int4::loadu(packed + i), x, y, z);
+                alignas(16) float xs[4], ys[4], zs[4];
+                x.store(xs);
+                y.store(ys);
+                z.store(zs);
+                for (int k = 0; k < 4; k++)
+                    normals[i + k] = Vec3f(xs[k], ys[k], zs[k]);
+            }
+            for (; i < end; i++)
+                normals[i] = octDecode(packed[i]);
+        }, impl::kCompressionGrain);
+    }
+
+    inline void packHalf2(const Vec2f* values, uint32_t* packed, size_t n)
+    {
+        parallelForChunks(0, n, [&](size_t begin, size_t end)
+        {
+            size_t i = begin;
+            for (; i + 4 <= end; i += 4)
+            {
+                const float* f = &values[i][0];
+                const impl::Simd4 a = impl::Simd4::loadu(f), b = impl::Simd4::loadu(f + 4);
+                const impl::Int4 lo = impl::floatToHalf4(shuffle<0, 2, 0, 2>(a, b));
+                const impl::Int4 hi = impl::floatToHalf4(shuffle<1, 3, 1, 3>(a, b));
+                ((lo & impl::Int4::broadcast(0xffff)) | shiftLeft<16>(hi)).storeu(packed + i);
+            }
+            for (; i < end; i++)
+                packed[i] = packHalf2(values[i]);
+        }, impl::kCompressionGrain);
+    }
+
+    inline void unpackHalf2(const uint32_t* packed, Vec2f* values, size_t n)
+    {
+        parallelForChunks(0, n, [&](size_t begin, size_t end)
+        {
+            size_t i = begin;
+            for (; i + 4 <= end; i += 4)
+            {
+                const impl::Int4 p = impl::Int4::loadu(packed + i);
+                alignas(16) float lo[4], hi[4];
+                impl::halfToFloat4(p & impl::Int4::broadcast(0xffff)).store(lo);
+                impl::halfToFloat4(shiftRight<16>(p)).store(hi);
+                for (int k = 0; k < 4; k++)
+                    values[i + k] = Vec2f(lo[k], hi[k]);
+            }
+            for (; i < end; i++)
+                values[i] = unpackHalf2(packed[i]);
+        }, impl::kCompressionGrain);
+    }
+#endif // __CUDACC__
+
+} // namespace prayground
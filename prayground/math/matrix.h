@@ -6,6 +6,7 @@
 
 #ifndef __CUDACC__
     #include <iostream>
+    #include <prayground/math/matrix_simd.h>
 #endif
 
 namespace prayground {
@@ -154,6 +155,13 @@ namespace prayground {
     INLINE HOSTDEVICE Matrix<T, N> operator*(const Matrix<T, N>& m1, const Matrix<T, N>& m2)
     {
         Matrix<T, N> ret;
+#ifndef __CUDACC__
+        if constexpr (std::is_same_v<T, float> && N == 4)
+        {
+            impl::mat4Mul(m1.data(), m2.data(), ret.data());
+            return ret;
+        }
+#endif
         for (uint32_t row = 0; row < N; row++)
         {
             for (uint32_t col = 0; col < N; col++)
@@ -344,6 +352,13 @@ namespace prayground {
     INLINE HOSTDEVICE Matrix<T, N> Matrix<T, N>::inverse() const
     {
         Matrix<T, N> ret = Matrix<T, N>::identity();
+#ifndef __CUDACC__
+        if constexpr (std::is_same_v<T, float> && N == 4)
+        {
+            impl::mat4Inverse(m_data, ret.data());
+            return ret;
+        }
+#endif
         Matrix<T, N> mat(*this);
         float tmp;
         for (uint32_t i = 0; i < N; i++)
@@ -553,4 +568,35 @@ namespace prayground {
         return Matrix<T, N>(data);
     }
 
+#ifndef __CUDACC__
+    // Batched transforms on the host
+    // ----------------------------------------------------------------------------
+    // Same as m.pointMul(src[i]) for all i. src and dst may be the same array.
+    inline void transformPoints(const Matrix4f& m, const Vec3f* src, Vec3f* dst, size_t n)
+    {
+        impl::Simd4 columns[4];
+        impl::mat4Columns(m.data(), columns);
+        impl::transformVec3Array<true, true>(columns, src, dst, n);
+    }
+
+    // Same as m.vectorMul(src[i]) for all i
+    inline void transformVectors(const Matrix4f& m, const Vec3f* src, Vec3f* dst, size_t n)
+    {
+        impl::Simd4 columns[4];
+        impl::mat4Columns(m.data(), columns);
+        impl::transformVec3Array<false, false>(columns, src, dst, n);
+    }
+
+    // Same as m.normalMul(src[i]) for all i, but the inverse is computed only once
+    inline void transformNormals(const Matrix4f& m, const Vec3f* src, Vec3f* dst, size_t n)
+    {
+        // Columns of the inverse transpose are the rows of the inverse
+        const Matrix4f inv = m.inverse();
+        impl::Simd4 columns[4];
+        for (int c = 0; c < 4; c++)
+            columns[c] = impl::Simd4::loadu(inv.data() + c * 4);
+        impl::transformVec3Array<false, false>(columns, src, dst, n);
+    }
+#endif // __CUDACC__
+
 } // namespace prayground
\ No newline at end of file
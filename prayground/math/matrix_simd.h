@@ -0,0 +1,231 @@
+#pragma once
+
+#ifndef __CUDACC__
+
+#include <prayground/cpu/simd.h>
+#include <prayground/math/vec.h>
+#include <cstring>
+#include <limits>
+
+/**
+ * Host SIMD kernels for row-major 4x4 float matrices and arrays of Vec3f.
+ *
+ * They are built on SimdFloat<4>, so SSE/NEON or the scalar fallback is selected at compile time.
+ * Matrix4f::inverse(), Matrix4f * Matrix4f and the batched transforms in matrix.h use them on the host,
+ * and the device keeps the scalar templates.
+ *
+ * Vec3f is 12 bytes and has no alignment, so arrays are accessed with unaligned loads and
+ * every store writes exactly 3 floats.
+ */
+
+namespace prayground {
+
+    namespace impl {
+        using Simd4 = SimdFloat<4>;
+
+        // out = a * b. Each row of the result accumulates the rows of b in the same order as the scalar loop.
+        // out may alias a or b.
+        inline void mat4Mul(const float* a, const float* b, float* out)
+        {
+            const Simd4 b0 = Simd4::loadu(b);
+            const Simd4 b1 = Simd4::loadu(b + 4);
+            const Simd4 b2 = Simd4::loadu(b + 8);
+            const Simd4 b3 = Simd4::loadu(b + 12);
+            for (int row = 0; row < 4; row++)
+            {
+                const float* r = a + row * 4;
+                Simd4 sum = Simd4::broadcast(r[0]) * b0;
+                sum = sum + Simd4::broadcast(r[1]) * b1;
+                sum = sum + Simd4::broadcast(r[2]) * b2;
+                sum = sum + Simd4::broadcast(r[3]) * b3;
+                sum.storeu(out + row * 4);
+            }
+        }
+
+        // 2x2 row-major matrices packed into (m00, m01, m10, m11)
+        // a * b
+        inline Simd4 mat2Mul(const Simd4& a, const Simd4& b)
+        {
+            return a * shuffle<0, 3, 0, 3>(b, b) + shuffle<1, 0, 3, 2>(a, a) * shuffle<2, 1, 2, 1>(b, b);
+        }
+
+        // adj(a) * b
+        inline Simd4 mat2AdjMul(const Simd4& a, const Simd4& b)
+        {
+            return shuffle<3, 3, 0, 0>(a, a) * b - shuffle<1, 1, 2, 2>(a, a) * shuffle<2, 3, 0, 1>(b, b);
+        }
+
+        // a * adj(b)
+        inline Simd4 mat2MulAdj(const Simd4& a, const Simd4& b)
+        {
+            return a * shuffle<3, 0, 3, 0>(b, b) - shuffle<1, 0, 3, 2>(a, a) * shuffle<2, 1, 2, 1>(b, b);
+        }
+
+        /**
+         * Inverse of a 4x4 matrix with 2x2 blocks
+         *   M = | A B |
+         *       | C D |
+         * The adjugate is assembled from the blocks and their adjugates, and divided by
+         * |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C). Unlike Gauss-Jordan elimination without pivoting,
+         * this doesn't depend on the diagonal elements, so zero pivots such as 90 degree rotations are fine.
+         * Singular matrices result in inf/NaN. out may alias m.
+         */
+        inline void mat4Inverse(const float* m, float* out)
+        {
+            const Simd4 r0 = Simd4::loadu(m);
+            const Simd4 r1 = Simd4::loadu(m + 4);
+            const Simd4 r2 = Simd4::loadu(m + 8);
+            const Simd4 r3 = Simd4::loadu(m + 12);
+
+            const Simd4 A = shuffle<0, 1, 0, 1>(r0, r1);
+            const Simd4 B = shuffle<2, 3, 2, 3>(r0, r1);
+            const Simd4 C = shuffle<0, 1, 0, 1>(r2, r3);
+            const Simd4 D = shuffle<2, 3, 2, 3>(r2, r3);
+
+            // (|A|, |B|, |C|, |D|)
+            const Simd4 det_sub = shuffle<0, 2, 0, 2>(r0, r2) * shuffle<1, 3, 1, 3>(r1, r3)
+                                - shuffle<1, 3, 1, 3>(r0, r2) * shuffle<0, 2, 0, 2>(r1, r3);
+            const Simd4 det_A = shuffle<0, 0, 0, 0>(det_sub, det_sub);
+            const Simd4 det_B = shuffle<1, 1, 1, 1>(det_sub, det_sub);
+            const Simd4 det_C = shuffle<2, 2, 2, 2>(det_sub, det_sub);
+            const Simd4 det_D = shuffle<3, 3, 3, 3>(det_sub, det_sub);
+
+            const Simd4 D_C = mat2AdjMul(D, C);
+            const Simd4 A_B = mat2AdjMul(A, B);
+
+            // Adjugates of the blocks of the inverse
+            Simd4 X = det_D * A - mat2Mul(B, D_C);
+            Simd4 W = det_A * D - mat2Mul(C, A_B);
+            Simd4 Y = det_B * C - mat2MulAdj(D, A_B);
+            Simd4 Z = det_C * B - mat2MulAdj(A, D_C);
+
+            const float tr = reduceAdd(A_B * shuffle<0, 2, 1, 3>(D_C, D_C));
+            const Simd4 det_M = det_A * det_D + det_B * det_C - Simd4::broadcast(tr);
+
+            alignas(16) constexpr float sign[4] = { 1.0f, -1.0f, -1.0f, 1.0f };
+            const Simd4 inv_det = Simd4::load(sign) / det_M;
+            X = X * inv_det;
+            Y = Y * inv_det;
+            Z = Z * inv_det;
+            W = W * inv_det;
+
+            // Adjugate of each block and the layout of rows at once
+            shuffle<3, 1, 3, 1>(X, Y).storeu(out);
+            shuffle<2, 0, 2, 0>(X, Y).storeu(out + 4);
+            shuffle<3, 1, 3, 1>(Z, W).storeu(out + 8);
+            shuffle<2, 0, 2, 0>(Z, W).storeu(out + 12);
+        }
+
+        // Columns of a row-major 4x4 matrix
+        inline void mat4Columns(const float* m, Simd4 (&columns)[4])
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                alignas(16) const float column[4] = { m[c], m[4 + c], m[8 + c], m[12 + c] };
+                columns[c] = Simd4::load(column);
+            }
+        }
+
+        /**
+         * dst[i] = (columns * (src[i], 1 or 0)).xyz for all i. With project, the result is divided by w
+         * unless w is 0 or 1, as Matrix4f::pointMul() does. src and dst may be the same array.
+         */
+        template <bool Translate, bool Project>
+        inline void transformVec3Array(const Simd4 (&columns)[4], const Vec3f* src, Vec3f* dst, size_t n)
+        {
+            static_assert(sizeof(Vec3f) == sizeof(float) * 3);
+            const float* in = reinterpret_cast<const float*>(src);
+            float* out = reinterpret_cast<float*>(dst);
+            for (size_t i = 0; i < n; i++)
+            {
+                const float* p = in + i * 3;
+                Simd4 r = columns[0] * Simd4::broadcast(p[0]);
+                r = r + columns[1] * Simd4::broadcast(p[1]);
+                r = r + columns[2] * Simd4::broadcast(p[2]);
+                if constexpr (Translate)
+                    r = r + columns[3];
+
+                alignas(16) float result[4];
+                r.store(result);
+                if constexpr (Project)
+                {
+                    const float w = result[3];
+                    if (w != 1.0f && w != 0.0f)
+                        (r * Simd4::broadcast(1 / w)).store(result);
+                }
+                // Writing 3 floats keeps the next element intact when transforming in place
+                std::memcpy(out + i * 3, result, sizeof(float) * 3);
+            }
+        }
+
+        // Batched Vec3f
+        // ----------------------------------------------------------------------------
+        /**
+         * Component-wise min/max of the points, which is the kernel of boundPoints() in core/bounds.h.
+         * Returns false if n == 0.
+         *
+         * W points are read as 3 vectors of W floats. Lane j of the k-th vector always holds
+         * the component (k * W + j) % 3, so the lanes are folded per component after the loop.
+         * NaN components are ignored like fminf/fmaxf.
+         */
+        inline bool minMaxPoints(const Vec3f* points, size_t n, Vec3f& bmin, Vec3f& bmax)
+        {
+            static_assert(sizeof(Vec3f) == sizeof(float) * 3);
+            if (n == 0)
+                return false;
+
+            constexpr uint32_t W = 8;
+            using SimdT = SimdFloat<W>;
+            const float* p = reinterpret_cast<const float*>(points);
+
+            bmin = points[0];
+            bmax = points[0];
+
+            size_t i = 0;
+            if (n >= W)
+            {
+                SimdT lo[3], hi[3];
+                for (int k = 0; k < 3; k++)
+                {
+                    lo[k] = SimdT::broadcast(std::numeric_limits<float>::infinity());
+                    hi[k] = SimdT::broadcast(-std::numeric_limits<float>::infinity());
+                }
+                for (; i + W <= n; i += W)
+                {
+                    for (int k = 0; k < 3; k++)
+                    {
+                        const SimdT v = SimdT::loadu(p + i * 3 + k * W);
+                        // The accumulator is the second operand, which is returned when v is NaN
+                        lo[k] = vmin(v, lo[k]);
+                        hi[k] = vmax(v, hi[k]);
+                    }
+                }
+
+                alignas(32) float lanes_min[W * 3], lanes_max[W * 3];
+                for (int k = 0; k < 3; k++)
+                {
+                    lo[k].store(lanes_min + k * W);
+                    hi[k].store(lanes_max + k * W);
+                }
+                for (uint32_t j = 0; j < W * 3; j++)
+                {
+                    bmin[j % 3] = fminf(bmin[j % 3], lanes_min[j]);
+                    bmax[j % 3] = fmaxf(bmax[j % 3], lanes_max[j]);
+                }
+            }
+
+            for (; i < n; i++)
+            {
+                for (int c = 0; c < 3; c++)
+                {
+                    bmin[c] = fminf(bmin[c], points[i][c]);
+                    bmax[c] = fmaxf(bmax[c], points[i][c]);
+                }
+            }
+            return true;
+        }
+    } // namespace impl
+
+} // namespace prayground
+
+#endif // __CUDACC__
@@ -17,48 +17,50 @@ namespace prayground {
         HOSTDEVICE float noise(const Vec3f& p) const;
     private:
         static const int POINT_COUNT = 256;
-        Vec3f* m_rnd_vec;
-        int* m_perm_x;
-        int* m_perm_y;
-        int* m_perm_z;
+        // Tables are stored in place, so the noise can be copied to the device as it is
+        Vec3f m_rnd_vec[POINT_COUNT];
+        uint8_t m_perm_x[POINT_COUNT];
+        uint8_t m_perm_y[POINT_COUNT];
+        uint8_t m_perm_z[POINT_COUNT];
 
         unsigned int m_seed;
 
-        int* perlinGeneratePerm()
+        HOSTDEVICE void perlinGeneratePerm(uint8_t* p)
         {
-            int* p = new int[POINT_COUNT];
             for (int i = 0; i < POINT_COUNT; i++)
-                p[i] = i;
-        
-            permute(m_seed, p, POINT_COUNT);
+                p[i] = static_cast<uint8_t>(i);
 
-            return p;
+            permute(m_seed, p, POINT_COUNT);
         }
 
-        static void permute(unsigned int& seed, int* p, int n)
+        static HOSTDEVICE void permute(unsigned int& seed, uint8_t* p, int n)
         {
             for (int i = n-1; i > 0; i--)
             {
                 int target = rndInt(seed, 0, i);
-                int tmp = p[i];
+                uint8_t tmp = p[i];
                 p[i] = p[target];
                 p[target] = tmp;
             }
         }
+
+        HOSTDEVICE const Vec3f& gradient(int i, int j, int k) const
+        {
+            return m_rnd_vec[m_perm_x[i & 255] ^ m_perm_y[j & 255] ^ m_perm_z[k & 255]];
+        }
     };
 
     // Definitions
     INLINE HOSTDEVICE PerlinNoise::PerlinNoise(uint32_t seed) : m_seed{seed}
     {
-        m_rnd_vec = new Vec3f[POINT_COUNT];
         for (int i = 0; i < POINT_COUNT; i++) {
             const Vec3f rnd_v = Vec3f(rnd(seed), rnd(seed), rnd(seed)) * 2.0f - 1.0f;
             m_rnd_vec[i] = normalize(rnd_v);
         }
 
-        m_perm_x = perlinGeneratePerm();
-        m_perm_y = perlinGeneratePerm();
-        m_perm_z = perlinGeneratePerm();
+        perlinGeneratePerm(m_perm_x);
+        perlinGeneratePerm(m_perm_y);
+        perlinGeneratePerm(m_perm_z);
     }
 
     void INLINE HOSTDEVICE PerlinNoise::setSeed(uint32_t seed)
@@ -66,7 +68,7 @@ namespace prayground {
         m_seed = seed;
     }
 
-    float INLINE HOSTDEVICE PerlinNoise::turb(const Vec3f& p, int depth) const 
+    float INLINE HOSTDEVICE PerlinNoise::turb(const Vec3f& p, int depth) const
     {
         float accum = 0.0f;
         Vec3f tmp_p = p;
@@ -81,7 +83,7 @@ namespace prayground {
         return fabs(accum);
     }
 
-    float INLINE HOSTDEVICE PerlinNoise::noise(const Vec3f& p) const 
+    float INLINE HOSTDEVICE PerlinNoise::noise(const Vec3f& p) const
     {
         float u = p.x() - floor(p.x());
         float v = p.y() - floor(p.y());
@@ -95,15 +97,11 @@ namespace prayground {
         for(int di=0; di<2; di++) {
             for(int dj=0; dj<2; dj++) {
                 for(int dk=0; dk<2; dk++) {
-                    c[di][dj][dk] = m_rnd_vec[
-                        m_perm_x[(i+di) & 255] ^ 
-                        m_perm_y[(j+dj) & 255] ^ 
-                        m_perm_z[(k+dk) & 255]
-                    ];
+                    c[di][dj][dk] = gradient(i+di, j+dj, k+dk);
                 }
             }
         }
         return perlinInterop(c, u, v, w);
     }
 
-}
\ No newline at end of file
+}
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <prayground/math/vec.h>
+
 template <unsigned int N>
 static HOSTDEVICE INLINE unsigned int tea(unsigned int val0, unsigned int val1)
 {
@@ -46,6 +48,8 @@ static HOSTDEVICE INLINE unsigned int tea(unsigned int val0, unsigned int val1)
 }
 
 // Generate random unsigned int in [0, 2^24)
+// @note The period is only 2^32 and the low bits are strongly correlated.
+//       New code should prefer the counter-based generators below.
 static HOSTDEVICE INLINE unsigned int lcg(unsigned int &prev)
 {
     const unsigned int LCG_A = 1664525u;
@@ -80,3 +84,153 @@ static HOSTDEVICE INLINE int rndInt(unsigned int& prev, int min, int max)
 {
     return static_cast<int>(rnd(prev, min, max + 1));
 }
+
+namespace prayground {
+
+    // ---------------------------------------------------------------------------
+    // Counter-based random number generators
+    // ---------------------------------------------------------------------------
+    // High 32 bits of the 64-bit product
+    INLINE HOSTDEVICE uint32_t mulhi32(uint32_t a, uint32_t b)
+    {
+#ifdef __CUDA_ARCH__
+        return __umulhi(a, b);
+#else
+        return static_cast<uint32_t>((static_cast<uint64_t>(a) * b) >> 32);
+#endif
+    }
+
+    // Float in [0, 1) from the upper 24 bits
+    INLINE HOSTDEVICE float uintToFloat(uint32_t v)
+    {
+        return static_cast<float>(v >> 8) * 0x1p-24f;
+    }
+
+    // Integer in [0, range) with multiply-shift (Lemire), which has no modulo bias from the low bits
+    INLINE HOSTDEVICE uint32_t uintToRange(uint32_t v, uint32_t range)
+    {
+        return mulhi32(v, range);
+    }
+
+    /**
+     * @brief
+     * PCG32 (O'Neill, "PCG: A Family of Simple Fast Space-Efficient Statistically Good
+     * Algorithms for Random Number Generation", 2014). 64-bit LCG state with XSH-RR output,
+     * period 2^64 per stream, and 2^63 streams selected by the stream id.
+     * advance() jumps over any number of outputs in O(log n).
+     */
+    class PCG32 {
+    public:
+        HOSTDEVICE PCG32(uint64_t seed = 0x853c49e6748fea9bull, uint64_t stream = 0xda3e39cb94b95bdbull)
+        {
+            setSeed(seed, stream);
+        }
+
+        HOSTDEVICE void setSeed(uint64_t seed, uint64_t stream = 0xda3e39cb94b95bdbull)
+        {
+            m_state = 0u;
+            m_inc = (stream << 1u) | 1u;
+            nextUint();
+            m_state += seed;
+            nextUint();
+        }
+
+        HOSTDEVICE uint32_t nextUint()
+        {
+            const uint64_t old_state = m_state;
+            m_state = old_state * kMultiplier + m_inc;
+            const uint32_t xorshifted = static_cast<uint32_t>(((old_state >> 18u) ^ old_state) >> 27u);
+            const uint32_t rot = static_cast<uint32_t>(old_state >> 59u);
+            return (xorshifted >> rot) | (xorshifted << ((0u - rot) & 31u));
+        }
+
+        // Integer in [0, range)
+        HOSTDEVICE uint32_t nextUint(uint32_t range)
+        {
+            return uintToRange(nextUint(), range);
+        }
+
+        HOSTDEVICE float nextFloat()
+        {
+            return uintToFloat(nextUint());
+        }
+
+        // Skip delta outputs. Negative delta goes back, since the period is 2^64.
+        // (Brown, "Random Number Generation with Arbitrary Strides", 1994)
+        HOSTDEVICE void advance(int64_t delta)
+        {
+            uint64_t cur_mult = kMultiplier, cur_plus = m_inc;
+            uint64_t acc_mult = 1u, acc_plus = 0u;
+            for (uint64_t d = static_cast<uint64_t>(delta); d > 0; d >>= 1)
+            {
+                if (d & 1u)
+                {
+                    acc_mult *= cur_mult;
+                    acc_plus = acc_plus * cur_mult + cur_plus;
+                }
+                cur_plus = (cur_mult + 1u) * cur_plus;
+                cur_mult *= cur_mult;
+            }
+            m_state = acc_mult * m_state + acc_plus;
+        }
+
+        HOSTDEVICE bool operator==(const PCG32& other) const { return m_state == other.m_state && m_inc == other.m_inc; }
+        HOSTDEVICE bool operator!=(const PCG32& other) const { return !(*this == other); }
+    private:
+        static constexpr uint64_t kMultiplier = 0x5851f42d4c957f2dull;
+        uint64_t m_state;
+        uint64_t m_inc;
+    };
+
+    /**
+     * @brief
+     * Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", 2011).
+     * Stateless bijection from a 128-bit counter to 4 random words under a 64-bit key.
+     * Any element of the sequence can be computed directly from its counter.
+     */
+    INLINE HOSTDEVICE Vec4ui philox4x32(Vec4ui counter, Vec2ui key)
+    {
+        constexpr uint32_t kMul0 = 0xd2511f53u, kMul1 = 0xcd9e8d57u;
+        constexpr uint32_t kWeyl0 = 0x9e3779b9u, kWeyl1 = 0xbb67ae85u;
+        for (int round = 0; round < 10; round++)
+        {
+            if (round > 0)
+            {
+                key[0] += kWeyl0;
+                key[1] += kWeyl1;
+            }
+            const uint32_t hi0 = mulhi32(kMul0, counter[0]), lo0 = kMul0 * counter[0];
+            const uint32_t hi1 = mulhi32(kMul1, counter[2]), lo1 = kMul1 * counter[2];
+            counter = Vec4ui(hi1 ^ counter[1] ^ key[0], lo1, hi0 ^ counter[3] ^ key[1], lo0);
+        }
+        return counter;
+    }
+
+    /**
+     * @brief
+     * Words of the dimensions (dimension & ~3) ... (dimension | 3) of the (pixel, sample) from
+     * one Philox call. Word i is sampleHash() of the dimension (dimension & ~3) + i.
+     */
+    INLINE HOSTDEVICE Vec4ui sampleHashBlock(uint32_t pixel, uint32_t sample, uint32_t dimension, uint32_t seed = 0u)
+    {
+        return philox4x32(Vec4ui(pixel, sample, dimension >> 2, 0u), Vec2ui(seed, 0x5eed5eedu));
+    }
+
+    /**
+     * @brief
+     * Random word of the (pixel, sample, dimension) triple. Every dimension is computed
+     * independently, so paths can skip or reorder dimensions without carrying RNG state.
+     * Each call runs a full Philox and keeps one of its 4 words. Consecutive dimensions should be
+     * drawn with IndependentSampler, which reuses the block of sampleHashBlock() for 4 dimensions.
+     */
+    INLINE HOSTDEVICE uint32_t sampleHash(uint32_t pixel, uint32_t sample, uint32_t dimension, uint32_t seed = 0u)
+    {
+        return sampleHashBlock(pixel, sample, dimension, seed)[dimension & 3u];
+    }
+
+    INLINE HOSTDEVICE float sampleFloat(uint32_t pixel, uint32_t sample, uint32_t dimension, uint32_t seed = 0u)
+    {
+        return uintToFloat(sampleHash(pixel, sample, dimension, seed));
+    }
+
+} // namespace prayground
@@ -25,6 +25,12 @@ namespace prayground {
         m_count++;
     }
 
+    void GeometryAccel::setShape(uint32_t idx, const std::shared_ptr<Shape>& shape)
+    {
+        ASSERT(idx < m_shapes.size(), "The index of shape is out of range.");
+        m_shapes[idx] = shape;
+    }
+
     std::vector<std::shared_ptr<Shape>> GeometryAccel::shapes() const 
     {
         return m_shapes;
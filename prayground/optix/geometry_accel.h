@@ -17,6 +17,8 @@ namespace prayground {
         ~GeometryAccel();
 
         void addShape(const std::shared_ptr<Shape>& shape);
+        // Replace the shape at the index (e.g. switching level of detail). build() must be called again.
+        void setShape(uint32_t idx, const std::shared_ptr<Shape>& shape);
         std::vector<std::shared_ptr<Shape>> shapes() const;
    
         void build(const Context& ctx, CUstream stream);
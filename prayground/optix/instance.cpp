@@ -188,6 +188,11 @@ void ShapeInstance::addShape(const std::shared_ptr<Shape>& shape)
     m_gas.addShape(shape);
 }
 
+void ShapeInstance::setShape(uint32_t idx, const std::shared_ptr<Shape>& shape)
+{
+    m_gas.setShape(idx, shape);
+}
+
 std::vector<std::shared_ptr<Shape>> ShapeInstance::shapes() const 
 {
     return m_gas.shapes();
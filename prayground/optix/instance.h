@@ -61,6 +61,8 @@ namespace prayground {
         explicit operator OptixInstance() const { return *(m_instance.rawInstancePtr()); }
 
         void addShape(const std::shared_ptr<Shape>& shape);
+        // Replace the shape in GAS. buildAccel() must be called again.
+        void setShape(uint32_t idx, const std::shared_ptr<Shape>& shape);
         std::vector<std::shared_ptr<Shape>> shapes() const;
 
         void setId(const uint32_t id);
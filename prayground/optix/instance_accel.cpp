@@ -5,6 +5,11 @@
 
 namespace prayground {
 
+    namespace {
+        // Clean instances allowed between dirty ones in a single upload
+        constexpr uint32_t kMaxInstanceUploadGap = 16;
+    } // nonamed namespace
+
     InstanceAccel::InstanceAccel(Type type)
     : m_type(type)
     {
@@ -19,32 +24,56 @@ namespace prayground {
     // ---------------------------------------------------------------------------
     void InstanceAccel::addInstance(const Instance& instance)
     {
-        m_instances.emplace_back(instance.rawInstancePtr());
+        OptixInstance* instance_ptr = instance.rawInstancePtr();
+        m_linked_instances.emplace_back(m_instances.add(*instance_ptr), instance_ptr);
     }
 
     void InstanceAccel::addInstance(const ShapeInstance& shape_instance)
     {
-        m_instances.emplace_back(shape_instance.rawInstancePtr());
+        OptixInstance* instance_ptr = shape_instance.rawInstancePtr();
+        m_linked_instances.emplace_back(m_instances.add(*instance_ptr), instance_ptr);
+    }
+
+    uint32_t InstanceAccel::addInstance(const OptixInstance& instance)
+    {
+        return m_instances.add(instance);
+    }
+
+    void InstanceAccel::updateTransforms(std::span<const Matrix4f> transforms, std::span<const uint32_t> ids)
+    {
+        m_instances.updateTransforms(transforms, ids);
+    }
+
+    InstanceArray& InstanceAccel::instances()
+    {
+        return m_instances;
+    }
+
+    const InstanceArray& InstanceAccel::instances() const
+    {
+        return m_instances;
     }
 
     // ---------------------------------------------------------------------------
     void InstanceAccel::build(const Context& ctx, CUstream stream)
     {
-        std::vector<OptixInstance> optix_instances;
-        std::transform(m_instances.begin(), m_instances.end(), std::back_inserter(optix_instances),
-            [](OptixInstance* instance) { return *instance; });
+        for (auto& [idx, instance_ptr] : m_linked_instances)
+            m_instances.set(idx, *instance_ptr);
 
-        CUDA_CHECK(cudaMalloc(reinterpret_cast<void**>(&d_instances), sizeof(OptixInstance) * optix_instances.size()));
+        if (d_instances) cuda_free(d_instances);
+        m_count = m_instances.size();
+        CUDA_CHECK(cudaMalloc(reinterpret_cast<void**>(&d_instances), sizeof(OptixInstance) * m_count));
         CUDA_CHECK(cudaMemcpy(
             reinterpret_cast<void*>(d_instances),
-            optix_instances.data(), sizeof(OptixInstance) * optix_instances.size(),
+            m_instances.data(), sizeof(OptixInstance) * m_count,
             cudaMemcpyHostToDevice
         ));
+        m_instances.clearDirty();
 
         m_instance_input = {};
         m_instance_input.type = static_cast<OptixBuildInputType>(m_type);
         m_instance_input.instanceArray.instances = d_instances;
-        m_instance_input.instanceArray.numInstances = static_cast<uint32_t>(m_instances.size());
+        m_instance_input.instanceArray.numInstances = m_count;
 
         m_options.operation = OPTIX_BUILD_OPERATION_BUILD;
 
@@ -90,17 +119,9 @@ namespace prayground {
     {
         ASSERT((m_options.buildFlags & OPTIX_BUILD_FLAG_ALLOW_UPDATE) != 0, "allowUpdate() must be called before an update operation.");
 
-        OptixInstance* instance_device_ptr = reinterpret_cast<OptixInstance*>(d_instances);
-        for (int i=0; OptixInstance* instance : m_instances)
-        {
-            CUDA_CHECK(cudaMemcpy(
-                &instance_device_ptr[i],
-                instance,
-                sizeof(OptixInstance),
-                cudaMemcpyHostToDevice
-            ));
-            i++;
-        }
+        ASSERT(m_instances.size() == m_count, "Instances have been added after build(). Call build() again instead of update().");
+
+        uploadInstances(stream);
 
         m_options.operation = OPTIX_BUILD_OPERATION_UPDATE;
 
@@ -133,11 +154,35 @@ namespace prayground {
         ));
 
         CUDA_SYNC_CHECK();
+        cuda_free(d_temp_buffer);
+    }
+
+    void InstanceAccel::uploadInstances(CUstream stream)
+    {
+        // Instance/ShapeInstance may have been modified since the last upload
+        for (auto& [idx, instance_ptr] : m_linked_instances)
+            m_instances.set(idx, *instance_ptr);
+
+        OptixInstance* instance_device_ptr = reinterpret_cast<OptixInstance*>(d_instances);
+        for (const auto& range : m_instances.dirtyRanges(kMaxInstanceUploadGap))
+        {
+            CUDA_CHECK(cudaMemcpyAsync(
+                &instance_device_ptr[range.offset],
+                &m_instances[range.offset],
+                sizeof(OptixInstance) * range.count,
+                cudaMemcpyHostToDevice, 
+                stream
+            ));
+        }
+        m_instances.clearDirty();
     }
 
     void InstanceAccel::free()
     {
         if (d_buffer) cuda_free(d_buffer);
+        if (d_instances) cuda_free(d_instances);
+        d_buffer = 0;
+        d_instances = 0;
         d_buffer_size = 0;
     }
 
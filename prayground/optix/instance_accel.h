@@ -2,6 +2,8 @@
 #include <optix.h>
 #include <prayground/optix/context.h>
 #include <prayground/optix/instance.h>
+#include <prayground/optix/instance_array.h>
+#include <span>
 #include <variant>
 
 namespace prayground {
@@ -18,8 +20,21 @@ namespace prayground {
         explicit InstanceAccel(Type type);
         ~InstanceAccel();
 
+        // Instances added by these functions are linked to their OptixInstance,
+        // so changes through Instance/ShapeInstance are reflected at the next update().
         void addInstance(const Instance& instance);
         void addInstance(const ShapeInstance& shape_instance);
+        // Add an instance owned by the IAS and return its index to update it later
+        uint32_t addInstance(const OptixInstance& instance);
+
+        /**
+         * @brief Update transforms of instances owned by the IAS in bulk.
+         * Only the modified instances are uploaded at the next update().
+         */
+        void updateTransforms(std::span<const Matrix4f> transforms, std::span<const uint32_t> ids);
+
+        InstanceArray& instances();
+        const InstanceArray& instances() const;
 
         void build(const Context& ctx, CUstream stream);
         void update(const Context& ctx, CUstream stream);
@@ -51,8 +66,13 @@ namespace prayground {
         OptixAccelBuildOptions m_options{};
         uint32_t m_count{ 0 };
 
-        std::vector<OptixInstance*> m_instances;
-        CUdeviceptr d_instances;
+        // Synchronize linked instances and upload dirty ranges of the instance array
+        void uploadInstances(CUstream stream);
+
+        InstanceArray m_instances;
+        // Pairs of an index to m_instances and the linked OptixInstance owned by Instance
+        std::vector<std::pair<uint32_t, OptixInstance*>> m_linked_instances;
+        CUdeviceptr d_instances{ 0 };
         OptixBuildInput m_instance_input;
 
         CUdeviceptr d_buffer{ 0 };
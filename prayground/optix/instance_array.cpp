@@ -0,0 +1,162 @@
+#include "instance_array.h"
+#include <prayground/core/util.h>
+#include <prayground/core/parallel.h>
+#include <cstring>
+
+namespace prayground {
+
+    namespace {
+        // Transforms written by a worker thread at once
+        constexpr size_t kTransformGrain = 4096;
+
+        inline void writeTransform(OptixInstance& instance, const Matrix4f& transform)
+        {
+            // OptixInstance stores the upper 3x4 part of the row-major matrix
+            memcpy(instance.transform, transform.data(), sizeof(float) * 12);
+        }
+    } // nonamed namespace
+
+    // ---------------------------------------------------------------------------
+    uint32_t InstanceArray::add(const OptixInstance& instance)
+    {
+        m_instances.emplace_back(instance);
+        m_dirty.emplace_back(1);
+        return static_cast<uint32_t>(m_instances.size() - 1);
+    }
+
+    void InstanceArray::reserve(size_t n)
+    {
+        m_instances.reserve(n);
+        m_dirty.reserve(n);
+    }
+
+    void InstanceArray::clear()
+    {
+        m_instances.clear();
+        m_dirty.clear();
+    }
+
+    uint32_t InstanceArray::size() const
+    {
+        return static_cast<uint32_t>(m_instances.size());
+    }
+
+    bool InstanceArray::empty() const
+    {
+        return m_instances.empty();
+    }
+
+    const OptixInstance& InstanceArray::operator[](uint32_t idx) const
+    {
+        return m_instances[idx];
+    }
+
+    const OptixInstance* InstanceArray::data() const
+    {
+        return m_instances.data();
+    }
+
+    // ---------------------------------------------------------------------------
+    bool InstanceArray::set(uint32_t idx, const OptixInstance& instance)
+    {
+        ASSERT(idx < m_instances.size(), "The index out of range.");
+        if (memcmp(&m_instances[idx], &instance, sizeof(OptixInstance)) == 0)
+            return false;
+        m_instances[idx] = instance;
+        m_dirty[idx] = 1;
+        return true;
+    }
+
+    void InstanceArray::setTransform(uint32_t idx, const Matrix4f& transform)
+    {
+        ASSERT(idx < m_instances.size(), "The index out of range.");
+        writeTransform(m_instances[idx], transform);
+        m_dirty[idx] = 1;
+    }
+
+    void InstanceArray::updateTransforms(std::span<const Matrix4f> transforms, std::span<const uint32_t> ids)
+    {
+        ASSERT(transforms.size() == ids.size(), "The number of transforms must be same with the number of instance ids.");
+
+        const uint32_t num_instances = size();
+        for (const uint32_t id : ids)
+            ASSERT(id < num_instances, "The instance id " + std::to_string(id) + " is out of range.");
+
+        parallelForChunks(0, ids.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                writeTransform(m_instances[ids[i]], transforms[i]);
+                m_dirty[ids[i]] = 1;
+            }
+        }, kTransformGrain);
+    }
+
+    void InstanceArray::updateTransforms(std::span<const Matrix4f> transforms)
+    {
+        ASSERT(transforms.size() <= m_instances.size(), "The number of transforms exceeds the number of instances.");
+
+        parallelForChunks(0, transforms.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                writeTransform(m_instances[i], transforms[i]);
+            std::fill(m_dirty.begin() + begin, m_dirty.begin() + end, uint8_t(1));
+        }, kTransformGrain);
+    }
+
+    // ---------------------------------------------------------------------------
+    void InstanceArray::markDirty(uint32_t idx)
+    {
+        ASSERT(idx < m_dirty.size(), "The index out of range.");
+        m_dirty[idx] = 1;
+    }
+
+    void InstanceArray::markAllDirty()
+    {
+        std::fill(m_dirty.begin(), m_dirty.end(), uint8_t(1));
+    }
+
+    bool InstanceArray::isDirty(uint32_t idx) const
+    {
+        return m_dirty[idx] != 0;
+    }
+
+    void InstanceArray::clearDirty()
+    {
+        std::fill(m_dirty.begin(), m_dirty.end(), uint8_t(0));
+    }
+
+    std::vector<IndexRange> InstanceArray::dirtyRanges(uint32_t max_gap) const
+    {
+        std::vector<IndexRange> ranges;
+        const uint32_t n = size();
+        uint32_t i = 0;
+        while (i < n)
+        {
+            if (!m_dirty[i])
+            {
+                i++;
+                continue;
+            }
+
+            uint32_t end = i + 1;
+            uint32_t gap = 0;
+            for (uint32_t j = end; j < n && gap <= max_gap; j++)
+            {
+                if (m_dirty[j])
+                {
+                    end = j + 1;
+                    gap = 0;
+                }
+                else
+                {
+                    gap++;
+                }
+            }
+            ranges.push_back({ i, end - i });
+            i = end;
+        }
+        return ranges;
+    }
+
+} // namespace prayground
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <optix.h>
+#include <prayground/math/matrix.h>
+#include <prayground/core/index_range.h>
+#include <span>
+#include <vector>
+
+namespace prayground {
+
+    /**
+     * @brief
+     * Contiguous host storage of OptixInstance records for an instance acceleration structure.
+     *
+     * The records are packed in the same layout as the instance buffer on device,
+     * so modified records can be uploaded with a few ranged copies.
+     * Every modification marks the record dirty, and dirtyRanges() gathers them into ranges.
+     * This class never touches the device; uploading is done by InstanceAccel.
+     */
+    class InstanceArray {
+    public:
+        InstanceArray() = default;
+
+        // Append a record and return its index in the array
+        uint32_t add(const OptixInstance& instance);
+        void reserve(size_t n);
+        void clear();
+
+        uint32_t size() const;
+        bool empty() const;
+
+        const OptixInstance& operator[](uint32_t idx) const;
+        const OptixInstance* data() const;
+
+        // Overwrite the record when it differs from the stored one. Returns true if the record has been changed.
+        bool set(uint32_t idx, const OptixInstance& instance);
+
+        void setTransform(uint32_t idx, const Matrix4f& transform);
+
+        /**
+         * @brief Update transforms of many instances at once.
+         * transforms[i] is written to the instance ids[i]. The conversion runs on multiple threads,
+         * so each id must appear only once in \c ids.
+         */
+        void updateTransforms(std::span<const Matrix4f> transforms, std::span<const uint32_t> ids);
+
+        // Update transforms of the instances [0, transforms.size())
+        void updateTransforms(std::span<const Matrix4f> transforms);
+
+        void markDirty(uint32_t idx);
+        void markAllDirty();
+        bool isDirty(uint32_t idx) const;
+        void clearDirty();
+
+        /**
+         * @brief Gather dirty records into contiguous ranges.
+         * @param max_gap Number of clean records allowed inside a range to merge neighbouring copies
+         */
+        std::vector<IndexRange> dirtyRanges(uint32_t max_gap = 0) const;
+    private:
+        std::vector<OptixInstance> m_instances;
+        // uint8_t instead of bool so that worker threads can write flags of different records concurrently
+        std::vector<uint8_t> m_dirty;
+    };
+
+} // namespace prayground
@@ -33,7 +33,9 @@
 #include <prayground/core/util.h>
 #include <prayground/app/app_runner.h>
 #include <prayground/optix/macros.h>
+#include <prayground/optix/module_cache.h>
 #include <map>
+#include <mutex>
 
 #define STRINGIFY( x ) STRINGIFY2( x )
 #define STRINGIFY2( x ) #x
@@ -55,6 +57,8 @@ namespace prayground {
         struct SourceCache
         {
             std::map<std::string, std::string*> map;
+            // Modules may be compiled on multiple threads (see Pipeline::createModulesFromCudaFiles())
+            std::mutex mutex;
             ~SourceCache()
             {
                 for (std::map<std::string, std::string*>::const_iterator it = map.begin(); it != map.end(); ++it)
@@ -138,43 +142,46 @@ namespace prayground {
         }
 
     #if CUDA_NVRTC_ENABLED
-        std::string g_nvrtcLog;
+        thread_local std::string g_nvrtcLog;
 
-        void getPtxFromCuString(std::string& ptx, const char* cu_source, const char* name, const char** log_string)
+        // Include directories passed to NVRTC
+        std::vector<fs::path> nvrtcIncludeDirs(const char* name)
         {
-            nvrtcProgram prog = 0;
-            NVRTC_CHECK(nvrtcCreateProgram(&prog, cu_source, name, 0, nullptr, nullptr));
-
-            std::vector<const char*> options;
-
-            std::string app_dir;
-            if (pgAppDir().string() != "") {
-                app_dir = std::string("-I") + pgAppDir().string();
-                options.push_back(app_dir.c_str());
-            }
-
-            std::string file_dir;
+            std::vector<fs::path> include_dirs;
+            if (pgAppDir().string() != "")
+                include_dirs.push_back(pgAppDir());
             if (name)
-            {
-                file_dir = std::string("-I") + fs::path(name).parent_path().string();
-                options.push_back( file_dir.c_str() );
-            }
+                include_dirs.push_back(fs::path(name).parent_path());
 
-            // Collect include dirs
-            std::vector<std::string> include_dirs;
             const char* abs_dirs[] = { PRAYGROUND_ABSOLUTE_INCLUDE_DIRS };
             const char* rel_dirs[] = { PRAYGROUND_RELATIVE_INCLUDE_DIRS };
-
             for (const char* dir : abs_dirs)
-                include_dirs.push_back(std::string("-I") + dir);
+                include_dirs.push_back(dir);
             for (const char* dir : rel_dirs)
-                include_dirs.push_back(std::string("-I") + dir);
-            for (const std::string& dir : include_dirs)
-                options.push_back(dir.c_str());
+                include_dirs.push_back(dir);
+            return include_dirs;
+        }
+
+        std::vector<std::string> nvrtcOptions(const std::vector<fs::path>& include_dirs)
+        {
+            std::vector<std::string> options;
+            for (const auto& dir : include_dirs)
+                options.push_back(std::string("-I") + dir.string());
 
             // Collect NVRTC options
             const char* compiler_options[] = { CUDA_NVRTC_OPTIONS };
             std::copy(std::begin(compiler_options), std::end(compiler_options), std::back_inserter(options));
+            return options;
+        }
+
+        void getPtxFromCuString(std::string& ptx, const char* cu_source, const char* name, const std::vector<std::string>& option_strings, const char** log_string)
+        {
+            nvrtcProgram prog = 0;
+            NVRTC_CHECK(nvrtcCreateProgram(&prog, cu_source, name, 0, nullptr, nullptr));
+
+            std::vector<const char*> options;
+            for (const std::string& option : option_strings)
+                options.push_back(option.c_str());
 
             // JIT compile CU to PTX
             const nvrtcResult compileRes = nvrtcCompileProgram(prog, (int)options.size(), options.data());
@@ -201,6 +208,51 @@ namespace prayground {
             // Cleanup
             NVRTC_CHECK(nvrtcDestroyProgram(&prog));
         }
+
+        /**
+         * Same as getPtxFromCuString(), but the PTX is looked up from the persistent module cache first.
+         * The key covers the source, all headers reachable from it, NVRTC and its options, and the compile options of OptiX.
+         */
+        void getPtxFromCuStringCached(
+            std::string& ptx, const std::string& cu_source, const char* name,
+            const OptixModuleCompileOptions& module_options, const OptixPipelineCompileOptions& pipeline_options,
+            const char** log_string)
+        {
+            const std::vector<fs::path> include_dirs = nvrtcIncludeDirs(name);
+            const std::vector<std::string> options = nvrtcOptions(include_dirs);
+
+            auto cache_dir = ModuleCache::defaultDirectory();
+            if (!cache_dir)
+            {
+                getPtxFromCuString(ptx, cu_source.c_str(), name, options, log_string);
+                return;
+            }
+
+            int nvrtc_major = 0, nvrtc_minor = 0;
+            NVRTC_CHECK(nvrtcVersion(&nvrtc_major, &nvrtc_minor));
+
+            ModuleHasher hasher;
+            hasher.update(nvrtc_major).update(nvrtc_minor);
+            hasher.update(std::string_view(cu_source));
+            for (const std::string& option : options)
+                hasher.update(std::string_view(option));
+            const fs::path source_dir = name ? fs::path(name).parent_path() : fs::path();
+            hashFiles(hasher, scanIncludeClosure(cu_source, source_dir, include_dirs));
+            hashCompileOptions(hasher, module_options, pipeline_options);
+            const std::string key = hasher.digest();
+
+            // Other processes compiling the same module wait here, then pick up the stored entry
+            ModuleCache cache(cache_dir.value());
+            auto lock = cache.lock(key);
+            if (auto cached = cache.load(key, ".ptx"))
+            {
+                ptx = std::move(cached.value());
+                return;
+            }
+
+            getPtxFromCuString(ptx, cu_source.c_str(), name, options, log_string);
+            cache.store(key, ".ptx", ptx);
+        }
     #endif // CUDA_NVRTC_ENABLED
 
     } // nonamed namespace
@@ -258,39 +310,46 @@ namespace prayground {
 //        }
 //        createFromPtxSource(ctx, *ptx, pipeline_options);
 
+        createFromPtxSource(ctx, compileCudaFile(filename, pipeline_options), pipeline_options);
+    }
+
+    std::string Module::compileCudaFile(const fs::path& filename, const OptixPipelineCompileOptions& pipeline_options) const
+    {
         auto filepath = pgFindDataPath(filename);
         ASSERT(filepath, "The CUDA file to create module of '" + filename.string() + "' is not found.");
 
-        const char** log = nullptr;
-        std::string* input_data;
         std::string key = filepath.value().string();
-        std::map<std::string, std::string*>::iterator elem = g_source_cache.map.find(key);
-
-        if (elem == g_source_cache.map.end())
         {
-            input_data = new std::string();
+            std::lock_guard<std::mutex> lock(g_source_cache.mutex);
+            std::map<std::string, std::string*>::iterator elem = g_source_cache.map.find(key);
+            if (elem != g_source_cache.map.end())
+                return *elem->second;
+        }
+
+        // Compile outside the lock so that other files can be compiled at the same time
+        const char** log = nullptr;
+        std::string* input_data = new std::string();
 #if CUDA_NVRTC_ENABLED
-            std::string cu_source = pgGetTextFromFile(filepath.value());
-            getPtxFromCuString(input_data, cu_source.c_str(), filepath.value().string().c_str(), log);
+        std::string cu_source = pgGetTextFromFile(filepath.value());
+        getPtxFromCuStringCached(*input_data, cu_source, filepath.value().string().c_str(), m_options, pipeline_options, log);
 #else
-            getInputDataFromFile(*input_data, filepath.value().string());
+        getInputDataFromFile(*input_data, filepath.value().string());
 #endif
-            g_source_cache.map[key] = input_data;
-        }
-        else
-        {
-            input_data = elem->second;
-        }
-        createFromPtxSource(ctx, *input_data, pipeline_options);
+
+        std::lock_guard<std::mutex> lock(g_source_cache.mutex);
+        auto [elem, inserted] = g_source_cache.map.emplace(key, input_data);
+        if (!inserted)
+            delete input_data;
+        return *elem->second;
     }
 
     void Module::createFromCudaSource(const Context& ctx, const std::string& source, OptixPipelineCompileOptions pipeline_options)
     {
 #if CUDA_NVRTC_ENABLED
         const char** log = nullptr;
-        std::string* ptx = new std::string;
-        getPtxFromCuString(*ptx, source.c_str(), "", log);
-        createFromPtxSource(ctx, *ptx, pipeline_options);
+        std::string ptx;
+        getPtxFromCuStringCached(ptx, source, "", m_options, pipeline_options, log);
+        createFromPtxSource(ctx, ptx, pipeline_options);
 #endif
     }
 
@@ -300,16 +359,22 @@ namespace prayground {
         ASSERT(filepath, "The PTX file to create module of '" + filename.string() + "' is not found.");
 
         std::string key = filepath.value().string();
-        std::map<std::string, std::string*>::iterator elem = g_source_cache.map.find(key);
-        std::string* ptx = new std::string;
-
-        if (elem == g_source_cache.map.end())
+        std::string* ptx = nullptr;
         {
-            *ptx = pgGetTextFromFile(filepath.value());
-            g_source_cache.map[key] = ptx;
+            std::lock_guard<std::mutex> lock(g_source_cache.mutex);
+            std::map<std::string, std::string*>::iterator elem = g_source_cache.map.find(key);
+            if (elem != g_source_cache.map.end())
+                ptx = elem->second;
         }
-        else
+
+        // Read the file and create the module outside the lock so that modules can be created at the same time
+        if (!ptx)
         {
+            std::string* source = new std::string(pgGetTextFromFile(filepath.value()));
+            std::lock_guard<std::mutex> lock(g_source_cache.mutex);
+            auto [elem, inserted] = g_source_cache.map.emplace(key, source);
+            if (!inserted)
+                delete source;
             ptx = elem->second;
         }
 
@@ -351,24 +416,88 @@ namespace prayground {
         auto filepath = pgFindDataPath(filename);
         ASSERT(filepath, "The Optix IR file to create module of '" + filename.string() + "' is not found.");
 
-        std::string* input_data = new std::string;
         std::string key = filepath.value().string();
-        std::map<std::string, std::string*>::iterator elem = g_source_cache.map.find(key);
+        std::string* input_data = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(g_source_cache.mutex);
+            std::map<std::string, std::string*>::iterator elem = g_source_cache.map.find(key);
+            if (elem != g_source_cache.map.end())
+                input_data = elem->second;
+        }
 
-        if (elem == g_source_cache.map.end()) {
-            if (!readSourceFile(*input_data, filepath.value().string())) {
+        if (!input_data)
+        {
+            std::string* source = new std::string;
+            if (!readSourceFile(*source, filepath.value().string())) {
+                delete source;
                 std::string err = "Couldn't open source file " + filepath.value().string();
                 throw std::runtime_error(err.c_str());
             }
 
-            g_source_cache.map[key] = input_data;
-        } else {
+            std::lock_guard<std::mutex> lock(g_source_cache.mutex);
+            auto [elem, inserted] = g_source_cache.map.emplace(key, source);
+            if (!inserted)
+                delete source;
             input_data = elem->second;
         }
 
         createFromPtxSource(ctx, *input_data, pipeline_options);
     }
 
+#if OPTIX_VERSION >= 70400
+    OptixTask Module::createFromPtxSourceWithTasks(const Context& ctx, const std::string& source, const OptixPipelineCompileOptions& pipeline_options)
+    {
+        char log[2048];
+        size_t sizeof_log = sizeof(log);
+
+        OptixTask first_task = nullptr;
+    #if OPTIX_VERSION < 70700
+        OPTIX_CHECK_LOG(optixModuleCreateFromPTXWithTasks(
+            static_cast<OptixDeviceContext>(ctx),
+            &m_options,
+            &pipeline_options,
+            source.c_str(),
+            source.size(),
+            log,
+            &sizeof_log,
+            &m_module,
+            &first_task
+        ));
+    #else
+        OPTIX_CHECK_LOG(optixModuleCreateWithTasks(
+            static_cast<OptixDeviceContext>(ctx),
+            &m_options,
+            &pipeline_options,
+            source.c_str(),
+            source.size(),
+            log,
+            &sizeof_log,
+            &m_module,
+            &first_task
+        ));
+    #endif
+        return first_task;
+    }
+
+    void Module::checkCompilationState() const
+    {
+        OptixModuleCompileState state;
+        OPTIX_CHECK(optixModuleGetCompilationState(m_module, &state));
+        switch (state)
+        {
+        case OPTIX_MODULE_COMPILE_STATE_COMPLETED:
+            break;
+        case OPTIX_MODULE_COMPILE_STATE_IMPERFECT:
+            pgLogWarn("Module has been compiled with errors. Some of tasks failed.");
+            break;
+        case OPTIX_MODULE_COMPILE_STATE_FAILED:
+            THROW("Failed to compile the module.");
+        default:
+            THROW("The compilation of the module hasn't been finished yet.");
+        }
+    }
+#endif
+
     void Module::destroy()
     {
         OPTIX_CHECK(optixModuleDestroy(m_module));
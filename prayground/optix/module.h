@@ -28,6 +28,26 @@ public:
     void createFromPtxSource(const Context& ctx, const std::string& source, OptixPipelineCompileOptions pipeline_options);
     void createFromOptixIr(const Context& ctx, const std::filesystem::path& filename, OptixPipelineCompileOptions pipeline_options);
 
+    /**
+     * @brief
+     * Compile the CUDA file with NVRTC (or load the prebuilt PTX/OptiX-IR) without creating OptixModule.
+     * This is thread-safe, so several files can be compiled at once.
+     */
+    std::string compileCudaFile(const std::filesystem::path& filename, const OptixPipelineCompileOptions& pipeline_options) const;
+
+#if OPTIX_VERSION >= 70400
+    /**
+     * @brief
+     * Start task-based creation of the module and return the first task.
+     * The module can't be used until all tasks spawned from it are executed with optixTaskExecute().
+     * \c source and \c pipeline_options must stay alive until then.
+     */
+    OptixTask createFromPtxSourceWithTasks(const Context& ctx, const std::string& source, const OptixPipelineCompileOptions& pipeline_options);
+
+    /** @brief Throw if the task-based compilation failed. Must be called after all tasks finished. */
+    void checkCompilationState() const;
+#endif
+
     void destroy();
 
     /** @note At default, This is set to OPTIX_COMPILE_OPTIMIZATION_DEFAULT */
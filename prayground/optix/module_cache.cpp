@@ -0,0 +1,417 @@
+#include "module_cache.h"
+#include <prayground/core/util.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <thread>
+
+#if defined(_WIN32) | defined(_WIN64)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+namespace prayground {
+
+    namespace fs = std::filesystem;
+
+    namespace {
+        // Bump this when the layout of the keys or the entries changes
+        constexpr uint32_t kModuleCacheVersion = 1;
+
+        inline uint64_t fmix64(uint64_t k)
+        {
+            k ^= k >> 33;
+            k *= 0xff51afd7ed558ccdull;
+            k ^= k >> 33;
+            k *= 0xc4ceb9fe1a85ec53ull;
+            k ^= k >> 33;
+            return k;
+        }
+
+        bool readFile(std::string& out, const fs::path& filepath)
+        {
+            std::ifstream file(filepath, std::ios::binary);
+            if (!file.good())
+                return false;
+            out.assign(std::istreambuf_iterator<char>(file), {});
+            return true;
+        }
+
+        uint64_t processId()
+        {
+#if defined(_WIN32) | defined(_WIN64)
+            return static_cast<uint64_t>(GetCurrentProcessId());
+#else
+            return static_cast<uint64_t>(getpid());
+#endif
+        }
+
+        std::optional<fs::path> resolveInclude(const std::string& name, const fs::path& current_dir, const std::vector<fs::path>& include_dirs)
+        {
+            std::error_code ec;
+            auto tryPath = [&](const fs::path& dir) -> std::optional<fs::path>
+            {
+                const fs::path candidate = dir / name;
+                if (fs::is_regular_file(candidate, ec))
+                {
+                    fs::path canonical = fs::canonical(candidate, ec);
+                    return ec ? candidate : canonical;
+                }
+                return std::nullopt;
+            };
+
+            if (!current_dir.empty())
+            {
+                if (auto path = tryPath(current_dir))
+                    return path;
+            }
+            for (const auto& dir : include_dirs)
+            {
+                if (auto path = tryPath(dir))
+                    return path;
+            }
+            return std::nullopt;
+        }
+    } // nonamed namespace
+
+    // ------------------------------------------------------------------
+    ModuleHasher::ModuleHasher()
+        : m_lo(kFnv1aOffsetBasis), m_hi(0x9e3779b97f4a7c15ull ^ kModuleCacheVersion)
+    {
+
+    }
+
+    ModuleHasher& ModuleHasher::update(const void* data, size_t size)
+    {
+        // FNV-1a for the lower half, and an independent multiply-xorshift for the upper half
+        m_lo = fnv1a(std::string_view(static_cast<const char*>(data), size), m_lo);
+
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        uint64_t hi = m_hi;
+        for (size_t i = 0; i < size; i++)
+        {
+            hi = (hi + bytes[i] + 1) * 0x9e3779b97f4a7c15ull;
+            hi ^= hi >> 29;
+        }
+        m_hi = hi;
+        return *this;
+    }
+
+    ModuleHasher& ModuleHasher::update(std::string_view str)
+    {
+        update(static_cast<uint64_t>(str.size()));
+        return update(str.data(), str.size());
+    }
+
+    std::string ModuleHasher::digest() const
+    {
+        const uint64_t hi = fmix64(m_hi ^ fmix64(m_lo));
+        const uint64_t lo = fmix64(m_lo);
+        char buf[33];
+        snprintf(buf, sizeof(buf), "%016llx%016llx", static_cast<unsigned long long>(hi), static_cast<unsigned long long>(lo));
+        return std::string(buf);
+    }
+
+    // ------------------------------------------------------------------
+    void hashCompileOptions(ModuleHasher& hasher, const OptixModuleCompileOptions& module_options, const OptixPipelineCompileOptions& pipeline_options)
+    {
+        hasher.update(static_cast<uint32_t>(OPTIX_VERSION));
+
+        hasher.update(module_options.maxRegisterCount);
+        hasher.update(module_options.optLevel);
+        hasher.update(module_options.debugLevel);
+        hasher.update(module_options.numBoundValues);
+        for (uint32_t i = 0; i < module_options.numBoundValues && module_options.boundValues; i++)
+        {
+            // Annotations are only labels for debugging, so they don't affect the compiled module
+            const OptixModuleCompileBoundValueEntry& entry = module_options.boundValues[i];
+            hasher.update(static_cast<uint64_t>(entry.pipelineParamOffsetInBytes));
+            hasher.update(static_cast<uint64_t>(entry.sizeInBytes));
+            if (entry.boundValuePtr)
+                hasher.update(entry.boundValuePtr, entry.sizeInBytes);
+        }
+#if OPTIX_VERSION >= 70400
+        hasher.update(module_options.numPayloadTypes);
+        for (uint32_t i = 0; i < module_options.numPayloadTypes && module_options.payloadTypes; i++)
+        {
+            const OptixPayloadType& payload_type = module_options.payloadTypes[i];
+            hasher.update(payload_type.numPayloadValues);
+            if (payload_type.payloadSemantics)
+                hasher.update(payload_type.payloadSemantics, sizeof(unsigned int) * payload_type.numPayloadValues);
+        }
+#endif
+
+        hasher.update(pipeline_options.usesMotionBlur);
+        hasher.update(pipeline_options.traversableGraphFlags);
+        hasher.update(pipeline_options.numPayloadValues);
+        hasher.update(pipeline_options.numAttributeValues);
+        hasher.update(pipeline_options.exceptionFlags);
+        hasher.update(std::string_view(pipeline_options.pipelineLaunchParamsVariableName ? pipeline_options.pipelineLaunchParamsVariableName : ""));
+        hasher.update(pipeline_options.usesPrimitiveTypeFlags);
+#if OPTIX_VERSION >= 70600
+        hasher.update(pipeline_options.allowOpacityMicromaps);
+#endif
+    }
+
+    // ------------------------------------------------------------------
+    std::vector<std::string> parseIncludeDirectives(std::string_view source)
+    {
+        std::vector<std::string> includes;
+        size_t pos = 0;
+        while (pos < source.size())
+        {
+            size_t line_end = source.find('\n', pos);
+            if (line_end == std::string_view::npos)
+                line_end = source.size();
+            std::string_view line = source.substr(pos, line_end - pos);
+            pos = line_end + 1;
+
+            auto skipSpaces = [&line]()
+            {
+                while (!line.empty() && (line.front() == ' ' || line.front() == '\t'))
+                    line.remove_prefix(1);
+            };
+
+            skipSpaces();
+            if (line.empty() || line.front() != '#')
+                continue;
+            line.remove_prefix(1);
+            skipSpaces();
+            if (!line.starts_with("include"))
+                continue;
+            line.remove_prefix(7);
+            skipSpaces();
+            if (line.empty())
+                continue;
+
+            const char close = line.front() == '"' ? '"' : line.front() == '<' ? '>' : '\0';
+            if (close == '\0')
+                continue;
+            const size_t name_end = line.find(close, 1);
+            if (name_end == std::string_view::npos || name_end == 1)
+                continue;
+            includes.emplace_back(line.substr(1, name_end - 1));
+        }
+        return includes;
+    }
+
+    std::vector<fs::path> scanIncludeClosure(std::string_view source, const fs::path& source_dir, const std::vector<fs::path>& include_dirs)
+    {
+        std::set<fs::path> visited;
+        std::vector<fs::path> stack;
+
+        auto push = [&](const std::vector<std::string>& names, const fs::path& current_dir)
+        {
+            for (const auto& name : names)
+            {
+                auto path = resolveInclude(name, current_dir, include_dirs);
+                if (path && visited.insert(path.value()).second)
+                    stack.push_back(path.value());
+            }
+        };
+
+        push(parseIncludeDirectives(source), source_dir);
+        std::string text;
+        while (!stack.empty())
+        {
+            const fs::path header = stack.back();
+            stack.pop_back();
+            if (!readFile(text, header))
+                continue;
+            push(parseIncludeDirectives(text), header.parent_path());
+        }
+
+        return std::vector<fs::path>(visited.begin(), visited.end());
+    }
+
+    void hashFiles(ModuleHasher& hasher, const std::vector<fs::path>& files)
+    {
+        std::string text;
+        for (const auto& file : files)
+        {
+            hasher.update(std::string_view(file.generic_string()));
+            if (readFile(text, file))
+                hasher.update(std::string_view(text));
+            else
+                hasher.update(static_cast<uint64_t>(-1));
+        }
+    }
+
+    // ------------------------------------------------------------------
+    ModuleCache::Lock::Lock(const fs::path& lock_path)
+    {
+#if defined(_WIN32) | defined(_WIN64)
+        HANDLE handle = CreateFileW(lock_path.wstring().c_str(), GENERIC_READ | GENERIC_WRITE,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+            return;
+        OVERLAPPED overlapped{};
+        if (!LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped))
+        {
+            CloseHandle(handle);
+            return;
+        }
+        m_handle = handle;
+#else
+        int fd = open(lock_path.c_str(), O_RDWR | O_CREAT, 0666);
+        if (fd < 0)
+            return;
+        int res;
+        do {
+            res = flock(fd, LOCK_EX);
+        } while (res != 0 && errno == EINTR);
+        if (res != 0)
+        {
+            close(fd);
+            return;
+        }
+        m_fd = fd;
+#endif
+    }
+
+    ModuleCache::Lock::~Lock()
+    {
+        unlock();
+    }
+
+    ModuleCache::Lock::Lock(Lock&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    ModuleCache::Lock& ModuleCache::Lock::operator=(Lock&& other) noexcept
+    {
+        if (this != &other)
+        {
+            unlock();
+#if defined(_WIN32) | defined(_WIN64)
+            std::swap(m_handle, other.m_handle);
+#else
+            std::swap(m_fd, other.m_fd);
+#endif
+        }
+        return *this;
+    }
+
+    bool ModuleCache::Lock::locked() const
+    {
+#if defined(_WIN32) | defined(_WIN64)
+        return m_handle != nullptr;
+#else
+        return m_fd >= 0;
+#endif
+    }
+
+    void ModuleCache::Lock::unlock()
+    {
+#if defined(_WIN32) | defined(_WIN64)
+        if (m_handle)
+        {
+            OVERLAPPED overlapped{};
+            UnlockFileEx(m_handle, 0, MAXDWORD, MAXDWORD, &overlapped);
+            CloseHandle(m_handle);
+            m_handle = nullptr;
+        }
+#else
+        if (m_fd >= 0)
+        {
+            flock(m_fd, LOCK_UN);
+            close(m_fd);
+            m_fd = -1;
+        }
+#endif
+    }
+
+    // ------------------------------------------------------------------
+    ModuleCache::ModuleCache(const fs::path& directory)
+        : m_directory(directory)
+    {
+
+    }
+
+    std::optional<fs::path> ModuleCache::defaultDirectory()
+    {
+        if (getenv("PRAYGROUND_DISABLE_MODULE_CACHE"))
+            return std::nullopt;
+        if (const char* dir = getenv("PRAYGROUND_MODULE_CACHE_DIR"))
+            return fs::path(dir);
+
+        std::error_code ec;
+        fs::path tmp = fs::temp_directory_path(ec);
+        if (ec)
+            return std::nullopt;
+        return tmp / "prayground_module_cache";
+    }
+
+    const fs::path& ModuleCache::directory() const
+    {
+        return m_directory;
+    }
+
+    fs::path ModuleCache::entryPath(const std::string& key, const std::string& extension) const
+    {
+        return m_directory / (key + extension);
+    }
+
+    std::optional<std::string> ModuleCache::load(const std::string& key, const std::string& extension) const
+    {
+        std::string data;
+        if (!readFile(data, entryPath(key, extension)) || data.empty())
+            return std::nullopt;
+        return data;
+    }
+
+    bool ModuleCache::store(const std::string& key, const std::string& extension, const std::string& data) const
+    {
+        std::error_code ec;
+        fs::create_directories(m_directory, ec);
+        if (ec)
+        {
+            pgLogWarn("Failed to create the module cache directory '" + m_directory.string() + "':", ec.message());
+            return false;
+        }
+
+        // Unique name per writer, so that concurrent writers never share a temporary file
+        const fs::path entry = entryPath(key, extension);
+        const size_t thread_id = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        fs::path tmp = entry;
+        tmp += ".tmp." + std::to_string(processId()) + "." + std::to_string(thread_id);
+
+        {
+            std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            file.close();
+            if (!file)
+            {
+                pgLogWarn("Failed to write the module cache entry '" + tmp.string() + "'");
+                fs::remove(tmp, ec);
+                return false;
+            }
+        }
+
+        // Readers see either the old entry or the complete new one
+        fs::rename(tmp, entry, ec);
+        if (ec)
+        {
+            pgLogWarn("Failed to rename the module cache entry '" + entry.string() + "':", ec.message());
+            fs::remove(tmp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    ModuleCache::Lock ModuleCache::lock(const std::string& key) const
+    {
+        std::error_code ec;
+        fs::create_directories(m_directory, ec);
+        return Lock(entryPath(key, ".lock"));
+    }
+
+} // namespace prayground
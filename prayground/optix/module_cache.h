@@ -0,0 +1,129 @@
+#pragma once
+
+#include <optix.h>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace prayground {
+
+    /**
+     * @brief
+     * Persistent on-disk cache of modules compiled at run-time.
+     *
+     * Module::createFromCudaFile() and Module::createFromCudaSource() look up this cache
+     * before invoking NVRTC. An entry is keyed by a hash of the CUDA source, all headers
+     * reachable from it, the NVRTC options and the OptiX module/pipeline compile options,
+     * so editing any of them simply results in a new entry.
+     *
+     * The cache may be shared by several processes at once (e.g. render nodes mounting
+     * the same directory). Entries are written to a temporary file and renamed into place,
+     * so readers never observe a partially written entry, and compilation of the same key
+     * is serialized through a lock file.
+     *
+     * Nothing in this file touches CUDA or OptiX at run-time.
+     *
+     * @note
+     * The directory is taken from the PRAYGROUND_MODULE_CACHE_DIR environment variable,
+     * or "prayground_module_cache" in the temporary directory of the system.
+     * Set PRAYGROUND_DISABLE_MODULE_CACHE to disable the cache.
+     */
+
+    /** @brief 128-bit non-cryptographic hash used as the key of cache entries. */
+    class ModuleHasher {
+    public:
+        ModuleHasher();
+
+        ModuleHasher& update(const void* data, size_t size);
+
+        // Strings are hashed with their length, so that "ab" + "c" differs from "a" + "bc"
+        ModuleHasher& update(std::string_view str);
+
+        template <class T>
+        requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+        ModuleHasher& update(const T& value)
+        {
+            return update(static_cast<const void*>(&value), sizeof(T));
+        }
+
+        // Hex string of 32 characters
+        std::string digest() const;
+    private:
+        uint64_t m_lo;
+        uint64_t m_hi;
+    };
+
+    // Hash compile options. Data referred by pointers in the options (bound values, payload types, launch params name) is hashed instead of the addresses.
+    void hashCompileOptions(ModuleHasher& hasher, const OptixModuleCompileOptions& module_options, const OptixPipelineCompileOptions& pipeline_options);
+
+    // Header names in #include directives of the source, in order of appearance
+    std::vector<std::string> parseIncludeDirectives(std::string_view source);
+
+    /**
+     * @brief Collect all headers reachable from the source through #include directives.
+     * @param source_dir Directory searched first for the includes of the source itself. Can be empty.
+     * @return Canonical paths of the headers, sorted.
+     * @note Preprocessor conditions are not evaluated, so the result may contain headers
+     *       that are not actually compiled. Headers not found in \c include_dirs
+     *       (e.g. headers NVRTC provides by itself) are skipped.
+     */
+    std::vector<std::filesystem::path> scanIncludeClosure(
+        std::string_view source,
+        const std::filesystem::path& source_dir,
+        const std::vector<std::filesystem::path>& include_dirs);
+
+    // Hash paths and contents of the headers
+    void hashFiles(ModuleHasher& hasher, const std::vector<std::filesystem::path>& files);
+
+    class ModuleCache {
+    public:
+        /** @brief Exclusive inter-process lock of a cache entry. Released on destruction. */
+        class Lock {
+        public:
+            Lock() = default;
+            explicit Lock(const std::filesystem::path& lock_path);
+            ~Lock();
+
+            Lock(const Lock&) = delete;
+            Lock& operator=(const Lock&) = delete;
+            Lock(Lock&& other) noexcept;
+            Lock& operator=(Lock&& other) noexcept;
+
+            bool locked() const;
+            void unlock();
+        private:
+#if defined(_WIN32) | defined(_WIN64)
+            void* m_handle{ nullptr };
+#else
+            int m_fd{ -1 };
+#endif
+        };
+
+        explicit ModuleCache(const std::filesystem::path& directory);
+
+        // Return nullopt when the cache is disabled through the environment variable
+        static std::optional<std::filesystem::path> defaultDirectory();
+
+        const std::filesystem::path& directory() const;
+        std::filesystem::path entryPath(const std::string& key, const std::string& extension) const;
+
+        std::optional<std::string> load(const std::string& key, const std::string& extension) const;
+
+        /**
+         * @brief Write an entry atomically.
+         * @return false if the entry couldn't be written. The cache is only an optimization,
+         *         so the failure is reported as a warning rather than an exception.
+         */
+        bool store(const std::string& key, const std::string& extension, const std::string& data) const;
+
+        // Block until no other process (or thread) holds the lock of the key
+        [[nodiscard]] Lock lock(const std::string& key) const;
+    private:
+        std::filesystem::path m_directory;
+    };
+
+} // namespace prayground
@@ -3,9 +3,66 @@
 #include <optix_stubs.h>
 #include <optix_function_table_definition.h>
 #include <optix_stack_size.h>
+#include <prayground/core/parallel.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 
 namespace prayground {
 
+    namespace {
+#if OPTIX_VERSION >= 70400
+        // Maximum number of tasks spawned by one optixTaskExecute() call
+        constexpr uint32_t kMaxAdditionalTasks = 64;
+
+        /**
+         * Execute OptiX tasks and all tasks spawned from them on worker threads.
+         * Returns after every task has finished. Failures are reported through the compilation
+         * state of each module, so they are not checked here.
+         */
+        void executeOptixTasks(const std::vector<OptixTask>& initial_tasks)
+        {
+            std::deque<OptixTask> queue(initial_tasks.begin(), initial_tasks.end());
+            std::mutex mutex;
+            std::condition_variable cv;
+            uint32_t num_running = 0;
+
+            auto worker = [&]()
+            {
+                OptixTask additional_tasks[kMaxAdditionalTasks];
+                std::unique_lock<std::mutex> lock(mutex);
+                while (true)
+                {
+                    // Wait for a new task, or exit when no task is queued and no one can spawn more
+                    cv.wait(lock, [&]() { return !queue.empty() || num_running == 0; });
+                    if (queue.empty())
+                        return;
+
+                    OptixTask task = queue.front();
+                    queue.pop_front();
+                    num_running++;
+                    lock.unlock();
+
+                    unsigned int num_created = 0;
+                    optixTaskExecute(task, additional_tasks, kMaxAdditionalTasks, &num_created);
+
+                    lock.lock();
+                    num_running--;
+                    queue.insert(queue.end(), additional_tasks, additional_tasks + num_created);
+                    cv.notify_all();
+                }
+            };
+
+            std::vector<std::thread> workers;
+            for (uint32_t i = 1; i < numHostThreads(); i++)
+                workers.emplace_back(worker);
+            worker();
+            for (auto& w : workers)
+                w.join();
+        }
+#endif
+    } // nonamed namespace
+
     // --------------------------------------------------------------------
     Pipeline::Pipeline()
     {
@@ -116,6 +173,37 @@ namespace prayground {
         return m_modules.back();
     }
 
+    std::vector<Module> Pipeline::createModulesFromCudaFiles(const Context& ctx, const std::vector<std::filesystem::path>& filenames)
+    {
+        std::vector<Module> modules(filenames.size());
+
+        // NVRTC is thread-safe as long as each thread compiles its own program
+        std::vector<std::string> inputs(filenames.size());
+        parallelFor(0, filenames.size(), [&](size_t i)
+        {
+            inputs[i] = modules[i].compileCudaFile(filenames[i], m_compile_options);
+        }, 1);
+
+#if OPTIX_VERSION >= 70400
+        std::vector<OptixTask> tasks;
+        for (size_t i = 0; i < modules.size(); i++)
+        {
+            OptixTask task = modules[i].createFromPtxSourceWithTasks(ctx, inputs[i], m_compile_options);
+            if (task)
+                tasks.push_back(task);
+        }
+        executeOptixTasks(tasks);
+        for (const auto& module : modules)
+            module.checkCompilationState();
+#else
+        for (size_t i = 0; i < modules.size(); i++)
+            modules[i].createFromPtxSource(ctx, inputs[i], m_compile_options);
+#endif
+
+        m_modules.insert(m_modules.end(), modules.begin(), modules.end());
+        return modules;
+    }
+
     // --------------------------------------------------------------------
     [[nodiscard]]
     ProgramGroup Pipeline::createRaygenProgram(const Context& ctx, const Module& module, const std::string& func_name)
@@ -33,6 +33,14 @@ public:
 
     [[nodiscard]] Module createModuleFromOptixIr(const Context& ctx, const std::filesystem::path& filename);
 
+    /**
+     * @brief Create modules from several CUDA files at once.
+     * NVRTC runs on worker threads for each file, and then creation of OptixModules is
+     * split into OptiX tasks shared by the worker threads. All modules are ready when this returns.
+     * @return Modules in the same order as \c filenames
+     */
+    [[nodiscard]] std::vector<Module> createModulesFromCudaFiles(const Context& ctx, const std::vector<std::filesystem::path>& filenames);
+
     [[nodiscard]] ProgramGroup createRaygenProgram(const Context& ctx, const Module& module, const std::string& func_name);
     [[nodiscard]] ProgramGroup createRaygenProgram(const Context& ctx, const ProgramEntry& entry);
     [[nodiscard]] ProgramGroup createMissProgram(const Context& ctx, const Module& module, const std::string& func_name);
@@ -8,6 +8,7 @@
 #include <concepts>
 #include <type_traits>
 #include <prayground/core/cudabuffer.h>
+#include <prayground/optix/sbt_diff.h>
 #endif // __CUDACC__
 
 namespace prayground {
@@ -185,6 +186,36 @@ namespace prayground {
             m_sbt.hitgroupRecordStrideInBytes = static_cast<uint32_t>(sizeof(HitgroupRecord));
         }
 
+        /**
+         * @brief Upload the data part of hitgroup records only in the given ranges.
+         * @param data   Data for all hitgroup records. The host-side records are also updated with it.
+         * @param ranges Ranges of records to be uploaded, typically computed by diffRecords().
+         */
+        void updateHitgroupDataOnDevice(const std::vector<decltype(HitgroupRecord::data)>& data, const std::vector<IndexRange>& ranges)
+        {
+            using HitgroupData = decltype(HitgroupRecord::data);
+
+            if (!m_sbt.hitgroupRecordBase || data.size() != m_sbt.hitgroupRecordCount)
+            {
+                THROW("The number of hitgroup records on device doesn't match with the data. Rebuild the SBT with createOnDevice().");
+            }
+
+            for (const auto& range : ranges)
+            {
+                for (uint32_t i = range.offset; i < range.offset + range.count; i++)
+                    m_hitgroup_records[i].data = data[i];
+
+                /* Copy the data with the record-size pitch to keep the record headers on device untouched. */
+                const CUdeviceptr dst = m_sbt.hitgroupRecordBase + range.offset * sizeof(HitgroupRecord) + offsetof(HitgroupRecord, data);
+                CUDA_CHECK(cudaMemcpy2D(
+                    reinterpret_cast<void*>(dst), sizeof(HitgroupRecord),
+                    &data[range.offset], sizeof(HitgroupData),
+                    sizeof(HitgroupData), range.count,
+                    cudaMemcpyHostToDevice
+                ));
+            }
+        }
+
         uint32_t numHitgroupRecords() const 
         {
             return static_cast<uint32_t>(m_hitgroup_records.size());
@@ -361,7 +392,7 @@ namespace prayground {
         CUDABuffer<CallablesRecord>     d_callables_records;
         CUDABuffer<ExceptionRecord>     d_exception_record;
 
-        bool on_device;
+        bool on_device { false };
     };
 
     // Default declaration for easy usage
@@ -0,0 +1,41 @@
+#pragma once
+
+#ifndef __CUDACC__
+#include <prayground/core/index_range.h>
+#include <cstring>
+#include <vector>
+#include <type_traits>
+
+namespace prayground {
+
+    /**
+     * @brief
+     * Host-side diffing of shader binding table records.
+     *
+     * This layer only compares host arrays and never touches the device,
+     * so it can be used (and tested) without any CUDA context.
+     * The ranges returned from diffRecords() are uploaded to the device
+     * with ShaderBindingTable::updateHitgroupDataOnDevice().
+     */
+
+    /**
+     * @brief Compare two arrays of records byte-wise and return the changed ranges.
+     * Records that exist only in \c current (i.e. the array has grown) are always reported as changed.
+     * max_gap is the same as coalesceIndices().
+     */
+    template <class T>
+    requires std::is_trivially_copyable_v<T>
+    inline std::vector<IndexRange> diffRecords(const std::vector<T>& previous, const std::vector<T>& current, uint32_t max_gap = 0)
+    {
+        std::vector<uint32_t> changed;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(current.size()); i++)
+        {
+            if (i >= previous.size() || std::memcmp(&previous[i], &current[i], sizeof(T)) != 0)
+                changed.push_back(i);
+        }
+        return coalesceIndices(changed, max_gap);
+    }
+
+} // namespace prayground
+
+#endif // __CUDACC__
@@ -1,4 +1,5 @@
 #include "sph.h"
+#include <prayground/core/bounds.h>
 #include <prayground/physics/cuda/sph.cuh>
 
 namespace prayground {
@@ -114,12 +115,7 @@ namespace prayground {
     // ------------------------------------------------------------------
     AABB SPHParticles::bound() const
     {
-        AABB aabb;
-        for (uint32_t i = 0; i < m_num_particles; i++) {
-            auto p = m_particles.get()[i];
-            aabb = AABB::merge(aabb, AABB(p.position - p.radius, p.position + p.radius));
-        }
-        return aabb;
+        return boundSpheres(m_particles.get(), m_num_particles, &Data::position, &Data::radius);
     }
 
 } // namespace prayground
\ No newline at end of file
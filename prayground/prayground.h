@@ -15,10 +15,14 @@
 #include "core/file_util.h"
 #include "core/cudabuffer.h"
 #include "core/bitmap.h"
+#include "core/bounds.h"
+#include "core/animation.h"
 #include "core/cexpr_map.h"
+#include "core/index_range.h"
 #include "core/camera.h"
 #include "core/attribute.h"
 #include "core/scene.h"
+#include "core/spectrum_library.h"
 
 // optix utilities
 #include "optix/module.h"
@@ -47,6 +51,7 @@
 #include <optix.h>
 
 #include "core/spectrum.h"
+#include "core/spectrum_table.h"
 #include "core/aabb.h"
 #include "core/sampler.h"
 #include "core/bsdf.h"
@@ -94,6 +99,7 @@
 #include "texture/checker.h"
 #include "texture/bitmap.h"
 #include "texture/gradient.h"
+#include "texture/noise_bake.h"
 
 // Medium include 
 #include "medium/atmosphere.h"
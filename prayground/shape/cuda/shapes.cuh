@@ -6,6 +6,8 @@
 #include <prayground/shape/plane.h>
 #include <prayground/shape/sphere.h>
 #include <prayground/shape/trianglemesh.h>
+#include <prayground/shape/intersection.h>
+#include <prayground/math/compression.h>
 #include <prayground/core/ray.h>
 #include <prayground/core/interaction.h>
 #include <prayground/optix/sbt.h>
@@ -21,98 +23,6 @@ namespace prayground {
     // ----------------------------------------------------------------------------------------
     // Cylinder
     // ----------------------------------------------------------------------------------------
-    INLINE DEVICE Vec2f pgGetCylinderUV(
-        const Vec3f& p, const Cylinder::Data& cylinder, const bool hit_disk)
-    {
-        if (hit_disk)
-        {
-            const float r = sqrtf(p.x() * p.x() + p.z() * p.z()) / cylinder.radius;
-            const float theta = atan2(p.z(), p.x());
-            float u = 1.0f - (theta + math::pi / 2.0f) / math::pi;
-            return Vec2f(u, r);
-        }
-        else
-        {
-            float phi = atan2(p.z(), p.x());
-            if (phi < 0.0f) phi += math::two_pi;
-            const float u = phi / math::two_pi;
-            const float v = (p.y() + cylinder.height / 2.0f) / cylinder.height;
-            return Vec2f(u, v);
-        }
-    }
-
-    INLINE DEVICE bool pgIntersectionCylinder(
-        const Cylinder::Data* cylinder, const Ray& ray, Shading* shading, float* time
-    )
-    {
-        const float radius = cylinder->radius;
-        const float height = cylinder->height;
-
-        // Get discriminant with infinite cylinder along with Y axis
-        const float a = pow2(ray.d.x()) + pow2(ray.d.z());
-        const float half_b = ray.o.x() * ray.d.x() + ray.o.z() * ray.d.z();
-        const float c = dot(ray.o, ray.o) - ray.o.y() * ray.o.y() - radius * radius;
-        const float discriminant = half_b * half_b - a * c;
-
-        if (discriminant <= 0.0f)
-            return false;
-
-        const float sqrtd = sqrtf(discriminant);
-
-        const float side_tmin = (-half_b - sqrtd) / a;
-        const float side_tmax = (-half_b + sqrtd) / a;
-
-        if (side_tmin > ray.tmax || side_tmax < ray.tmin)
-            return false;
-
-        const float upper = height / 2.0f;
-        const float lower = -height / 2.0f;
-        const float y_tmin = fmin((lower - ray.o.y()) / ray.d.y(), (upper - ray.o.y()) / ray.d.y());
-        const float y_tmax = fmax((lower - ray.o.y()) / ray.d.y(), (upper - ray.o.y()) / ray.d.y());
-
-        float tmin = fmax(y_tmin, side_tmin);
-        float tmax = fmin(y_tmax, side_tmax);
-        if (tmin > tmax || (tmax < ray.tmin) || (tmin > ray.tmax))
-            return false;
-
-        bool hit_min = true;
-        float t = tmin;
-
-        // Check near intersection
-        if (t < ray.tmin || ray.tmax < t)
-        {
-            hit_min = false;
-            t = tmax;
-            // Check far intersection
-            if (t < ray.tmin || ray.tmax < t)
-                return false;
-        }
-
-        Vec3f p = ray.at(t);
-        bool hit_disk = hit_min ? y_tmin > side_tmin : y_tmax < side_tmax;
-        Vec3f n = hit_disk
-            ? normalize(p - Vec3f(p.x(), 0.0f, p.z()))   // Hit at disk
-            : normalize(p - Vec3f(0.0f, p.y(), 0.0f));   // Hit at side
-        Vec2f uv = pgGetCylinderUV(p, *cylinder, hit_disk);
-
-        shading->n = n;
-        shading->uv = uv;
-        *time = t;
-
-        if (hit_disk)
-        {
-            const float r_hit = sqrtf(p.x() * p.x() + p.z() * p.z());
-            shading->dpdu = Vec3f(-math::two_pi * p.y(), 0.0f, math::two_pi * p.z());
-            shading->dpdv = Vec3f(p.x(), 0.0f, p.z()) * radius / r_hit;
-        }
-        else
-        {
-            shading->dpdu = Vec3f(-math::two_pi * p.z(), 0.0f, math::two_pi * p.x());
-            shading->dpdv = Vec3f(0.0f, height, 0.0f);
-        }
-        return true;
-    }
-
     INLINE DEVICE void pgReportIntersectionCylinder(const Cylinder::Data* cylinder, const Ray& ray)
     {
         Shading shading;
@@ -131,110 +41,6 @@ namespace prayground {
     // ----------------------------------------------------------------------------------------
     // Box
     // ----------------------------------------------------------------------------------------
-    INLINE DEVICE Vec2f pgGetBoxUV(const Vec3f& p, const Box::Data& box, const int axis)
-    {
-        int u_axis = (axis + 1) % 3;
-        int v_axis = (axis + 2) % 3;
-
-        // Swap axis (u=Z, v=X) -> (u=X, v=Z) if axis == Y
-        if (axis == 1) swap(u_axis, v_axis);
-
-        Vec2f uv(
-            (p[u_axis] - box.min[u_axis]) / (box.max[u_axis] - box.min[u_axis]),
-            (p[v_axis] - box.min[v_axis]) / (box.max[v_axis] - box.min[v_axis])
-        );
-
-        return clamp(uv, 0.0f, 1.0f);
-    }
-
-    /* Return a hitting axis of box face, X=0, Y=1, Z=2 */
-    INLINE DEVICE bool pgIntersectionBox(
-        const Box::Data* box, const Ray& ray, Shading* shading, float* time
-    )
-    {
-        const Vec3f min = box->min;
-        const Vec3f max = box->max;
-
-        float tmin = ray.tmin, tmax = ray.tmax;
-        int min_axis = -1, max_axis = -1;
-
-        // Intersection test
-        for (int i = 0; i < 3; i++)
-        {
-            float t0, t1;
-            if (ray.d[i] == 0.0f)
-            {
-                t0 = fminf(min[i] - ray.o[i], max[i] - ray.o[i]);
-                t1 = fmaxf(min[i] - ray.o[i], max[i] - ray.o[i]);
-            }
-            else
-            {
-                t0 = fminf((min[i] - ray.o[i]) / ray.d[i], (max[i] - ray.o[i]) / ray.d[i]);
-                t1 = fmaxf((min[i] - ray.o[i]) / ray.d[i], (max[i] - ray.o[i]) / ray.d[i]);
-            }
-
-            // Update hitting axis 
-            min_axis = t0 > tmin ? i : min_axis;
-            max_axis = t1 < tmax ? i : max_axis;
-
-            // Update distance from the ray origin to an intersection surface
-            tmin = fmaxf(t0, tmin);
-            tmax = fminf(t1, tmax);
-
-            // No intersection
-            if (tmax < tmin)
-                return false;
-        }
-
-        Vec3f center = (min + max) / 2.0f;
-        int axis = min_axis;
-        float t = tmin;
-        // Check the near intersection
-        if ((t < ray.tmin || ray.tmax < t) || (axis < 0 || 2 < axis))
-        {
-            axis = max_axis;
-            t = tmax;
-            // Check the far intersection
-            if ((t < ray.tmin || ray.tmax < t) || (axis < 0 || 2 < axis))
-            {
-                return false;
-            }
-        }
-
-        Vec3f p = ray.at(t);
-        Vec3f center_axis = p;
-        center_axis[axis] = center[axis];
-        Vec3f n = normalize(p - center_axis);
-        Vec2f uv = pgGetBoxUV(p, *box, axis);
-
-        // Store the shading information
-        shading->n = n;
-        shading->uv = uv;
-
-        // x
-        if (axis == 0)
-        {
-            shading->dpdu = Vec3f(0.0f, 0.0f, 1.0f);
-            shading->dpdv = Vec3f(0.0f, 1.0f, 0.0f);
-        }
-        // y
-        else if (axis == 1)
-        {
-            shading->dpdu = Vec3f(1.0f, 0.0f, 0.0f);
-            shading->dpdv = Vec3f(0.0f, 0.0f, 1.0f);
-        }
-        // z
-        else if (axis == 2)
-        {
-            shading->dpdu = Vec3f(1.0f, 0.0f, 0.0f);
-            shading->dpdv = Vec3f(0.0f, 1.0f, 0.0f);
-        }
-
-        *time = t;
-
-        return true;
-    }
-
     INLINE DEVICE void pgReportIntersectionBox(const Box::Data* box, const Ray& ray)
     {
         Shading shading;
@@ -253,33 +59,6 @@ namespace prayground {
     // ----------------------------------------------------------------------------------------
     // Plane
     // ----------------------------------------------------------------------------------------
-    INLINE DEVICE Vec2f pgGetPlaneUV(const Vec2f p, const Plane::Data& plane)
-    {
-        const float u = (p.x() - plane.min.x()) / (plane.max.x() - plane.min.x());
-        const float v = (p.y() - plane.min.y()) / (plane.max.y() - plane.min.y());
-        return Vec2f(u, v);
-    }
-
-    INLINE DEVICE bool pgIntersectionPlane(const Plane::Data* plane, const Ray& ray, Shading* shading, float* time)
-    {
-        const float t = -ray.o.y() / ray.d.y();
-        const float x = ray.o.x() + t * ray.d.x();
-        const float z = ray.o.z() + t * ray.d.z();
-
-        if (plane->min.x() < x && x < plane->max.x() &&
-            plane->min.y() < z && z < plane->max.y() &&
-            ray.tmin < t && t < ray.tmax)
-        {
-            shading->uv = pgGetPlaneUV(Vec2f(x, z), *plane);
-            shading->n = Vec3f(0, 1, 0);
-            shading->dpdu = Vec3f(1, 0, 0);
-            shading->dpdv = Vec3f(0, 0, 1);
-            *time = t;
-            return true;
-        }
-        return false;
-    }
-
     INLINE DEVICE void pgReportIntersectionPlane(const Plane::Data* plane, const Ray& ray)
     {
         Shading shading;
@@ -298,52 +77,6 @@ namespace prayground {
     // ----------------------------------------------------------------------------------------
     // Sphere
     // ----------------------------------------------------------------------------------------
-    INLINE DEVICE Vec2f pgGetSphereUV(const Vec3f& p) {
-        float phi = atan2(p.z(), p.x());
-        if (phi < 0) phi += 2.0f * math::pi;
-        float theta = acos(p.y());
-        float u = phi / (2.0f * math::pi);
-        float v = theta * math::inv_pi;
-        return Vec2f(u, v);
-    }
-
-    INLINE DEVICE bool pgIntersectionSphere(
-        const Sphere::Data* sphere, const Ray& ray, Shading* shading, float* time)
-    {
-        const Vec3f oc = ray.o - sphere->center;
-        const float a = dot(ray.d, ray.d);
-        const float half_b = dot(oc, ray.d);
-        const float c = dot(oc, oc) - pow2(sphere->radius);
-        const float discriminant = half_b * half_b - a * c;
-
-        if (discriminant <= 0.0f)
-            return false;
-
-        const float sqrtd = sqrtf(discriminant);
-
-        float t = (-half_b - sqrtd) / a;
-        if (t < ray.tmin || ray.tmax < t)
-        {
-            t = (-half_b + sqrtd) / a;
-            if (t < ray.tmin || ray.tmax < t)
-                return false;
-        }
-
-        const Vec3f p = ray.at(t) - sphere->center;
-        shading->n = p / sphere->radius;
-        shading->uv = pgGetSphereUV(shading->n);
-
-        float phi = atan2(shading->n.z(), shading->n.x());
-        if (phi < 0) phi += math::two_pi;
-        const float theta = acosf(shading->n.y());
-        shading->dpdu = Vec3f(-math::two_pi * shading->n.z(), 0, math::two_pi * shading->n.x());
-        shading->dpdv = math::pi * Vec3f(shading->n.y() * cosf(phi), -sinf(theta), shading->n.y() * sinf(phi));
-
-        *time = t;
-
-        return true;
-    }
-
     INLINE DEVICE void pgReportIntersectionSphere(const Sphere::Data* sphere, const Ray& ray)
     {
         Shading shading = {};
@@ -363,6 +96,29 @@ namespace prayground {
     // Mesh
     // ----------------------------------------------------------------------------------------
 
+    // Tangents along texture coordinates, or an arbitrary frame when texture coordinates are degenerate
+    INLINE DEVICE void pgSetMeshTangents(Shading& shading, const Vec3f& p0, const Vec3f& p1, const Vec3f& p2, 
+        const Vec2f& texcoord0, const Vec2f& texcoord1, const Vec2f& texcoord2)
+    {
+        const Vec2f duv02 = texcoord0 - texcoord2, duv12 = texcoord1 - texcoord2;
+        const Vec3f dp02 = p0 - p2, dp12 = p1 - p2;
+        const float D = duv02.x() * duv12.y() - duv02.y() * duv12.x();
+        bool degenerateUV = abs(D) < 1e-8f;
+        if (!degenerateUV)
+        {
+            const float invD = 1.0f / D;
+            shading.dpdu = (duv12.y() * dp02 - duv02.y() * dp12) * invD;
+            shading.dpdv = (-duv12.x() * dp02 + duv02.x() * dp12) * invD;
+        }
+        if (degenerateUV || length(cross(shading.dpdu, shading.dpdv)) == 0.0f)
+        {
+            const Vec3f n = normalize(cross(p2 - p0, p1 - p0));
+            Onb onb(n);
+            shading.dpdu = onb.tangent;
+            shading.dpdv = onb.bitangent;
+        }
+    }
+
     /**
      * @brief Calculate shading frame on triangle 
      * @param mesh : Triangle mesh data
@@ -390,23 +146,44 @@ namespace prayground {
         const Vec3f n2 = mesh->normals[face.normal_id[2]];
         shading.n = barycentricInterop(n0, n1, n2, bc);
 
-        const Vec2f duv02 = texcoord0 - texcoord2, duv12 = texcoord1 - texcoord2;
-        const Vec3f dp02 = p0 - p2, dp12 = p1 - p2;
-        const float D = duv02.x() * duv12.y() - duv02.y() * duv12.x();
-        bool degenerateUV = abs(D) < 1e-8f;
-        if (!degenerateUV)
+        pgSetMeshTangents(shading, p0, p1, p2, texcoord0, texcoord1, texcoord2);
+
+        return shading;
+    }
+
+    // Shading frame on a triangle of TriangleMesh::Storage::Compact
+    INLINE DEVICE Shading pgGetMeshShading(const TriangleMesh::CompactData* mesh, const Vec2f& bc, const uint32_t primitive_index)
+    {
+        Shading shading = {};
+
+        const Vec3ui idx = mesh->indices[primitive_index];
+
+        const Vec3f p0 = mesh->vertices[idx[0]];
+        const Vec3f p1 = mesh->vertices[idx[1]];
+        const Vec3f p2 = mesh->vertices[idx[2]];
+
+        Vec2f texcoord0(0.0f), texcoord1(1.0f, 0.0f), texcoord2(0.0f, 1.0f);
+        if (mesh->texcoords)
         {
-            const float invD = 1.0f / D;
-            shading.dpdu = (duv12.y() * dp02 - duv02.y() * dp12) * invD;
-            shading.dpdv = (-duv12.x() * dp02 + duv02.x() * dp12) * invD;
+            texcoord0 = unpackHalf2(mesh->texcoords[idx[0]]);
+            texcoord1 = unpackHalf2(mesh->texcoords[idx[1]]);
+            texcoord2 = unpackHalf2(mesh->texcoords[idx[2]]);
         }
-        if (degenerateUV || length(cross(shading.dpdu, shading.dpdv)) == 0.0f)
+        shading.uv = barycentricInterop(texcoord0, texcoord1, texcoord2, bc);
+
+        if (mesh->normals)
         {
-            const Vec3f n = normalize(cross(p2 - p0, p1 - p0));
-            Onb onb(n);
-            shading.dpdu = onb.tangent;
-            shading.dpdv = onb.bitangent;
+            const Vec3f n0 = octDecode(mesh->normals[idx[0]]);
+            const Vec3f n1 = octDecode(mesh->normals[idx[1]]);
+            const Vec3f n2 = octDecode(mesh->normals[idx[2]]);
+            shading.n = barycentricInterop(n0, n1, n2, bc);
         }
+        else
+        {
+            shading.n = normalize(cross(p1 - p0, p2 - p0));
+        }
+
+        pgSetMeshTangents(shading, p0, p1, p2, texcoord0, texcoord1, texcoord2);
 
         return shading;
     }
@@ -1,7 +1,9 @@
 #include "curves.h"
+#include <prayground/core/bounds.h>
 #include <prayground/core/cudabuffer.h>
 #include <prayground/core/file_util.h>
 #include <prayground/math/util.h>
+#include <algorithm>
 
 namespace prayground {
 
@@ -86,7 +88,28 @@ namespace prayground {
 
     AABB Curves::bound() const
     {
-        return AABB{};
+        if (m_vertices.empty())
+            return AABB{};
+
+        // B-spline and linear segments lie in the convex hull of their control vertices
+        AABB aabb = boundPoints(m_vertices);
+#if OPTIX_VERSION >= 70400
+        // Catmull-Rom segments may overshoot the hull, but not the hull of their Bezier control points
+        if (m_curve_type == Curves::Type::CatmullRom)
+        {
+            for (const int32_t i : m_indices)
+            {
+                if (i < 0 || static_cast<size_t>(i) + 3 >= m_vertices.size())
+                    continue;
+                const Vec3f* p = &m_vertices[i];
+                aabb.expand(p[1] + (p[2] - p[0]) / 6.0f);
+                aabb.expand(p[2] - (p[3] - p[1]) / 6.0f);
+            }
+        }
+#endif
+        // Widths are radii of the curves
+        const float radius = m_widths.empty() ? 0.0f : *std::max_element(m_widths.begin(), m_widths.end());
+        return AABB(aabb.min() - Vec3f(radius), aabb.max() + Vec3f(radius));
     }
 
     Curves::Data Curves::getData()
@@ -0,0 +1,1126 @@
+#include "gltfmesh.h"
+#include <prayground/core/file_util.h>
+#include <prayground/core/parallel.h>
+#include <prayground/core/util.h>
+#include <prayground/ext/stb/stb_image.h>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace prayground {
+
+    namespace fs = std::filesystem;
+
+    namespace {
+        // -------------------------------------------------------------------------------
+        // Minimal JSON document for the glTF header
+        struct JsonValue {
+            enum class Type { Null, Bool, Number, String, Array, Object };
+
+            Type type{ Type::Null };
+            bool boolean{ false };
+            double number{ 0.0 };
+            std::string string;
+            // Elements of an array or values of an object
+            std::vector<JsonValue> values;
+            std::vector<std::string> keys;
+
+            // Null value is returned when the member doesn't exist
+            const JsonValue& operator[](const std::string& key) const;
+            const JsonValue& operator[](size_t i) const;
+
+            bool isNull() const { return type == Type::Null; }
+            size_t size() const { return type == Type::Array ? values.size() : 0; }
+
+            int asInt(int d) const { return type == Type::Number ? static_cast<int>(number) : d; }
+            size_t asSize(size_t d) const { return type == Type::Number && number >= 0.0 ? static_cast<size_t>(number) : d; }
+            float asFloat(float d) const { return type == Type::Number ? static_cast<float>(number) : d; }
+        };
+
+        const JsonValue null_json;
+
+        const JsonValue& JsonValue::operator[](const std::string& key) const
+        {
+            if (type != Type::Object)
+                return null_json;
+            for (size_t i = 0; i < keys.size(); i++)
+            {
+                if (keys[i] == key)
+                    return values[i];
+            }
+            return null_json;
+        }
+
+        const JsonValue& JsonValue::operator[](size_t i) const
+        {
+            return type == Type::Array && i < values.size() ? values[i] : null_json;
+        }
+
+        class JsonParser {
+        public:
+            JsonParser(const char* begin, const char* end) : m_begin(begin), m_cur(begin), m_end(end) {}
+
+            JsonValue parse()
+            {
+                JsonValue value = parseValue(0);
+                skipSpaces();
+                if (m_cur != m_end)
+                    error("unexpected characters after the document");
+                return value;
+            }
+
+        private:
+            [[noreturn]] void error(const std::string& msg) const
+            {
+                THROW("glTF: Invalid JSON (" + msg + ") at offset " + std::to_string(m_cur - m_begin));
+            }
+
+            void skipSpaces()
+            {
+                while (m_cur != m_end && (*m_cur == ' ' || *m_cur == '\t' || *m_cur == '\n' || *m_cur == '\r'))
+                    m_cur++;
+            }
+
+            void expect(char c)
+            {
+                skipSpaces();
+                if (m_cur == m_end || *m_cur != c)
+                    error(std::string("'") + c + "' is expected");
+                m_cur++;
+            }
+
+            bool consume(char c)
+            {
+                skipSpaces();
+                if (m_cur != m_end && *m_cur == c)
+                {
+                    m_cur++;
+                    return true;
+                }
+                return false;
+            }
+
+            JsonValue parseValue(int depth)
+            {
+                if (depth > 256)
+                    error("too deep nesting");
+
+                skipSpaces();
+                if (m_cur == m_end)
+                    error("unexpected end of the document");
+
+                JsonValue value;
+                switch (*m_cur)
+                {
+                case '{':
+                    m_cur++;
+                    value.type = JsonValue::Type::Object;
+                    if (consume('}'))
+                        return value;
+                    do {
+                        skipSpaces();
+                        value.keys.emplace_back(parseString());
+                        expect(':');
+                        value.values.emplace_back(parseValue(depth + 1));
+                    } while (consume(','));
+                    expect('}');
+                    return value;
+                case '[':
+                    m_cur++;
+                    value.type = JsonValue::Type::Array;
+                    if (consume(']'))
+                        return value;
+                    do {
+                        value.values.emplace_back(parseValue(depth + 1));
+                    } while (consume(','));
+                    expect(']');
+                    return value;
+                case '"':
+                    value.type = JsonValue::Type::String;
+                    value.string = parseString();
+                    return value;
+                case 't':
+                    parseLiteral("true");
+                    value.type = JsonValue::Type::Bool;
+                    value.boolean = true;
+                    return value;
+                case 'f':
+                    parseLiteral("false");
+                    value.type = JsonValue::Type::Bool;
+                    return value;
+                case 'n':
+                    parseLiteral("null");
+                    return value;
+                default:
+                {
+                    // from_chars() doesn't depend on the locale unlike strtod()
+                    const auto [ptr, ec] = std::from_chars(m_cur, m_end, value.number);
+                    if (ec != std::errc() || ptr == m_cur)
+                        error("invalid value");
+                    m_cur = ptr;
+                    value.type = JsonValue::Type::Number;
+                    return value;
+                }
+                }
+            }
+
+            void parseLiteral(const char* literal)
+            {
+                const size_t n = strlen(literal);
+                if (static_cast<size_t>(m_end - m_cur) < n || strncmp(m_cur, literal, n) != 0)
+                    error("invalid literal");
+                m_cur += n;
+            }
+
+            uint32_t parseHex4()
+            {
+                if (m_end - m_cur < 4)
+                    error("invalid unicode escape");
+                uint32_t code = 0;
+                for (int i = 0; i < 4; i++, m_cur++)
+                {
+                    const char c = *m_cur;
+                    code <<= 4;
+                    if ('0' <= c && c <= '9')      code |= c - '0';
+                    else if ('a' <= c && c <= 'f') code |= c - 'a' + 10;
+                    else if ('A' <= c && c <= 'F') code |= c - 'A' + 10;
+                    else error("invalid unicode escape");
+                }
+                return code;
+            }
+
+            std::string parseString()
+            {
+                if (m_cur == m_end || *m_cur != '"')
+                    error("string is expected");
+                m_cur++;
+
+                std::string str;
+                while (true)
+                {
+                    if (m_cur == m_end)
+                        error("unterminated string");
+                    const char c = *m_cur++;
+                    if (c == '"')
+                        return str;
+                    if (c != '\\')
+                    {
+                        str += c;
+                        continue;
+                    }
+
+                    if (m_cur == m_end)
+                        error("unterminated string");
+                    switch (*m_cur++)
+                    {
+                    case '"':  str += '"'; break;
+                    case '\\': str += '\\'; break;
+                    case '/':  str += '/'; break;
+                    case 'b':  str += '\b'; break;
+                    case 'f':  str += '\f'; break;
+                    case 'n':  str += '\n'; break;
+                    case 'r':  str += '\r'; break;
+                    case 't':  str += '\t'; break;
+                    case 'u':
+                    {
+                        uint32_t code = parseHex4();
+                        // Surrogate pair
+                        if (0xd800 <= code && code < 0xdc00 && m_end - m_cur >= 6 && m_cur[0] == '\\' && m_cur[1] == 'u')
+                        {
+                            m_cur += 2;
+                            const uint32_t low = parseHex4();
+                            if (low < 0xdc00 || 0xe000 <= low)
+                                error("invalid surrogate pair");
+                            code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                        }
+                        appendUtf8(str, code);
+                        break;
+                    }
+                    default:
+                        error("invalid escape sequence");
+                    }
+                }
+            }
+
+            static void appendUtf8(std::string& str, uint32_t code)
+            {
+                if (code < 0x80)
+                {
+                    str += static_cast<char>(code);
+                }
+                else if (code < 0x800)
+                {
+                    str += static_cast<char>(0xc0 | (code >> 6));
+                    str += static_cast<char>(0x80 | (code & 0x3f));
+                }
+                else if (code < 0x10000)
+                {
+                    str += static_cast<char>(0xe0 | (code >> 12));
+                    str += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+                    str += static_cast<char>(0x80 | (code & 0x3f));
+                }
+                else
+                {
+                    str += static_cast<char>(0xf0 | (code >> 18));
+                    str += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+                    str += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+                    str += static_cast<char>(0x80 | (code & 0x3f));
+                }
+            }
+
+            const char* m_begin;
+            const char* m_cur;
+            const char* m_end;
+        };
+
+        // -------------------------------------------------------------------------------
+        // URIs
+        bool isDataUri(const std::string& uri)
+        {
+            return uri.compare(0, 5, "data:") == 0;
+        }
+
+        std::vector<uint8_t> decodeDataUri(const std::string& uri)
+        {
+            const size_t comma = uri.find(',');
+            if (comma == std::string::npos || uri.rfind(";base64", comma) == std::string::npos)
+                THROW("glTF: Only base64 data URIs are supported.");
+
+            auto sextet = [](char c) -> int {
+                if ('A' <= c && c <= 'Z') return c - 'A';
+                if ('a' <= c && c <= 'z') return c - 'a' + 26;
+                if ('0' <= c && c <= '9') return c - '0' + 52;
+                if (c == '+' || c == '-') return 62;
+                if (c == '/' || c == '_') return 63;
+                return -1;
+            };
+
+            std::vector<uint8_t> bytes;
+            bytes.reserve((uri.size() - comma) / 4 * 3);
+            uint32_t bits = 0;
+            int num_bits = 0;
+            for (size_t i = comma + 1; i < uri.size() && uri[i] != '='; i++)
+            {
+                const int s = sextet(uri[i]);
+                if (s < 0)
+                    continue;
+                bits = (bits << 6) | static_cast<uint32_t>(s);
+                num_bits += 6;
+                if (num_bits >= 8)
+                {
+                    num_bits -= 8;
+                    bytes.push_back(static_cast<uint8_t>(bits >> num_bits));
+                }
+            }
+            return bytes;
+        }
+
+        // Relative URI of an external file to a path
+        fs::path uriToPath(const fs::path& base_dir, const std::string& uri)
+        {
+            auto hex = [](char c) -> int {
+                if ('0' <= c && c <= '9') return c - '0';
+                if ('a' <= c && c <= 'f') return c - 'a' + 10;
+                if ('A' <= c && c <= 'F') return c - 'A' + 10;
+                return -1;
+            };
+
+            std::u8string decoded;
+            for (size_t i = 0; i < uri.size(); i++)
+            {
+                if (uri[i] == '%' && i + 2 < uri.size() && hex(uri[i + 1]) >= 0 && hex(uri[i + 2]) >= 0)
+                {
+                    decoded += static_cast<char8_t>(hex(uri[i + 1]) * 16 + hex(uri[i + 2]));
+                    i += 2;
+                }
+                else
+                {
+                    decoded += static_cast<char8_t>(uri[i]);
+                }
+            }
+            return base_dir / fs::path(decoded);
+        }
+
+        // -------------------------------------------------------------------------------
+        constexpr uint32_t glb_magic = 0x46546c67;      // "glTF"
+        constexpr uint32_t glb_chunk_json = 0x4e4f534a; // "JSON"
+        constexpr uint32_t glb_chunk_bin = 0x004e4942;  // "BIN"
+
+        uint32_t readU32(const uint8_t* p)
+        {
+            // GLB is little endian
+            return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+
+        enum ComponentType {
+            BYTE = 5120,
+            UNSIGNED_BYTE = 5121,
+            SHORT = 5122,
+            UNSIGNED_SHORT = 5123,
+            UNSIGNED_INT = 5125,
+            FLOAT = 5126
+        };
+
+        size_t componentSize(int component_type)
+        {
+            switch (component_type)
+            {
+            case BYTE:
+            case UNSIGNED_BYTE:  return 1;
+            case SHORT:
+            case UNSIGNED_SHORT: return 2;
+            case UNSIGNED_INT:
+            case FLOAT:          return 4;
+            default:
+                THROW("glTF: Invalid component type " + std::to_string(component_type));
+            }
+        }
+
+        int numComponents(const std::string& type)
+        {
+            if (type == "SCALAR") return 1;
+            if (type == "VEC2")   return 2;
+            if (type == "VEC3")   return 3;
+            if (type == "VEC4")   return 4;
+            if (type == "MAT2")   return 4;
+            if (type == "MAT3")   return 9;
+            if (type == "MAT4")   return 16;
+            THROW("glTF: Invalid accessor type '" + type + "'");
+        }
+
+        uint32_t readUint(const uint8_t* p, int component_type)
+        {
+            switch (component_type)
+            {
+            case UNSIGNED_BYTE: return *p;
+            case UNSIGNED_SHORT:
+            {
+                uint16_t v;
+                memcpy(&v, p, sizeof(v));
+                return v;
+            }
+            case UNSIGNED_INT:
+            {
+                uint32_t v;
+                memcpy(&v, p, sizeof(v));
+                return v;
+            }
+            default:
+                THROW("glTF: Indices must be unsigned integers");
+            }
+        }
+
+        float readFloat(const uint8_t* p, int component_type, bool normalized)
+        {
+            switch (component_type)
+            {
+            case FLOAT:
+            {
+                float v;
+                memcpy(&v, p, sizeof(v));
+                return v;
+            }
+            case BYTE:
+            {
+                const float v = static_cast<float>(static_cast<int8_t>(*p));
+                return normalized ? std::max(v / 127.0f, -1.0f) : v;
+            }
+            case UNSIGNED_BYTE:
+                return normalized ? *p / 255.0f : static_cast<float>(*p);
+            case SHORT:
+            {
+                int16_t v;
+                memcpy(&v, p, sizeof(v));
+                return normalized ? std::max(v / 32767.0f, -1.0f) : static_cast<float>(v);
+            }
+            case UNSIGNED_SHORT:
+            {
+                uint16_t v;
+                memcpy(&v, p, sizeof(v));
+                return normalized ? v / 65535.0f : static_cast<float>(v);
+            }
+            default:
+                return static_cast<float>(readUint(p, component_type));
+            }
+        }
+
+        // Column-major matrix of glTF to Matrix4f
+        Matrix4f toMatrix(const JsonValue& m)
+        {
+            Matrix4f mat;
+            for (int col = 0; col < 4; col++)
+                for (int row = 0; row < 4; row++)
+                    mat[row * 4 + col] = m[col * 4 + row].asFloat(row == col ? 1.0f : 0.0f);
+            return mat;
+        }
+
+        // T * R * S
+        Matrix4f toMatrix(const Vec3f& t, const Vec4f& q, const Vec3f& s)
+        {
+            const float x = q[0], y = q[1], z = q[2], w = q[3];
+            const float r[3][3] = {
+                { 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - z * w), 2.0f * (x * z + y * w) },
+                { 2.0f * (x * y + z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - x * w) },
+                { 2.0f * (x * z - y * w), 2.0f * (y * z + x * w), 1.0f - 2.0f * (x * x + y * y) }
+            };
+            Matrix4f mat = Matrix4f::identity();
+            for (int row = 0; row < 3; row++)
+            {
+                for (int col = 0; col < 3; col++)
+                    mat[row * 4 + col] = r[row][col] * s[col];
+                mat[row * 4 + 3] = t[row];
+            }
+            return mat;
+        }
+
+        Vec3f toVec3f(const JsonValue& v, const Vec3f& d)
+        {
+            return v.size() == 3 ? Vec3f(v[0].asFloat(d[0]), v[1].asFloat(d[1]), v[2].asFloat(d[2])) : d;
+        }
+
+        Vec4f toVec4f(const JsonValue& v, const Vec4f& d)
+        {
+            return v.size() == 4 ? Vec4f(v[0].asFloat(d[0]), v[1].asFloat(d[1]), v[2].asFloat(d[2]), v[3].asFloat(d[3])) : d;
+        }
+
+        // -------------------------------------------------------------------------------
+        struct Buffer {
+            // Backing storage: mapped .glb/.bin file or decoded data URI
+            MappedFile file;
+            std::vector<uint8_t> bytes;
+
+            const uint8_t* data{ nullptr };
+            size_t size{ 0 };
+        };
+
+        struct BufferView {
+            const uint8_t* data;
+            size_t size;
+            size_t stride;
+        };
+
+        // Buffers of a glTF mesh before they are moved to glTFMesh
+        struct MeshData {
+            std::string name;
+            std::vector<Vec3f> vertices;
+            std::vector<Face> faces;
+            std::vector<Vec3f> normals;
+            std::vector<Vec2f> texcoords;
+            std::vector<uint32_t> sbt_indices;
+            std::vector<int32_t> material_indices;
+        };
+
+        struct Accessor {
+            // nullptr when the accessor doesn't have bufferView and is initialized with zeros
+            const uint8_t* data;
+            size_t count;
+            size_t stride;
+            int component_type;
+            int num_components;
+            bool normalized;
+            const JsonValue* sparse;
+        };
+
+        class glTFLoader {
+        public:
+            glTFLoader(const fs::path& filename)
+            {
+                ASSERT(fs::exists(filename), "glTF: The file '" + filename.string() + "' is not found.");
+                m_base_dir = filename.parent_path();
+
+                MappedFile file(filename);
+                const uint8_t* bin = nullptr;
+                size_t bin_size = 0;
+                if (file.size() >= 12 && readU32(file.data()) == glb_magic)
+                {
+                    // GLB: 12 bytes header and chunks of (length, type, data)
+                    const size_t length = std::min<size_t>(readU32(file.data() + 8), file.size());
+                    const char* json_begin = nullptr;
+                    size_t json_size = 0;
+                    for (size_t offset = 12; offset + 8 <= length; )
+                    {
+                        const size_t chunk_size = readU32(file.data() + offset);
+                        const uint32_t chunk_type = readU32(file.data() + offset + 4);
+                        if (offset + 8 + chunk_size > length)
+                            THROW("glTF: The chunk of GLB exceeds the file size.");
+
+                        const uint8_t* chunk = file.data() + offset + 8;
+                        if (chunk_type == glb_chunk_json && !json_begin)
+                        {
+                            json_begin = reinterpret_cast<const char*>(chunk);
+                            json_size = chunk_size;
+                        }
+                        else if (chunk_type == glb_chunk_bin && !bin)
+                        {
+                            bin = chunk;
+                            bin_size = chunk_size;
+                        }
+                        offset += 8 + chunk_size;
+                    }
+                    if (!json_begin)
+                        THROW("glTF: GLB doesn't have the JSON chunk.");
+                    m_json = JsonParser(json_begin, json_begin + json_size).parse();
+                }
+                else
+                {
+                    const char* text = reinterpret_cast<const char*>(file.data());
+                    m_json = JsonParser(text, text + file.size()).parse();
+                }
+
+                const std::string version = m_json["asset"]["version"].string;
+                if (version.empty() || version[0] != '2')
+                    THROW("glTF: Unsupported version '" + version + "'. Only glTF 2.0 is supported.");
+
+                loadBuffers(bin, bin_size);
+                m_glb = std::move(file);
+            }
+
+            MeshData loadMesh(const JsonValue& json) const;
+            void loadMaterials(std::vector<Attributes>& materials) const;
+            void loadImages(std::vector<std::shared_ptr<Bitmap>>& images) const;
+            void loadInstances(std::vector<glTFAsset::MeshInstance>& instances) const;
+
+            const JsonValue& json() const { return m_json; }
+
+        private:
+            void loadBuffers(const uint8_t* bin, size_t bin_size);
+            BufferView bufferView(int index) const;
+            Accessor accessor(int index) const;
+
+            void readFloats(int index, int num_components, float* dst) const;
+            std::vector<uint32_t> readIndices(int index) const;
+            // Call func(element index, pointer to the value) for each sparse element
+            template <class Func>
+            void forEachSparse(const Accessor& acc, const Func& func) const;
+
+            void addNode(int index, const Matrix4f& parent, int depth, std::vector<glTFAsset::MeshInstance>& instances) const;
+
+            fs::path m_base_dir;
+            JsonValue m_json;
+            MappedFile m_glb;
+            std::vector<Buffer> m_buffers;
+        };
+
+        // -------------------------------------------------------------------------------
+        void glTFLoader::loadBuffers(const uint8_t* bin, size_t bin_size)
+        {
+            const JsonValue& buffers = m_json["buffers"];
+            m_buffers.resize(buffers.size());
+            for (size_t i = 0; i < buffers.size(); i++)
+            {
+                Buffer& buffer = m_buffers[i];
+                const std::string& uri = buffers[i]["uri"].string;
+                if (uri.empty())
+                {
+                    // The first buffer of GLB refers to the BIN chunk
+                    if (i != 0 || !bin)
+                        THROW("glTF: The buffer " + std::to_string(i) + " doesn't have URI.");
+                    buffer.data = bin;
+                    buffer.size = bin_size;
+                }
+                else if (isDataUri(uri))
+                {
+                    buffer.bytes = decodeDataUri(uri);
+                    buffer.data = buffer.bytes.data();
+                    buffer.size = buffer.bytes.size();
+                }
+                else
+                {
+                    const fs::path path = uriToPath(m_base_dir, uri);
+                    if (!buffer.file.open(path))
+                        THROW("glTF: Failed to open the buffer '" + path.string() + "'.");
+                    buffer.data = buffer.file.data();
+                    buffer.size = buffer.file.size();
+                }
+
+                const size_t byte_length = buffers[i]["byteLength"].asSize(0);
+                if (buffer.size < byte_length)
+                    THROW("glTF: The buffer " + std::to_string(i) + " is smaller than byteLength.");
+            }
+        }
+
+        BufferView glTFLoader::bufferView(int index) const
+        {
+            const JsonValue& view = m_json["bufferViews"][index];
+            const size_t buffer_id = view["buffer"].asSize(m_buffers.size());
+            if (view.isNull() || buffer_id >= m_buffers.size())
+                THROW("glTF: Invalid bufferView " + std::to_string(index));
+
+            const Buffer& buffer = m_buffers[buffer_id];
+            const size_t offset = view["byteOffset"].asSize(0);
+            const size_t length = view["byteLength"].asSize(0);
+            if (offset > buffer.size || length > buffer.size - offset)
+                THROW("glTF: The bufferView " + std::to_string(index) + " exceeds the buffer.");
+            return BufferView{ buffer.data + offset, length, view["byteStride"].asSize(0) };
+        }
+
+        Accessor glTFLoader::accessor(int index) const
+        {
+            const JsonValue& json = m_json["accessors"][index];
+            if (json.isNull())
+                THROW("glTF: Invalid accessor " + std::to_string(index));
+
+            Accessor acc;
+            acc.count = json["count"].asSize(0);
+            acc.component_type = json["componentType"].asInt(0);
+            acc.num_components = numComponents(json["type"].string);
+            acc.normalized = json["normalized"].boolean;
+            acc.sparse = json["sparse"].isNull() ? nullptr : &json["sparse"];
+            acc.data = nullptr;
+            const size_t element_size = componentSize(acc.component_type) * acc.num_components;
+            acc.stride = element_size;
+
+            const int view_id = json["bufferView"].asInt(-1);
+            if (view_id >= 0)
+            {
+                const BufferView view = bufferView(view_id);
+                if (view.stride > 0)
+                    acc.stride = view.stride;
+                const size_t offset = json["byteOffset"].asSize(0);
+                if (acc.count > 0 && (offset > view.size || (acc.count - 1) * acc.stride + element_size > view.size - offset))
+                    THROW("glTF: The accessor " + std::to_string(index) + " exceeds the bufferView.");
+                acc.data = view.data + offset;
+            }
+            return acc;
+        }
+
+        template <class Func>
+        void glTFLoader::forEachSparse(const Accessor& acc, const Func& func) const
+        {
+            const JsonValue& sparse = *acc.sparse;
+            const size_t count = sparse["count"].asSize(0);
+            const JsonValue& indices = sparse["indices"];
+            const JsonValue& values = sparse["values"];
+
+            const int index_type = indices["componentType"].asInt(0);
+            const size_t index_size = componentSize(index_type);
+            const size_t value_size = componentSize(acc.component_type) * acc.num_components;
+            const BufferView index_view = bufferView(indices["bufferView"].asInt(-1));
+            const BufferView value_view = bufferView(values["bufferView"].asInt(-1));
+            const size_t index_offset = indices["byteOffset"].asSize(0);
+            const size_t value_offset = values["byteOffset"].asSize(0);
+            if (index_offset + count * index_size > index_view.size || value_offset + count * value_size > value_view.size)
+                THROW("glTF: Sparse accessor exceeds the bufferView.");
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const uint32_t element = readUint(index_view.data + index_offset + i * index_size, index_type);
+                if (element >= acc.count)
+                    THROW("glTF: Index of sparse accessor is out of range.");
+                func(element, value_view.data + value_offset + i * value_size);
+            }
+        }
+
+        void glTFLoader::readFloats(int index, int num_components, float* dst) const
+        {
+            const Accessor acc = accessor(index);
+            if (acc.num_components != num_components)
+                THROW("glTF: The accessor " + std::to_string(index) + " has unexpected type.");
+
+            const size_t element_size = sizeof(float) * num_components;
+            const size_t component_size = componentSize(acc.component_type);
+            if (!acc.data)
+            {
+                std::fill(dst, dst + acc.count * num_components, 0.0f);
+            }
+            else if (acc.component_type == FLOAT && acc.stride == element_size)
+            {
+                // Tightly packed floats are copied from the mapped buffer as they are
+                memcpy(dst, acc.data, acc.count * element_size);
+            }
+            else
+            {
+                for (size_t i = 0; i < acc.count; i++)
+                {
+                    const uint8_t* src = acc.data + i * acc.stride;
+                    for (int c = 0; c < num_components; c++)
+                        dst[i * num_components + c] = readFloat(src + c * component_size, acc.component_type, acc.normalized);
+                }
+            }
+
+            if (acc.sparse)
+            {
+                forEachSparse(acc, [&](uint32_t element, const uint8_t* src) {
+                    for (int c = 0; c < num_components; c++)
+                        dst[element * num_components + c] = readFloat(src + c * component_size, acc.component_type, acc.normalized);
+                });
+            }
+        }
+
+        std::vector<uint32_t> glTFLoader::readIndices(int index) const
+        {
+            const Accessor acc = accessor(index);
+            if (acc.num_components != 1)
+                THROW("glTF: Indices must be scalars.");
+
+            std::vector<uint32_t> indices(acc.count, 0u);
+            if (acc.data)
+            {
+                if (acc.component_type == UNSIGNED_INT && acc.stride == sizeof(uint32_t))
+                {
+                    memcpy(indices.data(), acc.data, acc.count * sizeof(uint32_t));
+                }
+                else
+                {
+                    for (size_t i = 0; i < acc.count; i++)
+                        indices[i] = readUint(acc.data + i * acc.stride, acc.component_type);
+                }
+            }
+            if (acc.sparse)
+            {
+                forEachSparse(acc, [&](uint32_t element, const uint8_t* src) {
+                    indices[element] = readUint(src, acc.component_type);
+                });
+            }
+            return indices;
+        }
+
+        // -------------------------------------------------------------------------------
+        MeshData glTFLoader::loadMesh(const JsonValue& json) const
+        {
+            static_assert(sizeof(Vec3f) == sizeof(float) * 3 && sizeof(Vec2f) == sizeof(float) * 2);
+
+            MeshData mesh;
+            mesh.name = json["name"].string;
+
+            std::vector<uint32_t> sbt_indices;
+            for (const JsonValue& primitive : json["primitives"].values)
+            {
+                const int mode = primitive["mode"].asInt(4);
+                const JsonValue& attributes = primitive["attributes"];
+                const int position_id = attributes["POSITION"].asInt(-1);
+                if (mode < 4 || 6 < mode)
+                {
+                    pgLogWarn("glTF: Primitive mode", mode, "of the mesh '" + mesh.name + "' is not triangles, and it is skipped.");
+                    continue;
+                }
+                if (position_id < 0)
+                {
+                    pgLogWarn("glTF: Primitive of the mesh '" + mesh.name + "' doesn't have POSITION, and it is skipped.");
+                    continue;
+                }
+
+                // Vertex attributes are written to the mesh buffers directly
+                const int32_t vertex_base = static_cast<int32_t>(mesh.vertices.size());
+                const size_t num_vertices = accessor(position_id).count;
+                mesh.vertices.resize(vertex_base + num_vertices);
+                readFloats(position_id, 3, reinterpret_cast<float*>(mesh.vertices.data() + vertex_base));
+
+                const int normal_id = attributes["NORMAL"].asInt(-1);
+                const int32_t normal_base = static_cast<int32_t>(mesh.normals.size());
+                if (normal_id >= 0)
+                {
+                    if (accessor(normal_id).count != num_vertices)
+                        THROW("glTF: NORMAL and POSITION of the mesh '" + mesh.name + "' have different counts.");
+                    mesh.normals.resize(normal_base + num_vertices);
+                    readFloats(normal_id, 3, reinterpret_cast<float*>(mesh.normals.data() + normal_base));
+                }
+
+                // Texcoords are always required by the device data, so the primitive without them refers single (0, 0)
+                const int texcoord_id = attributes["TEXCOORD_0"].asInt(-1);
+                const int32_t texcoord_base = static_cast<int32_t>(mesh.texcoords.size());
+                if (texcoord_id >= 0)
+                {
+                    if (accessor(texcoord_id).count != num_vertices)
+                        THROW("glTF: TEXCOORD_0 and POSITION of the mesh '" + mesh.name + "' have different counts.");
+                    mesh.texcoords.resize(texcoord_base + num_vertices);
+                    readFloats(texcoord_id, 2, reinterpret_cast<float*>(mesh.texcoords.data() + texcoord_base));
+                }
+                else
+                {
+                    mesh.texcoords.emplace_back(0.0f, 0.0f);
+                }
+
+                std::vector<uint32_t> indices;
+                const int indices_id = primitive["indices"].asInt(-1);
+                if (indices_id >= 0)
+                {
+                    indices = readIndices(indices_id);
+                    for (uint32_t idx : indices)
+                    {
+                        if (idx >= num_vertices)
+                            THROW("glTF: Index of the mesh '" + mesh.name + "' is out of range.");
+                    }
+                }
+                else
+                {
+                    indices.resize(num_vertices);
+                    std::iota(indices.begin(), indices.end(), 0u);
+                }
+
+                // Material slot, which becomes the SBT index of faces
+                const int32_t material = primitive["material"].asInt(-1);
+                auto slot = std::find(mesh.material_indices.begin(), mesh.material_indices.end(), material);
+                if (slot == mesh.material_indices.end())
+                    slot = mesh.material_indices.insert(slot, material);
+                const uint32_t sbt_index = static_cast<uint32_t>(slot - mesh.material_indices.begin());
+
+                auto addTriangle = [&](uint32_t i0, uint32_t i1, uint32_t i2)
+                {
+                    const Vec3i local(static_cast<int32_t>(i0), static_cast<int32_t>(i1), static_cast<int32_t>(i2));
+                    Face face;
+                    face.vertex_id = local + Vec3i(vertex_base);
+                    face.texcoord_id = texcoord_id >= 0 ? local + Vec3i(texcoord_base) : Vec3i(texcoord_base);
+                    if (normal_id >= 0)
+                    {
+                        face.normal_id = local + Vec3i(normal_base);
+                    }
+                    else
+                    {
+                        // Flat normal of the counter-clockwise front face
+                        const Vec3f& v0 = mesh.vertices[face.vertex_id[0]];
+                        const Vec3f n = cross(mesh.vertices[face.vertex_id[1]] - v0, mesh.vertices[face.vertex_id[2]] - v0);
+                        const float len = length(n);
+                        face.normal_id = Vec3i(static_cast<int32_t>(mesh.normals.size()));
+                        mesh.normals.emplace_back(len > 0.0f ? n / len : Vec3f(0.0f, 0.0f, 1.0f));
+                    }
+                    mesh.faces.emplace_back(face);
+                    sbt_indices.emplace_back(sbt_index);
+                };
+
+                const size_t n = indices.size();
+                if (mode == 4)
+                {
+                    for (size_t i = 0; i + 2 < n; i += 3)
+                        addTriangle(indices[i], indices[i + 1], indices[i + 2]);
+                }
+                else if (mode == 5)
+                {
+                    for (size_t i = 0; i + 2 < n; i++)
+                    {
+                        if (i & 1)
+                            addTriangle(indices[i], indices[i + 2], indices[i + 1]);
+                        else
+                            addTriangle(indices[i], indices[i + 1], indices[i + 2]);
+                    }
+                }
+                else
+                {
+                    for (size_t i = 1; i + 1 < n; i++)
+                        addTriangle(indices[i], indices[i + 1], indices[0]);
+                }
+            }
+
+            // Per-face SBT indices are only required for multiple materials
+            if (mesh.material_indices.size() > 1)
+                mesh.sbt_indices = std::move(sbt_indices);
+            return mesh;
+        }
+
+        // -------------------------------------------------------------------------------
+        void glTFLoader::loadMaterials(std::vector<Attributes>& materials) const
+        {
+            const JsonValue& textures = m_json["textures"];
+            // Textures refer images, and several textures can share the same image
+            auto imageIndex = [&](const JsonValue& texture_info) -> int {
+                const int texture = texture_info["index"].asInt(-1);
+                return texture < 0 ? -1 : textures[texture]["source"].asInt(-1);
+            };
+
+            const JsonValue& json = m_json["materials"];
+            materials.resize(json.size());
+            for (size_t i = 0; i < json.size(); i++)
+            {
+                const JsonValue& material = json[i];
+                const JsonValue& pbr = material["pbrMetallicRoughness"];
+                Attributes& attribs = materials[i];
+                attribs.name = material["name"].string;
+
+                const Vec4f base_color = toVec4f(pbr["baseColorFactor"], Vec4f(1.0f));
+                attribs.addVec4f("base_color", base_color);
+                attribs.addFloat("metallic", pbr["metallicFactor"].asFloat(1.0f));
+                attribs.addFloat("roughness", pbr["roughnessFactor"].asFloat(1.0f));
+                const Vec3f emission = toVec3f(material["emissiveFactor"], Vec3f(0.0f));
+                attribs.addVec3f("emission", emission);
+
+                attribs.addInt("base_color_texture", imageIndex(pbr["baseColorTexture"]));
+                attribs.addInt("metallic_roughness_texture", imageIndex(pbr["metallicRoughnessTexture"]));
+                attribs.addInt("normal_texture", imageIndex(material["normalTexture"]));
+                attribs.addInt("emission_texture", imageIndex(material["emissiveTexture"]));
+            }
+        }
+
+        // -------------------------------------------------------------------------------
+        void glTFLoader::loadImages(std::vector<std::shared_ptr<Bitmap>>& images) const
+        {
+            struct Decoded {
+                int width{ 0 }, height{ 0 }, channels{ 0 };
+                stbi_uc* pixels{ nullptr };
+                std::string source;
+            };
+
+            const JsonValue& json = m_json["images"];
+            std::vector<Decoded> decoded(json.size());
+
+            // Decoding is independent for each image. Bitmaps are created on this thread
+            // since they may prepare OpenGL textures.
+            parallelFor(0, json.size(), [&](size_t i)
+            {
+                const JsonValue& image = json[i];
+                Decoded& result = decoded[i];
+                const std::string& uri = image["uri"].string;
+
+                const uint8_t* data = nullptr;
+                size_t size = 0;
+                MappedFile file;
+                std::vector<uint8_t> bytes;
+                if (const int view_id = image["bufferView"].asInt(-1); view_id >= 0)
+                {
+                    const BufferView view = bufferView(view_id);
+                    data = view.data;
+                    size = view.size;
+                    result.source = "bufferView " + std::to_string(view_id);
+                }
+                else if (isDataUri(uri))
+                {
+                    bytes = decodeDataUri(uri);
+                    data = bytes.data();
+                    size = bytes.size();
+                    result.source = "data URI";
+                }
+                else
+                {
+                    const fs::path path = uriToPath(m_base_dir, uri);
+                    result.source = path.string();
+                    if (!file.open(path))
+                        return;
+                    data = file.data();
+                    size = file.size();
+                }
+
+                if (data && 0 < size && size <= static_cast<size_t>(std::numeric_limits<int>::max()))
+                    result.pixels = stbi_load_from_memory(data, static_cast<int>(size), &result.width, &result.height, &result.channels, 0);
+            }, 1);
+
+            images.resize(json.size());
+            for (size_t i = 0; i < decoded.size(); i++)
+            {
+                Decoded& d = decoded[i];
+                if (!d.pixels)
+                {
+                    pgLogWarn("glTF: Failed to load the image " + std::to_string(i) + " from " + d.source);
+                    continue;
+                }
+                images[i] = std::make_shared<Bitmap>(static_cast<PixelFormat>(d.channels), d.width, d.height, d.pixels);
+                stbi_image_free(d.pixels);
+            }
+        }
+
+        // -------------------------------------------------------------------------------
+        void glTFLoader::addNode(int index, const Matrix4f& parent, int depth, std::vector<glTFAsset::MeshInstance>& instances) const
+        {
+            const JsonValue& node = m_json["nodes"][index];
+            if (node.isNull() || depth > 256)
+                THROW("glTF: Invalid node hierarchy at the node " + std::to_string(index));
+
+            Matrix4f local;
+            if (node["matrix"].size() == 16)
+            {
+                local = toMatrix(node["matrix"]);
+            }
+            else
+            {
+                local = toMatrix(
+                    toVec3f(node["translation"], Vec3f(0.0f)),
+                    toVec4f(node["rotation"], Vec4f(0.0f, 0.0f, 0.0f, 1.0f)),
+                    toVec3f(node["scale"], Vec3f(1.0f)));
+            }
+            const Matrix4f world = parent * local;
+
+            const int mesh = node["mesh"].asInt(-1);
+            if (mesh >= 0)
+            {
+                if (static_cast<size_t>(mesh) >= m_json["meshes"].size())
+                    THROW("glTF: The node " + std::to_string(index) + " refers invalid mesh.");
+                instances.push_back(glTFAsset::MeshInstance{ node["name"].string, static_cast<uint32_t>(mesh), world });
+            }
+
+            for (const JsonValue& child : node["children"].values)
+                addNode(child.asInt(-1), world, depth + 1, instances);
+        }
+
+        void glTFLoader::loadInstances(std::vector<glTFAsset::MeshInstance>& instances) const
+        {
+            const JsonValue& scenes = m_json["scenes"];
+            const JsonValue& scene = scenes[static_cast<size_t>(m_json["scene"].asInt(0))];
+            if (!scene.isNull())
+            {
+                for (const JsonValue& root : scene["nodes"].values)
+                    addNode(root.asInt(-1), Matrix4f::identity(), 0, instances);
+                return;
+            }
+
+            // Without scenes, every node that isn't a child of others is a root
+            const JsonValue& nodes = m_json["nodes"];
+            std::vector<bool> is_child(nodes.size(), false);
+            for (const JsonValue& node : nodes.values)
+            {
+                for (const JsonValue& child : node["children"].values)
+                {
+                    const int c = child.asInt(-1);
+                    if (0 <= c && static_cast<size_t>(c) < is_child.size())
+                        is_child[c] = true;
+                }
+            }
+            for (size_t i = 0; i < nodes.size(); i++)
+            {
+                if (!is_child[i])
+                    addNode(static_cast<int>(i), Matrix4f::identity(), 0, instances);
+            }
+        }
+    } // nonamed namespace
+
+    // -------------------------------------------------------------------------------
+    glTFAsset::glTFAsset(const fs::path& filename)
+    {
+        std::optional<fs::path> filepath = pgFindDataPath(filename);
+        ASSERT(filepath, "The glTF file '" + filename.string() + "' is not found.");
+
+        pgLog("Loading glTF file '" + filepath.value().string() + "' ...");
+
+        glTFLoader loader(filepath.value());
+        for (const JsonValue& json : loader.json()["meshes"].values)
+        {
+            MeshData data = loader.loadMesh(json);
+            auto mesh = std::make_shared<glTFMesh>();
+            mesh->setVertices(std::move(data.vertices));
+            mesh->setFaces(std::move(data.faces));
+            mesh->setNormals(std::move(data.normals));
+            mesh->setTexcoords(std::move(data.texcoords));
+            mesh->m_sbt_indices = std::move(data.sbt_indices);
+            mesh->m_name = std::move(data.name);
+            mesh->m_material_indices = std::move(data.material_indices);
+            m_meshes.emplace_back(std::move(mesh));
+        }
+        loader.loadInstances(m_instances);
+        loader.loadMaterials(m_materials);
+        loader.loadImages(m_images);
+    }
+
+    std::vector<ShapeInstance> glTFAsset::createShapeInstances() const
+    {
+        std::vector<ShapeInstance> instances;
+        instances.reserve(m_instances.size());
+        for (const MeshInstance& instance : m_instances)
+            instances.emplace_back(ShapeType::Mesh, m_meshes[instance.mesh], instance.transform);
+        return instances;
+    }
+
+    std::vector<Instance> glTFAsset::createInstances(const std::vector<OptixTraversableHandle>& gas_handles) const
+    {
+        ASSERT(gas_handles.size() == m_meshes.size(), "The number of GAS handles must be the same as meshes.");
+
+        std::vector<Instance> instances;
+        instances.reserve(m_instances.size());
+        for (const MeshInstance& instance : m_instances)
+        {
+            Instance& result = instances.emplace_back(instance.transform);
+            result.setTraversableHandle(gas_handles[instance.mesh]);
+        }
+        return instances;
+    }
+
+} // namespace prayground
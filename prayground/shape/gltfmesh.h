@@ -1,10 +1,89 @@
-#pragma once 
+#pragma once
+
+#ifndef __CUDACC__
+#include <prayground/core/attribute.h>
+#include <prayground/core/bitmap.h>
+#include <prayground/math/matrix.h>
+#include <prayground/optix/instance.h>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#endif
 
 #include <prayground/shape/trianglemesh.h>
 
 namespace prayground {
 
+    /**
+     * @brief Triangle mesh of a glTF 2.0 mesh loaded by glTFAsset.
+     * All primitives of the glTF mesh are merged, and faces of a primitive have the SBT index of
+     * its material in materialIndices().
+     */
     class glTFMesh : public TriangleMesh {
-        
+    public:
+        using Data = TriangleMesh::Data;
+
+#ifndef __CUDACC__
+        glTFMesh() = default;
+
+        const std::string& name() const { return m_name; }
+
+        // Index of glTFAsset::materials() for each SBT index of the mesh. -1 is the default material of glTF.
+        const std::vector<int32_t>& materialIndices() const { return m_material_indices; }
+
+    private:
+        friend class glTFAsset;
+
+        std::string m_name;
+        std::vector<int32_t> m_material_indices;
+#endif
     };
-}
\ No newline at end of file
+
+#ifndef __CUDACC__
+    /**
+     * @brief Meshes, node instances, materials and images of a glTF 2.0 file (.gltf or .glb).
+     *
+     * - Binary buffers (.glb BIN chunk and external .bin files) are memory mapped and accessors
+     *   are converted directly into the buffers of glTFMesh.
+     * - A mesh referenced by several nodes is loaded once, and each node becomes a MeshInstance
+     *   that shares it with a world transform.
+     * - Images are decoded in parallel, and an image used by several textures is loaded once.
+     *
+     * Attributes of materials():
+     * - "base_color" (Vec4f), "metallic" (float), "roughness" (float), "emission" (Vec3f)
+     * - "base_color_texture", "metallic_roughness_texture", "normal_texture", "emission_texture" (int):
+     *   Index of images(), or -1 if the material doesn't have the texture.
+     */
+    class glTFAsset {
+    public:
+        struct MeshInstance {
+            std::string name;
+            // Index of meshes()
+            uint32_t mesh;
+            Matrix4f transform;
+        };
+
+        explicit glTFAsset(const std::filesystem::path& filename);
+
+        const std::vector<std::shared_ptr<glTFMesh>>& meshes() const { return m_meshes; }
+        // Nodes that have a mesh in the default scene
+        const std::vector<MeshInstance>& instances() const { return m_instances; }
+        const std::vector<Attributes>& materials() const { return m_materials; }
+        // nullptr if the image failed to be loaded
+        const std::vector<std::shared_ptr<Bitmap>>& images() const { return m_images; }
+
+        // One instance for each of instances(). Instances of the same mesh share glTFMesh but build their own GAS.
+        std::vector<ShapeInstance> createShapeInstances() const;
+        // One instance for each of instances() referring the GAS of meshes()[i] with gas_handles[i]
+        std::vector<Instance> createInstances(const std::vector<OptixTraversableHandle>& gas_handles) const;
+
+    private:
+        std::vector<std::shared_ptr<glTFMesh>> m_meshes;
+        std::vector<MeshInstance> m_instances;
+        std::vector<Attributes> m_materials;
+        std::vector<std::shared_ptr<Bitmap>> m_images;
+    };
+#endif
+
+} // namespace prayground
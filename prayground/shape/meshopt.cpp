@@ -0,0 +1,1406 @@
+#include "meshopt.h"
+#include <prayground/core/parallel.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+namespace prayground {
+
+    namespace {
+        constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+        // Spatial hash of grid cells (Teschner et al. 2003). Different cells may share a bucket,
+        // which only costs extra distance tests.
+        uint32_t hashCell(int64_t x, int64_t y, int64_t z, uint32_t mask)
+        {
+            return (static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u ^ static_cast<uint32_t>(z) * 83492791u) & mask;
+        }
+
+        /**
+         * Indices grouped by hash buckets with a counting sort. Indices in a bucket are in ascending order,
+         * and bucket `num_buckets` collects indices to be excluded from searches.
+         */
+        struct HashBuckets {
+            uint32_t num_buckets;
+            std::vector<uint32_t> offsets;
+            std::vector<uint32_t> sorted;
+
+            static uint32_t bucketCount(uint32_t num_items)
+            {
+                uint32_t n = 1;
+                while (n < num_items)
+                    n <<= 1;
+                return n;
+            }
+
+            HashBuckets(const std::vector<uint32_t>& buckets, uint32_t num_buckets)
+                : num_buckets(num_buckets), offsets(num_buckets + 2, 0), sorted(buckets.size())
+            {
+                for (uint32_t b : buckets)
+                    offsets[b + 1]++;
+                for (uint32_t b = 0; b <= num_buckets; b++)
+                    offsets[b + 1] += offsets[b];
+                std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+                for (uint32_t i = 0; i < static_cast<uint32_t>(buckets.size()); i++)
+                    sorted[cursor[buckets[i]]++] = i;
+            }
+
+            uint32_t begin(uint32_t bucket) const { return offsets[bucket]; }
+            uint32_t end(uint32_t bucket) const { return offsets[bucket + 1]; }
+        };
+
+        /**
+         * For each point, find a preceding point within the tolerance, and resolve chains of them
+         * (a ~ b ~ c but a !~ c) to the first point of the chain.
+         * Points are bucketed into a hash grid whose cells are larger than the tolerance, so a
+         * neighboring cell is only searched when the point is closer to it than the tolerance.
+         * The search stops at the first match, so only the first point of each cluster visits all
+         * neighboring cells.
+         */
+        template <uint32_t N, class VecT>
+        std::vector<uint32_t> findRepresentatives(const std::vector<VecT>& points, float tolerance)
+        {
+            const uint32_t num_points = static_cast<uint32_t>(points.size());
+            std::vector<uint32_t> reps(num_points);
+            for (uint32_t i = 0; i < num_points; i++)
+                reps[i] = i;
+            if (num_points == 0)
+                return reps;
+
+            auto isFinite = [](const VecT& p)
+            {
+                for (uint32_t k = 0; k < N; k++)
+                    if (!std::isfinite(p[k])) return false;
+                return true;
+            };
+
+            // Identical positions are always in the same cell, whose size is then taken from the extent of the points
+            float cell_size = tolerance * 4.0f;
+            if (tolerance <= 0.0f)
+            {
+                float extent = 0.0f;
+                for (const auto& p : points)
+                    for (uint32_t k = 0; k < N; k++)
+                        if (std::isfinite(p[k])) extent = std::max(extent, std::fabs(p[k]));
+                cell_size = extent > 0.0f ? extent / static_cast<float>(1 << 20) : 1.0f;
+            }
+            const float inv_cell_size = 1.0f / cell_size;
+
+            // Cells are centered at multiples of the cell size, so that points on a regular grid
+            // (e.g. integer or decimal coordinates) don't lie on cell boundaries
+            auto cellOf = [&](const VecT& p)
+            {
+                std::array<int64_t, 3> c = { 0, 0, 0 };
+                for (uint32_t k = 0; k < N; k++)
+                    c[k] = static_cast<int64_t>(std::floor(p[k] * inv_cell_size + 0.5f));
+                return c;
+            };
+
+            const uint32_t num_buckets = HashBuckets::bucketCount(num_points);
+            const uint32_t mask = num_buckets - 1;
+
+            // Non-finite points are never merged, and are put in an extra bucket which isn't searched
+            std::vector<uint32_t> buckets(num_points);
+            parallelFor(0, num_points, [&](size_t i)
+            {
+                const VecT& p = points[i];
+                if (!isFinite(p))
+                {
+                    buckets[i] = num_buckets;
+                    return;
+                }
+                const auto c = cellOf(p);
+                buckets[i] = hashCell(c[0], c[1], c[2], mask);
+            });
+
+            const HashBuckets grid(buckets, num_buckets);
+
+            const float tolerance2 = tolerance > 0.0f ? tolerance * tolerance : 0.0f;
+
+            // Set reps[i] to a preceding point in the bucket within the tolerance
+            auto searchBucket = [&](uint32_t i, uint32_t bucket)
+            {
+                const VecT& p = points[i];
+                for (uint32_t j = grid.begin(bucket); j < grid.end(bucket); j++)
+                {
+                    const uint32_t other = grid.sorted[j];
+                    if (other >= i)
+                        return;
+                    float d2 = 0.0f;
+                    for (uint32_t k = 0; k < N; k++)
+                        d2 += (p[k] - points[other][k]) * (p[k] - points[other][k]);
+                    if (d2 <= tolerance2)
+                    {
+                        reps[i] = other;
+                        return;
+                    }
+                }
+            };
+
+            parallelFor(0, num_points, [&](size_t j)
+            {
+                const uint32_t i = static_cast<uint32_t>(j);
+                if (buckets[i] == num_buckets)
+                    return;
+                searchBucket(i, buckets[i]);
+                if (reps[i] != i || tolerance <= 0.0f)
+                    return;
+
+                // Neighbor cells closer than the tolerance along each axis
+                const VecT& p = points[i];
+                const auto c = cellOf(p);
+                std::array<int32_t, 3> lo = { 0, 0, 0 }, hi = { 0, 0, 0 };
+                for (uint32_t k = 0; k < N; k++)
+                {
+                    const float local = p[k] - (static_cast<float>(c[k]) - 0.5f) * cell_size;
+                    lo[k] = local < tolerance ? -1 : 0;
+                    hi[k] = local > cell_size - tolerance ? 1 : 0;
+                }
+                for (int32_t dz = lo[2]; dz <= hi[2]; dz++)
+                {
+                    for (int32_t dy = lo[1]; dy <= hi[1]; dy++)
+                    {
+                        for (int32_t dx = lo[0]; dx <= hi[0]; dx++)
+                        {
+                            if (reps[i] != i)
+                                return;
+                            if (dx != 0 || dy != 0 || dz != 0)
+                                searchBucket(i, hashCell(c[0] + dx, c[1] + dy, c[2] + dz, mask));
+                        }
+                    }
+                }
+            });
+
+            // reps[i] <= i, so a forward sweep resolves chains
+            for (uint32_t i = 0; i < num_points; i++)
+                reps[i] = reps[reps[i]];
+            return reps;
+        }
+
+        // Indices out of the buffer (e.g. normal_id of a mesh without normals) are left as they are
+        void remapIndices(std::vector<Face>& faces, Vec3i Face::* member, const std::vector<uint32_t>& map)
+        {
+            parallelFor(0, faces.size(), [&](size_t i)
+            {
+                Vec3i& idx = faces[i].*member;
+                for (int k = 0; k < 3; k++)
+                {
+                    if (idx[k] >= 0 && static_cast<size_t>(idx[k]) < map.size())
+                        idx[k] = static_cast<int32_t>(map[idx[k]]);
+                }
+            });
+        }
+
+        // Remove elements not referenced by faces, keeping the order of the others
+        template <class T>
+        std::vector<T> compactBuffer(const std::vector<T>& buffer, std::vector<Face>& faces, Vec3i Face::* member)
+        {
+            std::vector<uint8_t> used(buffer.size(), 0);
+            for (const Face& face : faces)
+            {
+                const Vec3i& idx = face.*member;
+                for (int k = 0; k < 3; k++)
+                    if (idx[k] >= 0 && static_cast<size_t>(idx[k]) < buffer.size()) used[idx[k]] = 1;
+            }
+
+            std::vector<uint32_t> map(buffer.size(), kInvalidIndex);
+            std::vector<T> compacted;
+            for (size_t i = 0; i < buffer.size(); i++)
+            {
+                if (!used[i])
+                    continue;
+                map[i] = static_cast<uint32_t>(compacted.size());
+                compacted.emplace_back(buffer[i]);
+            }
+            remapIndices(faces, member, map);
+            return compacted;
+        }
+
+        // Rotate the indices so the smallest comes first; the winding order is preserved
+        Vec3i canonicalTriangle(const Vec3i& idx)
+        {
+            int first = 0;
+            if (idx[1] < idx[first]) first = 1;
+            if (idx[2] < idx[first]) first = 2;
+            return Vec3i(idx[first], idx[(first + 1) % 3], idx[(first + 2) % 3]);
+        }
+
+        uint32_t hashTriangle(const Vec3i& idx, uint32_t mask)
+        {
+            uint64_t h = 1469598103934665603ull;
+            for (int k = 0; k < 3; k++)
+                h = (h ^ static_cast<uint32_t>(idx[k])) * 1099511628211ull;
+            return static_cast<uint32_t>(h ^ (h >> 32)) & mask;
+        }
+
+        // Insert two zero bits between each of the lower 21 bits
+        uint64_t spreadBits(uint64_t x)
+        {
+            x &= 0x1fffff;
+            x = (x | x << 32) & 0x1f00000000ffffull;
+            x = (x | x << 16) & 0x1f0000ff0000ffull;
+            x = (x | x << 8) & 0x100f00f00f00f00full;
+            x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+            x = (x | x << 2) & 0x1249249249249249ull;
+            return x;
+        }
+
+        uint64_t mortonCode(uint32_t x, uint32_t y, uint32_t z)
+        {
+            return (spreadBits(x) << 2) | (spreadBits(y) << 1) | spreadBits(z);
+        }
+
+        // Hilbert index of `bits`-bit coordinates (J. Skilling, "Programming the Hilbert curve", 2004)
+        uint64_t hilbertCode(uint32_t x, uint32_t y, uint32_t z, uint32_t bits)
+        {
+            uint32_t X[3] = { x, y, z };
+            const uint32_t M = 1u << (bits - 1);
+
+            // Inverse undo
+            for (uint32_t Q = M; Q > 1; Q >>= 1)
+            {
+                const uint32_t P = Q - 1;
+                for (int i = 0; i < 3; i++)
+                {
+                    if (X[i] & Q)
+                        X[0] ^= P;
+                    else
+                    {
+                        const uint32_t t = (X[0] ^ X[i]) & P;
+                        X[0] ^= t;
+                        X[i] ^= t;
+                    }
+                }
+            }
+
+            // Gray encode
+            for (int i = 1; i < 3; i++)
+                X[i] ^= X[i - 1];
+            uint32_t t = 0;
+            for (uint32_t Q = M; Q > 1; Q >>= 1)
+                if (X[2] & Q) t ^= Q - 1;
+            for (int i = 0; i < 3; i++)
+                X[i] ^= t;
+
+            // Interleave the transposed bits from the most significant one
+            uint64_t code = 0;
+            for (int b = static_cast<int>(bits) - 1; b >= 0; b--)
+                for (int i = 0; i < 3; i++)
+                    code = (code << 1) | ((X[i] >> b) & 1u);
+            return code;
+        }
+
+        /**
+         * Number the elements in the order they are first referenced by faces, followed by unreferenced ones,
+         * then rewrite the buffer and the indices.
+         */
+        template <class T>
+        std::vector<T> renumberFirstUse(const std::vector<T>& buffer, std::vector<Face>& faces, Vec3i Face::* member)
+        {
+            std::vector<uint32_t> map(buffer.size(), kInvalidIndex);
+            uint32_t next = 0;
+            for (const Face& face : faces)
+            {
+                const Vec3i& idx = face.*member;
+                for (int k = 0; k < 3; k++)
+                {
+                    if (idx[k] >= 0 && static_cast<size_t>(idx[k]) < buffer.size() && map[idx[k]] == kInvalidIndex)
+                        map[idx[k]] = next++;
+                }
+            }
+            for (auto& m : map)
+                if (m == kInvalidIndex) m = next++;
+
+            std::vector<T> renumbered(buffer.size());
+            parallelFor(0, buffer.size(), [&](size_t i) { renumbered[map[i]] = buffer[i]; });
+            remapIndices(faces, member, map);
+            return renumbered;
+        }
+
+        // Indices of faces sorted along the curve by their centroids quantized to a 2^16 grid over their bounds
+        std::vector<uint32_t> sortFacesAlongCurve(const TriangleMesh& mesh, SpaceFillingCurve curve)
+        {
+            const uint32_t num_faces = mesh.numFaces();
+            const std::vector<Face>& faces = mesh.faces();
+            const std::vector<Vec3f>& vertices = mesh.vertices();
+
+            auto centroid = [&](const Face& face)
+            {
+                return (vertices[face.vertex_id[0]] + vertices[face.vertex_id[1]] + vertices[face.vertex_id[2]]) / 3.0f;
+            };
+
+            Vec3f bmin(std::numeric_limits<float>::max()), bmax(-std::numeric_limits<float>::max());
+            for (const Face& face : faces)
+            {
+                const Vec3f c = centroid(face);
+                for (int k = 0; k < 3; k++)
+                {
+                    bmin[k] = std::min(bmin[k], c[k]);
+                    bmax[k] = std::max(bmax[k], c[k]);
+                }
+            }
+
+            constexpr uint32_t bits = 16;
+            constexpr float grid_max = static_cast<float>((1u << bits) - 1);
+            std::vector<std::pair<uint64_t, uint32_t>> keys(num_faces);
+            parallelFor(0, num_faces, [&](size_t i)
+            {
+                const Vec3f c = centroid(faces[i]);
+                uint32_t q[3];
+                for (int k = 0; k < 3; k++)
+                {
+                    const float extent = bmax[k] - bmin[k];
+                    const float u = extent > 0.0f ? (c[k] - bmin[k]) / extent : 0.0f;
+                    q[k] = static_cast<uint32_t>(std::clamp(u * grid_max, 0.0f, grid_max));
+                }
+                const uint64_t code = curve == SpaceFillingCurve::Hilbert
+                    ? hilbertCode(q[0], q[1], q[2], bits)
+                    : mortonCode(q[0], q[1], q[2]);
+                keys[i] = { code, static_cast<uint32_t>(i) };
+            });
+            std::sort(keys.begin(), keys.end());
+
+            std::vector<uint32_t> order(num_faces);
+            for (uint32_t i = 0; i < num_faces; i++)
+                order[i] = keys[i].second;
+            return order;
+        }
+
+        // ---------------------------------------------------------------------------
+        // Error quadric of Garland and Heckbert (1997): sum of squared distances to planes, kept in double
+        struct Quadric {
+            double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+            // Plane n.p + d = 0 with unit normal n
+            static Quadric plane(const Vec3f& n, float d, double weight)
+            {
+                Quadric q;
+                const double a = n[0], b = n[1], c = n[2], dd = d;
+                q.a2 = a * a * weight; q.ab = a * b * weight; q.ac = a * c * weight; q.ad = a * dd * weight;
+                q.b2 = b * b * weight; q.bc = b * c * weight; q.bd = b * dd * weight;
+                q.c2 = c * c * weight; q.cd = c * dd * weight;
+                q.d2 = dd * dd * weight;
+                return q;
+            }
+
+            Quadric& operator+=(const Quadric& q)
+            {
+                a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad; b2 += q.b2;
+                bc += q.bc; bd += q.bd; c2 += q.c2; cd += q.cd; d2 += q.d2;
+                return *this;
+            }
+
+            double error(const Vec3f& p) const
+            {
+                const double x = p[0], y = p[1], z = p[2];
+                const double e = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+                               + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                               + c2 * z * z + 2 * cd * z + d2;
+                return std::max(e, 0.0);
+            }
+        };
+
+        /**
+         * Greedy half-edge collapses ordered by quadric error on a subset of faces.
+         * A collapse u -> v moves u onto v, so the simplified faces reference only original positions,
+         * normals and texcoords, and the output shares the buffers of the input mesh.
+         * Normal and texcoord ids are carried along the collapse: a vertex lying on an attribute seam
+         * (several ids around it) is kept, except for streams where faces are flat (three equal ids).
+         */
+        class QuadricSimplifier {
+        public:
+            // `faces` index the buffers of the mesh, and `face_ids` are the indices of the original faces they come from
+            QuadricSimplifier(const TriangleMesh& mesh, std::vector<Face> faces, std::vector<uint32_t> face_ids,
+                const std::vector<uint8_t>& locked_vertices, float scale, const MeshSimplifySettings& settings)
+                : m_mesh(mesh), m_face_ids(std::move(face_ids)), m_scale(scale), m_settings(settings), m_faces(std::move(faces))
+            {
+                const uint32_t num_faces = static_cast<uint32_t>(m_faces.size());
+
+                // Local numbering of the vertices referenced by the faces
+                for (const Face& face : m_faces)
+                    for (int k = 0; k < 3; k++)
+                        m_vertex_ids.emplace_back(static_cast<uint32_t>(face.vertex_id[k]));
+                std::sort(m_vertex_ids.begin(), m_vertex_ids.end());
+                m_vertex_ids.erase(std::unique(m_vertex_ids.begin(), m_vertex_ids.end()), m_vertex_ids.end());
+                const uint32_t num_vertices = static_cast<uint32_t>(m_vertex_ids.size());
+
+                m_face_alive.assign(num_faces, 1);
+                m_num_alive_faces = num_faces;
+                m_positions.resize(num_vertices);
+                m_vertex_faces.resize(num_vertices);
+                m_quadrics.resize(num_vertices);
+                m_areas.assign(num_vertices, 0.0);
+                m_locked.assign(num_vertices, 0);
+                m_border.assign(num_vertices, 0);
+                m_vertex_alive.assign(num_vertices, 1);
+                m_versions.assign(num_vertices, 0);
+
+                for (uint32_t v = 0; v < num_vertices; v++)
+                {
+                    m_positions[v] = mesh.vertices()[m_vertex_ids[v]] * m_scale;
+                    if (!locked_vertices.empty() && locked_vertices[m_vertex_ids[v]])
+                        m_locked[v] = 1;
+                }
+
+                for (uint32_t i = 0; i < num_faces; i++)
+                {
+                    for (int k = 0; k < 3; k++)
+                    {
+                        const uint32_t v = localVertex(static_cast<uint32_t>(m_faces[i].vertex_id[k]));
+                        m_faces[i].vertex_id[k] = static_cast<int32_t>(v);
+                        m_vertex_faces[v].emplace_back(i);
+                    }
+
+                    const Vec3i& idx = m_faces[i].vertex_id;
+                    const Vec3f n = cross(m_positions[idx[1]] - m_positions[idx[0]], m_positions[idx[2]] - m_positions[idx[0]]);
+                    const float len = length(n);
+                    if (len == 0.0f)
+                        continue;
+                    const double area = 0.5 * len;
+                    const Vec3f unit_n = n / len;
+                    const Quadric q = Quadric::plane(unit_n, -dot(unit_n, m_positions[idx[0]]), area);
+                    for (int k = 0; k < 3; k++)
+                    {
+                        m_quadrics[idx[k]] += q;
+                        m_areas[idx[k]] += area;
+                    }
+                }
+
+                classifyVertices();
+                m_attribute_ids.resize(num_vertices);
+                for (uint32_t v = 0; v < num_vertices; v++)
+                    updateAttributeIds(v);
+            }
+
+            void simplify(uint32_t target_faces)
+            {
+                const uint32_t num_vertices = static_cast<uint32_t>(m_vertex_ids.size());
+                for (uint32_t v = 0; v < num_vertices; v++)
+                    pushEdges(v, true);
+
+                const double max_cost = m_settings.max_error > 0.0f
+                    ? static_cast<double>(m_settings.max_error) * m_settings.max_error
+                    : std::numeric_limits<double>::max();
+
+                while (m_num_alive_faces > target_faces && !m_heap.empty())
+                {
+                    std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<>());
+                    const Candidate c = m_heap.back();
+                    m_heap.pop_back();
+
+                    if (c.cost > max_cost)
+                        break;
+                    if (!m_vertex_alive[c.u] || !m_vertex_alive[c.v] || m_versions[c.u] != c.version_u || m_versions[c.v] != c.version_v)
+                        continue;
+
+                    Collapse collapse;
+                    if (!evaluate(c.u, c.v, collapse) || !isTopologyValid(c.u, c.v, collapse))
+                        continue;
+                    apply(c.u, c.v, collapse);
+                    pushEdges(c.v);
+                }
+            }
+
+            // Alive faces in the global indices, and the indices of their original faces
+            void collect(std::vector<Face>& faces, std::vector<uint32_t>& face_ids) const
+            {
+                for (uint32_t i = 0; i < static_cast<uint32_t>(m_faces.size()); i++)
+                {
+                    if (!m_face_alive[i])
+                        continue;
+                    Face face = m_faces[i];
+                    for (int k = 0; k < 3; k++)
+                        face.vertex_id[k] = static_cast<int32_t>(m_vertex_ids[face.vertex_id[k]]);
+                    faces.emplace_back(face);
+                    face_ids.emplace_back(m_face_ids[i]);
+                }
+            }
+
+            uint32_t numFaces() const { return m_num_alive_faces; }
+        private:
+            struct Candidate {
+                double cost;
+                uint32_t u, v;
+                uint32_t version_u, version_v;
+                bool operator>(const Candidate& c) const { return cost > c.cost; }
+            };
+
+            // Attribute ids given to the corners of u in the faces that survive the collapse
+            struct Collapse {
+                double cost;
+                uint32_t num_edge_faces;
+                int32_t normal_id;
+                int32_t texcoord_id;
+            };
+
+            static constexpr uint32_t kNumAttributes = 2;
+            static constexpr Vec3i Face::* kAttributes[kNumAttributes] = { &Face::normal_id, &Face::texcoord_id };
+            // Values of m_attribute_ids for vertices only in flat faces, and for vertices on seams
+            static constexpr int32_t kNoAttribute = std::numeric_limits<int32_t>::min();
+            static constexpr int32_t kSeamAttribute = std::numeric_limits<int32_t>::min() + 1;
+
+            uint32_t localVertex(uint32_t global_id) const
+            {
+                return static_cast<uint32_t>(std::lower_bound(m_vertex_ids.begin(), m_vertex_ids.end(), global_id) - m_vertex_ids.begin());
+            }
+
+            static int corner(const Face& face, uint32_t v)
+            {
+                for (int k = 0; k < 3; k++)
+                    if (static_cast<uint32_t>(face.vertex_id[k]) == v) return k;
+                return -1;
+            }
+
+            static bool isFlat(const Vec3i& idx)
+            {
+                return idx[0] == idx[1] && idx[1] == idx[2];
+            }
+
+            // The single normal/texcoord id of v in its faces that aren't flat, or kSeamAttribute
+            void updateAttributeIds(uint32_t v)
+            {
+                std::array<int32_t, kNumAttributes>& ids = m_attribute_ids[v];
+                ids.fill(kNoAttribute);
+                for (uint32_t f : m_vertex_faces[v])
+                {
+                    const Face& face = m_faces[f];
+                    if (!m_face_alive[f])
+                        continue;
+                    const int cv = corner(face, v);
+                    for (uint32_t s = 0; s < kNumAttributes; s++)
+                    {
+                        const Vec3i& idx = face.*kAttributes[s];
+                        if (isFlat(idx) || ids[s] == kSeamAttribute)
+                            continue;
+                        ids[s] = ids[s] == kNoAttribute || ids[s] == idx[cv] ? idx[cv] : kSeamAttribute;
+                    }
+                }
+            }
+
+            // Count the faces on every edge. Border edges have one face, and vertices where the borders
+            // don't form a simple path (non-manifold edges, bowties) are locked.
+            void classifyVertices()
+            {
+                std::vector<uint64_t> edges;
+                edges.reserve(m_faces.size() * 3);
+                for (const Face& face : m_faces)
+                {
+                    for (int k = 0; k < 3; k++)
+                    {
+                        const uint32_t a = static_cast<uint32_t>(face.vertex_id[k]);
+                        const uint32_t b = static_cast<uint32_t>(face.vertex_id[(k + 1) % 3]);
+                        edges.emplace_back((static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b));
+                    }
+                }
+                std::sort(edges.begin(), edges.end());
+
+                std::vector<uint32_t> num_border_edges(m_vertex_ids.size(), 0);
+                for (size_t i = 0; i < edges.size();)
+                {
+                    size_t j = i;
+                    while (j < edges.size() && edges[j] == edges[i])
+                        j++;
+                    const uint32_t a = static_cast<uint32_t>(edges[i] >> 32);
+                    const uint32_t b = static_cast<uint32_t>(edges[i] & 0xffffffff);
+                    if (j - i == 1)
+                    {
+                        num_border_edges[a]++;
+                        num_border_edges[b]++;
+                        addBorderPlane(a, b);
+                    }
+                    else if (j - i > 2)
+                    {
+                        m_locked[a] = m_locked[b] = 1;
+                    }
+                    i = j;
+                }
+
+                for (uint32_t v = 0; v < static_cast<uint32_t>(m_vertex_ids.size()); v++)
+                {
+                    if (num_border_edges[v] == 0)
+                        continue;
+                    m_border[v] = 1;
+                    if (num_border_edges[v] != 2 || m_settings.lock_border)
+                        m_locked[v] = 1;
+                }
+            }
+
+            // A plane through the border edge perpendicular to its face keeps the border from shrinking
+            void addBorderPlane(uint32_t a, uint32_t b)
+            {
+                for (uint32_t f : m_vertex_faces[a])
+                {
+                    const Face& face = m_faces[f];
+                    if (corner(face, b) < 0)
+                        continue;
+                    const Vec3i& idx = face.vertex_id;
+                    const Vec3f face_n = cross(m_positions[idx[1]] - m_positions[idx[0]], m_positions[idx[2]] - m_positions[idx[0]]);
+                    const Vec3f e = m_positions[b] - m_positions[a];
+                    const Vec3f n = cross(e, face_n);
+                    const float len = length(n);
+                    if (len == 0.0f)
+                        return;
+                    constexpr double border_weight = 10.0;
+                    const Vec3f unit_n = n / len;
+                    const Quadric q = Quadric::plane(unit_n, -dot(unit_n, m_positions[a]), lengthSquared(e) * border_weight);
+                    m_quadrics[a] += q;
+                    m_quadrics[b] += q;
+                    return;
+                }
+            }
+
+            void neighbors(uint32_t v, std::vector<uint32_t>& out) const
+            {
+                out.clear();
+                for (uint32_t f : m_vertex_faces[v])
+                {
+                    if (!m_face_alive[f])
+                        continue;
+                    for (int k = 0; k < 3; k++)
+                    {
+                        const uint32_t w = static_cast<uint32_t>(m_faces[f].vertex_id[k]);
+                        if (w != v) out.emplace_back(w);
+                    }
+                }
+                std::sort(out.begin(), out.end());
+                out.erase(std::unique(out.begin(), out.end()), out.end());
+            }
+
+            /**
+             * Compute the cost of collapsing u into v, and reject collapses that the attributes or the borders
+             * don't allow. The costly checks of the neighborhood are deferred to isTopologyValid() when the
+             * collapse is taken from the heap.
+             */
+            bool evaluate(uint32_t u, uint32_t v, Collapse& collapse) const
+            {
+                if (m_locked[u])
+                    return false;
+
+                // Ids of v on the collapsed edge replace the ids of u in the faces moving to v
+                uint32_t num_edge_faces = 0;
+                std::array<int32_t, kNumAttributes> ids_v;
+                ids_v.fill(kNoAttribute);
+                for (uint32_t f : m_vertex_faces[u])
+                {
+                    const Face& face = m_faces[f];
+                    const int cv = corner(face, v);
+                    if (!m_face_alive[f] || cv < 0)
+                        continue;
+                    num_edge_faces++;
+                    for (uint32_t s = 0; s < kNumAttributes; s++)
+                    {
+                        const Vec3i& idx = face.*kAttributes[s];
+                        if (isFlat(idx))
+                            continue;
+                        if (ids_v[s] != kNoAttribute && ids_v[s] != idx[cv])
+                            return false;
+                        ids_v[s] = idx[cv];
+                    }
+                }
+                if (num_edge_faces == 0 || num_edge_faces > 2)
+                    return false;
+                // A border vertex can only slide along the border
+                if (m_border[u] && num_edge_faces != 1)
+                    return false;
+                collapse.num_edge_faces = num_edge_faces;
+
+                double attribute_cost = 0.0;
+                for (uint32_t s = 0; s < kNumAttributes; s++)
+                {
+                    const int32_t id_u = m_attribute_ids[u][s];
+                    if (id_u == kSeamAttribute)
+                        return false;
+                    if (id_u == kNoAttribute)
+                        continue;
+                    if (ids_v[s] == kNoAttribute)
+                        return false;
+                    const int32_t id_v = ids_v[s];
+                    if (id_u == id_v || id_u < 0 || id_v < 0)
+                        continue;
+                    if (s == 0 && std::max(id_u, id_v) < static_cast<int32_t>(m_mesh.normals().size()))
+                        attribute_cost += m_settings.normal_weight * lengthSquared(m_mesh.normals()[id_u] - m_mesh.normals()[id_v]);
+                    if (s == 1 && std::max(id_u, id_v) < static_cast<int32_t>(m_mesh.texcoords().size()))
+                        attribute_cost += m_settings.texcoord_weight * lengthSquared(m_mesh.texcoords()[id_u] - m_mesh.texcoords()[id_v]);
+                }
+
+                // Quadric error normalized by the area is a mean squared distance, and attribute
+                // differences are scaled by the squared edge length to be in the same unit
+                const Vec3f& pu = m_positions[u];
+                const Vec3f& pv = m_positions[v];
+                Quadric q = m_quadrics[u];
+                q += m_quadrics[v];
+                const double area = std::max(m_areas[u] + m_areas[v], 1e-30);
+                collapse.cost = q.error(pv) / area + attribute_cost * lengthSquared(pv - pu);
+                collapse.normal_id = ids_v[0];
+                collapse.texcoord_id = ids_v[1];
+                return true;
+            }
+
+            bool isTopologyValid(uint32_t u, uint32_t v, const Collapse& collapse) const
+            {
+                // Link condition: the collapse must not join two sheets of the surface
+                thread_local std::vector<uint32_t> ring_u, ring_v;
+                neighbors(u, ring_u);
+                neighbors(v, ring_v);
+                uint32_t num_common = 0;
+                for (size_t i = 0, j = 0; i < ring_u.size() && j < ring_v.size();)
+                {
+                    if (ring_u[i] < ring_v[j]) i++;
+                    else if (ring_u[i] > ring_v[j]) j++;
+                    else { num_common++; i++; j++; }
+                }
+                if (num_common != collapse.num_edge_faces)
+                    return false;
+
+                // Reject faces that flip or degenerate when u moves to v
+                const Vec3f& pu = m_positions[u];
+                const Vec3f& pv = m_positions[v];
+                for (uint32_t f : m_vertex_faces[u])
+                {
+                    const Face& face = m_faces[f];
+                    if (!m_face_alive[f] || corner(face, v) >= 0)
+                        continue;
+                    const int cu = corner(face, u);
+                    const Vec3f& p1 = m_positions[face.vertex_id[(cu + 1) % 3]];
+                    const Vec3f& p2 = m_positions[face.vertex_id[(cu + 2) % 3]];
+                    const Vec3f n_before = cross(p1 - pu, p2 - pu);
+                    const Vec3f n_after = cross(p1 - pv, p2 - pv);
+                    const float len_before = length(n_before);
+                    const float len_after = length(n_after);
+                    if (len_after <= 1e-12f)
+                        return false;
+                    if (len_before > 0.0f && dot(n_before, n_after) < 0.2f * len_before * len_after)
+                        return false;
+                }
+                return true;
+            }
+
+            void apply(uint32_t u, uint32_t v, const Collapse& collapse)
+            {
+                std::vector<uint32_t>& faces_v = m_vertex_faces[v];
+                for (uint32_t f : m_vertex_faces[u])
+                {
+                    if (!m_face_alive[f])
+                        continue;
+                    Face& face = m_faces[f];
+                    if (corner(face, v) >= 0)
+                    {
+                        m_face_alive[f] = 0;
+                        m_num_alive_faces--;
+                        continue;
+                    }
+                    const int cu = corner(face, u);
+                    face.vertex_id[cu] = static_cast<int32_t>(v);
+                    if (!isFlat(face.normal_id))
+                        face.normal_id[cu] = collapse.normal_id;
+                    if (!isFlat(face.texcoord_id))
+                        face.texcoord_id[cu] = collapse.texcoord_id;
+                    faces_v.emplace_back(f);
+                }
+                faces_v.erase(std::remove_if(faces_v.begin(), faces_v.end(), [&](uint32_t f) { return !m_face_alive[f]; }), faces_v.end());
+
+                m_quadrics[v] += m_quadrics[u];
+                m_areas[v] += m_areas[u];
+                m_border[v] |= m_border[u];
+                m_vertex_alive[u] = 0;
+                m_vertex_faces[u].clear();
+                m_vertex_faces[u].shrink_to_fit();
+                m_versions[v]++;
+                updateAttributeIds(v);
+            }
+
+            // Push the cheaper direction of every edge around v. At initialization, each edge is pushed
+            // only from its smaller end.
+            void pushEdges(uint32_t v, bool initial = false)
+            {
+                thread_local std::vector<uint32_t> ring;
+                neighbors(v, ring);
+                for (uint32_t w : ring)
+                {
+                    if (initial && w < v)
+                        continue;
+                    Collapse c0, c1;
+                    const bool valid0 = evaluate(v, w, c0);
+                    const bool valid1 = evaluate(w, v, c1);
+                    if (!valid0 && !valid1)
+                        continue;
+                    Candidate c;
+                    if (valid0 && (!valid1 || c0.cost <= c1.cost))
+                        c = { c0.cost, v, w, m_versions[v], m_versions[w] };
+                    else
+                        c = { c1.cost, w, v, m_versions[w], m_versions[v] };
+                    m_heap.emplace_back(c);
+                    std::push_heap(m_heap.begin(), m_heap.end(), std::greater<>());
+                }
+            }
+
+            const TriangleMesh& m_mesh;
+            std::vector<uint32_t> m_face_ids;
+            float m_scale;
+            MeshSimplifySettings m_settings;
+
+            std::vector<Face> m_faces;
+            std::vector<uint32_t> m_vertex_ids;
+            std::vector<uint8_t> m_face_alive;
+            uint32_t m_num_alive_faces;
+
+            std::vector<Vec3f> m_positions;
+            std::vector<std::vector<uint32_t>> m_vertex_faces;
+            std::vector<Quadric> m_quadrics;
+            std::vector<double> m_areas;
+            std::vector<uint8_t> m_locked;
+            std::vector<uint8_t> m_border;
+            std::vector<uint8_t> m_vertex_alive;
+            std::vector<uint32_t> m_versions;
+            // Seams of faces around each vertex are cached, since they only change at v of collapses
+            std::vector<std::array<int32_t, kNumAttributes>> m_attribute_ids;
+            std::vector<Candidate> m_heap;
+        };
+
+        /**
+         * Grow clusters over faces[face_ids[0..num_faces)], which are sorted along a curve, and append them to `out`.
+         * Positions are numbered locally, so ranges of faces can be clustered in parallel.
+         */
+        void clusterFaces(const TriangleMesh& mesh, const uint32_t* face_ids, uint32_t num_faces, const MeshClusterSettings& settings, MeshClusters& out)
+        {
+            const std::vector<Face>& faces = mesh.faces();
+            const std::vector<Vec3f>& vertices = mesh.vertices();
+
+            std::vector<uint32_t> triangles(static_cast<size_t>(num_faces) * 3);
+            for (uint32_t i = 0; i < num_faces; i++)
+                for (int k = 0; k < 3; k++)
+                    triangles[i * 3 + k] = static_cast<uint32_t>(faces[face_ids[i]].vertex_id[k]);
+            std::vector<uint32_t> positions = triangles;
+            std::sort(positions.begin(), positions.end());
+            positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+            for (uint32_t& v : triangles)
+                v = static_cast<uint32_t>(std::lower_bound(positions.begin(), positions.end(), v) - positions.begin());
+            const uint32_t num_vertices = static_cast<uint32_t>(positions.size());
+
+            // Faces around each position
+            std::vector<uint32_t> adjacency_offsets(num_vertices + 1, 0);
+            std::vector<uint32_t> adjacency(triangles.size());
+            for (uint32_t v : triangles)
+                adjacency_offsets[v + 1]++;
+            std::partial_sum(adjacency_offsets.begin(), adjacency_offsets.end(), adjacency_offsets.begin());
+            {
+                std::vector<uint32_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+                for (size_t i = 0; i < triangles.size(); i++)
+                    adjacency[fill[triangles[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+
+            std::vector<Vec3f> centroids(num_faces);
+            for (uint32_t i = 0; i < num_faces; i++)
+                centroids[i] = (vertices[positions[triangles[i * 3]]] + vertices[positions[triangles[i * 3 + 1]]] + vertices[positions[triangles[i * 3 + 2]]]) / 3.0f;
+
+            std::vector<uint8_t> assigned(num_faces, 0);
+            // Number of unassigned faces around each position
+            std::vector<uint32_t> live_faces(num_vertices);
+            for (uint32_t v = 0; v < num_vertices; v++)
+                live_faces[v] = adjacency_offsets[v + 1] - adjacency_offsets[v];
+            // Slot of the position in the current cluster, which is valid while vertex_clusters[v] is the current cluster
+            std::vector<uint32_t> vertex_clusters(num_vertices, kInvalidIndex);
+            std::vector<uint8_t> vertex_slots(num_vertices, 0);
+            std::vector<uint32_t> candidate_clusters(num_faces, kInvalidIndex);
+            std::vector<uint32_t> candidates;
+
+            uint32_t cursor = 0;
+            for (uint32_t cluster = 0; ; cluster++)
+            {
+                while (cursor < num_faces && assigned[cursor])
+                    cursor++;
+                if (cursor == num_faces)
+                    break;
+
+                // Start next to the previous cluster from the face with the fewest unassigned neighbors, which would
+                // be left isolated otherwise, or from the first unassigned face along the curve
+                uint32_t seed = cursor, seed_neighbors = kInvalidIndex;
+                for (uint32_t f : candidates)
+                {
+                    if (assigned[f])
+                        continue;
+                    uint32_t n = 0;
+                    for (int k = 0; k < 3; k++)
+                        n += live_faces[triangles[f * 3 + k]];
+                    if (n < seed_neighbors)
+                    {
+                        seed = f;
+                        seed_neighbors = n;
+                    }
+                }
+
+                MeshCluster mc{ static_cast<uint32_t>(out.face_ids.size()), 0, static_cast<uint32_t>(out.vertex_ids.size()), 0, AABB() };
+                Vec3f bmin(std::numeric_limits<float>::max()), bmax(-std::numeric_limits<float>::max());
+                Vec3f centroid_sum(0.0f);
+                candidates.clear();
+
+                auto numNewVertices = [&](uint32_t f)
+                {
+                    uint32_t n = 0;
+                    for (int k = 0; k < 3; k++)
+                        n += vertex_clusters[triangles[f * 3 + k]] != cluster;
+                    return n;
+                };
+
+                auto addFace = [&](uint32_t f)
+                {
+                    assigned[f] = 1;
+                    for (int k = 0; k < 3; k++)
+                        live_faces[triangles[f * 3 + k]]--;
+                    out.face_ids.emplace_back(face_ids[f]);
+                    for (int k = 0; k < 3; k++)
+                    {
+                        const uint32_t v = triangles[f * 3 + k];
+                        if (vertex_clusters[v] != cluster)
+                        {
+                            vertex_clusters[v] = cluster;
+                            vertex_slots[v] = static_cast<uint8_t>(mc.num_vertices++);
+                            out.vertex_ids.emplace_back(positions[v]);
+                            const Vec3f& p = vertices[positions[v]];
+                            for (int a = 0; a < 3; a++)
+                            {
+                                bmin[a] = std::min(bmin[a], p[a]);
+                                bmax[a] = std::max(bmax[a], p[a]);
+                            }
+                            // Faces around a new position become candidates
+                            for (uint32_t i = adjacency_offsets[v]; i < adjacency_offsets[v + 1]; i++)
+                            {
+                                const uint32_t g = adjacency[i];
+                                if (!assigned[g] && candidate_clusters[g] != cluster)
+                                {
+                                    candidate_clusters[g] = cluster;
+                                    candidates.emplace_back(g);
+                                }
+                            }
+                        }
+                        out.local_indices.emplace_back(vertex_slots[v]);
+                    }
+                    mc.num_faces++;
+                    centroid_sum += centroids[f];
+                };
+
+                addFace(seed);
+                while (mc.num_faces < settings.max_triangles)
+                {
+                    // Prefer faces adding fewer positions, then faces with fewer unassigned neighbors so that no gaps
+                    // are left between clusters, and then the closest ones to keep the cluster round
+                    const Vec3f center = centroid_sum / static_cast<float>(mc.num_faces);
+                    uint32_t best = kInvalidIndex, best_new_vertices = 4, best_live_faces = kInvalidIndex;
+                    float best_distance = std::numeric_limits<float>::max();
+                    for (size_t i = 0; i < candidates.size();)
+                    {
+                        const uint32_t f = candidates[i];
+                        if (assigned[f])
+                        {
+                            candidates[i] = candidates.back();
+                            candidates.pop_back();
+                            continue;
+                        }
+                        i++;
+                        const uint32_t n = numNewVertices(f);
+                        if (mc.num_vertices + n > settings.max_vertices)
+                            continue;
+                        uint32_t live = 0;
+                        for (int k = 0; k < 3; k++)
+                            live += live_faces[triangles[f * 3 + k]];
+                        const float distance = lengthSquared(centroids[f] - center);
+                        if (std::tie(n, live, distance) < std::tie(best_new_vertices, best_live_faces, best_distance))
+                        {
+                            best = f;
+                            best_new_vertices = n;
+                            best_live_faces = live;
+                            best_distance = distance;
+                        }
+                    }
+
+                    if (best == kInvalidIndex)
+                    {
+                        // A cluster without connected faces left (e.g. a gap between clusters, a small part or a triangle soup)
+                        // continues with the closest face around the seed along the curve, unless it's far from the cluster
+                        if (!candidates.empty())
+                            break;
+                        const uint32_t window_begin = seed > settings.max_triangles ? seed - settings.max_triangles : 0;
+                        const uint32_t window_end = std::min(seed + settings.max_triangles, num_faces);
+                        best_distance = 4.0f * lengthSquared(bmax - bmin);
+                        for (uint32_t f = window_begin; f < window_end; f++)
+                        {
+                            const float distance = lengthSquared(centroids[f] - center);
+                            if (!assigned[f] && distance < best_distance && mc.num_vertices + numNewVertices(f) <= settings.max_vertices)
+                            {
+                                best = f;
+                                best_distance = distance;
+                            }
+                        }
+                        if (best == kInvalidIndex)
+                            break;
+                    }
+                    addFace(best);
+                }
+
+                mc.bound = AABB(bmin, bmax);
+                out.clusters.emplace_back(mc);
+            }
+        }
+
+        /**
+         * Gather the elements referenced by the faces into a new buffer keeping their order, and remap the indices.
+         * Indices out of the buffer are left as they are.
+         */
+        template <class T>
+        std::vector<T> extractBuffer(const std::vector<T>& buffer, std::vector<Face>& faces, Vec3i Face::* member)
+        {
+            std::vector<uint32_t> used;
+            for (const Face& face : faces)
+            {
+                const Vec3i& idx = face.*member;
+                for (int k = 0; k < 3; k++)
+                    if (idx[k] >= 0 && static_cast<size_t>(idx[k]) < buffer.size()) used.emplace_back(idx[k]);
+            }
+            std::sort(used.begin(), used.end());
+            used.erase(std::unique(used.begin(), used.end()), used.end());
+
+            for (Face& face : faces)
+            {
+                Vec3i& idx = face.*member;
+                for (int k = 0; k < 3; k++)
+                {
+                    if (idx[k] >= 0 && static_cast<size_t>(idx[k]) < buffer.size())
+                        idx[k] = static_cast<int32_t>(std::lower_bound(used.begin(), used.end(), static_cast<uint32_t>(idx[k])) - used.begin());
+                }
+            }
+
+            std::vector<T> extracted(used.size());
+            for (size_t i = 0; i < used.size(); i++)
+                extracted[i] = buffer[used[i]];
+            return extracted;
+        }
+    } // nonamed namespace
+
+    // ---------------------------------------------------------------------------
+    MeshWeldStats weldVertices(TriangleMesh& mesh, const MeshWeldSettings& settings)
+    {
+        MeshWeldStats stats;
+        stats.num_vertices_before = mesh.numVertices();
+        stats.num_normals_before = mesh.numNormals();
+        stats.num_texcoords_before = mesh.numTexcoords();
+        stats.num_faces_before = mesh.numFaces();
+
+        const uint32_t num_faces = mesh.numFaces();
+        std::vector<Face> faces = mesh.faces();
+
+        // Map every element to the first element of its cluster
+        remapIndices(faces, &Face::vertex_id, findRepresentatives<3>(mesh.vertices(), std::max(settings.position_tolerance, 0.0f)));
+        if (settings.normal_tolerance >= 0.0f)
+            remapIndices(faces, &Face::normal_id, findRepresentatives<3>(mesh.normals(), settings.normal_tolerance));
+        if (settings.texcoord_tolerance >= 0.0f)
+            remapIndices(faces, &Face::texcoord_id, findRepresentatives<2>(mesh.texcoords(), settings.texcoord_tolerance));
+
+        // Remove degenerate and duplicated faces
+        std::vector<uint8_t> keep(num_faces, 1);
+        if (settings.remove_degenerate_faces)
+        {
+            parallelFor(0, num_faces, [&](size_t i)
+            {
+                const Vec3i& v = faces[i].vertex_id;
+                if (v[0] == v[1] || v[1] == v[2] || v[2] == v[0])
+                    keep[i] = 0;
+            });
+        }
+        if (settings.remove_duplicate_faces)
+        {
+            std::vector<Vec3i> keys(num_faces);
+            const uint32_t num_buckets = HashBuckets::bucketCount(num_faces);
+            std::vector<uint32_t> buckets(num_faces);
+            parallelFor(0, num_faces, [&](size_t i)
+            {
+                keys[i] = canonicalTriangle(faces[i].vertex_id);
+                buckets[i] = keep[i] ? hashTriangle(keys[i], num_buckets - 1) : num_buckets;
+            });
+
+            // A face is removed when a preceding face in the bucket has the same key
+            const HashBuckets table(buckets, num_buckets);
+            std::vector<uint8_t> duplicated(num_faces, 0);
+            parallelFor(0, num_faces, [&](size_t i)
+            {
+                if (buckets[i] == num_buckets)
+                    return;
+                for (uint32_t j = table.begin(buckets[i]); j < table.end(buckets[i]) && table.sorted[j] < i; j++)
+                {
+                    if (keys[table.sorted[j]] == keys[i])
+                    {
+                        duplicated[i] = 1;
+                        return;
+                    }
+                }
+            });
+            for (uint32_t i = 0; i < num_faces; i++)
+                keep[i] &= !duplicated[i];
+        }
+
+        // SBT indices are per face only when the number matches; a single index is shared by all faces
+        const std::vector<uint32_t>& sbt_indices = mesh.sbtIndices();
+        const bool per_face_sbt = sbt_indices.size() == num_faces && num_faces > 1;
+
+        std::vector<Face> kept_faces;
+        std::vector<uint32_t> kept_sbt_indices;
+        kept_faces.reserve(num_faces);
+        for (uint32_t i = 0; i < num_faces; i++)
+        {
+            if (!keep[i])
+                continue;
+            kept_faces.emplace_back(faces[i]);
+            if (per_face_sbt)
+                kept_sbt_indices.emplace_back(sbt_indices[i]);
+        }
+
+        std::vector<Vec3f> vertices = compactBuffer(mesh.vertices(), kept_faces, &Face::vertex_id);
+        std::vector<Vec3f> normals = compactBuffer(mesh.normals(), kept_faces, &Face::normal_id);
+        std::vector<Vec2f> texcoords = compactBuffer(mesh.texcoords(), kept_faces, &Face::texcoord_id);
+
+        stats.num_vertices_after = static_cast<uint32_t>(vertices.size());
+        stats.num_normals_after = static_cast<uint32_t>(normals.size());
+        stats.num_texcoords_after = static_cast<uint32_t>(texcoords.size());
+        stats.num_faces_after = static_cast<uint32_t>(kept_faces.size());
+
+        mesh.setVertices(std::move(vertices));
+        mesh.setNormals(std::move(normals));
+        mesh.setTexcoords(std::move(texcoords));
+        mesh.setFaces(std::move(kept_faces));
+        if (per_face_sbt)
+            mesh.setSbtIndices(kept_sbt_indices);
+
+        return stats;
+    }
+
+    // ---------------------------------------------------------------------------
+    void reorderMesh(TriangleMesh& mesh, const MeshReorderSettings& settings)
+    {
+        const uint32_t num_faces = mesh.numFaces();
+        if (num_faces == 0)
+            return;
+
+        const std::vector<Face>& faces = mesh.faces();
+        const std::vector<uint32_t> order = sortFacesAlongCurve(mesh, settings.curve);
+
+        std::vector<Face> sorted_faces(num_faces);
+        parallelFor(0, num_faces, [&](size_t i) { sorted_faces[i] = faces[order[i]]; });
+
+        const std::vector<uint32_t>& sbt_indices = mesh.sbtIndices();
+        if (sbt_indices.size() == num_faces && num_faces > 1)
+        {
+            std::vector<uint32_t> sorted_sbt_indices(num_faces);
+            parallelFor(0, num_faces, [&](size_t i) { sorted_sbt_indices[i] = sbt_indices[order[i]]; });
+            mesh.setSbtIndices(sorted_sbt_indices);
+        }
+
+        if (settings.reorder_vertices)
+        {
+            mesh.setVertices(renumberFirstUse(mesh.vertices(), sorted_faces, &Face::vertex_id));
+            mesh.setNormals(renumberFirstUse(mesh.normals(), sorted_faces, &Face::normal_id));
+            mesh.setTexcoords(renumberFirstUse(mesh.texcoords(), sorted_faces, &Face::texcoord_id));
+        }
+        mesh.setFaces(std::move(sorted_faces));
+    }
+
+    // ---------------------------------------------------------------------------
+    std::shared_ptr<TriangleMesh> simplifyMesh(const TriangleMesh& mesh, uint32_t target_faces, const MeshSimplifySettings& settings)
+    {
+        const uint32_t num_faces = mesh.numFaces();
+        std::vector<Face> faces = mesh.faces();
+        std::vector<uint32_t> face_ids(num_faces);
+        std::iota(face_ids.begin(), face_ids.end(), 0u);
+
+        // Positions are normalized by the diagonal of the bounding box, so errors are relative to the size of the mesh
+        const AABB bound = mesh.bound();
+        const float diagonal = length(bound.max() - bound.min());
+        const float scale = diagonal > 0.0f ? 1.0f / diagonal : 1.0f;
+
+        constexpr uint32_t min_cluster_faces = 16384;
+        uint32_t num_clusters = settings.num_clusters > 0
+            ? settings.num_clusters
+            : std::min(numHostThreads() * 2, num_faces / min_cluster_faces);
+        num_clusters = std::clamp(num_clusters, 1u, std::max(num_faces, 1u));
+
+        if (target_faces < num_faces && num_clusters > 1)
+        {
+            const std::vector<uint32_t> order = sortFacesAlongCurve(mesh, SpaceFillingCurve::Morton);
+            auto clusterBegin = [&](uint32_t c) { return static_cast<uint32_t>(static_cast<uint64_t>(c) * num_faces / num_clusters); };
+
+            // Vertices shared by clusters are locked so that clusters can be simplified independently
+            std::vector<uint32_t> owners(mesh.numVertices(), kInvalidIndex);
+            std::vector<uint8_t> locked(mesh.numVertices(), 0);
+            for (uint32_t c = 0; c < num_clusters; c++)
+            {
+                for (uint32_t i = clusterBegin(c); i < clusterBegin(c + 1); i++)
+                {
+                    for (int k = 0; k < 3; k++)
+                    {
+                        const uint32_t v = static_cast<uint32_t>(faces[order[i]].vertex_id[k]);
+                        if (owners[v] == kInvalidIndex)
+                            owners[v] = c;
+                        else if (owners[v] != c)
+                            locked[v] = 1;
+                    }
+                }
+            }
+
+            std::vector<std::vector<Face>> cluster_faces(num_clusters);
+            std::vector<std::vector<uint32_t>> cluster_face_ids(num_clusters);
+            parallelFor(0, num_clusters, [&](size_t c)
+            {
+                const uint32_t begin = clusterBegin(static_cast<uint32_t>(c));
+                const uint32_t end = clusterBegin(static_cast<uint32_t>(c) + 1);
+                std::vector<Face> local_faces;
+                std::vector<uint32_t> local_face_ids(order.begin() + begin, order.begin() + end);
+                for (uint32_t f : local_face_ids)
+                    local_faces.emplace_back(faces[f]);
+
+                const uint32_t local_target = static_cast<uint32_t>(static_cast<uint64_t>(target_faces) * (end - begin) / num_faces);
+                QuadricSimplifier simplifier(mesh, std::move(local_faces), std::move(local_face_ids), locked, scale, settings);
+                simplifier.simplify(local_target);
+                simplifier.collect(cluster_faces[c], cluster_face_ids[c]);
+            }, 1);
+
+            faces.clear();
+            face_ids.clear();
+            for (uint32_t c = 0; c < num_clusters; c++)
+            {
+                faces.insert(faces.end(), cluster_faces[c].begin(), cluster_faces[c].end());
+                face_ids.insert(face_ids.end(), cluster_face_ids[c].begin(), cluster_face_ids[c].end());
+            }
+        }
+
+        // Collapse the rest across cluster borders. Quadrics are rebuilt from the faces left by the clusters.
+        if (target_faces < static_cast<uint32_t>(faces.size()))
+        {
+            QuadricSimplifier simplifier(mesh, std::move(faces), std::move(face_ids), {}, scale, settings);
+            simplifier.simplify(target_faces);
+            faces.clear();
+            face_ids.clear();
+            simplifier.collect(faces, face_ids);
+        }
+
+        std::vector<uint32_t> sbt_indices = mesh.sbtIndices();
+        if (sbt_indices.size() == num_faces && num_faces > 1)
+        {
+            sbt_indices.resize(face_ids.size());
+            for (size_t i = 0; i < face_ids.size(); i++)
+                sbt_indices[i] = mesh.sbtIndices()[face_ids[i]];
+        }
+
+        std::vector<Vec3f> vertices = compactBuffer(mesh.vertices(), faces, &Face::vertex_id);
+        std::vector<Vec3f> normals = compactBuffer(mesh.normals(), faces, &Face::normal_id);
+        std::vector<Vec2f> texcoords = compactBuffer(mesh.texcoords(), faces, &Face::texcoord_id);
+        return std::make_shared<TriangleMesh>(vertices, faces, normals, texcoords, sbt_indices);
+    }
+
+    // ---------------------------------------------------------------------------
+    std::vector<std::shared_ptr<TriangleMesh>> generateLODs(const TriangleMesh& mesh, const std::vector<uint32_t>& target_faces, const MeshSimplifySettings& settings)
+    {
+        std::vector<std::shared_ptr<TriangleMesh>> lods;
+        const TriangleMesh* previous = &mesh;
+        for (uint32_t target : target_faces)
+        {
+            lods.emplace_back(simplifyMesh(*previous, target, settings));
+            previous = lods.back().get();
+        }
+        return lods;
+    }
+
+    // ---------------------------------------------------------------------------
+    MeshClusters buildMeshClusters(const TriangleMesh& mesh, const MeshClusterSettings& settings)
+    {
+        ASSERT(settings.max_triangles > 0, "A cluster must be able to hold at least one triangle.");
+        ASSERT(settings.max_vertices >= 3 && settings.max_vertices <= 256, "The number of positions in a cluster must be in [3, 256].");
+
+        MeshClusters result;
+        const uint32_t num_faces = mesh.numFaces();
+        if (num_faces == 0)
+            return result;
+
+        const std::vector<uint32_t> order = sortFacesAlongCurve(mesh, SpaceFillingCurve::Hilbert);
+
+        constexpr uint32_t min_range_faces = 65536;
+        const uint32_t num_ranges = std::max(std::min(numHostThreads() * 2, num_faces / min_range_faces), 1u);
+        auto rangeBegin = [&](uint32_t r) { return static_cast<uint32_t>(static_cast<uint64_t>(r) * num_faces / num_ranges); };
+
+        std::vector<MeshClusters> ranges(num_ranges);
+        parallelFor(0, num_ranges, [&](size_t r)
+        {
+            const uint32_t begin = rangeBegin(static_cast<uint32_t>(r));
+            const uint32_t end = rangeBegin(static_cast<uint32_t>(r) + 1);
+            clusterFaces(mesh, order.data() + begin, end - begin, settings, ranges[r]);
+        }, 1);
+
+        if (num_ranges == 1)
+            return std::move(ranges[0]);
+
+        for (MeshClusters& range : ranges)
+        {
+            for (MeshCluster& cluster : range.clusters)
+            {
+                cluster.face_offset += static_cast<uint32_t>(result.face_ids.size());
+                cluster.vertex_offset += static_cast<uint32_t>(result.vertex_ids.size());
+            }
+            result.clusters.insert(result.clusters.end(), range.clusters.begin(), range.clusters.end());
+            result.face_ids.insert(result.face_ids.end(), range.face_ids.begin(), range.face_ids.end());
+            result.vertex_ids.insert(result.vertex_ids.end(), range.vertex_ids.begin(), range.vertex_ids.end());
+            result.local_indices.insert(result.local_indices.end(), range.local_indices.begin(), range.local_indices.end());
+            range = MeshClusters{};
+        }
+        return result;
+    }
+
+    // ---------------------------------------------------------------------------
+    std::vector<std::shared_ptr<TriangleMesh>> splitMeshByClusters(const TriangleMesh& mesh, const MeshClusters& clusters, uint32_t max_faces)
+    {
+        // Consecutive clusters are grouped until the next one doesn't fit
+        std::vector<uint32_t> group_begins;
+        uint32_t group_faces = 0;
+        for (uint32_t c = 0; c < static_cast<uint32_t>(clusters.clusters.size()); c++)
+        {
+            const uint32_t n = clusters.clusters[c].num_faces;
+            if (group_begins.empty() || group_faces + n > max_faces)
+            {
+                group_begins.emplace_back(c);
+                group_faces = 0;
+            }
+            group_faces += n;
+        }
+        const uint32_t num_groups = static_cast<uint32_t>(group_begins.size());
+        group_begins.emplace_back(static_cast<uint32_t>(clusters.clusters.size()));
+
+        const std::vector<uint32_t>& sbt_indices = mesh.sbtIndices();
+        const bool per_face_sbt = sbt_indices.size() == mesh.numFaces() && mesh.numFaces() > 1;
+
+        std::vector<std::shared_ptr<TriangleMesh>> parts(num_groups);
+        parallelFor(0, num_groups, [&](size_t g)
+        {
+            // Faces of consecutive clusters are contiguous in face_ids
+            const MeshCluster& first = clusters.clusters[group_begins[g]];
+            const MeshCluster& last = clusters.clusters[group_begins[g + 1] - 1];
+            std::vector<Face> faces;
+            std::vector<uint32_t> part_sbt_indices;
+            for (uint32_t i = first.face_offset; i < last.face_offset + last.num_faces; i++)
+            {
+                const uint32_t f = clusters.face_ids[i];
+                faces.emplace_back(mesh.faceAt(f));
+                if (per_face_sbt)
+                    part_sbt_indices.emplace_back(sbt_indices[f]);
+            }
+            if (!per_face_sbt)
+                part_sbt_indices = sbt_indices;
+
+            std::vector<Vec3f> vertices = extractBuffer(mesh.vertices(), faces, &Face::vertex_id);
+            std::vector<Vec3f> normals = extractBuffer(mesh.normals(), faces, &Face::normal_id);
+            std::vector<Vec2f> texcoords = extractBuffer(mesh.texcoords(), faces, &Face::texcoord_id);
+            parts[g] = std::make_shared<TriangleMesh>(vertices, faces, normals, texcoords, part_sbt_indices);
+        }, 1);
+        return parts;
+    }
+
+} // namespace prayground
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <prayground/shape/trianglemesh.h>
+#include <memory>
+
+namespace prayground {
+
+    /**
+     * @brief
+     * Processing passes that rewrite the host buffers of TriangleMesh.
+     * The number and order of vertices/faces are changed, so they should be applied before
+     * copyToDevice() and building GAS (or the GAS must be rebuilt, not updated, after them).
+     */
+
+    // ---------------------------------------------------------------------------
+    struct MeshWeldSettings {
+        // Vertices closer than the tolerance are merged. 0 merges only vertices at the identical position.
+        float position_tolerance = 0.0f;
+        // Normals and texture coordinates are merged in the same way. Negative values keep them as they are.
+        float normal_tolerance = 0.0f;
+        float texcoord_tolerance = 0.0f;
+        // Remove faces that have collapsed to a line or a point after welding
+        bool remove_degenerate_faces = true;
+        // Remove faces referencing the same vertices in the same winding order as a preceding face
+        bool remove_duplicate_faces = true;
+    };
+
+    struct MeshWeldStats {
+        uint32_t num_vertices_before;
+        uint32_t num_vertices_after;
+        uint32_t num_normals_before;
+        uint32_t num_normals_after;
+        uint32_t num_texcoords_before;
+        uint32_t num_texcoords_after;
+        uint32_t num_faces_before;
+        uint32_t num_faces_after;
+    };
+
+    /**
+     * @brief Weld coincident vertices of the mesh with a spatial hash, and compact the buffers.
+     * Face indices of the position/normal/texcoord streams are remapped to the welded buffers, unused
+     * elements are removed while keeping the order of the others, and per-face SBT indices follow
+     * removed faces. Each welded vertex takes the value of the first vertex in the original order.
+     */
+    MeshWeldStats weldVertices(TriangleMesh& mesh, const MeshWeldSettings& settings = {});
+
+    // ---------------------------------------------------------------------------
+    enum class SpaceFillingCurve {
+        Morton,
+        Hilbert
+    };
+
+    struct MeshReorderSettings {
+        // Curve along which triangles are sorted by their centroids
+        SpaceFillingCurve curve = SpaceFillingCurve::Hilbert;
+        // Renumber positions, normals and texcoords in the order they are first referenced by faces
+        bool reorder_vertices = true;
+    };
+
+    /**
+     * @brief Reorder faces along a space-filling curve for the locality of GAS builds and attribute fetches.
+     * Per-face SBT indices are permuted together with faces, so every face keeps its material.
+     * Vertices not referenced by any face are kept after the referenced ones.
+     * @note Face-dependent data built before (e.g. opacity micromaps) must be rebuilt.
+     */
+    void reorderMesh(TriangleMesh& mesh, const MeshReorderSettings& settings = {});
+
+    // ---------------------------------------------------------------------------
+    struct MeshSimplifySettings {
+        // Stop collapsing when the error exceeds this fraction of the bounding box diagonal. 0 means no limit.
+        float max_error = 0.0f;
+        // Weights of the normal and texcoord differences added to the geometric error
+        float normal_weight = 0.5f;
+        float texcoord_weight = 1.0f;
+        // Keep every vertex on open borders in place. Otherwise they only slide along the border.
+        bool lock_border = false;
+        // Number of clusters simplified in parallel. 0 chooses it from the number of faces and host threads.
+        uint32_t num_clusters = 0;
+    };
+
+    /**
+     * @brief Simplify the mesh toward the target number of faces with quadric error metrics (Garland and Heckbert 1997).
+     * Edges are collapsed to one of their vertices, so the simplified mesh references a subset of the
+     * original positions, normals and texcoords. Vertices on normal/texcoord seams, non-manifold edges
+     * and bowties are kept, and per-face SBT indices follow the faces.
+     * Faces are split into spatially coherent clusters along a Morton curve, which are simplified in
+     * parallel with the vertices between clusters locked, and the rest is simplified over the whole mesh.
+     * @note The mesh should be welded (see weldVertices()), since unconnected triangles can't be collapsed.
+     * The result may have more faces than the target when no more valid collapses are left.
+     */
+    std::shared_ptr<TriangleMesh> simplifyMesh(const TriangleMesh& mesh, uint32_t target_faces, const MeshSimplifySettings& settings = {});
+
+    /**
+     * @brief Generate a chain of LODs, each simplified from the previous one.
+     * @param target_faces Number of faces of each LOD in descending order
+     */
+    std::vector<std::shared_ptr<TriangleMesh>> generateLODs(const TriangleMesh& mesh, const std::vector<uint32_t>& target_faces, const MeshSimplifySettings& settings = {});
+
+    // ---------------------------------------------------------------------------
+    struct MeshClusterSettings {
+        // Upper limits of the number of triangles and positions in a cluster. max_vertices must be 256 or less.
+        uint32_t max_triangles = 124;
+        uint32_t max_vertices = 64;
+    };
+
+    struct MeshCluster {
+        // Range of faces in MeshClusters::face_ids, and of their local triangles in MeshClusters::local_indices
+        uint32_t face_offset;
+        uint32_t num_faces;
+        // Range of positions in MeshClusters::vertex_ids
+        uint32_t vertex_offset;
+        uint32_t num_vertices;
+        // Bounds of the positions of the cluster
+        AABB bound;
+    };
+
+    struct MeshClusters {
+        std::vector<MeshCluster> clusters;
+        // Indices of the original faces, grouped by clusters
+        std::vector<uint32_t> face_ids;
+        // Indices of the original positions referenced by each cluster
+        std::vector<uint32_t> vertex_ids;
+        // Three indices per face into the range of vertex_ids of its cluster
+        std::vector<uint8_t> local_indices;
+    };
+
+    /**
+     * @brief Partition faces into spatially coherent clusters with bounded numbers of triangles and positions.
+     * Each cluster is grown from a face next to the previous one (or the first unassigned face along a Hilbert curve),
+     * adding connected faces that introduce the fewest new positions, leave the fewest gaps and are the closest
+     * to the cluster's center.
+     * Consecutive clusters are close to each other, so any range of them forms a compact part of the mesh.
+     * Large meshes are split into ranges along the curve, which are clustered in parallel.
+     */
+    MeshClusters buildMeshClusters(const TriangleMesh& mesh, const MeshClusterSettings& settings = {});
+
+    /**
+     * @brief Split the mesh into parts of consecutive clusters with up to max_faces faces (or one cluster if it's larger).
+     * Each part has its own compacted positions, normals and texcoords, and keeps per-face SBT indices,
+     * so it can be built as a separate GAS (see Scene::addClusteredObject()).
+     */
+    std::vector<std::shared_ptr<TriangleMesh>> splitMeshByClusters(const TriangleMesh& mesh, const MeshClusters& clusters, uint32_t max_faces);
+
+} // namespace prayground
@@ -1,4 +1,5 @@
 #include "pcd.h"
+#include <prayground/core/bounds.h>
 
 namespace prayground {
 
@@ -86,13 +87,7 @@ namespace prayground {
     // ------------------------------------------------------------------
     AABB PointCloud::bound() const
     {
-        /* NOTE: Should I aggreagte all points into single AABB? */
-        AABB aabb;
-        for (uint32_t i = 0; i < m_num_points; i++) {
-            auto p = m_points.get()[i];
-            aabb = AABB::merge(aabb, AABB(p.point - p.radius, p.point + p.radius));
-        }
-        return aabb;
+        return boundSpheres(m_points.get(), m_num_points, &Data::point, &Data::radius);
     }
 
     // ------------------------------------------------------------------
@@ -1,4 +1,5 @@
 #include "primitivemesh.h"
+#include <prayground/core/parallel.h>
 #include <algorithm>
 
 namespace prayground {
@@ -14,11 +15,73 @@ namespace prayground {
             return Vec2f(u, v);
         }
 
+        // Number of rows processed by a task, so that each task generates at least a few thousand faces
+        size_t rowGrain(uint32_t faces_per_row)
+        {
+            return std::max<size_t>(1, 4096 / std::max(faces_per_row, 1u));
+        }
+
+        /**
+         * Open addressing hash table from an undirected edge to the index of its midpoint vertex.
+         * The capacity is fixed to twice the expected number of edges, so it never rehashes.
+         */
+        class EdgeMidpointTable {
+        public:
+            explicit EdgeMidpointTable(size_t num_edges)
+            {
+                size_t capacity = 64;
+                while (capacity < num_edges * 2)
+                    capacity <<= 1;
+                m_keys.assign(capacity, kEmpty);
+                m_values.resize(capacity);
+                m_mask = capacity - 1;
+            }
+
+            // Return the midpoint of the edge between a and b. A new edge takes `next` and increments it.
+            int32_t findOrAdd(int32_t a, int32_t b, int32_t& next)
+            {
+                const uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | static_cast<uint32_t>(std::max(a, b));
+                size_t slot = static_cast<size_t>((key * 0x9e3779b97f4a7c15ull) >> 32) & m_mask;
+                while (m_keys[slot] != key)
+                {
+                    if (m_keys[slot] == kEmpty)
+                    {
+                        m_keys[slot] = key;
+                        m_values[slot] = next;
+                        return next++;
+                    }
+                    slot = (slot + 1) & m_mask;
+                }
+                return m_values[slot];
+            }
+        private:
+            static constexpr uint64_t kEmpty = ~0ull;
+
+            std::vector<uint64_t> m_keys;
+            std::vector<int32_t> m_values;
+            size_t m_mask;
+        };
+
+        // One flat normal per face facing outward, which is referenced by all corners of the face
+        void setFaceNormals(const std::vector<Vec3f>& vertices, std::vector<Face>& faces, std::vector<Vec3f>& normals)
+        {
+            normals.resize(faces.size());
+            parallelFor(0, faces.size(), [&](size_t i)
+            {
+                Face& f = faces[i];
+                const Vec3f& v0 = vertices[f.vertex_id.x()];
+                const Vec3f& v1 = vertices[f.vertex_id.y()];
+                const Vec3f& v2 = vertices[f.vertex_id.z()];
+                normals[i] = normalize(cross(v2 - v0, v1 - v0));
+                f.normal_id = Vec3i(static_cast<int32_t>(i));
+            }, 4096);
+        }
+
     } // nonamed namespace
 
     // ---------------------------------------------------------
     IcoSphereMesh::IcoSphereMesh(float radius, int level)
-    : m_radius(radius), m_level(level)
+    : m_radius(radius), m_level(0)
     {
         ASSERT(level >= 0 && level < 20, "The level of subdivision must be 0 to 19.");
 
@@ -35,7 +98,6 @@ namespace prayground {
         // Top vertex
         m_vertices[0] = Vec3f(0, radius, 0);
         m_texcoords[0] = Vec2f(0, 0);
-        m_indices.emplace(std::make_pair<float, float>(0, 0), 0);
 
         // 10 vertices at 2nd and 3rd rows
         for (int32_t i = 1; i <= 5; i++)
@@ -50,27 +112,22 @@ namespace prayground {
             const Vec3f v1(xz * cosf(h_angle2), -y, xz * sinf(h_angle2));
             m_vertices[i0] = v0;
             m_vertices[i1] = v1;
-            const Vec2f uv0 = getSphereUV(normalize(v0));
-            const Vec2f uv1 = getSphereUV(normalize(v1));
-            std::pair<float, float> key0(uv0.x(), uv0.y());
-            std::pair<float, float> key1(uv1.x(), uv1.y());
-            m_indices.emplace(key0, i0);
-            m_indices.emplace(key1, i1);
-            m_texcoords[i0] = uv0;
-            m_texcoords[i1] = uv1;
+            m_texcoords[i0] = getSphereUV(normalize(v0));
+            m_texcoords[i1] = getSphereUV(normalize(v1));
 
+            // Texcoords are stored per vertex, so they share the indices with vertices
             // Top face
-            Face f0{ {0, i0, i0 % 5 + 1}, {0, 0, 0}, {0, i0, i0 % 5 + 1} };
+            const Vec3i f0(0, i0, i0 % 5 + 1);
             // Middle face
-            Face f1{ {i0, i1, i0 % 5 + 1}, {0, 0, 0}, {i0, i1, i1 % 5 + 1} };
-            Face f2{ {i1, i1 % 5 + 6, i0 % 5 + 1}, {0, 0, 0}, {i1, i1 % 5 + 6, i0 % 5 + 1} };
+            const Vec3i f1(i0, i1, i0 % 5 + 1);
+            const Vec3i f2(i1, i1 % 5 + 6, i0 % 5 + 1);
             // Bottom face
-            Face f3{ {i1, 11, i1 % 5 + 6}, {0, 0, 0}, {i1, 11, i1 % 5 + 6} };
+            const Vec3i f3(i1, 11, i1 % 5 + 6);
 
-            m_faces[i - 1] = f0;
-            m_faces[5 + (i - 1) * 2 + 0] = f1;
-            m_faces[5 + (i - 1) * 2 + 1] = f2;
-            m_faces[15 + (i - 1)] = f3;
+            m_faces[i - 1] = Face{ f0, f0, f0 };
+            m_faces[5 + (i - 1) * 2 + 0] = Face{ f1, f1, f1 };
+            m_faces[5 + (i - 1) * 2 + 1] = Face{ f2, f2, f2 };
+            m_faces[15 + (i - 1)] = Face{ f3, f3, f3 };
 
             // Move to next angles
             h_angle1 += H_ANGLE;
@@ -80,113 +137,92 @@ namespace prayground {
         // Bottom vertex
         m_vertices[11] = Vec3f(0, -radius, 0);
         m_texcoords[11] = Vec2f(0, 1);
-        m_indices.emplace(std::make_pair<float, float>(0, 1), 11);
 
-        int32_t n_id = 0;
-        for (auto& f : m_faces)
-        {
-            const Vec3f& v0 = m_vertices[f.vertex_id.x()];
-            const Vec3f& v1 = m_vertices[f.vertex_id.y()];
-            const Vec3f& v2 = m_vertices[f.vertex_id.z()];
-
-            const Vec3f n = normalize(cross(v1 - v0, v2 - v0));
-
-            m_normals.emplace_back(n);
-            m_normals.emplace_back(n);
-            m_normals.emplace_back(n);
-
-            f.normal_id = Vec3i(n_id, n_id + 1, n_id + 2);
-            n_id += 3;
-        }
-
-        subdivide(m_level);
+        subdivide(level);
     }
 
-    // Subdivide each faces to 4 faces
+    // Subdivide each faces to 4 faces, `level` times
     // Prohibit m_level(current level) + level exceeds 20 due to decline of performance
-    void IcoSphereMesh::subdivide(const float level)
+    void IcoSphereMesh::subdivide(int level)
     {
         PG_LOG("Processing subdivision of Icosphere (subdivision level =", level, ") ...");
 
         const int32_t total_level = m_level + level;
-        ASSERT(total_level >= 0 && total_level < 20, "The level of subdivision must be 0 to 19.");
-
-        std::vector<Face> temp_faces;
-        int32_t index = 0;
+        ASSERT(level >= 0 && total_level < 20, "The level of subdivision must be 0 to 19.");
 
-        for (int32_t i = 1; i <= total_level; i++)
+        for (int32_t l = 0; l < level; l++)
         {
-            // Copy previous vertices/faces and clear it
-            temp_faces = m_faces;
-            m_faces.clear();
-            index = 0;
-
-            // Perform subdivision for each triangle
-            for (int32_t j = 0; j < temp_faces.size(); j++)
+            const size_t num_faces = m_faces.size();
+            const int32_t num_vertices = static_cast<int32_t>(m_vertices.size());
+
+            // Number midpoints of edges in the order of faces. Only this pass is serial, and it just hashes indices.
+            std::vector<Vec3i> midpoints(num_faces);
+            std::vector<std::pair<int32_t, int32_t>> edges;
+            edges.reserve(num_faces * 3 / 2);
+            EdgeMidpointTable table(num_faces * 3 / 2);
+            int32_t next = num_vertices;
+            for (size_t j = 0; j < num_faces; j++)
             {
-                const int32_t i0 = temp_faces[j].vertex_id.x();
-                const int32_t i1 = temp_faces[j].vertex_id.y();
-                const int32_t i2 = temp_faces[j].vertex_id.z();
-                const Vec3f v0 = m_vertices[i0];
-                const Vec3f v1 = m_vertices[i1];
-                const Vec3f v2 = m_vertices[i2];
-
-                /**
-                 * Add 3 vertices between each edges, 4 triangle faces 
-                 * 
-                 *              v0 *
-                 *                / \
-                 *        new_v0 * - * new_v2
-                 *              / \ / \
-                 *          v1 * - * - * v2
-                 *                 new_v1
-                 */
-
-                Vec3f new_v0 = lerp(v0, v1, 0.5f);
-                Vec3f new_v1 = lerp(v1, v2, 0.5f);
-                Vec3f new_v2 = lerp(v2, v0, 0.5f);
-                new_v0 = normalize(new_v0) * m_radius;
-                new_v1 = normalize(new_v1) * m_radius;
-                new_v2 = normalize(new_v2) * m_radius;
-                Vec2f new_uv0 = getSphereUV(new_v0 * (1.0f / m_radius));
-                Vec2f new_uv1 = getSphereUV(new_v1 * (1.0f / m_radius));
-                Vec2f new_uv2 = getSphereUV(new_v2 * (1.0f / m_radius));
-
-                int32_t new_i0 = findOrAddVertex(new_v0, new_uv0);
-                int32_t new_i1 = findOrAddVertex(new_v1, new_uv1);
-                int32_t new_i2 = findOrAddVertex(new_v2, new_uv2);
-
-                Face f0{ {i0, new_i0, new_i2}, {0, 0, 0}, {i0, new_i0, new_i2} };
-                Face f1{ {new_i0, i1, new_i1}, {0, 0, 0}, {new_i0, i1, new_i1} };
-                Face f2{ {new_i0, new_i1, new_i2}, {0, 0, 0}, {new_i0, new_i1, new_i2} };
-                Face f3{ {new_i2, new_i1, i2}, {0, 0, 0}, {new_i2, new_i1, i2} };
-
-                addFace(f0); addFace(f1); addFace(f2); addFace(f3);
+                const Vec3i& idx = m_faces[j].vertex_id;
+                for (int k = 0; k < 3; k++)
+                {
+                    const int32_t a = idx[k], b = idx[(k + 1) % 3];
+                    midpoints[j][k] = table.findOrAdd(a, b, next);
+                    if (static_cast<size_t>(midpoints[j][k] - num_vertices) == edges.size())
+                        edges.emplace_back(a, b);
+                }
             }
-        }
-
-        m_normals.clear();
-        int32_t n_id = 0;
-        for (auto& f : m_faces)
-        {
-            const Vec3f& v0 = m_vertices[f.vertex_id.x()];
-            const Vec3f& v1 = m_vertices[f.vertex_id.y()];
-            const Vec3f& v2 = m_vertices[f.vertex_id.z()];
-
-            const Vec3f n = normalize(cross(v2 - v0, v1 - v0));
-
-            addNormal(n);
-            addNormal(n);
-            addNormal(n);
 
-            f.normal_id = Vec3i(n_id, n_id + 1, n_id + 2);
-            n_id += 3;
+            // Midpoints are projected onto the sphere
+            m_vertices.resize(next);
+            m_texcoords.resize(next);
+            parallelFor(0, edges.size(), [&](size_t e)
+            {
+                const auto [a, b] = edges[e];
+                const Vec3f n = normalize(lerp(m_vertices[a], m_vertices[b], 0.5f));
+                m_vertices[num_vertices + e] = n * m_radius;
+                m_texcoords[num_vertices + e] = getSphereUV(n);
+            }, 4096);
+
+            /**
+             * Add 3 vertices between each edges, 4 triangle faces
+             *
+             *              v0 *
+             *                / \
+             *        new_v0 * - * new_v2
+             *              / \ / \
+             *          v1 * - * - * v2
+             *                 new_v1
+             */
+            std::vector<Face> faces(num_faces * 4);
+            parallelFor(0, num_faces, [&](size_t j)
+            {
+                const int32_t i0 = m_faces[j].vertex_id.x();
+                const int32_t i1 = m_faces[j].vertex_id.y();
+                const int32_t i2 = m_faces[j].vertex_id.z();
+                const int32_t new_i0 = midpoints[j][0];
+                const int32_t new_i1 = midpoints[j][1];
+                const int32_t new_i2 = midpoints[j][2];
+
+                const Vec3i f0(i0, new_i0, new_i2);
+                const Vec3i f1(new_i0, i1, new_i1);
+                const Vec3i f2(new_i0, new_i1, new_i2);
+                const Vec3i f3(new_i2, new_i1, i2);
+                faces[j * 4 + 0] = Face{ f0, f0, f0 };
+                faces[j * 4 + 1] = Face{ f1, f1, f1 };
+                faces[j * 4 + 2] = Face{ f2, f2, f2 };
+                faces[j * 4 + 3] = Face{ f3, f3, f3 };
+            }, 4096);
+            m_faces = std::move(faces);
         }
+
+        m_level = total_level;
+        setFaceNormals(m_vertices, m_faces, m_normals);
     }
 
     // ---------------------------------------------------------
     /**
-     * @note 
+     * @note
      * Split shared vertices to independent vertices
      */
     void IcoSphereMesh::splitVertices()
@@ -194,57 +230,50 @@ namespace prayground {
         UNIMPLEMENTED();
     }
 
-    int32_t IcoSphereMesh::findOrAddVertex(const Vec3f& v, const Vec2f& texcoord)
-    {
-        std::pair<float, float> key(texcoord.x(), texcoord.y());
-        auto itr = m_indices.find(key);
-        // Found the same vertex and return it's index
-        if (itr != m_indices.end())
-            return itr->second;
-        // There has been no same vertex yet, and add vertex/texcoord
-        else
-        {
-            int32_t index = static_cast<int32_t>(m_indices.size());
-            addVertex(v);
-            addTexcoord(texcoord);
-            m_indices.emplace(key, index);
-            return index;
-        }
-    }
-
     // ---------------------------------------------------------
     UVSphereMesh::UVSphereMesh(float radius, const Vec2ui& resolution)
         : m_radius(radius), m_resolution(resolution)
     {
-        const int32_t total_num_vertices = resolution.x() * (resolution.y() - 1) + 2;
+        ASSERT(resolution.x() >= 3 && resolution.y() >= 2, "The resolution of UV sphere must be at least (3, 2).");
 
-        // Add top vertex
-        addVertex(0, radius, 0);
-        addTexcoord(0, 0);
+        const uint32_t res_u = resolution.x();
+        const uint32_t res_v = resolution.y();
+        const int32_t total_num_vertices = res_u * (res_v - 1) + 2;
 
-        // Add vertices on side
-        for (uint32_t v = 1; v < resolution.y(); v++)
+        m_vertices.resize(total_num_vertices);
+        m_texcoords.resize(total_num_vertices);
+
+        // Top vertex
+        m_vertices[0] = Vec3f(0, radius, 0);
+        m_texcoords[0] = Vec2f(0, 0);
+
+        // Vertices on side
+        parallelFor(1, res_v, [&](size_t v)
         {
-            for (uint32_t u = 0; u < resolution.x(); u++)
+            for (uint32_t u = 0; u < res_u; u++)
             {
-                const float phi = (math::pi / 2.0f) - ((float)v / resolution.y()) * math::pi;
-                const float theta = math::two_pi * ((float)u / resolution.x());
+                const float phi = (math::pi / 2.0f) - ((float)v / res_v) * math::pi;
+                const float theta = math::two_pi * ((float)u / res_u);
                 const float x = cosf(phi) * cosf(theta);
                 const float y = sinf(phi);
                 const float z = cosf(phi) * sinf(theta);
-                Vec3f vertex = Vec3f(x, y, z) * radius;
-                addVertex(vertex);
-                addTexcoord(getSphereUV(normalize(vertex)));
+                const Vec3f vertex = Vec3f(x, y, z) * radius;
+                const size_t i = (v - 1) * res_u + u + 1;
+                m_vertices[i] = vertex;
+                m_texcoords[i] = getSphereUV(normalize(vertex));
             }
-        }
+        }, rowGrain(res_u));
 
-        // Add bottom vertex
-        addVertex(0, -radius, 0);
-        addTexcoord(0, 1);
+        // Bottom vertex
+        m_vertices[total_num_vertices - 1] = Vec3f(0, -radius, 0);
+        m_texcoords[total_num_vertices - 1] = Vec2f(0, 1);
 
-        for (uint32_t v = 0; v < resolution.y(); v++)
+        // Rows at the poles have a triangle per segment, and the others have two
+        m_faces.resize(2 * res_u * (res_v - 1));
+        parallelFor(0, res_v, [&](size_t v)
         {
-            for (uint32_t u = 0; u < resolution.x(); u++)
+            size_t f = v == 0 ? 0 : res_u + (v - 1) * 2 * res_u;
+            for (uint32_t u = 0; u < res_u; u++)
             {
                 if (v == 0)
                 {
@@ -254,26 +283,10 @@ namespace prayground {
                     // ... * - * ...
                     //    i1   i2
 
-                    const int32_t i0 = 0;
-                    const int32_t i1 = u + 1;
-                    const int32_t i2 = (u + 1) % resolution.x() + 1;
-
-                    const Vec3f v0 = vertexAt(i0);
-                    const Vec3f v1 = vertexAt(i1);
-                    const Vec3f v2 = vertexAt(i2);
-
-                    const Vec3f n = normalize(cross(v2 - v0, v1 - v0));
-
-                    // Get base index of normal
-                    const int32_t n_base_idx = numNormals();
-                    // Add three normals for vertices that constructs triangle face
-                    for (int i = 0; i < 3; i++)
-                        addNormal(n);
-
-                    const Face f{ {i0, i1, i2}, {n_base_idx, n_base_idx + 1, n_base_idx + 2}, {i0, i1, i2} };
-                    addFace(f);
+                    const Vec3i idx(0, u + 1, (u + 1) % res_u + 1);
+                    m_faces[f++] = Face{ idx, idx, idx };
                 }
-                else if (v == resolution.y() - 1)
+                else if (v == res_v - 1)
                 {
                     //      i0   i2
                     // ... - * - * - ...
@@ -281,62 +294,31 @@ namespace prayground {
                     //         * <- bottom vertex
                     //         i1
 
-                    const int32_t i0 = (v - 1) * resolution.x() + u + 1;
-                    const int32_t i1 = total_num_vertices - 1;
-                    const int32_t i2 = (v - 1) * resolution.x() + (u + 1) % resolution.x() + 1;
-
-                    const Vec3f v0 = vertexAt(i0);
-                    const Vec3f v1 = vertexAt(i1);
-                    const Vec3f v2 = vertexAt(i2);
-
-                    const Vec3f n = normalize(cross(v2 - v0, v1 - v0));
-
-                    // Get base index of normal
-                    const int32_t n_base_idx = numNormals();
-                    // Add three normals for vertices that construct triangle face
-                    for (int i = 0; i < 3; i++)
-                        addNormal(n);
-
-                    const Face f{ {i0, i1, i2}, {n_base_idx, n_base_idx + 1, n_base_idx + 2}, {i0, i1, i2} };
-                    addFace(f);
+                    const Vec3i idx((v - 1) * res_u + u + 1, total_num_vertices - 1, (v - 1) * res_u + (u + 1) % res_u + 1);
+                    m_faces[f++] = Face{ idx, idx, idx };
                 }
                 else
                 {
                     //      i0   i1
                     // ... - * - * - ...
-                    //       | \ | 
-                    // ... - * - * - ... 
+                    //       | \ |
+                    // ... - * - * - ...
                     //      i2   i3
 
-                    const int32_t i0 = (v - 1) * resolution.x() + u + 1;
-                    const int32_t i1 = (v - 1) * resolution.x() + (u + 1) % resolution.x() + 1;
-                    const int32_t i2 = v * resolution.x() + u + 1;
-                    const int32_t i3 = v * resolution.x() + (u + 1) % resolution.x() + 1;
-
-                    const Vec3f v0 = vertexAt(i0);
-                    const Vec3f v1 = vertexAt(i1);
-                    const Vec3f v2 = vertexAt(i2);
-                    const Vec3f v3 = vertexAt(i3);
+                    const int32_t i0 = (v - 1) * res_u + u + 1;
+                    const int32_t i1 = (v - 1) * res_u + (u + 1) % res_u + 1;
+                    const int32_t i2 = v * res_u + u + 1;
+                    const int32_t i3 = v * res_u + (u + 1) % res_u + 1;
 
-                    const Vec3f n0 = normalize(cross(v3 - v0, v2 - v0));
-                    const Vec3f n1 = normalize(cross(v1 - v0, v3 - v0));
-
-                    const int32_t n_base_idx = numNormals();
-                    // Add three normals for vertices that construct triangle face
-                    for (int i = 0; i < 3; i++)
-                        addNormal(n0);
-                    for (int i = 0; i < 3; i++)
-                        addNormal(n1);
-
-                    Face f0{ {i0, i2, i3}, {n_base_idx, n_base_idx + 1, n_base_idx + 2}, {i0, i2, i3} };
-                    Face f1{ {i0, i3, i1}, {n_base_idx + 3, n_base_idx + 4, n_base_idx + 5}, {i0, i3, i1} };
-
-                    addFace(f0); addFace(f1);
+                    const Vec3i idx0(i0, i2, i3);
+                    const Vec3i idx1(i0, i3, i1);
+                    m_faces[f++] = Face{ idx0, idx0, idx0 };
+                    m_faces[f++] = Face{ idx1, idx1, idx1 };
                 }
             }
-        }
+        }, rowGrain(2 * res_u));
 
-        PG_LOG("Dummy");
+        setFaceNormals(m_vertices, m_faces, m_normals);
     }
 
     float UVSphereMesh::radius() const
@@ -363,96 +345,82 @@ namespace prayground {
     CylinderMesh::CylinderMesh(float radius, float height, const Vec2ui& resolution)
         : m_radius(radius), m_height(height), m_resolution(resolution)
     {
-        const Vec3f top_center_vertex(0.0f, height / 2.0f, 0.0f);
-        const Vec3f bottom_center_vertex(0.0f, -height / 2.0f, 0.0f);
-        const int32_t total_num_vertices = m_resolution.x() * (m_resolution.y() + 1) + 2;
-
-        addVertex(top_center_vertex);
-        addTexcoord(Vec2f(0, 0));
-        addNormal(Vec3f(0, 1, 0));
+        ASSERT(resolution.x() >= 3 && resolution.y() >= 1, "The resolution of cylinder must be at least (3, 1).");
 
-        int32_t num_top_vertices = m_resolution.x() + 1;
+        const uint32_t res_r = m_resolution.x();
+        const uint32_t res_h = m_resolution.y();
+        const int32_t total_num_vertices = res_r * (res_h + 1) + 2;
 
-        // Add faces for top surface
-        for (uint32_t r = 0; r < m_resolution.x(); r++)
-        {
-            int32_t i1 = r + 1;
-            int32_t i2 = (r + 1) % m_resolution.x() + 1;
-            Face f{{0, i1, i2}, {0, i1, i2}, {0, i1, i2}};
-            addFace(f);
-            addNormal(Vec3f(0, 1, 0));
-        }
+        m_vertices.resize(total_num_vertices);
+        m_texcoords.resize(total_num_vertices);
 
-        // Add vertices/texcoords on the side
-        for (uint32_t h = 0; h <= m_resolution.y(); h++)
+        // Center vertices of the caps, followed by rings of the side from the top
+        m_vertices[0] = Vec3f(0.0f, height / 2.0f, 0.0f);
+        m_texcoords[0] = Vec2f(0, 0);
+        m_vertices[total_num_vertices - 1] = Vec3f(0.0f, -height / 2.0f, 0.0f);
+        m_texcoords[total_num_vertices - 1] = Vec2f(0.0f);
+        parallelFor(0, res_h + 1, [&](size_t h)
         {
-            for (uint32_t r = 0; r < m_resolution.x(); r++)
+            for (uint32_t r = 0; r < res_r; r++)
             {
-                float x = sinf(((float)r / m_resolution.x()) * math::two_pi) * radius;
-                float z = cosf(((float)r / m_resolution.x()) * math::two_pi) * radius;
-                float y = height / 2.0f - ((float)h / m_resolution.y()) * height;
-                // Side faces 
-                Vec3f v(x, y, z);
-                addVertex(v);
-                addTexcoord(Vec2f((float)r / m_resolution.x(), (float)h / m_resolution.y()));
+                const float x = sinf(((float)r / res_r) * math::two_pi) * radius;
+                const float z = cosf(((float)r / res_r) * math::two_pi) * radius;
+                const float y = height / 2.0f - ((float)h / res_h) * height;
+                m_vertices[h * res_r + r + 1] = Vec3f(x, y, z);
+                m_texcoords[h * res_r + r + 1] = Vec2f((float)r / res_r, (float)h / res_h);
             }
+        }, rowGrain(res_r));
+
+        // Normals of the caps come first, followed by a flat normal per side face
+        constexpr int32_t top_normal = 0;
+        constexpr int32_t bottom_normal = 1;
+        constexpr int32_t side_normal_base = 2;
+        const uint32_t num_side_faces = 2 * res_r * res_h;
+        m_normals.resize(side_normal_base + num_side_faces);
+        m_normals[top_normal] = Vec3f(0, 1, 0);
+        m_normals[bottom_normal] = Vec3f(0, -1, 0);
+
+        // Top faces, side faces and bottom faces
+        m_faces.resize(num_side_faces + 2 * res_r);
+        const int32_t bottom_ring = res_r * res_h + 1;
+        for (uint32_t r = 0; r < res_r; r++)
+        {
+            const Vec3i top(0, r + 1, (r + 1) % res_r + 1);
+            m_faces[r] = Face{ top, Vec3i(top_normal), top };
+            const Vec3i bottom(total_num_vertices - 1, bottom_ring + r, bottom_ring + (r + 1) % res_r);
+            m_faces[res_r + num_side_faces + r] = Face{ bottom, Vec3i(bottom_normal), bottom };
         }
 
-        for (uint32_t h = 0; h < m_resolution.y(); h++)
+        parallelFor(0, res_h, [&](size_t h)
         {
-            for (uint32_t r = 0; r < m_resolution.x(); r++)
+            for (uint32_t r = 0; r < res_r; r++)
             {
                 /* i0   i1
                  *  .---.
                  *  | \ |
                  *  .---.
                  * i2   i3 */
-                int32_t i0 = h * m_resolution.x() + r + 1;
-                int32_t i1 = h * m_resolution.x() + (r + 1) % m_resolution.x() + 1;
-                int32_t i2 = (h + 1) * m_resolution.x() + r + 1;
-                int32_t i3 = (h + 1) * m_resolution.x() + (r + 1) % m_resolution.x() + 1;
-
-                auto v0 = vertexAt(i0);
-                auto v1 = vertexAt(i1);
-                auto v2 = vertexAt(i2);
-                auto v3 = vertexAt(i3);
-
-                int32_t in0 = numNormals();
-                int32_t in1 = numNormals() + 3;
-
-                // Add normal for vertex at i0 and i2 
-                Vec3f n0 = normalize(cross(v2 - v0, v3 - v0));
-                addNormal(n0); addNormal(n0); addNormal(n0);
-
-                Vec3f n1 = normalize(cross(v3 - v0, v1 - v0));
-                addNormal(n1); addNormal(n1); addNormal(n1);
-
-                Face f0 = { {i0, i2, i3}, {in0, in0 + 1, in0 + 2}, {i0, i2, i3} };
-                Face f1 = { {i0, i3, i1}, {in1, in1 + 1, in1 + 2}, {i0, i3, i1} };
-
-                addFace(f0); addFace(f1);
+                const int32_t i0 = h * res_r + r + 1;
+                const int32_t i1 = h * res_r + (r + 1) % res_r + 1;
+                const int32_t i2 = (h + 1) * res_r + r + 1;
+                const int32_t i3 = (h + 1) * res_r + (r + 1) % res_r + 1;
+
+                const Vec3f& v0 = m_vertices[i0];
+                const Vec3f& v1 = m_vertices[i1];
+                const Vec3f& v2 = m_vertices[i2];
+                const Vec3f& v3 = m_vertices[i3];
+
+                const size_t f = (h * res_r + r) * 2;
+                const int32_t n0 = side_normal_base + static_cast<int32_t>(f);
+                m_normals[n0] = normalize(cross(v2 - v0, v3 - v0));
+                m_normals[n0 + 1] = normalize(cross(v3 - v0, v1 - v0));
+
+                const Vec3i idx0(i0, i2, i3);
+                const Vec3i idx1(i0, i3, i1);
+                m_faces[res_r + f] = Face{ idx0, Vec3i(n0), idx0 };
+                m_faces[res_r + f + 1] = Face{ idx1, Vec3i(n0 + 1), idx1 };
             }
-        }
-        
-        int32_t n_base_idx = numNormals();
-        // Add faces for bottom surface
-        for (uint32_t r = 0; r < m_resolution.x(); r++)
-        {
-            int32_t base_idx = m_resolution.x() * m_resolution.y() + 1;
-            int32_t num_total_normals = numNormals() + num_top_vertices;
-            int32_t i0 = total_num_vertices - 1;
-            int32_t i1 = base_idx + r;
-            int32_t i2 = base_idx + (r + 1) % m_resolution.x();
-            Face f{ Vec3i{i0, i1, i2}, 
-                Vec3i{num_total_normals - 1, static_cast<int32_t>(n_base_idx + r), static_cast<int32_t>(n_base_idx + (r + 1) % resolution.x())},
-                Vec3i{i0, i1, i2}};
-            addFace(f);
-            addNormal(Vec3f(0, -1, 0));
-        }
-
-        addVertex(bottom_center_vertex);
-        addTexcoord(Vec2f(0.0f));
-        addNormal(Vec3f(0.0f, -1.0f, 0.0f));
+        }, rowGrain(2 * res_r));
     }
 
     float CylinderMesh::radius() const
@@ -489,50 +457,60 @@ namespace prayground {
     PlaneMesh::PlaneMesh(const Vec2f& size, const Vec2ui& resolution, Axis axis)
         : m_size(size), m_resolution(resolution), m_axis(axis)
     {
+        ASSERT(resolution.x() >= 1 && resolution.y() >= 1, "The resolution of plane must be at least (1, 1).");
+
+        const uint32_t res_u = m_resolution.x();
+        const uint32_t res_v = m_resolution.y();
         const float u_min = -m_size.x() / 2.0f;
         const float v_max = m_size.y() / 2.0f;
         const float v_min = -v_max;
-        const float u_step = m_size.x() / (float)m_resolution.x();
-        const float v_step = m_size.y() / (float)m_resolution.y();
+        const float u_step = m_size.x() / (float)res_u;
+        const float v_step = m_size.y() / (float)res_v;
 
-        for (int v = 0; v <= m_resolution.y(); v++)
-        {
-            int u_axis = ((int)m_axis + 1) % 3;
-            int v_axis = ((int)m_axis + 2) % 3;
-            if (m_axis == Axis::Y)
-                std::swap(u_axis, v_axis);
+        int u_axis = ((int)m_axis + 1) % 3;
+        int v_axis = ((int)m_axis + 2) % 3;
+        if (m_axis == Axis::Y)
+            std::swap(u_axis, v_axis);
+
+        const size_t num_vertices = static_cast<size_t>(res_u + 1) * (res_v + 1);
+        m_vertices.resize(num_vertices);
+        m_texcoords.resize(num_vertices);
+        m_faces.resize(static_cast<size_t>(res_u) * res_v * 2);
 
-            for (int u = 0; u <= m_resolution.x(); u++)
+        parallelFor(0, res_v + 1, [&](size_t v)
+        {
+            for (uint32_t u = 0; u <= res_u; u++)
             {
                 Vec3f vertex(0.0f);
                 vertex[u_axis] = u_min + (float)u * u_step;
                 vertex[v_axis] = m_axis == Axis::Y ? v_min + (float)v * v_step : v_max - (float)v * v_step;
-                addTexcoord(Vec2f((float)u / m_resolution.x(), (float)v / m_resolution.y()));
-                addVertex(vertex);
+                m_vertices[(res_u + 1) * v + u] = vertex;
+                m_texcoords[(res_u + 1) * v + u] = Vec2f((float)u / res_u, (float)v / res_v);
 
-                if (u == m_resolution.x() || v == m_resolution.y())
+                if (u == res_u || v == res_v)
                     continue;
 
                 // i00 - i01 ...
-                //  |  \  |  
+                //  |  \  |
                 // i10 - i11 ...
                 //  |  \  |
 
-                int i00 = (m_resolution.x() + 1) * v + u;
-                int i01 = i00 + 1;
-                int i10 = (m_resolution.x() + 1) * (v + 1) + u;
-                int i11 = i10 + 1;
-                Face f1{ Vec3i(i00, i10, i11), Vec3i(i00, i10, i11), Vec3i(i00, i10, i11) };
-                Face f2{ Vec3i(i00, i11, i01), Vec3i(i00, i11, i01), Vec3i(i00, i11, i01) };
-                m_faces.push_back(f1);
-                m_faces.push_back(f2);
+                const int32_t i00 = static_cast<int32_t>((res_u + 1) * v + u);
+                const int32_t i01 = i00 + 1;
+                const int32_t i10 = static_cast<int32_t>((res_u + 1) * (v + 1) + u);
+                const int32_t i11 = i10 + 1;
+                const Vec3i idx0(i00, i10, i11);
+                const Vec3i idx1(i00, i11, i01);
+                const size_t f = (res_u * v + u) * 2;
+                m_faces[f] = Face{ idx0, Vec3i(0), idx0 };
+                m_faces[f + 1] = Face{ idx1, Vec3i(0), idx1 };
             }
-        }
+        }, rowGrain(2 * res_u));
 
+        // All faces share a normal
         Vec3f n{ 0.0f, 0.0f, 0.0f };
         n[(int)m_axis] = 1.0f;
-        m_normals.resize(m_vertices.size());
-        std::fill(m_normals.begin(), m_normals.end(), n);
+        m_normals.assign(1, n);
     }
 
     const Vec2f& PlaneMesh::size() const
@@ -555,4 +533,4 @@ namespace prayground {
         m_resolution = resolution;
     }
 
-} // namespace prayground
\ No newline at end of file
+} // namespace prayground
@@ -1,9 +1,6 @@
 #pragma once 
 
 #include <prayground/shape/trianglemesh.h>
-#ifndef __CUDACC__
-#include <map>
-#endif
 
 namespace prayground {
 
@@ -13,17 +10,13 @@ namespace prayground {
     public:
         IcoSphereMesh(float radius = 1, int level = 2);
 
-        void subdivide(const float level);
+        /* Subdivide each face into 4 faces `level` more times. Midpoints of edges are shared by
+        *  the neighboring faces through a hash table, and the faces are generated in parallel. */
+        void subdivide(int level);
         void splitVertices();
     private:
-        /* Return index if the same vertex position has already existed.
-        *  If there is no same vertex, it will return -1. */
-        int32_t findOrAddVertex(const Vec3f& v, const Vec2f& texcoord);
-
         float m_radius;
         int m_level;
-        /* Map to search an index correnponds to a texcoord */
-        std::map<std::pair<float, float>, int32_t> m_indices;
     };
 
     class UVSphereMesh final : public TriangleMesh {
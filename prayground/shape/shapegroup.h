@@ -3,6 +3,7 @@
 #ifndef __CUDACC__
 
 #include <prayground/core/util.h>
+#include <prayground/core/bounds.h>
 #include <prayground/core/cudabuffer.h>
 #include <prayground/core/shape.h>
 #include <prayground/shape/trianglemesh.h>
@@ -201,13 +202,14 @@ namespace prayground {
 
         AABB bound() const override
         {
-            AABB aabb{};
             if constexpr (Type == ShapeType::Custom)
             {
-                for (auto& shape : m_shapes)
-                    aabb = AABB::merge(aabb, shape.bound());
+                std::vector<AABB> bounds(m_shapes.size());
+                for (size_t i = 0; i < m_shapes.size(); i++)
+                    bounds[i] = m_shapes[i].bound();
+                return boundBoxes(bounds);
             }
-            return aabb;
+            return AABB{};
         }
 
         void addShape(const ShapeT& shape)
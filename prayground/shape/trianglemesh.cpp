@@ -1,9 +1,12 @@
 #include "trianglemesh.h"
+#include <prayground/core/bounds.h>
 #include <prayground/core/cudabuffer.h>
 #include <prayground/core/load3d.h>
 #include <prayground/core/file_util.h>
 #include <prayground/math/util.h>
+#include <prayground/math/compression.h>
 #include <algorithm>
+#include <array>
 
 namespace prayground {
 
@@ -44,10 +47,24 @@ namespace prayground {
     // ------------------------------------------------------------------
     void TriangleMesh::copyToDevice() 
     {
-        Data data = this->getData();
+        // Both layouts consist of four pointers, so the allocation is shared by them
+        static_assert(sizeof(Data) == sizeof(CompactData));
 
         if (!d_data) 
             CUDA_CHECK(cudaMalloc(&d_data, sizeof(Data)));
+
+        if (m_storage == Storage::Compact)
+        {
+            CompactData data = this->getCompactData();
+            CUDA_CHECK(cudaMemcpy(
+                d_data,
+                &data, sizeof(CompactData),
+                cudaMemcpyHostToDevice
+            ));
+            return;
+        }
+
+        Data data = this->getData();
         CUDA_CHECK(cudaMemcpy(
             d_data,
             &data, sizeof(Data),
@@ -72,11 +89,11 @@ namespace prayground {
         bi.type = static_cast<OptixBuildInputType>(this->type());
         bi.triangleArray.vertexFormat = OPTIX_VERTEX_FORMAT_FLOAT3;
         bi.triangleArray.vertexStrideInBytes = sizeof(Vec3f);
-        bi.triangleArray.numVertices = static_cast<uint32_t>(m_vertices.size());
+        bi.triangleArray.numVertices = m_storage == Storage::Compact ? m_num_compact_vertices : static_cast<uint32_t>(m_vertices.size());
         bi.triangleArray.vertexBuffers = &d_vertices;
         bi.triangleArray.flags = triangle_input_flags;
         bi.triangleArray.indexFormat = OPTIX_INDICES_FORMAT_UNSIGNED_INT3;
-        bi.triangleArray.indexStrideInBytes = sizeof(Face);
+        bi.triangleArray.indexStrideInBytes = m_storage == Storage::Compact ? sizeof(Vec3ui) : sizeof(Face);
         bi.triangleArray.numIndexTriplets = static_cast<uint32_t>(m_faces.size());
         bi.triangleArray.indexBuffer = d_faces;
         bi.triangleArray.numSbtRecords = num_materials;
@@ -102,7 +119,7 @@ namespace prayground {
 
     AABB TriangleMesh::bound() const 
     {
-        return AABB{};
+        return boundPoints(m_vertices);
     }
 
     void TriangleMesh::setSbtIndex(const uint32_t sbt_idx)
@@ -155,6 +172,119 @@ namespace prayground {
         return data;
     }
 
+    // ------------------------------------------------------------------
+    void TriangleMesh::setStorage(Storage storage)
+    {
+        m_storage = storage;
+    }
+
+    TriangleMesh::CompactBuffers TriangleMesh::compactBuffers() const
+    {
+        CompactBuffers buffers;
+        const uint32_t num_faces = static_cast<uint32_t>(m_faces.size());
+        const bool has_normals = !m_normals.empty();
+        const bool has_texcoords = !m_texcoords.empty();
+
+        // Corners with the same (position, normal, texcoord) ids become one vertex.
+        // Vertices are numbered in the order of their first corners to keep the locality of faces.
+        using Key = std::array<int32_t, 3>;
+        const uint32_t num_corners = num_faces * 3;
+        std::vector<std::pair<Key, uint32_t>> corners(num_corners);
+        parallelFor(0, num_corners, [&](size_t c)
+        {
+            const Face& face = m_faces[c / 3];
+            const int k = static_cast<int>(c % 3);
+            corners[c] = { Key{ face.vertex_id[k], has_normals ? face.normal_id[k] : -1, has_texcoords ? face.texcoord_id[k] : -1 }, static_cast<uint32_t>(c) };
+        });
+        std::sort(corners.begin(), corners.end());
+
+        // First corner of each group and the group of each corner
+        std::vector<uint32_t> first_corners;
+        std::vector<uint32_t> groups(num_corners);
+        for (uint32_t i = 0; i < num_corners; i++)
+        {
+            if (i == 0 || corners[i].first != corners[i - 1].first)
+                first_corners.emplace_back(corners[i].second);
+            groups[corners[i].second] = static_cast<uint32_t>(first_corners.size() - 1);
+        }
+        const uint32_t num_vertices = static_cast<uint32_t>(first_corners.size());
+
+        std::vector<uint32_t> order(num_vertices);
+        for (uint32_t g = 0; g < num_vertices; g++)
+            order[g] = g;
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return first_corners[a] < first_corners[b]; });
+        std::vector<uint32_t> renumbered(num_vertices);
+        for (uint32_t i = 0; i < num_vertices; i++)
+            renumbered[order[i]] = i;
+
+        buffers.indices.resize(num_faces);
+        parallelFor(0, num_faces, [&](size_t f)
+        {
+            buffers.indices[f] = Vec3ui(renumbered[groups[f * 3 + 0]], renumbered[groups[f * 3 + 1]], renumbered[groups[f * 3 + 2]]);
+        });
+
+        // Attribute ids out of range (e.g. faces without normals in a mesh with normals) get zero values
+        std::vector<Vec3f> normals(has_normals ? num_vertices : 0);
+        std::vector<Vec2f> texcoords(has_texcoords ? num_vertices : 0);
+        buffers.vertices.resize(num_vertices);
+        parallelFor(0, num_vertices, [&](size_t i)
+        {
+            const uint32_t corner = first_corners[order[i]];
+            const Face& face = m_faces[corner / 3];
+            const int k = static_cast<int>(corner % 3);
+            buffers.vertices[i] = m_vertices[face.vertex_id[k]];
+            if (has_normals)
+            {
+                const int32_t id = face.normal_id[k];
+                normals[i] = id >= 0 && id < static_cast<int32_t>(m_normals.size()) ? m_normals[id] : Vec3f(0.0f);
+            }
+            if (has_texcoords)
+            {
+                const int32_t id = face.texcoord_id[k];
+                texcoords[i] = id >= 0 && id < static_cast<int32_t>(m_texcoords.size()) ? m_texcoords[id] : Vec2f(0.0f);
+            }
+        });
+
+        buffers.normals.resize(normals.size());
+        octEncode(normals.data(), buffers.normals.data(), normals.size());
+        buffers.texcoords.resize(texcoords.size());
+        packHalf2(texcoords.data(), buffers.texcoords.data(), texcoords.size());
+        return buffers;
+    }
+
+    TriangleMesh::CompactData TriangleMesh::getCompactData()
+    {
+        const CompactBuffers buffers = compactBuffers();
+        m_num_compact_vertices = static_cast<uint32_t>(buffers.vertices.size());
+
+        // Buffers of the previous upload are replaced
+        cuda_frees(d_vertices, d_normals, d_faces, d_texcoords);
+
+        CUDABuffer<Vec3f> d_vertices_buf;
+        CUDABuffer<Vec3ui> d_indices_buf;
+        CUDABuffer<uint32_t> d_normals_buf;
+        CUDABuffer<uint32_t> d_texcoords_buf;
+        d_vertices_buf.copyToDevice(buffers.vertices);
+        d_indices_buf.copyToDevice(buffers.indices);
+        if (!buffers.normals.empty())
+            d_normals_buf.copyToDevice(buffers.normals);
+        if (!buffers.texcoords.empty())
+            d_texcoords_buf.copyToDevice(buffers.texcoords);
+
+        d_vertices = d_vertices_buf.devicePtr();
+        d_faces = d_indices_buf.devicePtr();
+        d_normals = d_normals_buf.devicePtr();
+        d_texcoords = d_texcoords_buf.devicePtr();
+
+        CompactData data = {
+            .vertices = d_vertices_buf.deviceData(),
+            .indices = d_indices_buf.deviceData(),
+            .normals = buffers.normals.empty() ? nullptr : d_normals_buf.deviceData(),
+            .texcoords = buffers.texcoords.empty() ? nullptr : d_texcoords_buf.deviceData()
+        };
+        return data;
+    }
+
     // ------------------------------------------------------------------
     void TriangleMesh::setupOpacitymap(
         const Context& ctx, 
@@ -297,6 +427,27 @@ namespace prayground {
         m_texcoords.emplace_back(Vec2f(x, y));
     }
 
+    // ------------------------------------------------------------------
+    void TriangleMesh::setVertices(std::vector<Vec3f> vertices)
+    {
+        m_vertices = std::move(vertices);
+    }
+
+    void TriangleMesh::setFaces(std::vector<Face> faces)
+    {
+        m_faces = std::move(faces);
+    }
+
+    void TriangleMesh::setNormals(std::vector<Vec3f> normals)
+    {
+        m_normals = std::move(normals);
+    }
+
+    void TriangleMesh::setTexcoords(std::vector<Vec2f> texcoords)
+    {
+        m_texcoords = std::move(texcoords);
+    }
+
     const Vec3f& TriangleMesh::vertexAt(const int32_t i) const
     {
         return m_vertices[i];
@@ -477,15 +628,9 @@ namespace prayground {
         if (m_sbt_indices.empty())
             return 1u;
 
-        std::vector<uint32_t> sbt_counter;
-        // Count the number of sbt indices that doesn't duplicate
-        for (auto& sbt_idx : m_sbt_indices)
-        {
-            auto itr = std::find(sbt_counter.begin(), sbt_counter.end(), sbt_idx);
-            if (sbt_counter.empty() || itr == sbt_counter.end())
-                sbt_counter.push_back(sbt_idx);
-        }
-        return static_cast<uint32_t>(sbt_counter.size());
+        // SBT records must cover the largest offset even if some of materials aren't used by this mesh
+        // (e.g. a part of the mesh split by splitMeshByClusters())
+        return *std::max_element(m_sbt_indices.begin(), m_sbt_indices.end()) + 1;
     }
 
     void TriangleMesh::setSbtIndices(const std::vector<uint32_t>& sbt_indices)
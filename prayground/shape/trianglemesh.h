@@ -28,6 +28,25 @@ namespace prayground {
             Vec2f* texcoords;
         };
 
+        /**
+         * Device data for Storage::Compact. Positions, normals and texcoords share one index per corner,
+         * normals are decoded with octDecode() and texcoords with unpackHalf2() (see math/compression.h).
+         * normals/texcoords are nullptr when the mesh doesn't have them.
+         */
+        struct CompactData {
+            Vec3f* vertices;
+            Vec3ui* indices;
+            uint32_t* normals;
+            uint32_t* texcoords;
+        };
+
+        enum class Storage {
+            // Data: 32-bit float attributes with indices for each of them (48 bytes per face, 32 bytes per vertex)
+            Full,
+            // CompactData: 12 bytes per face and 20 bytes per vertex, though vertices on attribute seams are duplicated
+            Compact
+        };
+
 #ifndef __CUDACC__
         TriangleMesh();
         TriangleMesh(const std::filesystem::path& filename);
@@ -56,6 +75,20 @@ namespace prayground {
 
         Data getData();
 
+        // Layout of device data uploaded by copyToDevice(). Full by default; copyToDevice() and GAS build must follow a change.
+        void setStorage(Storage storage);
+        Storage storage() const { return m_storage; }
+
+        // Host buffers uploaded in Storage::Compact
+        struct CompactBuffers {
+            std::vector<Vec3f> vertices;
+            std::vector<Vec3ui> indices;
+            std::vector<uint32_t> normals;
+            std::vector<uint32_t> texcoords;
+        };
+        CompactBuffers compactBuffers() const;
+        CompactData getCompactData();
+
         // For opacity micromap
         void setupOpacitymap(const Context& ctx,
             CUstream stream,
@@ -99,6 +132,12 @@ namespace prayground {
         void addTexcoord(const Vec2f& texcoord);
         void addTexcoord(float x, float y);
 
+        // Replace whole buffers, e.g. by mesh processing passes in shape/meshopt.h
+        void setVertices(std::vector<Vec3f> vertices);
+        void setFaces(std::vector<Face> faces);
+        void setNormals(std::vector<Vec3f> normals);
+        void setTexcoords(std::vector<Vec2f> texcoords);
+
         void load(const std::filesystem::path& filename);
         void loadWithMtl(
             const std::filesystem::path& objpath, 
@@ -147,6 +186,11 @@ namespace prayground {
         std::vector<Vec2f> m_texcoords;
         std::vector<uint32_t> m_sbt_indices;
 
+        Storage m_storage { Storage::Full };
+        // Number of vertices uploaded in Storage::Compact
+        uint32_t m_num_compact_vertices { 0 };
+
+        // In Storage::Compact, d_faces, d_normals and d_texcoords hold the buffers of CompactData
         CUdeviceptr d_vertices { 0 };
         CUdeviceptr d_faces { 0 };
         CUdeviceptr d_normals { 0 };
@@ -27,13 +27,14 @@ namespace prayground {
         {
             Bitmap_<PixelT>::load(filepath.value(), PixelFormat::RGBA);
         }
+        initTextureDesc();
+    }
 
-        // Initialize texture description
-        m_tex_desc.addressMode[0] = cudaAddressModeWrap;
-        m_tex_desc.addressMode[1] = cudaAddressModeWrap;
-        m_tex_desc.filterMode = cudaFilterModeLinear;
-        m_tex_desc.normalizedCoords = 1;
-        m_tex_desc.sRGB = 1;
+    template <typename PixelT>
+    BitmapTexture_<PixelT>::BitmapTexture_(const std::filesystem::path& filename, cudaTextureDesc desc, int prg_id)
+    : BitmapTexture_<PixelT>(filename, prg_id)
+    {
+        m_tex_desc = desc;
         if constexpr (std::is_same_v<PixelT, float>)
             m_tex_desc.readMode = cudaReadModeElementType;
         else
@@ -41,10 +42,47 @@ namespace prayground {
     }
 
     template <typename PixelT>
-    BitmapTexture_<PixelT>::BitmapTexture_(const std::filesystem::path& filename, cudaTextureDesc desc, int prg_id)
-    : BitmapTexture_<PixelT>(filename, prg_id)
+    BitmapTexture_<PixelT>::BitmapTexture_(const Bitmap_<PixelT>& bitmap, int prg_id)
+    : Texture(prg_id)
     {
-        m_tex_desc = desc;
+        const int width = bitmap.width();
+        const int height = bitmap.height();
+        const int channels = bitmap.channels();
+        ASSERT(channels >= 1 && channels <= 4, "The bitmap has no pixels.");
+
+        constexpr PixelT one = std::is_same_v<PixelT, float> ? PixelT(1) : PixelT(255);
+        const PixelT* src = bitmap.data();
+        std::vector<PixelT> rgba(static_cast<size_t>(width) * height * 4);
+        for (size_t i = 0; i < static_cast<size_t>(width) * height; i++)
+        {
+            const PixelT* p = src + i * channels;
+            PixelT* dst = rgba.data() + i * 4;
+            if (channels <= 2)
+            {
+                dst[0] = dst[1] = dst[2] = p[0];
+                dst[3] = channels == 2 ? p[1] : one;
+            }
+            else
+            {
+                dst[0] = p[0]; dst[1] = p[1]; dst[2] = p[2];
+                dst[3] = channels == 4 ? p[3] : one;
+            }
+        }
+        Bitmap_<PixelT>::allocate(PixelFormat::RGBA, width, height, rgba.data());
+
+        initTextureDesc();
+        // Values in memory are treated as linear
+        m_tex_desc.sRGB = 0;
+    }
+
+    template <typename PixelT>
+    void BitmapTexture_<PixelT>::initTextureDesc()
+    {
+        m_tex_desc.addressMode[0] = cudaAddressModeWrap;
+        m_tex_desc.addressMode[1] = cudaAddressModeWrap;
+        m_tex_desc.filterMode = cudaFilterModeLinear;
+        m_tex_desc.normalizedCoords = 1;
+        m_tex_desc.sRGB = 1;
         if constexpr (std::is_same_v<PixelT, float>)
             m_tex_desc.readMode = cudaReadModeElementType;
         else
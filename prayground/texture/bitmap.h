@@ -20,6 +20,8 @@ public:
     BitmapTexture_() = default;
     BitmapTexture_(const std::filesystem::path& filename, int prg_id);
     BitmapTexture_(const std::filesystem::path& filename, cudaTextureDesc desc, int prg_id);
+    // Texture of pixels in memory such as baked noise. Channels are expanded to RGBA, e.g. gray v to (v, v, v, 1).
+    BitmapTexture_(const Bitmap_<PixelT>& bitmap, int prg_id);
 
     constexpr TextureType type() override;
 
@@ -34,6 +36,8 @@ public:
 
     cudaTextureObject_t cudaTextureObject() const;
 private:
+    void initTextureDesc();
+
     cudaTextureDesc m_tex_desc {};
     cudaTextureObject_t d_texture{};
     cudaArray_t d_array { nullptr };
@@ -34,6 +34,7 @@ public:
     void setColor1(const T& c1)
     {
         m_color1 = c1;
+        markDirty();
     }
     const T& color1() const
     {
@@ -43,6 +44,7 @@ public:
     void setColor2(const T& c2)
     {
         m_color2 = c2;
+        markDirty();
     }
     const T& color2() const
     {
@@ -52,6 +54,7 @@ public:
     void setScale(const float& s)
     {
         m_scale = s;
+        markDirty();
     }
     float scale() const
     {
@@ -37,6 +37,7 @@ public:
     void setColor(const T& c)
     {
         m_color = c;
+        markDirty();
     }
     const T& color() const
     {
@@ -28,6 +28,7 @@ namespace prayground {
 
         void addKeypoint(const Keypoint<T>& keypoint) {
             m_keypoints.push_back(keypoint);
+            markDirty();
         }
 
         void removeKeypoint(int index) {
@@ -36,10 +37,12 @@ namespace prayground {
                 return;
             }
             m_keypoints.erase(m_keypoints.begin() + index);
+            markDirty();
         }
 
         void setEaseType(EaseType ease_type) {
             m_ease_type = ease_type;
+            markDirty();
         }
 
         void copyToDevice() override {
@@ -0,0 +1,140 @@
+#include "noise_bake.h"
+#include <prayground/core/parallel.h>
+#include <prayground/core/util.h>
+#include <algorithm>
+#include <cmath>
+
+namespace prayground {
+
+    namespace {
+        // Source texels [begin, end) covered by the texel i of the downsampled axis
+        inline void footprint(int i, int src_size, int dst_size, int& begin, int& end)
+        {
+            begin = static_cast<int>(static_cast<int64_t>(i) * src_size / dst_size);
+            end = static_cast<int>(static_cast<int64_t>(i + 1) * src_size / dst_size);
+        }
+
+        // Box filter of a grid with interleaved channels
+        void downsample(const float* src, int sx, int sy, int sz, int channels,
+                        float* dst, int dx, int dy, int dz)
+        {
+            parallelFor(0, static_cast<size_t>(dy) * dz, [&](size_t row)
+            {
+                const int y = static_cast<int>(row % dy);
+                const int z = static_cast<int>(row / dy);
+                int y0, y1, z0, z1;
+                footprint(y, sy, dy, y0, y1);
+                footprint(z, sz, dz, z0, z1);
+                for (int x = 0; x < dx; x++)
+                {
+                    int x0, x1;
+                    footprint(x, sx, dx, x0, x1);
+                    const float inv_count = 1.0f / static_cast<float>((x1 - x0) * (y1 - y0) * (z1 - z0));
+                    float* out = dst + ((static_cast<size_t>(z) * dy + y) * dx + x) * channels;
+                    for (int c = 0; c < channels; c++)
+                    {
+                        float sum = 0.0f;
+                        for (int k = z0; k < z1; k++)
+                            for (int j = y0; j < y1; j++)
+                                for (int i = x0; i < x1; i++)
+                                    sum += src[((static_cast<size_t>(k) * sy + j) * sx + i) * channels + c];
+                        out[c] = sum * inv_count;
+                    }
+                }
+            }, 16);
+        }
+    } // nonamed namespace
+
+    // ---------------------------------------------------------------------
+    float NoiseVolume::sample(const Vec3f& uvw) const
+    {
+        const int n[3] = { nx, ny, nz };
+        int i0[3], i1[3];
+        float t[3];
+        for (int a = 0; a < 3; a++)
+        {
+            const float f = clamp(uvw[a] * n[a] - 0.5f, 0.0f, static_cast<float>(n[a] - 1));
+            i0[a] = static_cast<int>(f);
+            i1[a] = std::min(i0[a] + 1, n[a] - 1);
+            t[a] = f - i0[a];
+        }
+
+        const float c00 = lerp(at(i0[0], i0[1], i0[2]), at(i1[0], i0[1], i0[2]), t[0]);
+        const float c10 = lerp(at(i0[0], i1[1], i0[2]), at(i1[0], i1[1], i0[2]), t[0]);
+        const float c01 = lerp(at(i0[0], i0[1], i1[2]), at(i1[0], i0[1], i1[2]), t[0]);
+        const float c11 = lerp(at(i0[0], i1[1], i1[2]), at(i1[0], i1[1], i1[2]), t[0]);
+        return lerp(lerp(c00, c10, t[1]), lerp(c01, c11, t[1]), t[2]);
+    }
+
+    // ---------------------------------------------------------------------
+    void bakeNoise(const PerlinNoise& noise, const NoiseBakeDesc& desc, int nx, int ny, int nz, float* out)
+    {
+        ASSERT(nx > 0 && ny > 0 && nz > 0, "The resolution of the noise must be positive.");
+
+        const Vec3f origin = desc.domain.min();
+        const Vec3f texel = desc.domain.extent() / Vec3f(static_cast<float>(nx), static_cast<float>(ny), static_cast<float>(nz));
+
+        parallelFor(0, static_cast<size_t>(ny) * nz, [&](size_t row)
+        {
+            const int y = static_cast<int>(row % ny);
+            const int z = static_cast<int>(row / ny);
+            float* dst = out + row * nx;
+            for (int x = 0; x < nx; x++)
+            {
+                const Vec3f p = origin + (Vec3f(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) + 0.5f) * texel;
+                dst[x] = desc.type == NoiseBakeType::Turbulence ? noise.turb(p, desc.depth) : noise.noise(p);
+            }
+        }, 4);
+    }
+
+    FloatBitmap bakeNoiseBitmap(const PerlinNoise& noise, const NoiseBakeDesc& desc, int width, int height)
+    {
+        FloatBitmap bitmap(PixelFormat::GRAY, width, height);
+        bakeNoise(noise, desc, width, height, 1, bitmap.data());
+        return bitmap;
+    }
+
+    NoiseVolume bakeNoiseVolume(const PerlinNoise& noise, const NoiseBakeDesc& desc, int nx, int ny, int nz)
+    {
+        NoiseVolume volume{ nx, ny, nz, std::vector<float>(static_cast<size_t>(nx) * ny * nz) };
+        bakeNoise(noise, desc, nx, ny, nz, volume.data.data());
+        return volume;
+    }
+
+    // ---------------------------------------------------------------------
+    std::vector<FloatBitmap> buildMipChain(const FloatBitmap& base)
+    {
+        std::vector<FloatBitmap> levels;
+        const FloatBitmap* src = &base;
+        PixelFormat format = static_cast<PixelFormat>(base.channels());
+        while (src->width() > 1 || src->height() > 1)
+        {
+            const int w = std::max(src->width() / 2, 1);
+            const int h = std::max(src->height() / 2, 1);
+            FloatBitmap level(format, w, h);
+            downsample(src->data(), src->width(), src->height(), 1, src->channels(), level.data(), w, h, 1);
+            levels.emplace_back(std::move(level));
+            src = &levels.back();
+        }
+        return levels;
+    }
+
+    std::vector<NoiseVolume> buildMipChain(const NoiseVolume& base)
+    {
+        std::vector<NoiseVolume> levels;
+        const NoiseVolume* src = &base;
+        while (src->nx > 1 || src->ny > 1 || src->nz > 1)
+        {
+            NoiseVolume level;
+            level.nx = std::max(src->nx / 2, 1);
+            level.ny = std::max(src->ny / 2, 1);
+            level.nz = std::max(src->nz / 2, 1);
+            level.data.resize(static_cast<size_t>(level.nx) * level.ny * level.nz);
+            downsample(src->data.data(), src->nx, src->ny, src->nz, 1, level.data.data(), level.nx, level.ny, level.nz);
+            levels.emplace_back(std::move(level));
+            src = &levels.back();
+        }
+        return levels;
+    }
+
+} // namespace prayground
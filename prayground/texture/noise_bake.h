@@ -0,0 +1,66 @@
+#pragma once
+
+#ifndef __CUDACC__
+
+#include <prayground/core/aabb.h>
+#include <prayground/core/bitmap.h>
+#include <prayground/math/noise.h>
+#include <vector>
+
+namespace prayground {
+
+    enum class NoiseBakeType : int
+    {
+        Noise = 0,      // PerlinNoise::noise()
+        Turbulence = 1  // PerlinNoise::turb()
+    };
+
+    struct NoiseBakeDesc {
+        NoiseBakeType type { NoiseBakeType::Turbulence };
+        // Octaves of the turbulence
+        int depth { 7 };
+        // Region of the noise space covered by the grid. Texel (x, y, z) is evaluated at its center,
+        // domain.min() + (Vec3f(x, y, z) + 0.5f) / resolution * domain.extent().
+        // 2D grids have a single slice at the middle of the domain in z.
+        AABB domain { Vec3f(0.0f), Vec3f(1.0f) };
+    };
+
+    /**
+     * @brief Dense scalar grid baked from the noise.
+     * Values are stored in x-fastest order, which is the layout of the density of GridMedium_.
+     * @code
+     * NoiseVolume v = bakeNoiseVolume(noise, desc, 64, 64, 64);
+     * auto medium = GridMedium(sigma_a, sigma_s, g, v.nx, v.ny, v.nz, v.data.data());
+     * @endcode
+     */
+    struct NoiseVolume {
+        int nx { 0 }, ny { 0 }, nz { 0 };
+        std::vector<float> data;
+
+        float at(int x, int y, int z) const { return data[(static_cast<size_t>(z) * ny + y) * nx + x]; }
+
+        // Trilinear interpolation at uvw in [0, 1]^3. Texel centers are at (i + 0.5) / n as in the bake.
+        float sample(const Vec3f& uvw) const;
+    };
+
+    /**
+     * Evaluate the noise at every texel of the nx x ny x nz grid. out is written in x-fastest order.
+     * Rows are distributed over host threads, and each texel gives the same value as PerlinNoise::noise()/turb().
+     */
+    void bakeNoise(const PerlinNoise& noise, const NoiseBakeDesc& desc, int nx, int ny, int nz, float* out);
+
+    // Single channel (PixelFormat::GRAY) bitmap
+    FloatBitmap bakeNoiseBitmap(const PerlinNoise& noise, const NoiseBakeDesc& desc, int width, int height);
+    NoiseVolume bakeNoiseVolume(const PerlinNoise& noise, const NoiseBakeDesc& desc, int nx, int ny, int nz);
+
+    /**
+     * Mip chain with 2x2 (2x2x2 for volumes) box filtering down to a single texel.
+     * The base level is not included, so the result[i] is the level i + 1.
+     * Odd sizes are rounded down, and the last row/column is folded into the previous texels.
+     */
+    std::vector<FloatBitmap> buildMipChain(const FloatBitmap& base);
+    std::vector<NoiseVolume> buildMipChain(const NoiseVolume& base);
+
+} // namespace prayground
+
+#endif // __CUDACC__
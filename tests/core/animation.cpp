@@ -0,0 +1,221 @@
+#include <prayground/math/vec.h>
+#include <prayground/core/animation.h>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace prayground;
+
+namespace {
+    bool near(float a, float b, float eps = 1e-5f)
+    {
+        return fabsf(a - b) <= eps * fmaxf(1.0f, fabsf(b));
+    }
+
+    bool near(const Matrix4f& a, const Matrix4f& b)
+    {
+        for (int i = 0; i < 16; i++)
+            if (!near(a[i], b[i])) return false;
+        return true;
+    }
+
+    // Bracketing keys found by a linear scan, as callers did without tracks
+    float linearEvaluate(const vector<Keypoint<float>>& keys, float t, EaseType type)
+    {
+        if (t <= keys.front().t) return keys.front().value;
+        if (t >= keys.back().t) return keys.back().value;
+        size_t i = 0;
+        while (keys[i + 1].t <= t) i++;
+        return Keypoint<float>::ease(keys[i], keys[i + 1], t, type);
+    }
+
+    template <EaseType E>
+    void checkEase()
+    {
+        const Keypoint<float> a{ -2.0f, 1.0f }, b{ 3.0f, 5.0f };
+        for (int i = 0; i <= 64; i++)
+        {
+            const float t = 1.0f + 4.0f * i / 64.0f;
+            assert(Keypoint<float>::ease<E>(a, b, t) == Keypoint<float>::ease(a, b, t, E));
+        }
+        assert(Keypoint<float>::ease<E>(a, b, 1.0f) == a.value);
+        assert(near(Keypoint<float>::ease<E>(a, b, 5.0f), b.value));
+    }
+} // nonamed namespace
+
+static void testEasing()
+{
+    checkEase<EaseType::Linear>();
+    checkEase<EaseType::InSine>();
+    checkEase<EaseType::OutSine>();
+    checkEase<EaseType::InOutSine>();
+    checkEase<EaseType::InQuad>();
+    checkEase<EaseType::OutQuad>();
+    checkEase<EaseType::InOutQuad>();
+    checkEase<EaseType::InCubic>();
+    checkEase<EaseType::OutCubic>();
+    checkEase<EaseType::InOutCubic>();
+    checkEase<EaseType::InQuart>();
+    checkEase<EaseType::OutQuart>();
+    checkEase<EaseType::InOutQuart>();
+    checkEase<EaseType::InExpo>();
+    checkEase<EaseType::OutExpo>();
+    checkEase<EaseType::InOutExpo>();
+}
+
+static void testTrack()
+{
+    mt19937 rng(1);
+    uniform_real_distribution<float> dist(0.0f, 10.0f);
+    vector<Keypoint<float>> keys(40);
+    for (auto& k : keys)
+        k = { dist(rng), dist(rng) };
+
+    // Keys are sorted by time on construction
+    AnimationTrack<float, EaseType::InOutCubic> track(keys);
+    sort(keys.begin(), keys.end(), [](const auto& a, const auto& b) { return a.t < b.t; });
+    assert(track.numKeypoints() == keys.size());
+    assert(track.startTime() == keys.front().t && track.endTime() == keys.back().t);
+
+    for (size_t i = 0; i < keys.size(); i++)
+        assert(track.evaluate(keys[i].t) == keys[i].value);
+    assert(track.evaluate(-1.0f) == keys.front().value);
+    assert(track.evaluate(11.0f) == keys.back().value);
+
+    // Random and monotonic times with the cached segment
+    for (int i = 0; i < 2000; i++)
+    {
+        const float t = i < 1000 ? dist(rng) : i * 0.01f - 10.0f;
+        const float ref = linearEvaluate(keys, t, EaseType::InOutCubic);
+        assert(track.evaluate(t) == ref);
+        assert(track.evaluateCached(t) == ref);
+    }
+
+    // Keys at the same time make a step
+    AnimationTrack<float> step({ { 0.0f, 0.0f }, { 1.0f, 1.0f }, { 5.0f, 1.0f }, { 2.0f, 2.0f } });
+    assert(step.evaluate(0.5f) == 0.5f);
+    assert(step.evaluate(0.999f) < 1.0f && step.evaluate(1.0f) == 5.0f);
+    assert(step.evaluate(1.5f) == 3.5f);
+
+    step.addKeypoint({ -4.0f, 0.5f });
+    assert(step.numKeypoints() == 5 && step.keypoint(1).value == -4.0f);
+    assert(step.evaluate(0.25f) == -2.0f);
+    step.removeKeypoint(1);
+    assert(step.evaluate(0.25f) == 0.25f);
+
+    AnimationTrack<float> single({ { 3.0f, 1.0f } });
+    assert(single.evaluate(0.0f) == 3.0f && single.evaluateCached(2.0f) == 3.0f);
+}
+
+static void testTransform()
+{
+    TransformTrack<> track;
+    // Empty channels are the identity
+    assert(near(track.evaluate(0.3f), Matrix4f::identity()));
+
+    track.translation = AnimationTrack<Vec3f>({ { Vec3f(0.0f), 0.0f }, { Vec3f(2.0f, -4.0f, 6.0f), 2.0f } });
+    track.rotation = AnimationTrack<Vec3f>({ { Vec3f(0.0f), 0.0f }, { Vec3f(1.0f, 2.0f, -3.0f), 2.0f } });
+    track.scale = AnimationTrack<Vec3f>({ { Vec3f(1.0f), 0.0f }, { Vec3f(3.0f, 1.0f, 0.5f), 2.0f } });
+
+    const Vec3f t(1.0f, -2.0f, 3.0f), r(0.5f, 1.0f, -1.5f), s(2.0f, 1.0f, 0.75f);
+    const Matrix4f ref = Matrix4f::translate(t)
+        * Matrix4f::rotate(r.z(), Vec3f(0.0f, 0.0f, 1.0f))
+        * Matrix4f::rotate(r.y(), Vec3f(0.0f, 1.0f, 0.0f))
+        * Matrix4f::rotate(r.x(), Vec3f(1.0f, 0.0f, 0.0f))
+        * Matrix4f::scale(s);
+    assert(near(TransformTrack<>::compose(t, r, s), ref));
+    assert(near(track.evaluate(1.0f), ref));
+}
+
+static void testBatch()
+{
+    mt19937 rng(2);
+    uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    vector<AnimationTrack<float, EaseType::OutQuad>> tracks(10000);
+    for (auto& track : tracks)
+    {
+        for (int k = 0; k < 8; k++)
+            track.addKeypoint({ dist(rng), k + dist(rng) * 0.5f });
+    }
+
+    vector<float> out(tracks.size());
+    for (float t = -1.0f; t < 9.0f; t += 0.37f)
+    {
+        evaluateTracks(tracks, t, out.data());
+        for (size_t i = 0; i < tracks.size(); i++)
+            assert(out[i] == tracks[i].evaluate(t));
+    }
+}
+
+static void benchmark()
+{
+    constexpr size_t num_tracks = 50000;
+    constexpr int num_keys = 32, num_frames = 60;
+    mt19937 rng(3);
+    uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    vector<vector<Keypoint<float>>> raw(num_tracks);
+    vector<AnimationTrack<float, EaseType::InOutSine>> tracks(num_tracks);
+    for (size_t i = 0; i < num_tracks; i++)
+    {
+        for (int k = 0; k < num_keys; k++)
+            raw[i].push_back({ dist(rng), static_cast<float>(k) });
+        tracks[i] = AnimationTrack<float, EaseType::InOutSine>(raw[i]);
+    }
+
+    vector<float> out(num_tracks);
+    double checksum = 0.0;
+    auto t0 = chrono::high_resolution_clock::now();
+    for (int f = 0; f < num_frames; f++)
+    {
+        const float t = f * (num_keys - 1.0f) / num_frames;
+        for (size_t i = 0; i < num_tracks; i++)
+            out[i] = linearEvaluate(raw[i], t, EaseType::InOutSine);
+        checksum += out[f];
+    }
+    auto t1 = chrono::high_resolution_clock::now();
+    cout << "Linear search + runtime ease (50k tracks): " << chrono::duration<double, milli>(t1 - t0).count() / num_frames << " ms/frame" << endl;
+
+    t0 = chrono::high_resolution_clock::now();
+    for (int f = 0; f < num_frames; f++)
+    {
+        const float t = f * (num_keys - 1.0f) / num_frames;
+        evaluateTracks(tracks, t, out.data());
+        checksum -= out[f];
+    }
+    t1 = chrono::high_resolution_clock::now();
+    cout << "evaluateTracks (50k tracks): " << chrono::duration<double, milli>(t1 - t0).count() / num_frames << " ms/frame" << endl;
+    assert(fabs(checksum) < 1e-3);
+
+    vector<TransformTrack<>> transforms(num_tracks);
+    for (size_t i = 0; i < num_tracks; i++)
+    {
+        for (int k = 0; k < num_keys; k++)
+        {
+            transforms[i].translation.addKeypoint({ Vec3f(dist(rng), dist(rng), dist(rng)), static_cast<float>(k) });
+            transforms[i].rotation.addKeypoint({ Vec3f(dist(rng), dist(rng), dist(rng)), static_cast<float>(k) });
+        }
+    }
+    vector<Matrix4f> matrices(num_tracks);
+    t0 = chrono::high_resolution_clock::now();
+    for (int f = 0; f < num_frames; f++)
+        evaluateTracks(transforms, f * (num_keys - 1.0f) / num_frames, matrices.data());
+    t1 = chrono::high_resolution_clock::now();
+    cout << "evaluateTracks (50k transforms): " << chrono::duration<double, milli>(t1 - t0).count() / num_frames << " ms/frame" << endl;
+}
+
+int main()
+{
+    testEasing();
+    testTrack();
+    testTransform();
+    testBatch();
+    benchmark();
+
+    cout << "animation: all tests passed" << endl;
+    return 0;
+}
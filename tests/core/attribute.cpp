@@ -0,0 +1,231 @@
+#include <prayground/core/attribute.h>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace prayground;
+
+namespace {
+    // Same parameters as loadObjWithMtl()
+    Attributes makeMaterial(int i)
+    {
+        Attributes attrib;
+        attrib.name = "material" + to_string(i);
+        attrib.addVec3f("ambient", Vec3f(0.1f));
+        attrib.addVec3f("diffuse", Vec3f(static_cast<float>(i)));
+        attrib.addVec3f("specular", Vec3f(0.5f));
+        attrib.addVec3f("transmittance", Vec3f(0.0f));
+        attrib.addVec3f("emission", Vec3f(0.0f));
+        attrib.addFloat("shininess", 10.0f);
+        attrib.addFloat("ior", 1.5f);
+        attrib.addFloat("dissolve", 1.0f);
+        attrib.addString("diffuse_texture", "textures/diffuse" + to_string(i) + ".png");
+        return attrib;
+    }
+    /* Reference of the previous layout: one array of named items per type, searched linearly
+     * by comparing names. Items are shared between copies as they were. */
+    template <typename T>
+    struct LinearTable {
+        struct Item {
+            string name;
+            unique_ptr<T[]> values;
+            int num_values;
+        };
+        vector<shared_ptr<Item>> items;
+
+        void add(const string& name, const T& value)
+        {
+            items.push_back(make_shared<Item>(Item{ name, unique_ptr<T[]>(new T[1]{ value }), 1 }));
+        }
+
+        T findOne(const string& name, const T& d) const
+        {
+            for (const auto& item : items)
+                if (item->name == name)
+                    return item->num_values == 1 ? item->values[0] : d;
+            return d;
+        }
+    };
+
+    struct LinearAttributes {
+        string name;
+        LinearTable<float> floats;
+        LinearTable<Vec3f> vec3fs;
+        LinearTable<string> strings;
+    };
+
+    LinearAttributes makeLinearMaterial(int i)
+    {
+        LinearAttributes attrib;
+        attrib.name = "material" + to_string(i);
+        attrib.vec3fs.add("ambient", Vec3f(0.1f));
+        attrib.vec3fs.add("diffuse", Vec3f(static_cast<float>(i)));
+        attrib.vec3fs.add("specular", Vec3f(0.5f));
+        attrib.vec3fs.add("transmittance", Vec3f(0.0f));
+        attrib.vec3fs.add("emission", Vec3f(0.0f));
+        attrib.floats.add("shininess", 10.0f);
+        attrib.floats.add("ior", 1.5f);
+        attrib.floats.add("dissolve", 1.0f);
+        attrib.strings.add("diffuse_texture", "textures/diffuse" + to_string(i) + ".png");
+        return attrib;
+    }
+
+    double elapsed(chrono::high_resolution_clock::time_point t0)
+    {
+        return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - t0).count();
+    }
+} // nonamed namespace
+
+static void testFind()
+{
+    Attributes attrib;
+    int n = -1;
+    assert(attrib.findFloat("x", &n) == nullptr && n == -1);
+    assert(attrib.findOneFloat("x", 2.0f) == 2.0f);
+
+    attrib.addBool("visible", true);
+    attrib.addInt("id", 7);
+    attrib.addFloat("roughness", 0.25f);
+    attrib.addVec2f("uv_scale", Vec2f(2.0f, 3.0f));
+    attrib.addVec4f("color", Vec4f(1.0f, 0.5f, 0.25f, 1.0f));
+    attrib.addString("texture", "a.png");
+    attrib.addVec3f("points", unique_ptr<Vec3f[]>(new Vec3f[3]{ Vec3f(1.0f), Vec3f(2.0f), Vec3f(3.0f) }), 3);
+    attrib.addInt("ids", unique_ptr<int[]>(new int[5]{ 1, 2, 3, 4, 5 }), 5);
+    attrib.addString("names", unique_ptr<string[]>(new string[2]{ "first", "second" }), 2);
+
+    assert(attrib.findOneBool("visible", false));
+    assert(attrib.findOneInt("id", 0) == 7);
+    assert(attrib.findOneFloat("roughness", 1.0f) == 0.25f);
+    assert(attrib.findOneVec2f("uv_scale", Vec2f(0.0f)) == Vec2f(2.0f, 3.0f));
+    assert(attrib.findOneVec4f("color", Vec4f(0.0f)) == Vec4f(1.0f, 0.5f, 0.25f, 1.0f));
+    assert(attrib.findOneString("texture", "") == "a.png");
+
+    const Vec3f* points = attrib.findVec3f("points", &n);
+    assert(n == 3 && points[2] == Vec3f(3.0f));
+    assert(reinterpret_cast<uintptr_t>(points) % alignof(Vec3f) == 0);
+    const int* ids = attrib.findInt("ids", &n);
+    assert(n == 5 && ids[0] == 1 && ids[4] == 5);
+    const string* names = attrib.findString("names", &n);
+    assert(n == 2 && names[1] == "second");
+    // Arrays are not single values
+    assert(attrib.findOneInt("ids", -1) == -1);
+
+    // Names are looked up per type
+    assert(attrib.findOneInt("roughness", -1) == -1);
+    assert(!attrib.contains("roughness", AttribType::Int) && attrib.contains("roughness", AttribType::Float));
+    attrib.addInt("roughness", 3);
+    assert(attrib.findOneInt("roughness", -1) == 3 && attrib.findOneFloat("roughness", 1.0f) == 0.25f);
+
+    // The first one added is kept
+    attrib.addFloat("roughness", 0.75f);
+    assert(attrib.findOneFloat("roughness", 1.0f) == 0.25f);
+    assert(attrib.numAttributes() == 10);
+
+    // Copies share the table until one of them is modified
+    Attributes copy = attrib;
+    const string* texture = attrib.findString("texture", &n);
+    assert(copy.findString("texture", &n) == texture);
+    copy.addFloat("metallic", 1.0f);
+    assert(copy.findOneFloat("metallic", 0.0f) == 1.0f && attrib.findOneFloat("metallic", 0.0f) == 0.0f);
+    assert(copy.findOneString("texture", "") == "a.png");
+    assert(copy.numAttributes() == 11 && attrib.numAttributes() == 10);
+    // Adding to the original keeps pointers found from the copy valid
+    Attributes other = attrib;
+    attrib.addFloat("specular", 0.5f);
+    assert(other.findString("texture", &n) == texture && *texture == "a.png");
+    assert(other.findOneFloat("specular", 0.0f) == 0.0f && attrib.findOneFloat("specular", 0.0f) == 0.5f);
+    // Duplicated names don't detach the table
+    Attributes same = other;
+    same.addFloat("roughness", 0.5f);
+    assert(same.findString("texture", &n) == texture);
+
+    Attributes empty;
+    Attributes empty_copy = empty;
+    assert(empty_copy.numAttributes() == 0 && !empty_copy.contains("texture", AttribType::String));
+}
+
+static void testManyAttributes()
+{
+    // Rehashing of the table
+    Attributes attrib;
+    for (int i = 0; i < 1000; i++)
+    {
+        attrib.addInt("attrib" + to_string(i), i);
+        attrib.addVec3f("attrib" + to_string(i), Vec3f(static_cast<float>(i)));
+    }
+    assert(attrib.numAttributes() == 2000);
+    for (int i = 0; i < 1000; i++)
+    {
+        assert(attrib.findOneInt("attrib" + to_string(i), -1) == i);
+        assert(attrib.findOneVec3f("attrib" + to_string(i), Vec3f(-1.0f)) == Vec3f(static_cast<float>(i)));
+    }
+    assert(attrib.findOneInt("attrib1000", -1) == -1);
+}
+
+static void benchmark()
+{
+    constexpr int num_materials = 50000, num_rounds = 10;
+    auto t0 = chrono::high_resolution_clock::now();
+    vector<LinearAttributes> linear_materials;
+    for (int i = 0; i < num_materials; i++)
+        linear_materials.emplace_back(makeLinearMaterial(i));
+    cout << "Build 50k materials (linear scan): " << elapsed(t0) << " ms" << endl;
+
+    t0 = chrono::high_resolution_clock::now();
+    vector<Attributes> materials;
+    for (int i = 0; i < num_materials; i++)
+        materials.emplace_back(makeMaterial(i));
+    cout << "Build 50k materials (Attributes): " << elapsed(t0) << " ms" << endl;
+
+    t0 = chrono::high_resolution_clock::now();
+    vector<LinearAttributes> linear_copies = linear_materials;
+    cout << "Copy 50k materials (linear scan): " << elapsed(t0) << " ms" << endl;
+
+    t0 = chrono::high_resolution_clock::now();
+    vector<Attributes> copies = materials;
+    cout << "Copy 50k materials (Attributes): " << elapsed(t0) << " ms" << endl;
+    assert(copies.size() == materials.size() && linear_copies.size() == linear_materials.size());
+
+    // The lookups of loadObjWithMtl() for each material
+    float linear_sum = 0.0f;
+    size_t linear_num_textures = 0;
+    t0 = chrono::high_resolution_clock::now();
+    for (int r = 0; r < num_rounds; r++)
+    {
+        for (const auto& m : linear_materials)
+        {
+            linear_sum += m.vec3fs.findOne("diffuse", Vec3f(0.0f)).x() + m.floats.findOne("dissolve", 0.0f) + m.floats.findOne("ior", 0.0f);
+            linear_num_textures += !m.strings.findOne("diffuse_texture", "").empty();
+        }
+    }
+    cout << "2M lookups (linear scan): " << elapsed(t0) << " ms" << endl;
+
+    float sum = 0.0f;
+    size_t num_textures = 0;
+    t0 = chrono::high_resolution_clock::now();
+    for (int r = 0; r < num_rounds; r++)
+    {
+        for (const auto& m : materials)
+        {
+            sum += m.findOneVec3f("diffuse", Vec3f(0.0f)).x() + m.findOneFloat("dissolve", 0.0f) + m.findOneFloat("ior", 0.0f);
+            num_textures += !m.findOneString("diffuse_texture", "").empty();
+        }
+    }
+    cout << "2M lookups (Attributes): " << elapsed(t0) << " ms" << endl;
+    assert(num_textures == num_rounds * num_materials && num_textures == linear_num_textures);
+    assert(sum == linear_sum);
+}
+
+int main()
+{
+    testFind();
+    testManyAttributes();
+    benchmark();
+
+    cout << "attribute: all tests passed" << endl;
+    return 0;
+}
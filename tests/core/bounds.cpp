@@ -0,0 +1,158 @@
+#include <prayground/core/bounds.h>
+#include <prayground/shape/pcd.h>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace prayground;
+
+namespace {
+    bool equal(const AABB& a, const AABB& b)
+    {
+        return a.min() == b.min() && a.max() == b.max();
+    }
+
+    // Bound of the spheres merged one at a time, as Shape::bound() did before
+    AABB mergeSpheres(const vector<PointCloud::Data>& points)
+    {
+        AABB aabb = AABB::empty();
+        for (const auto& p : points)
+            aabb = AABB::merge(aabb, AABB(p.point - p.radius, p.point + p.radius));
+        return aabb;
+    }
+
+    vector<Vec3f> randomPoints(mt19937& rng, size_t n)
+    {
+        uniform_real_distribution<float> dist(-50.0f, 100.0f);
+        vector<Vec3f> points(n);
+        for (auto& p : points)
+            p = Vec3f(dist(rng), dist(rng), dist(rng));
+        return points;
+    }
+} // nonamed namespace
+
+static void testAABB()
+{
+    const AABB box(Vec3f(0.0f, 1.0f, 2.0f), Vec3f(1.0f, 3.0f, 5.0f));
+    // 2 * (1*2 + 2*3 + 3*1)
+    assert(box.surfaceArea() == 22.0f);
+    assert(box.halfArea() == 11.0f);
+    assert(box.centroid() == Vec3f(0.5f, 2.0f, 3.5f));
+    assert(box.extent() == Vec3f(1.0f, 2.0f, 3.0f));
+    assert(box.longestAxis() == 2);
+    assert(AABB(Vec3f(0.0f), Vec3f(4.0f, 1.0f, 4.0f)).longestAxis() == 0);
+
+    // Empty box is the identity of merge
+    const AABB empty = AABB::empty();
+    assert(!empty.isValid() && empty.surfaceArea() == 0.0f);
+    assert(equal(AABB::merge(empty, box), box));
+    assert(equal(AABB::merge(box, empty), box));
+
+    AABB acc = AABB::empty();
+    acc.expand(Vec3f(1.0f, -1.0f, 2.0f));
+    assert(acc.isValid() && acc.surfaceArea() == 0.0f);
+    acc.expand(Vec3f(-1.0f, 1.0f, 3.0f));
+    assert(equal(acc, AABB(Vec3f(-1.0f, -1.0f, 2.0f), Vec3f(1.0f, 1.0f, 3.0f))));
+    assert(equal(AABB::merge(AABB{}, Vec3f(2.0f)), AABB(Vec3f(0.0f), Vec3f(2.0f))));
+}
+
+static void testPoints()
+{
+    mt19937 rng(1);
+    assert(equal(boundPoints(nullptr, 0), AABB{}));
+    // Sizes around the SIMD width and the parallel grain
+    for (size_t n : { size_t(1), size_t(7), size_t(8), size_t(9), size_t(100), size_t(1 << 16), size_t((1 << 18) + 5) })
+    {
+        const vector<Vec3f> points = randomPoints(rng, n);
+        AABB ref = AABB::empty();
+        for (const Vec3f& p : points)
+            ref.expand(p);
+        assert(equal(boundPoints(points), ref));
+    }
+}
+
+static void testBoxes()
+{
+    mt19937 rng(2);
+    assert(equal(boundBoxes(nullptr, 0), AABB{}));
+    for (size_t n : { size_t(1), size_t(5), size_t(1000), size_t(1 << 17) })
+    {
+        const vector<Vec3f> points = randomPoints(rng, n * 2);
+        vector<AABB> boxes(n);
+        AABB ref = AABB::empty();
+        for (size_t i = 0; i < n; i++)
+        {
+            AABB b = AABB::empty();
+            b.expand(points[i * 2]);
+            b.expand(points[i * 2 + 1]);
+            boxes[i] = b;
+            ref.expand(b);
+        }
+        // Empty boxes don't change the union
+        boxes.push_back(AABB::empty());
+        assert(equal(boundBoxes(boxes), ref));
+    }
+}
+
+static void testSpheres()
+{
+    mt19937 rng(3);
+    uniform_real_distribution<float> radius(0.0f, 2.0f);
+    for (size_t n : { size_t(1), size_t(3), size_t(1000), size_t(1 << 17) })
+    {
+        const vector<Vec3f> centers = randomPoints(rng, n);
+        vector<PointCloud::Data> points(n);
+        for (size_t i = 0; i < n; i++)
+            points[i] = { centers[i], radius(rng) };
+        assert(equal(boundSpheres(points.data(), n, &PointCloud::Data::point, &PointCloud::Data::radius), mergeSpheres(points)));
+    }
+
+    // The origin isn't included, unlike merging from AABB{}
+    const PointCloud::Data far_point{ Vec3f(10.0f), 1.0f };
+    const AABB aabb = boundSpheres(&far_point, 1, &PointCloud::Data::point, &PointCloud::Data::radius);
+    assert(equal(aabb, AABB(Vec3f(9.0f), Vec3f(11.0f))));
+}
+
+static void benchmark()
+{
+    constexpr size_t n = 1 << 22;
+    mt19937 rng(4);
+    const vector<Vec3f> centers = randomPoints(rng, n);
+    vector<PointCloud::Data> points(n);
+    for (size_t i = 0; i < n; i++)
+        points[i] = { centers[i], 0.5f };
+
+    auto time = [](const char* label, auto func)
+    {
+        auto t0 = chrono::high_resolution_clock::now();
+        const AABB aabb = func();
+        auto t1 = chrono::high_resolution_clock::now();
+        cout << label << ": " << chrono::duration<double, milli>(t1 - t0).count() << " ms (" << aabb << ")" << endl;
+    };
+
+    time("AABB::merge per sphere (4M)", [&] { return mergeSpheres(points); });
+    time("boundSpheres (4M)", [&] { return boundSpheres(points.data(), n, &PointCloud::Data::point, &PointCloud::Data::radius); });
+    time("AABB::expand per point (4M)", [&] {
+        AABB aabb = AABB::empty();
+        for (const Vec3f& p : centers)
+            aabb.expand(p);
+        return aabb;
+    });
+    time("boundPoints (4M)", [&] { return boundPoints(centers); });
+}
+
+int main()
+{
+    testAABB();
+    testPoints();
+    testBoxes();
+    testSpheres();
+    benchmark();
+
+    cout << "bounds: all tests passed" << endl;
+    return 0;
+}
@@ -7,8 +7,8 @@ using namespace prayground;
 
 unique_ptr<string[]> make_string(const std::string& str)
 {
-    auto ptr = make_unique<string[]>(str.size());
-    memcpy(ptr.get(), &str, str.size());
+    auto ptr = make_unique<string[]>(1);
+    ptr[0] = str;
     return ptr;
 }
 
@@ -0,0 +1,248 @@
+#include <prayground/core/sampler.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace prayground;
+
+// Order of x in GF(2)[x] / p(x). p(x) is primitive when it equals 2^degree - 1.
+static uint32_t orderOfX(uint32_t poly, uint32_t degree)
+{
+    uint32_t v = 1;
+    for (uint32_t order = 1; order < (1u << degree); order++)
+    {
+        v <<= 1;
+        if (v & (1u << degree))
+            v ^= poly;
+        if (v == 1)
+            return order;
+    }
+    return 0;
+}
+
+static void testDirectionNumbers()
+{
+    for (const auto& p : sobol_polynomials)
+    {
+        // x^s + a_1 x^(s-1) + ... + a_(s-1) x + 1
+        const uint32_t poly = (1u << p.degree) | (p.coeffs << 1) | 1u;
+        assert(orderOfX(poly, p.degree) == (1u << p.degree) - 1);
+        for (uint32_t k = 0; k < p.degree; k++)
+            assert((p.m[k] & 1u) && p.m[k] < (2u << k));
+    }
+    static_assert(sobol_matrices.columns[0][0] == 0x80000000u);
+    static_assert(sobol_matrices.columns[1][1] == 0xc0000000u);
+}
+
+// Each of 2^m points falls in a different interval of width 2^-m
+static bool isStratified1D(const vector<float>& xs)
+{
+    const size_t n = xs.size();
+    vector<int> count(n, 0);
+    for (float x : xs)
+        count[std::min<size_t>(size_t(x * n), n - 1)]++;
+    return all_of(count.begin(), count.end(), [](int c) { return c == 1; });
+}
+
+// 2^m points form a (0,m,2)-net: every elementary interval of area 2^-m contains one point
+static bool isNet2D(const vector<float>& xs, const vector<float>& ys)
+{
+    const uint32_t n = static_cast<uint32_t>(xs.size());
+    const uint32_t m = static_cast<uint32_t>(log2(n));
+    for (uint32_t a = 0; a <= m; a++)
+    {
+        const uint32_t nx = 1u << a, ny = 1u << (m - a);
+        vector<int> count(n, 0);
+        for (uint32_t i = 0; i < n; i++)
+            count[std::min(uint32_t(xs[i] * nx), nx - 1) * ny + std::min(uint32_t(ys[i] * ny), ny - 1)]++;
+        if (!all_of(count.begin(), count.end(), [](int c) { return c == 1; }))
+            return false;
+    }
+    return true;
+}
+
+static void testStratification()
+{
+    const uint32_t n = 256;
+    for (uint32_t seed : { 0u, 1u, 12345u })
+    {
+        vector<float> dims[kNumSobolDimensions];
+        vector<float> px, py;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            SobolSampler sampler(seed, i);
+            for (uint32_t d = 0; d < kNumSobolDimensions; d++)
+                dims[d].push_back(sampler.get1D());
+
+            PaddedSobolSampler padded(seed, i, 7);
+            const Vec2f u = padded.get2D();
+            px.push_back(u[0]);
+            py.push_back(u[1]);
+        }
+        for (uint32_t d = 0; d < kNumSobolDimensions; d++)
+            assert(isStratified1D(dims[d]));
+        assert(isNet2D(dims[0], dims[1]));
+        assert(isNet2D(px, py));
+    }
+}
+
+// L2 star discrepancy by Warnock's formula
+static double l2StarDiscrepancy(const vector<float>& xs, const vector<float>& ys)
+{
+    const size_t n = xs.size();
+    double sum1 = 0.0, sum2 = 0.0;
+    for (size_t i = 0; i < n; i++)
+    {
+        sum1 += (1.0 - xs[i] * xs[i]) * (1.0 - ys[i] * ys[i]);
+        for (size_t j = 0; j < n; j++)
+            sum2 += (1.0 - std::max(xs[i], xs[j])) * (1.0 - std::max(ys[i], ys[j]));
+    }
+    return sqrt(1.0 / 9.0 - sum1 / (2.0 * n) + sum2 / (double(n) * n));
+}
+
+static void testDiscrepancy()
+{
+    const uint32_t n = 1024;
+    vector<float> sx, sy, rx, ry;
+    uint32_t seed = 7;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        SobolSampler sampler(42, i);
+        const Vec2f u = sampler.get2D();
+        sx.push_back(u[0]);
+        sy.push_back(u[1]);
+        rx.push_back(rnd(seed));
+        ry.push_back(rnd(seed));
+    }
+    const double d_sobol = l2StarDiscrepancy(sx, sy);
+    const double d_random = l2StarDiscrepancy(rx, ry);
+    cout << "L2 star discrepancy (1024 points): sobol = " << d_sobol << ", random = " << d_random << endl;
+    assert(d_sobol * 10.0 < d_random);
+}
+
+// RMS error of estimating the integral of a smooth 2D function over many pixels (seeds)
+template <class SampleFunc>
+static double rmse(uint32_t n, const SampleFunc& sample2D)
+{
+    auto f = [](const Vec2f& u) { return exp(-(u[0] * u[0] + u[1] * u[1])); };
+    // \int_0^1 \int_0^1 exp(-x^2 - y^2) dx dy
+    const double reference = pow(0.5 * sqrt(M_PI) * erf(1.0), 2.0);
+
+    const uint32_t num_trials = 256;
+    double sum_sq = 0.0;
+    for (uint32_t t = 0; t < num_trials; t++)
+    {
+        double estimate = 0.0;
+        for (uint32_t i = 0; i < n; i++)
+            estimate += f(sample2D(t, i));
+        estimate /= n;
+        sum_sq += (estimate - reference) * (estimate - reference);
+    }
+    return sqrt(sum_sq / num_trials);
+}
+
+static void testConvergence()
+{
+    auto sobol = [](uint32_t seed, uint32_t i) { return SobolSampler(seed, i).get2D(); };
+    auto padded = [](uint32_t seed, uint32_t i) { return PaddedSobolSampler(seed, i, 3).get2D(); };
+    auto uniform = [](uint32_t seed, uint32_t i) { uint32_t s = tea<4>(seed, i); return UniformSampler::get2D(s); };
+
+    // Monte Carlo error decreases by 4x for 16x samples. Owen-scrambled Sobol converges at O(N^-1.5) for smooth integrands.
+    const double mc_ratio = rmse(64, uniform) / rmse(1024, uniform);
+    const double sobol_ratio = rmse(64, sobol) / rmse(1024, sobol);
+    const double padded_ratio = rmse(64, padded) / rmse(1024, padded);
+    cout << "RMSE ratio (64 -> 1024 spp): uniform = " << mc_ratio << ", sobol = " << sobol_ratio << ", padded = " << padded_ratio << endl;
+    assert(mc_ratio < 8.0);
+    assert(sobol_ratio > 25.0);
+    assert(padded_ratio > 25.0);
+    assert(rmse(256, sobol) * 8.0 < rmse(256, uniform));
+}
+
+static void testZSobol()
+{
+    const uint32_t log2_res = 4, res = 1u << log2_res;
+
+    // Samples in one pixel are stratified
+    for (uint32_t log2_spp : { 2u, 3u, 4u })
+    {
+        const uint32_t spp = 1u << log2_spp;
+        for (uint32_t y = 0; y < res; y += 5)
+        {
+            for (uint32_t x = 0; x < res; x += 3)
+            {
+                vector<float> d0, d1, d2;
+                for (uint32_t s = 0; s < spp; s++)
+                {
+                    ZSobolSampler sampler(Vec2ui(x, y), s, log2_spp, log2_res, 99);
+                    d0.push_back(sampler.get1D());
+                    const Vec2f u = sampler.get2D();
+                    d1.push_back(u[0]);
+                    d2.push_back(u[1]);
+                }
+                assert(isStratified1D(d0));
+                assert(isNet2D(d1, d2));
+            }
+        }
+    }
+
+    // At 1 spp, every aligned 2x2 pixel quad takes complementary points (blue-noise error distribution)
+    for (uint32_t y = 0; y < res; y += 2)
+    {
+        for (uint32_t x = 0; x < res; x += 2)
+        {
+            vector<float> d0;
+            for (uint32_t j = 0; j < 4; j++)
+                d0.push_back(ZSobolSampler(Vec2ui(x + (j & 1), y + (j >> 1)), 0, 0, log2_res, 99).get1D());
+            assert(isStratified1D(d0));
+        }
+    }
+
+    // At the limit of 2 * log2_resolution + log2_spp = 32, pixels in different screen quadrants
+    // keep their own sequences and the samples in the farthest pixel are still stratified
+    {
+        const uint32_t log2_big_res = 14, log2_spp = 4, half = 1u << (log2_big_res - 1);
+        const Vec2ui pixel(1234, 567);
+        vector<float> firsts;
+        for (uint32_t j = 0; j < 4; j++)
+        {
+            const Vec2ui p(pixel[0] + (j & 1) * half, pixel[1] + (j >> 1) * half);
+            ZSobolSampler sampler(p, 0, log2_spp, log2_big_res, 99);
+            firsts.push_back(sampler.get1D());
+        }
+        sort(firsts.begin(), firsts.end());
+        assert(adjacent_find(firsts.begin(), firsts.end()) == firsts.end());
+
+        vector<float> d0, d1, d2;
+        for (uint32_t s = 0; s < (1u << log2_spp); s++)
+        {
+            ZSobolSampler sampler(Vec2ui((1u << log2_big_res) - 1), s, log2_spp, log2_big_res, 99);
+            d0.push_back(sampler.get1D());
+            const Vec2f u = sampler.get2D();
+            d1.push_back(u[0]);
+            d2.push_back(u[1]);
+        }
+        assert(isStratified1D(d0));
+        assert(isNet2D(d1, d2));
+
+        // One more bit doesn't fit
+        bool thrown = false;
+        try { ZSobolSampler(pixel, 0, log2_spp + 1, log2_big_res, 99); }
+        catch (const std::runtime_error&) { thrown = true; }
+        assert(thrown);
+    }
+}
+
+int main()
+{
+    testDirectionNumbers();
+    testStratification();
+    testDiscrepancy();
+    testConvergence();
+    testZSobol();
+    cout << "sampler: all tests passed" << endl;
+    return 0;
+}
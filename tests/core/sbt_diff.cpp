@@ -0,0 +1,85 @@
+#include <prayground/optix/sbt_diff.h>
+#include <prayground/material/diffuse.h>
+#include <prayground/material/layered.h>
+#include <prayground/texture/constant.h>
+#include <prayground/texture/checker.h>
+#include <cassert>
+#include <iostream>
+
+using namespace std;
+using namespace prayground;
+
+struct HitgroupData {
+    void* shape_data;
+    void* surface_info;
+};
+
+int main()
+{
+    // Coalescing of record indices
+    assert(coalesceIndices({}).empty());
+    assert((coalesceIndices({ 0, 1, 2, 5 }) == vector<IndexRange>{ {0, 3}, {5, 1} }));
+    assert((coalesceIndices({ 0, 1, 2, 5 }, 2) == vector<IndexRange>{ {0, 6} }));
+    assert((coalesceIndices({ 3, 3, 4 }) == vector<IndexRange>{ {3, 2} }));
+
+    // Diffing records
+    vector<HitgroupData> prev(10);
+    for (int i = 0; i < 10; i++)
+        prev[i] = { reinterpret_cast<void*>(0x1000ull * i), reinterpret_cast<void*>(0x10ull * i) };
+
+    vector<HitgroupData> curr = prev;
+    assert(diffRecords(prev, curr).empty());
+
+    curr[2].surface_info = reinterpret_cast<void*>(0xdead);
+    curr[3].surface_info = reinterpret_cast<void*>(0xbeef);
+    curr[8].shape_data = nullptr;
+    auto ranges = diffRecords(prev, curr);
+    assert((ranges == vector<IndexRange>{ {2, 2}, {8, 1} }));
+    assert(numIndicesInRanges(ranges) == 3);
+
+    // Grown array reports the new records as changed
+    curr = prev;
+    curr.push_back({ nullptr, nullptr });
+    assert((diffRecords(prev, curr) == vector<IndexRange>{ {10, 1} }));
+
+    // Surfaces are re-uploaded by updateSBT() while they are dirty. Changes of textures
+    // and of layers must reach the owning material.
+    auto constant = make_shared<ConstantTexture_<Vec3f>>(Vec3f(0.5f), 0);
+    auto checker = make_shared<CheckerTexture_<Vec3f>>(Vec3f(1.0f), Vec3f(0.0f), 10.0f, 0);
+    auto diffuse = make_shared<Diffuse>(SurfaceCallableID{}, constant);
+    auto bumped = make_shared<Diffuse>(SurfaceCallableID{}, constant);
+    bumped->setBumpmap(checker);
+    auto layered = make_shared<Layered>(SurfaceCallableID{}, vector<shared_ptr<Material>>{ diffuse });
+    auto clear = [&]()
+    {
+        constant->clearDirty();
+        checker->clearDirty();
+        diffuse->clearDirty();
+        bumped->clearDirty();
+        layered->clearDirty();
+        assert(!diffuse->isDirty() && !bumped->isDirty() && !layered->isDirty());
+    };
+
+    clear();
+    constant->setColor(Vec3f(0.8f));
+    assert(diffuse->isDirty() && bumped->isDirty() && layered->isDirty());
+
+    clear();
+    checker->setColor1(Vec3f(0.2f));
+    assert(!diffuse->isDirty() && bumped->isDirty() && !layered->isDirty());
+
+    clear();
+    diffuse->setTexture(checker);
+    assert(layered->isDirty());
+
+    clear();
+    layered->addTopLayer(bumped);
+    assert(layered->isDirty() && !bumped->isDirty());
+
+    clear();
+    layered->addBottomLayer(make_shared<Diffuse>(SurfaceCallableID{}, checker));
+    assert(layered->isDirty());
+
+    cout << "sbt_diff: all tests passed" << endl;
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <prayground/core/scene.h>
+#include <prayground/shape/sphere.h>
+#include <prayground/shape/trianglemesh.h>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+using namespace prayground;
+
+namespace {
+    using SceneT = Scene<Camera, 1>;
+
+    bool near(float a, float b, float eps = 1e-4f)
+    {
+        return fabsf(a - b) <= eps * fmaxf(1.0f, fabsf(b));
+    }
+
+    bool near(const Vec3f& a, const Vec3f& b)
+    {
+        return near(a.x(), b.x()) && near(a.y(), b.y()) && near(a.z(), b.z());
+    }
+
+    // Square of [-1, 1]^2 on the z = 0 plane. Triangle 0 covers y < x and triangle 1 covers y > x.
+    shared_ptr<TriangleMesh> makeFloor()
+    {
+        vector<Vec3f> vertices{ Vec3f(-1.0f, -1.0f, 0.0f), Vec3f(1.0f, -1.0f, 0.0f), Vec3f(1.0f, 1.0f, 0.0f), Vec3f(-1.0f, 1.0f, 0.0f) };
+        vector<Face> faces{
+            Face{ Vec3i(0, 1, 2), Vec3i(0), Vec3i(0) },
+            Face{ Vec3i(0, 2, 3), Vec3i(0), Vec3i(0) }
+        };
+        return make_shared<TriangleMesh>(vertices, faces, vector<Vec3f>{ Vec3f(0.0f, 0.0f, 1.0f) }, vector<Vec2f>{ Vec2f(0.0f) });
+    }
+
+    // Straight down from above the point
+    Ray downRay(float x, float y)
+    {
+        return Ray(Vec3f(x, y, 5.0f), Vec3f(0.0f, 0.0f, -1.0f), 1e-3f, 1e16f);
+    }
+} // nonamed namespace
+
+int main()
+{
+    SceneT scene;
+    // Objects without materials have no hitgroup records, so no program groups are needed to add them.
+    array<ProgramGroup, 1> hitgroup_prgs;
+    scene.addObject("floor", makeFloor(), vector<shared_ptr<Material>>{}, hitgroup_prgs);
+    scene.addObject("ball", make_shared<Sphere>(0.5f), vector<shared_ptr<Material>>{}, hitgroup_prgs, Matrix4f::translate(0.0f, 0.0f, 2.0f));
+
+    // Name and primitive id of the closest hit. The BVH is built at the first query.
+    auto hit = scene.queryClosestHit(downRay(0.5f, -0.5f));
+    assert(hit && hit->name == "floor" && hit->prim_id == 0);
+    assert(near(hit->t, 5.0f) && near(hit->position, Vec3f(0.5f, -0.5f, 0.0f)) && near(hit->normal, Vec3f(0.0f, 0.0f, 1.0f)));
+    hit = scene.queryClosestHit(downRay(-0.5f, 0.5f));
+    assert(hit && hit->name == "floor" && hit->prim_id == 1);
+
+    // The ball is in front of the floor
+    hit = scene.queryClosestHit(downRay(0.0f, 0.0f));
+    assert(hit && hit->name == "ball" && near(hit->t, 2.5f) && near(hit->normal, Vec3f(0.0f, 0.0f, 1.0f)));
+
+    assert(!scene.queryClosestHit(downRay(3.0f, 0.0f)));
+    assert(scene.queryAnyHit(downRay(0.0f, 0.0f)) && !scene.queryAnyHit(downRay(3.0f, 0.0f)));
+
+    // Refit after moving the ball beside the floor
+    scene.updateObjectTransform("ball", Matrix4f::translate(3.0f, 0.0f, 0.0f));
+    hit = scene.queryClosestHit(downRay(0.0f, 0.0f));
+    assert(hit && hit->name == "floor" && near(hit->t, 5.0f));
+    hit = scene.queryClosestHit(downRay(3.0f, 0.0f));
+    assert(hit && hit->name == "ball" && near(hit->position, Vec3f(3.0f, 0.0f, 0.5f)));
+
+    // Batched queries give the same results as the single ones
+    vector<Ray> rays;
+    for (int i = 0; i < 1000; i++)
+        rays.push_back(downRay(-1.5f + 5.0f * i / 1000.0f, 0.25f));
+    auto hits = scene.queryClosestHits(rays);
+    auto any_hits = scene.queryAnyHits(rays);
+    assert(hits.size() == rays.size() && any_hits.size() == rays.size());
+    for (size_t i = 0; i < rays.size(); i++)
+    {
+        auto ref = scene.queryClosestHit(rays[i]);
+        assert(hits[i].has_value() == ref.has_value() && (any_hits[i] != 0) == ref.has_value());
+        if (ref)
+            assert(hits[i]->name == ref->name && hits[i]->prim_id == ref->prim_id && hits[i]->t == ref->t);
+    }
+
+    // Deleting an object rebuilds the BVH at the next query, and the remaining instances keep their names
+    assert(!scene.deleteObject("missing"));
+    assert(scene.deleteObject("floor"));
+    assert(!scene.queryClosestHit(downRay(0.5f, -0.5f)));
+    hit = scene.queryClosestHit(downRay(3.0f, 0.0f));
+    assert(hit && hit->name == "ball");
+
+    scene.addObject("floor2", makeFloor(), vector<shared_ptr<Material>>{}, hitgroup_prgs, Matrix4f::translate(0.0f, 0.0f, -1.0f));
+    hit = scene.queryClosestHit(downRay(-0.5f, 0.5f));
+    assert(hit && hit->name == "floor2" && hit->prim_id == 1 && near(hit->t, 6.0f));
+    hit = scene.queryClosestHit(downRay(3.0f, 0.0f));
+    assert(hit && hit->name == "ball");
+
+    // Moving an object after the rebuild refits the new BVH
+    scene.updateObjectTransform("floor2", Matrix4f::translate(3.0f, 0.0f, 1.0f));
+    hit = scene.queryClosestHit(downRay(3.0f, 0.0f));
+    assert(hit && hit->name == "floor2" && near(hit->t, 4.0f));
+    assert(!scene.queryAnyHit(downRay(-0.5f, 0.5f)));
+
+    cout << "scene_query: all tests passed" << endl;
+    return 0;
+}
@@ -0,0 +1,289 @@
+#include <prayground/core/spectrum.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace prayground;
+
+namespace {
+    constexpr float min_l = static_cast<float>(constants::min_lambda);
+    constexpr float max_l = static_cast<float>(constants::max_lambda);
+
+    float linearInterpReference(const float* lambda, const float* v, int n, float l)
+    {
+        if (l <= lambda[0]) return v[0];
+        if (l >= lambda[n - 1]) return v[n - 1];
+        for (int i = 0; i < n - 1; i++)
+            if (lambda[i] <= l && l < lambda[i + 1])
+                return lerp(v[i], v[i + 1], (l - lambda[i]) / (lambda[i + 1] - lambda[i]));
+        return v[n - 1];
+    }
+
+    // Dense trapezoidal integral of f(lambda) * CIE curves, normalized like toXYZ()
+    template <class Func>
+    Vec3f integrateXYZ(const Func& f)
+    {
+        constexpr int n = 68000;
+        double x = 0.0, y = 0.0, z = 0.0;
+        for (int i = 0; i <= n; i++)
+        {
+            const float l = min_l + (max_l - min_l) * i / n;
+            const double w = (i == 0 || i == n ? 0.5 : 1.0) * f(l) * (max_l - min_l) / n;
+            x += w * CIE_X(l);
+            y += w * CIE_Y(l);
+            z += w * CIE_Z(l);
+        }
+        return Vec3f(float(x), float(y), float(z)) / constants::CIE_Y_integral;
+    }
+
+    // Average of one-sample estimates over paths with stratified hero wavelengths
+    template <class Func>
+    Vec3f estimateXYZ(const Func& f, int num_paths, bool visible, bool terminate, uint32_t seed)
+    {
+        mt19937 rng(seed);
+        uniform_real_distribution<float> jitter(0.0f, 1.0f);
+        double x = 0.0, y = 0.0, z = 0.0;
+        for (int p = 0; p < num_paths; p++)
+        {
+            const float u = (p + jitter(rng)) / num_paths;
+            SampledWavelengths wl = visible ? SampledWavelengths::sampleVisible(u) : SampledWavelengths::sampleUniform(u);
+            if (terminate)
+                wl.terminateSecondary();
+            HeroSpectrum s;
+            for (int i = 0; i < HeroSpectrum::nSamples; i++)
+                s[i] = f(wl[i]);
+            const Vec3f xyz = s.toXYZ(wl);
+            x += xyz[0]; y += xyz[1]; z += xyz[2];
+        }
+        return Vec3f(float(x / num_paths), float(y / num_paths), float(z / num_paths));
+    }
+
+    float maxError(const Vec3f& a, const Vec3f& b)
+    {
+        return fmaxf(fabsf(a[0] - b[0]), fmaxf(fabsf(a[1] - b[1]), fabsf(a[2] - b[2])));
+    }
+} // nonamed namespace
+
+static void testInterpolation()
+{
+    mt19937 rng(1);
+    uniform_real_distribution<float> dist(0.0f, 1.0f);
+
+    // Direct indexing of the uniform grid gives the same values as the search in spectrum_lambda
+    const SampledSpectrum s = rgb2spectrum(Vec3f(0.3f, 0.6f, 0.9f));
+    for (int i = 0; i < 10000; i++)
+    {
+        const float l = 370.0f + 360.0f * dist(rng);
+        const float expected = linearInterpReference(constants::spectrum_lambda, s.c, SampledSpectrum::nSamples, l);
+        assert(fabsf(s.getSpectrumFromWavelength(l) - expected) < 1e-6f);
+    }
+    for (int i = 0; i < SampledSpectrum::nSamples; i++)
+        assert(s.getSpectrumFromWavelength(constants::spectrum_lambda[i]) == s.c[i]);
+
+    // Binary search on irregular samples
+    vector<float> lambda(57), value(57);
+    float l = 350.0f;
+    for (size_t i = 0; i < lambda.size(); i++)
+    {
+        l += 0.5f + 10.0f * dist(rng);
+        lambda[i] = l;
+        value[i] = dist(rng);
+    }
+    for (int i = 0; i < 10000; i++)
+    {
+        const float x = 340.0f + 700.0f * dist(rng);
+        const int n = static_cast<int>(lambda.size());
+        assert(fabsf(linearInterpSpectrumSamples(lambda.data(), value.data(), n, x) - linearInterpReference(lambda.data(), value.data(), n, x)) < 1e-6f);
+    }
+}
+
+static void testRGB()
+{
+    mt19937 rng(2);
+    uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (int i = 0; i < 1000; i++)
+    {
+        const Vec3f rgb(dist(rng), dist(rng), dist(rng));
+        const SampledSpectrum full = rgb2spectrum(rgb);
+        const SampledWavelengths wl = SampledWavelengths::sampleUniform(dist(rng));
+        const HeroSpectrum hero = rgb2spectrum(rgb, wl);
+        for (int k = 0; k < HeroSpectrum::nSamples; k++)
+            assert(fabsf(hero[k] - full.getSpectrumFromWavelength(wl[k])) < 1e-5f);
+    }
+
+    // Every ordering of RGB components reconstructs a spectrum of the similar color
+    const Vec3f colors[] = {
+        Vec3f(0.2f, 0.5f, 0.8f), Vec3f(0.2f, 0.8f, 0.5f), Vec3f(0.5f, 0.2f, 0.8f),
+        Vec3f(0.8f, 0.2f, 0.5f), Vec3f(0.5f, 0.8f, 0.2f), Vec3f(0.8f, 0.5f, 0.2f)
+    };
+    for (const Vec3f& rgb : colors)
+    {
+        const Vec3f reconstructed = rgb2spectrum(rgb).toRGB();
+        const Vec3f white = rgb2spectrum(Vec3f(1.0f)).toRGB();
+        const Vec3f normalized(reconstructed[0] / white[0], reconstructed[1] / white[1], reconstructed[2] / white[2]);
+        assert(maxError(normalized, rgb) < 0.1f);
+    }
+}
+
+static void testWavelengths()
+{
+    // Hero and rotated wavelengths fall into different strata of the range
+    for (float u : { 0.0f, 0.1f, 0.37f, 0.5f, 0.9999f })
+    {
+        const SampledWavelengths wl = SampledWavelengths::sampleUniform(u);
+        vector<bool> used(SampledWavelengths::nSamples, false);
+        for (int i = 0; i < SampledWavelengths::nSamples; i++)
+        {
+            assert(min_l <= wl[i] && wl[i] <= max_l);
+            assert(fabsf(wl.pdf[i] * (max_l - min_l) - 1.0f) < 1e-6f);
+            const int stratum = std::min(static_cast<int>((wl[i] - min_l) / (max_l - min_l) * SampledWavelengths::nSamples), SampledWavelengths::nSamples - 1);
+            assert(!used[stratum]);
+            used[stratum] = true;
+        }
+        assert(wl[0] == min_l + u * (max_l - min_l));
+    }
+
+    // PDF of visible wavelengths is normalized and matches the histogram of samples
+    double integral = 0.0;
+    for (int i = 0; i < 34000; i++)
+        integral += SampledWavelengths::visiblePdf(min_l + (i + 0.5f) * 0.01f) * 0.01;
+    assert(fabs(integral - 1.0) < 1e-4);
+
+    constexpr int num_bins = 34, num_samples = 1 << 18;
+    vector<int> histogram(num_bins, 0);
+    for (int i = 0; i < num_samples; i++)
+    {
+        const float lambda = SampledWavelengths::sampleVisible((i + 0.5f) / num_samples)[0];
+        assert(min_l <= lambda && lambda <= max_l);
+        histogram[std::min(static_cast<int>((lambda - min_l) / 10.0f), num_bins - 1)]++;
+    }
+    for (int b = 0; b < num_bins; b++)
+    {
+        double expected = 0.0;
+        for (int k = 0; k < 100; k++)
+            expected += SampledWavelengths::visiblePdf(min_l + b * 10.0f + (k + 0.5f) * 0.1f) * 0.1;
+        assert(fabs(double(histogram[b]) / num_samples - expected) < 1e-3);
+    }
+
+    SampledWavelengths wl = SampledWavelengths::sampleVisible(0.3f);
+    const float hero_pdf = wl.pdf[0];
+    assert(!wl.secondaryTerminated());
+    wl.terminateSecondary();
+    wl.terminateSecondary();
+    assert(wl.secondaryTerminated());
+    assert(wl.pdf[0] == hero_pdf / SampledWavelengths::nSamples && wl.pdf[1] == 0.0f);
+}
+
+static void testConvergence()
+{
+    // Binned SPD of tabulated samples (e.g. read by loadSPDFile()), reflectance from RGB and constant
+    vector<float> spd_lambda, spd_value;
+    for (float l = 300.0f; l <= 800.0f; l += 5.0f)
+    {
+        spd_lambda.push_back(l);
+        spd_value.push_back(1.0f + 0.8f * sinf(l * 0.05f) + 0.002f * (l - 500.0f));
+    }
+    const SampledSpectrum spd = SampledSpectrum::fromSample(spd_lambda.data(), spd_value.data(), static_cast<int>(spd_lambda.size()));
+    const SampledSpectrum rgb = rgb2spectrum(Vec3f(0.9f, 0.4f, 0.1f));
+    const SampledSpectrum bins[] = { spd, rgb, SampledSpectrum::constant(1.0f) };
+
+    for (const SampledSpectrum& s : bins)
+    {
+        auto f = [&](float l) { return s.getSpectrumFromWavelength(l); };
+        const Vec3f reference = integrateXYZ(f);
+        // Full-bin integration agrees with the piecewise linear spectrum up to the bin discretization
+        assert(maxError(s.toXYZ(), reference) < 0.04f * reference[1]);
+
+        float previous = 1e10f;
+        for (int num_paths : { 64, 1024, 16384 })
+        {
+            const Vec3f uniform = estimateXYZ(f, num_paths, false, false, 3);
+            const Vec3f visible = estimateXYZ(f, num_paths, true, false, 4);
+            const Vec3f terminated = estimateXYZ(f, num_paths, true, true, 5);
+            const float error = std::max(maxError(uniform, reference), maxError(visible, reference));
+            cout << "hero " << num_paths << " paths: uniform " << maxError(uniform, reference)
+                 << ", visible " << maxError(visible, reference)
+                 << ", hero only " << maxError(terminated, reference) << endl;
+            assert(error < previous || error < 1e-4f * reference[1]);
+            assert(maxError(terminated, reference) < 0.05f * reference[1]);
+            previous = error;
+        }
+        assert(previous < 1e-3f * reference[1]);
+    }
+
+    // Tabulated samples are evaluated directly without binning
+    SampledWavelengths wl = SampledWavelengths::sampleVisible(0.7f);
+    const HeroSpectrum direct = HeroSpectrum::fromSample(spd_lambda.data(), spd_value.data(), static_cast<int>(spd_lambda.size()), wl);
+    for (int i = 0; i < HeroSpectrum::nSamples; i++)
+        assert(fabsf(direct[i] - linearInterpReference(spd_lambda.data(), spd_value.data(), static_cast<int>(spd_lambda.size()), wl[i])) < 1e-6f);
+}
+
+static void testArithmetic()
+{
+    HeroSpectrum a = HeroSpectrum::constant(2.0f);
+    HeroSpectrum b = HeroSpectrum::zero();
+    assert(b.isBlack() && !a.isBlack());
+    b[1] = 4.0f;
+    const HeroSpectrum c = (a + b) * 0.5f - a / 4.0f;
+    assert(c[0] == 0.5f && c[1] == 2.5f);
+    // Zero components of divisor are ignored
+    const HeroSpectrum d = a / b;
+    assert(d[0] == 2.0f && d[1] == 0.5f);
+    assert((2.0f * a * b)[1] == 16.0f);
+    assert(c.maxValue() == 2.5f && c.average() == (0.5f * 3 + 2.5f) / HeroSpectrum::nSamples);
+}
+
+int main()
+{
+    testInterpolation();
+    testRGB();
+    testWavelengths();
+    testConvergence();
+    testArithmetic();
+
+    // Throughput of 8 bounces: full bins against hero wavelengths
+    mt19937 rng(6);
+    uniform_real_distribution<float> dist(0.0f, 1.0f);
+    constexpr int num_paths = 1 << 16;
+    vector<Vec3f> albedos(64);
+    for (auto& albedo : albedos)
+        albedo = Vec3f(dist(rng), dist(rng), dist(rng));
+    auto time = [](const char* label, auto&& func)
+    {
+        auto t0 = chrono::high_resolution_clock::now();
+        const float sum = func();
+        auto t1 = chrono::high_resolution_clock::now();
+        cout << label << ": " << chrono::duration<double, milli>(t1 - t0).count() << " ms (" << sum << ")" << endl;
+    };
+    time("SampledSpectrum (64K paths, 8 bounces)", [&] {
+        float sum = 0.0f;
+        for (int p = 0; p < num_paths; p++)
+        {
+            SampledSpectrum throughput = SampledSpectrum::constant(1.0f);
+            for (int depth = 0; depth < 8; depth++)
+                throughput *= rgb2spectrum(albedos[(p + depth) & 63]);
+            sum += throughput.toXYZ()[1];
+        }
+        return sum / num_paths;
+    });
+    time("HeroSpectrum (64K paths, 8 bounces)", [&] {
+        float sum = 0.0f;
+        for (int p = 0; p < num_paths; p++)
+        {
+            const SampledWavelengths wl = SampledWavelengths::sampleVisible((p + 0.5f) / num_paths);
+            HeroSpectrum throughput = HeroSpectrum::constant(1.0f);
+            for (int depth = 0; depth < 8; depth++)
+                throughput *= rgb2spectrum(albedos[(p + depth) & 63], wl);
+            sum += throughput.toXYZ(wl)[1];
+        }
+        return sum / num_paths;
+    });
+
+    cout << "spectrum: all tests passed" << endl;
+    return 0;
+}
@@ -0,0 +1,217 @@
+#include <prayground/core/spectrum_library.h>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+using namespace prayground;
+namespace fs = std::filesystem;
+
+namespace {
+    void writeFile(const fs::path& path, const string& text)
+    {
+        fs::create_directories(path.parent_path());
+        ofstream ofs(path, ios::binary);
+        ofs << text;
+    }
+
+    // Tabulated curve with a different shape for each id
+    string makeSPD(int id, const char* separator = " ", const char* eol = "\n")
+    {
+        ostringstream oss;
+        oss << "# Measured curve " << id << eol;
+        oss << "lambda" << separator << "value" << eol;
+        for (int l = 360; l <= 740; l += 5)
+            oss << l << separator << 0.5f + 0.4f * sinf(0.01f * l * (1 + id % 7) + id) << eol;
+        return oss.str();
+    }
+
+    // Line by line parsing with std::istringstream, which SPD files were loaded with before
+    SampledSpectrum referenceFromText(const string& text)
+    {
+        vector<float> lambda, value;
+        istringstream file(text);
+        string line;
+        while (getline(file, line))
+        {
+            istringstream iss(line);
+            float l, v;
+            if (!(iss >> l >> v)) continue;
+            lambda.emplace_back(l);
+            value.emplace_back(v);
+        }
+        return SampledSpectrum::fromSample(lambda.data(), value.data(), static_cast<int>(lambda.size()));
+    }
+
+    bool equal(const SampledSpectrum& a, const SampledSpectrum& b)
+    {
+        for (int i = 0; i < SampledSpectrum::nSamples; i++)
+            if (a[i] != b[i]) return false;
+        return true;
+    }
+
+    template <class Func>
+    bool throws(const Func& func)
+    {
+        try { func(); }
+        catch (const std::runtime_error&) { return true; }
+        return false;
+    }
+} // nonamed namespace
+
+static void testParse()
+{
+    vector<float> lambda, value;
+    parseSPD("# comment\r\nnm,value\r\n500, 0.5\r\n400;0.25\r\n\t600\t0.75 trailing\r\n700\r\nabc 1\r\n", lambda, value);
+    assert(lambda.size() == 3);
+    // Sorted by lambda
+    assert(lambda[0] == 400.0f && value[0] == 0.25f);
+    assert(lambda[1] == 500.0f && value[1] == 0.5f);
+    assert(lambda[2] == 600.0f && value[2] == 0.75f);
+
+    // Same result as the istringstream parser for whitespace separated files
+    const string text = makeSPD(3);
+    lambda.clear(); value.clear();
+    parseSPD(text, lambda, value);
+    assert(equal(SampledSpectrum::fromSample(lambda.data(), value.data(), static_cast<int>(lambda.size())), referenceFromText(text)));
+}
+
+static void testLibrary(const fs::path& root)
+{
+    const fs::path dir = root / "spd";
+    writeFile(dir / "metal" / "Au_eta.spd", makeSPD(0));
+    writeFile(dir / "metal" / "Au_k.SPD", makeSPD(1, ",", "\r\n"));
+    writeFile(dir / "glass.spd", makeSPD(2, "\t"));
+    writeFile(dir / "readme.txt", "not a spectrum");
+    writeFile(dir / "empty.spd", "");
+
+    SpectrumLibrary library;
+    library.loadDirectory(dir);
+    // empty.spd is skipped with a warning, and readme.txt is ignored
+    assert(library.size() == 3);
+    assert((library.names() == vector<string>{ "glass", "metal/Au_eta", "metal/Au_k" }));
+    assert(equal(library.at("metal/Au_eta"), referenceFromText(makeSPD(0))));
+    assert(equal(library.at("metal/Au_k"), referenceFromText(makeSPD(1, " "))));
+    assert(equal(library.at("glass"), SampledSpectrum::fromFile(dir / "glass.spd")));
+    assert(library.find("metal/Ag_eta") == nullptr);
+    assert(throws([&] { library.at("metal"); }));
+
+    // Archive gives the same spectra in place
+    const fs::path archive = root / "spd.bin";
+    library.save(archive);
+    SpectrumLibrary mapped;
+    mapped.openArchive(archive);
+    assert(mapped.size() == library.size());
+    assert(mapped.names() == library.names());
+    for (const auto& name : library.names())
+        assert(equal(mapped.at(name), library.at(name)));
+    assert(!mapped.contains("metal/Ag_eta"));
+
+    // Adding to a mapped library keeps the archived spectra
+    mapped.add("constant", SampledSpectrum::constant(0.5f));
+    assert(mapped.size() == 4);
+    assert(equal(mapped.at("glass"), library.at("glass")));
+    assert(mapped.at("constant")[40] == 0.5f);
+
+    // Broken archives are rejected
+    const fs::path broken = root / "broken.bin";
+    fs::copy_file(archive, broken);
+    fs::resize_file(broken, fs::file_size(broken) - 1);
+    assert(throws([&] { SpectrumLibrary l; l.openArchive(broken); }));
+    writeFile(broken, "PGSL");
+    assert(throws([&] { SpectrumLibrary l; l.openArchive(broken); }));
+}
+
+static void testCache(const fs::path& root)
+{
+    const fs::path dir = root / "cached";
+    const fs::path archive = root / "cached.bin";
+    writeFile(dir / "a.spd", makeSPD(10));
+    writeFile(dir / "b.spd", makeSPD(11));
+
+    SpectrumLibrary library;
+    library.loadCached(dir, archive);
+    assert(fs::exists(archive) && library.size() == 2);
+
+    // Up to date: the archive is used even if the contents are changed without updating the time stamp
+    const auto time = fs::last_write_time(dir / "a.spd");
+    writeFile(dir / "a.spd", makeSPD(12));
+    fs::last_write_time(dir / "a.spd", time);
+    library.loadCached(dir, archive);
+    assert(equal(library.at("a"), referenceFromText(makeSPD(10))));
+
+    // Newer file
+    fs::last_write_time(dir / "a.spd", fs::last_write_time(archive) + chrono::seconds(1));
+    library.loadCached(dir, archive);
+    assert(equal(library.at("a"), referenceFromText(makeSPD(12))));
+
+    // Removed file
+    fs::remove(dir / "b.spd");
+    library.loadCached(dir, archive);
+    assert(library.size() == 1 && !library.contains("b"));
+
+    // Broken archive is rebuilt
+    fs::resize_file(archive, 10);
+    fs::last_write_time(archive, fs::last_write_time(dir / "a.spd") + chrono::seconds(1));
+    library.loadCached(dir, archive);
+    assert(library.size() == 1 && fs::file_size(archive) > 10);
+}
+
+static void benchmark(const fs::path& root)
+{
+    constexpr int num_files = 2000;
+    const fs::path dir = root / "bench";
+    for (int i = 0; i < num_files; i++)
+        writeFile(dir / ("curve" + to_string(i) + ".spd"), makeSPD(i));
+
+    auto t0 = chrono::high_resolution_clock::now();
+    float sum = 0.0f;
+    for (int i = 0; i < num_files; i++)
+    {
+        ifstream ifs(dir / ("curve" + to_string(i) + ".spd"));
+        stringstream ss;
+        ss << ifs.rdbuf();
+        sum += referenceFromText(ss.str())[40];
+    }
+    auto t1 = chrono::high_resolution_clock::now();
+    cout << "istringstream, serial (" << num_files << " files): " << chrono::duration<double, milli>(t1 - t0).count() << " ms (" << sum << ")" << endl;
+
+    SpectrumLibrary library;
+    t0 = chrono::high_resolution_clock::now();
+    library.loadDirectory(dir);
+    t1 = chrono::high_resolution_clock::now();
+    cout << "SpectrumLibrary::loadDirectory: " << chrono::duration<double, milli>(t1 - t0).count() << " ms" << endl;
+
+    const fs::path archive = root / "bench.bin";
+    library.save(archive);
+    SpectrumLibrary mapped;
+    t0 = chrono::high_resolution_clock::now();
+    mapped.openArchive(archive);
+    sum = 0.0f;
+    for (int i = 0; i < num_files; i++)
+        sum += mapped.at("curve" + to_string(i))[40];
+    t1 = chrono::high_resolution_clock::now();
+    cout << "SpectrumLibrary::openArchive + lookups: " << chrono::duration<double, milli>(t1 - t0).count() << " ms (" << sum << ")" << endl;
+    assert(mapped.size() == num_files);
+}
+
+int main()
+{
+    const fs::path root = fs::temp_directory_path() / "prayground_spectrum_library_test";
+    fs::remove_all(root);
+    fs::create_directories(root);
+
+    testParse();
+    testLibrary(root);
+    testCache(root);
+    benchmark(root);
+
+    fs::remove_all(root);
+    cout << "spectrum_library: all tests passed" << endl;
+    return 0;
+}
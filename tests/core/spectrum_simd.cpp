@@ -0,0 +1,197 @@
+#include <prayground/core/spectrum.h>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace prayground;
+
+namespace {
+    constexpr int N = SampledSpectrum::nSamples;
+
+    // Scalar loops of SampledSpectrum before vectorization
+    namespace scalar {
+        SampledSpectrum mul(const SampledSpectrum& a, const SampledSpectrum& b)
+        {
+            SampledSpectrum ret;
+            for (int i = 0; i < N; i++) ret.c[i] = a.c[i] * b.c[i];
+            return ret;
+        }
+
+        SampledSpectrum add(const SampledSpectrum& a, const SampledSpectrum& b)
+        {
+            SampledSpectrum ret;
+            for (int i = 0; i < N; i++) ret.c[i] = a.c[i] + b.c[i];
+            return ret;
+        }
+
+        SampledSpectrum div(const SampledSpectrum& a, const SampledSpectrum& b)
+        {
+            SampledSpectrum ret;
+            for (int i = 0; i < N; i++) ret.c[i] = a.c[i] / (b.c[i] != 0.0f ? b.c[i] : 1.0f);
+            return ret;
+        }
+
+        bool isBlack(const SampledSpectrum& s)
+        {
+            for (int i = 0; i < N; i++)
+                if (s.c[i] != 0.0f) return false;
+            return true;
+        }
+
+        Vec3f toXYZ(const SampledSpectrum& s)
+        {
+            Vec3f ret{ 0.0f, 0.0f, 0.0f };
+            for (int i = 0; i < N; i++)
+            {
+                const float lambda = lerp(constants::min_lambda, constants::max_lambda, float(i) / N);
+                ret[0] += s.c[i] * CIE_X(lambda);
+                ret[1] += s.c[i] * CIE_Y(lambda);
+                ret[2] += s.c[i] * CIE_Z(lambda);
+            }
+            return ret * (float(constants::max_lambda - constants::min_lambda) / (constants::CIE_Y_integral * N));
+        }
+
+        float y(const SampledSpectrum& s)
+        {
+            float sum = 0.0f;
+            for (int i = 0; i < N; i++) sum += s.c[i];
+            return sum;
+        }
+    } // namespace scalar
+
+    SampledSpectrum randomSpectrum(mt19937& rng, bool with_zeros)
+    {
+        uniform_real_distribution<float> dist(0.0f, 2.0f);
+        SampledSpectrum s;
+        for (int i = 0; i < N; i++)
+            s.c[i] = (with_zeros && (rng() % 4 == 0)) ? 0.0f : dist(rng);
+        return s;
+    }
+
+    bool equal(const SampledSpectrum& a, const SampledSpectrum& b)
+    {
+        for (int i = 0; i < N; i++)
+            if (a.c[i] != b.c[i]) return false;
+        return true;
+    }
+} // nonamed namespace
+
+static void testElementwise()
+{
+    mt19937 rng(11);
+    for (int it = 0; it < 1000; it++)
+    {
+        const SampledSpectrum a = randomSpectrum(rng, false);
+        const SampledSpectrum b = randomSpectrum(rng, true);
+        const float t = 0.5f + float(it) / 1000.0f;
+
+        // Element-wise operations are exact regardless of the vector width
+        assert(equal(a + b, scalar::add(a, b)));
+        assert(equal(a * b, scalar::mul(a, b)));
+        assert(equal(a / b, scalar::div(a, b)));
+        SampledSpectrum d = a - b;
+        for (int i = 0; i < N; i++)
+            assert(d.c[i] == a.c[i] - b.c[i]);
+        d = a * t;
+        for (int i = 0; i < N; i++)
+            assert(d.c[i] == a.c[i] * t);
+        d = a / t;
+        for (int i = 0; i < N; i++)
+            assert(d.c[i] == a.c[i] / t);
+
+        // Compound assignment on itself
+        SampledSpectrum e = a;
+        e *= e;
+        assert(equal(e, scalar::mul(a, a)));
+    }
+}
+
+static void testReductions()
+{
+    mt19937 rng(5);
+    for (int it = 0; it < 1000; it++)
+    {
+        const SampledSpectrum s = randomSpectrum(rng, it % 2 == 0);
+        const Vec3f ref = scalar::toXYZ(s);
+        const Vec3f xyz = s.toXYZ();
+        for (int j = 0; j < 3; j++)
+            assert(fabsf(xyz[j] - ref[j]) <= 1e-5f * fmaxf(1.0f, fabsf(ref[j])));
+        assert(fabsf(s.y() - scalar::y(s)) <= 1e-5f * scalar::y(s));
+    }
+
+    // isBlack() checks every sample including the scalar remainder
+    SampledSpectrum s = SampledSpectrum::zero();
+    assert(s.isBlack());
+    for (int i = 0; i < N; i++)
+    {
+        s.c[i] = 1e-30f;
+        assert(!s.isBlack() && !scalar::isBlack(s));
+        s.c[i] = -0.0f;
+        assert(s.isBlack());
+        s.c[i] = NAN;
+        assert(!s.isBlack() && !scalar::isBlack(s));
+        s.c[i] = 0.0f;
+    }
+}
+
+static void benchmark()
+{
+    constexpr int num_spectra = 256;
+    constexpr int num_iterations = 20000;
+    mt19937 rng(1);
+    vector<SampledSpectrum> spectra(num_spectra);
+    for (auto& s : spectra)
+        s = randomSpectrum(rng, false);
+
+    auto time = [](const char* label, auto func)
+    {
+        auto t0 = chrono::high_resolution_clock::now();
+        const float sum = func();
+        auto t1 = chrono::high_resolution_clock::now();
+        cout << label << ": " << chrono::duration<double, milli>(t1 - t0).count() << " ms (" << sum << ")" << endl;
+    };
+
+    time("Scalar multiply-add", [&] {
+        SampledSpectrum acc = SampledSpectrum::zero();
+        for (int it = 0; it < num_iterations; it++)
+            for (int i = 0; i < num_spectra; i += 2)
+                acc = scalar::add(acc, scalar::mul(spectra[i], spectra[i + 1]));
+        return scalar::y(acc);
+    });
+    time("SIMD multiply-add", [&] {
+        SampledSpectrum acc = SampledSpectrum::zero();
+        for (int it = 0; it < num_iterations; it++)
+            for (int i = 0; i < num_spectra; i += 2)
+                acc += spectra[i] * spectra[i + 1];
+        return acc.y();
+    });
+
+    time("Scalar toXYZ", [&] {
+        float sum = 0.0f;
+        for (int it = 0; it < num_iterations / 20; it++)
+            for (int i = 0; i < num_spectra; i++)
+                sum += scalar::toXYZ(spectra[i])[1];
+        return sum;
+    });
+    time("SIMD toXYZ", [&] {
+        float sum = 0.0f;
+        for (int it = 0; it < num_iterations / 20; it++)
+            for (int i = 0; i < num_spectra; i++)
+                sum += spectra[i].toXYZ()[1];
+        return sum;
+    });
+}
+
+int main()
+{
+    testElementwise();
+    testReductions();
+    benchmark();
+
+    cout << "spectrum_simd: all tests passed" << endl;
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include <prayground/core/spectrum_table.h>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+using namespace std;
+using namespace prayground;
+
+namespace {
+    float maxError(const Vec3f& a, const Vec3f& b)
+    {
+        return fmaxf(fabsf(a[0] - b[0]), fmaxf(fabsf(a[1] - b[1]), fabsf(a[2] - b[2])));
+    }
+
+    // Random colors in the sRGB gamut, which is reachable by reflectances unlike the corners of ACEScg
+    Vec3f randomColor(RGBColorSpace color_space, mt19937& rng)
+    {
+        uniform_real_distribution<float> dist(0.0f, 1.0f);
+        const Vec3f c(dist(rng), dist(rng), dist(rng));
+        if (color_space == RGBColorSpace::sRGB)
+            return c;
+        return Vec3f(
+            0.6131f * c[0] + 0.3395f * c[1] + 0.0474f * c[2],
+            0.0702f * c[0] + 0.9164f * c[1] + 0.0134f * c[2],
+            0.0206f * c[0] + 0.1096f * c[1] + 0.8698f * c[2]);
+    }
+
+    RGBSigmoidPolynomial nodeCoefficients(const RGBToSpectrumTable& table, int l, int k, int j, int i)
+    {
+        const auto data = table.getData();
+        const int res = data.resolution;
+        const float* c = &data.coefficients[((((size_t)l * res + k) * res + j) * res + i) * 3];
+        return RGBSigmoidPolynomial{ c[0], c[1], c[2] };
+    }
+} // nonamed namespace
+
+// Spectra at the nodes reproduce the RGB they are optimized for. All nodes of sRGB are in the gamut of reflectances.
+static void testNodes(const RGBToSpectrumTable& table, float tolerance)
+{
+    const auto data = table.getData();
+    const int res = data.resolution;
+    float max_err = 0.0f;
+    for (int l = 0; l < 3; l++)
+        for (int k = 0; k < res; k++)
+            for (int j = 0; j < res; j++)
+                for (int i = 0; i < res; i++)
+                {
+                    const float z = data.z_nodes[k];
+                    Vec3f rgb;
+                    rgb[l] = z;
+                    rgb[(l + 1) % 3] = float(i) / (res - 1) * z;
+                    rgb[(l + 2) % 3] = float(j) / (res - 1) * z;
+                    max_err = fmaxf(max_err, maxError(table.toRGB(nodeCoefficients(table, l, k, j, i)), rgb));
+                }
+    cout << "  max round-trip error at nodes: " << max_err << endl;
+    assert(max_err < tolerance);
+}
+
+// Interpolated spectra of random colors are close to the RGB as well
+static void testInterpolated(const RGBToSpectrumTable& table, float tolerance)
+{
+    const auto data = table.getData();
+    mt19937 rng(7);
+    double sum_err = 0.0;
+    float max_err = 0.0f;
+    constexpr int n = 2000;
+    for (int s = 0; s < n; s++)
+    {
+        const Vec3f rgb = randomColor(table.colorSpace(), rng);
+        const RGBSigmoidPolynomial poly = data(rgb);
+        for (int i = 0; i < SampledSpectrum::nSamples; i++)
+        {
+            const float v = poly(constants::spectrum_lambda[i]);
+            assert(v >= 0.0f && v <= 1.0f);
+        }
+        const float err = maxError(table.toRGB(poly), rgb);
+        sum_err += err;
+        max_err = fmaxf(max_err, err);
+    }
+    cout << "  interpolated round-trip error: mean " << sum_err / n << ", max " << max_err << endl;
+    assert(sum_err / n < tolerance * 0.25f);
+    assert(max_err < tolerance);
+}
+
+static void testGrayAndBlack(const RGBToSpectrumTable& table)
+{
+    const auto data = table.getData();
+    for (float v : { 0.0f, 0.05f, 0.18f, 0.5f, 0.9f, 1.0f })
+    {
+        const RGBSigmoidPolynomial poly = data(Vec3f(v));
+        for (float l = 380.0f; l <= 720.0f; l += 10.0f)
+            assert(fabsf(poly(l) - v) < 1e-5f);
+        assert(maxError(table.toRGB(poly), Vec3f(v)) < 1e-4f);
+    }
+
+    SampledWavelengths wl = SampledWavelengths::sampleUniform(0.3f);
+    assert(data.unbounded(Vec3f(0.0f), wl).isBlack());
+    // Emission brighter than 1 keeps its scale
+    const HeroSpectrum e = data.unbounded(Vec3f(4.0f, 4.0f, 4.0f), wl);
+    for (int i = 0; i < HeroSpectrum::nSamples; i++)
+        assert(fabsf(e[i] - 4.0f) < 1e-4f);
+}
+
+// HeroSpectrum and SampledSpectrum of the same color evaluate the same polynomial
+static void testHero(const RGBToSpectrumTable& table)
+{
+    const auto data = table.getData();
+    mt19937 rng(3);
+    uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (int s = 0; s < 200; s++)
+    {
+        const Vec3f rgb = randomColor(table.colorSpace(), rng);
+        const SampledWavelengths wl = SampledWavelengths::sampleVisible(dist(rng));
+        const HeroSpectrum hero = rgb2spectrum(rgb, wl, data);
+        const SampledSpectrum full = data(rgb).toSampledSpectrum();
+        const RGBSigmoidPolynomial poly = data(rgb);
+        for (int i = 0; i < HeroSpectrum::nSamples; i++)
+        {
+            assert(hero[i] == poly(wl[i]));
+            // Only differs by the linear interpolation of SampledSpectrum
+            assert(fabsf(hero[i] - full.getSpectrumFromWavelength(wl[i])) < 2e-2f);
+        }
+    }
+}
+
+static void testSaveLoad(const RGBToSpectrumTable& table)
+{
+    const filesystem::path path = filesystem::temp_directory_path() / "prayground_rgb2spec_test.bin";
+    table.save(path);
+
+    RGBToSpectrumTable loaded;
+    loaded.load(path);
+    assert(loaded.colorSpace() == table.colorSpace());
+    assert(loaded.resolution() == table.resolution());
+    const auto a = table.getData();
+    const auto b = loaded.getData();
+    for (int k = 0; k < a.resolution; k++)
+        assert(a.z_nodes[k] == b.z_nodes[k]);
+    const size_t n = size_t(3) * a.resolution * a.resolution * a.resolution * 3;
+    for (size_t i = 0; i < n; i++)
+        assert(a.coefficients[i] == b.coefficients[i]);
+
+    // Truncated file must be rejected
+    filesystem::resize_file(path, filesystem::file_size(path) / 2);
+    bool thrown = false;
+    try { loaded.load(path); }
+    catch (const std::runtime_error&) { thrown = true; }
+    assert(thrown);
+    filesystem::remove(path);
+}
+
+int main()
+{
+    for (auto [color_space, name] : { pair{ RGBColorSpace::sRGB, "sRGB" }, pair{ RGBColorSpace::ACEScg, "ACEScg" } })
+    {
+        const auto t0 = chrono::high_resolution_clock::now();
+        const RGBToSpectrumTable table = RGBToSpectrumTable::optimize(color_space, 16);
+        const auto t1 = chrono::high_resolution_clock::now();
+        cout << name << ": optimized in " << chrono::duration<double, milli>(t1 - t0).count() << " ms" << endl;
+
+        if (color_space == RGBColorSpace::sRGB)
+            testNodes(table, 2e-2f);
+        testInterpolated(table, 5e-2f);
+        testGrayAndBlack(table);
+        testHero(table);
+        testSaveLoad(table);
+    }
+
+    cout << "spectrum_table: all tests passed" << endl;
+    return 0;
+}
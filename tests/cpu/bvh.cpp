@@ -0,0 +1,286 @@
+#include <prayground/cpu/bvh.h>
+#include <prayground/cpu/cpu_accel.h>
+#include <prayground/cpu/launch.h>
+#include <prayground/shape/intersection.h>
+#include <prayground/shape/trianglemesh.h>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <random>
+
+using namespace std;
+using namespace prayground;
+
+namespace {
+    struct Soup {
+        vector<Vec3f> vertices;
+        vector<Vec3i> indices;
+    };
+
+    // Small random triangles scattered in the unit cube
+    Soup randomTriangles(uint32_t n, uint32_t seed)
+    {
+        mt19937 rng(seed);
+        uniform_real_distribution<float> pos(-1.0f, 1.0f);
+        uniform_real_distribution<float> offset(-0.05f, 0.05f);
+
+        Soup soup;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            const Vec3f c(pos(rng), pos(rng), pos(rng));
+            for (int j = 0; j < 3; j++)
+                soup.vertices.emplace_back(c + Vec3f(offset(rng), offset(rng), offset(rng)));
+            soup.indices.emplace_back(i * 3, i * 3 + 1, i * 3 + 2);
+        }
+        return soup;
+    }
+
+    vector<AABB> bounds(const Soup& soup)
+    {
+        vector<AABB> result;
+        for (const Vec3i& idx : soup.indices)
+        {
+            Vec3f bmin(1e30f), bmax(-1e30f);
+            for (int j = 0; j < 3; j++)
+            {
+                const Vec3f& p = soup.vertices[idx[j]];
+                for (int k = 0; k < 3; k++)
+                {
+                    bmin[k] = std::min(bmin[k], p[k]);
+                    bmax[k] = std::max(bmax[k], p[k]);
+                }
+            }
+            result.emplace_back(bmin, bmax);
+        }
+        return result;
+    }
+
+    Ray randomRay(mt19937& rng)
+    {
+        uniform_real_distribution<float> u(-1.0f, 1.0f);
+        const Vec3f o(u(rng) * 2.0f, u(rng) * 2.0f, u(rng) * 2.0f);
+        const Vec3f target(u(rng), u(rng), u(rng));
+        return Ray(o, normalize(target - o), 0.0f, 1e16f);
+    }
+
+    bool bruteForce(const Soup& soup, Ray ray, uint32_t* prim_id)
+    {
+        bool hit = false;
+        for (uint32_t i = 0; i < soup.indices.size(); i++)
+        {
+            const Vec3i& idx = soup.indices[i];
+            Vec2f bc;
+            float t;
+            if (pgIntersectionTriangle(soup.vertices[idx.x()], soup.vertices[idx.y()], soup.vertices[idx.z()], ray, &bc, &t))
+            {
+                ray.tmax = t;
+                *prim_id = i;
+                hit = true;
+            }
+        }
+        return hit;
+    }
+
+    bool traverse(const BVH& bvh, const Soup& soup, Ray& ray, uint32_t* prim_id)
+    {
+        return bvh.intersect(ray, [&](uint32_t id, Ray& r)
+        {
+            const Vec3i& idx = soup.indices[id];
+            Vec2f bc;
+            float t;
+            if (!pgIntersectionTriangle(soup.vertices[idx.x()], soup.vertices[idx.y()], soup.vertices[idx.z()], r, &bc, &t))
+                return false;
+            r.tmax = t;
+            *prim_id = id;
+            return true;
+        });
+    }
+
+    void checkTree(const BVH& bvh, const vector<AABB>& prim_bounds)
+    {
+        const auto& nodes = bvh.nodes();
+        vector<int> referenced(prim_bounds.size(), 0);
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            const BVHNode& node = nodes[i];
+            if (!node.isLeaf())
+                continue;
+            for (uint32_t j = 0; j < node.count; j++)
+            {
+                const uint32_t id = bvh.primIndices()[node.offset + j];
+                referenced[id]++;
+                for (int k = 0; k < 3; k++)
+                {
+                    assert(node.bmin[k] <= prim_bounds[id].min()[k]);
+                    assert(node.bmax[k] >= prim_bounds[id].max()[k]);
+                }
+            }
+        }
+        // Each primitive belongs to exactly one leaf
+        for (int r : referenced)
+            assert(r == 1);
+    }
+} // nonamed namespace
+
+static void testTriangle()
+{
+    const Vec3f p0(0, 0, 0), p1(1, 0, 0), p2(0, 1, 0);
+    Vec2f bc;
+    float t;
+    Ray ray(Vec3f(0.25f, 0.5f, 1.0f), Vec3f(0, 0, -1), 0.0f, 10.0f);
+    assert(pgIntersectionTriangle(p0, p1, p2, ray, &bc, &t));
+    assert(fabsf(t - 1.0f) < 1e-6f);
+    // p = (1 - u - v) * p0 + u * p1 + v * p2
+    assert(fabsf(bc.x() - 0.25f) < 1e-6f && fabsf(bc.y() - 0.5f) < 1e-6f);
+
+    ray.tmax = 0.5f;
+    assert(!pgIntersectionTriangle(p0, p1, p2, ray, &bc, &t));
+    ray = Ray(Vec3f(0.75f, 0.75f, 1.0f), Vec3f(0, 0, -1), 0.0f, 10.0f);
+    assert(!pgIntersectionTriangle(p0, p1, p2, ray, &bc, &t));
+}
+
+static void testBVH()
+{
+    const Soup soup = randomTriangles(20000, 1);
+    const vector<AABB> prim_bounds = bounds(soup);
+
+    BVH bvh;
+    bvh.build(prim_bounds);
+    checkTree(bvh, prim_bounds);
+
+    mt19937 rng(2);
+    uint32_t num_hits = 0;
+    for (int i = 0; i < 2000; i++)
+    {
+        const Ray ray = randomRay(rng);
+        uint32_t expected_id = ~0u, id = ~0u;
+        const bool expected = bruteForce(soup, ray, &expected_id);
+
+        Ray r = ray;
+        assert(traverse(bvh, soup, r, &id) == expected);
+        assert(id == expected_id);
+
+        const bool occluded = bvh.occluded(ray, [&](uint32_t prim, const Ray& rr)
+        {
+            const Vec3i& idx = soup.indices[prim];
+            Vec2f bc;
+            float t;
+            return pgIntersectionTriangle(soup.vertices[idx.x()], soup.vertices[idx.y()], soup.vertices[idx.z()], rr, &bc, &t);
+        });
+        assert(occluded == expected);
+        num_hits += expected;
+    }
+    assert(num_hits > 0);
+
+    // Refit after moving every triangle
+    Soup moved = soup;
+    for (auto& v : moved.vertices)
+        v += Vec3f(0.1f, -0.2f, 0.05f);
+    const vector<AABB> moved_bounds = bounds(moved);
+    bvh.refit(moved_bounds);
+    checkTree(bvh, moved_bounds);
+    for (int i = 0; i < 500; i++)
+    {
+        const Ray ray = randomRay(rng);
+        uint32_t expected_id = ~0u, id = ~0u;
+        Ray r = ray;
+        assert(traverse(bvh, moved, r, &id) == bruteForce(moved, ray, &expected_id));
+        assert(id == expected_id);
+    }
+
+    // Degenerate input: all primitives at the same position
+    vector<AABB> same(1000, AABB(Vec3f(0.0f), Vec3f(1.0f)));
+    BVH degenerate;
+    degenerate.build(same);
+    checkTree(degenerate, same);
+}
+
+static void testAccel()
+{
+    // Unit quad on the XY plane
+    auto quad = make_shared<TriangleMesh>(
+        vector<Vec3f>{ Vec3f(-1, -1, 0), Vec3f(1, -1, 0), Vec3f(1, 1, 0), Vec3f(-1, 1, 0) },
+        vector<Face>{ Face{ Vec3i(0, 1, 2), Vec3i(0), Vec3i(0) }, Face{ Vec3i(0, 2, 3), Vec3i(0), Vec3i(0) } },
+        vector<Vec3f>{}, vector<Vec2f>{});
+    auto geometry = CpuGeometry::create(quad);
+    assert(geometry && geometry->numPrimitives() == 2);
+
+    CpuAccel accel;
+    // Rotation by 90 degrees makes Matrix4f::inverse() divide by zero, so it checks affineInverse()
+    accel.addInstance(geometry, Matrix4f::translate(0, 0, -5) * Matrix4f::rotate(math::pi / 2.0f, Vec3f(0, 0, 1)), 10);
+    accel.addInstance(geometry, Matrix4f::translate(0, 0, -10) * Matrix4f::scale(4.0f), 20);
+    accel.build();
+
+    CpuHit hit;
+    assert(accel.intersect(Ray(Vec3f(0.5f, 0.25f, 0.0f), Vec3f(0, 0, -1), 0.0f, 1e16f), &hit));
+    assert(hit.instance_id == 10 && fabsf(hit.t - 5.0f) < 1e-5f);
+    assert(fabsf(hit.normal.x()) < 1e-5f && fabsf(hit.normal.y()) < 1e-5f);
+
+    // Outside of the first quad, but inside of the scaled one
+    assert(accel.intersect(Ray(Vec3f(3.0f, 0.0f, 0.0f), Vec3f(0, 0, -1), 0.0f, 1e16f), &hit));
+    assert(hit.instance_id == 20 && fabsf(hit.t - 10.0f) < 1e-5f);
+    assert(!accel.intersect(Ray(Vec3f(5.0f, 0.0f, 0.0f), Vec3f(0, 0, -1), 0.0f, 1e16f), &hit));
+    assert(accel.occluded(Ray(Vec3f(0.0f), Vec3f(0, 0, -1), 0.0f, 6.0f)));
+    assert(!accel.occluded(Ray(Vec3f(0.0f), Vec3f(0, 0, -1), 0.0f, 4.0f)));
+
+    // Move the first quad behind the second one
+    accel.setTransform(0, Matrix4f::translate(0, 0, -20));
+    accel.refit();
+    assert(accel.intersect(Ray(Vec3f(0.5f, 0.25f, 0.0f), Vec3f(0, 0, -1), 0.0f, 1e16f), &hit));
+    assert(hit.instance_id == 20);
+}
+
+static void testLaunch()
+{
+    constexpr uint32_t w = 123, h = 77, d = 3;
+    vector<atomic<int>> counts(w * h * d);
+    launchOnCpu([&](const Vec3ui& idx, const Vec3ui& dim)
+    {
+        assert(dim == Vec3ui(w, h, d));
+        counts[(idx.z() * h + idx.y()) * w + idx.x()]++;
+    }, w, h, d);
+    for (auto& c : counts)
+        assert(c == 1);
+
+    bool thrown = false;
+    try
+    {
+        launchOnCpu([&](const Vec3ui& idx, const Vec3ui&) { if (idx.x() == 5 && idx.y() == 5) throw runtime_error("error"); }, 64, 64);
+    }
+    catch (const runtime_error&)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+int main()
+{
+    testTriangle();
+    testBVH();
+    testAccel();
+    testLaunch();
+
+    // Compare traversal with brute force
+    const Soup soup = randomTriangles(100000, 3);
+    BVH bvh;
+    auto t0 = chrono::high_resolution_clock::now();
+    bvh.build(bounds(soup));
+    auto t1 = chrono::high_resolution_clock::now();
+    cout << "build (" << soup.indices.size() << " triangles): " << chrono::duration<double, milli>(t1 - t0).count() << " ms" << endl;
+
+    mt19937 rng(4);
+    uint32_t num_hits = 0;
+    t0 = chrono::high_resolution_clock::now();
+    for (int i = 0; i < 100000; i++)
+    {
+        Ray ray = randomRay(rng);
+        uint32_t id;
+        num_hits += traverse(bvh, soup, ray, &id);
+    }
+    t1 = chrono::high_resolution_clock::now();
+    cout << "traverse 100000 rays: " << chrono::duration<double, milli>(t1 - t0).count() << " ms (" << num_hits << " hits)" << endl;
+
+    cout << "bvh: all tests passed" << endl;
+    return 0;
+}
@@ -0,0 +1,376 @@
+#include <prayground/cpu/bvh.h>
+#include <prayground/cpu/wide_bvh.h>
+#include <prayground/core/file_util.h>
+#include <prayground/shape/intersection.h>
+#include <prayground/shape/trianglemesh.h>
+#include <cassert>
+#include <chrono>
+#include <random>
+
+using namespace std;
+using namespace prayground;
+
+/**
+ * Correctness of BVH4/BVH8 and packet traversal against the binary BVH, and a benchmark of them.
+ * Meshes given as arguments (or the bunny and sponza under resources/model) are used for the benchmark.
+ * Procedural meshes of similar sizes are used when they are not found.
+ */
+
+namespace {
+    struct Mesh {
+        string name;
+        vector<Vec3f> vertices;
+        vector<Vec3i> indices;
+    };
+
+    struct HitRecord {
+        bool hit { false };
+        uint32_t prim_id { ~0u };
+        float t { 0.0f };
+    };
+
+    vector<AABB> triangleBounds(const Mesh& mesh)
+    {
+        vector<AABB> bounds;
+        bounds.reserve(mesh.indices.size());
+        for (const Vec3i& idx : mesh.indices)
+        {
+            const Vec3f& p0 = mesh.vertices[idx.x()];
+            const Vec3f& p1 = mesh.vertices[idx.y()];
+            const Vec3f& p2 = mesh.vertices[idx.z()];
+            bounds.emplace_back(
+                Vec3f(std::min({ p0.x(), p1.x(), p2.x() }), std::min({ p0.y(), p1.y(), p2.y() }), std::min({ p0.z(), p1.z(), p2.z() })),
+                Vec3f(std::max({ p0.x(), p1.x(), p2.x() }), std::max({ p0.y(), p1.y(), p2.y() }), std::max({ p0.z(), p1.z(), p2.z() })));
+        }
+        return bounds;
+    }
+
+    AABB meshBound(const Mesh& mesh)
+    {
+        Vec3f bmin(1e30f), bmax(-1e30f);
+        for (const Vec3f& v : mesh.vertices)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                bmin[k] = std::min(bmin[k], v[k]);
+                bmax[k] = std::max(bmax[k], v[k]);
+            }
+        }
+        return AABB(bmin, bmax);
+    }
+
+    // Bumpy sphere as a stand-in for a closed scanned mesh like the bunny
+    Mesh bumpySphere(uint32_t res)
+    {
+        Mesh mesh{ "procedural sphere" };
+        for (uint32_t j = 0; j <= res; j++)
+        {
+            const float theta = math::pi * j / res;
+            for (uint32_t i = 0; i <= res * 2; i++)
+            {
+                const float phi = math::two_pi * i / (res * 2);
+                const float r = 1.0f + 0.05f * sinf(phi * 13.0f) * sinf(theta * 11.0f);
+                mesh.vertices.emplace_back(r * sinf(theta) * cosf(phi), r * cosf(theta), r * sinf(theta) * sinf(phi));
+            }
+        }
+        const uint32_t stride = res * 2 + 1;
+        for (uint32_t j = 0; j < res; j++)
+        {
+            for (uint32_t i = 0; i < res * 2; i++)
+            {
+                const int v0 = j * stride + i, v1 = v0 + 1, v2 = v0 + stride, v3 = v2 + 1;
+                mesh.indices.emplace_back(v0, v2, v1);
+                mesh.indices.emplace_back(v1, v2, v3);
+            }
+        }
+        return mesh;
+    }
+
+    // Room filled with boxes of various sizes as a stand-in for an architectural scene like sponza
+    Mesh boxRoom(uint32_t num_boxes)
+    {
+        Mesh mesh{ "procedural room" };
+        auto addBox = [&](const Vec3f& bmin, const Vec3f& bmax)
+        {
+            const int base = static_cast<int>(mesh.vertices.size());
+            for (int c = 0; c < 8; c++)
+                mesh.vertices.emplace_back((c & 1) ? bmax.x() : bmin.x(), (c & 2) ? bmax.y() : bmin.y(), (c & 4) ? bmax.z() : bmin.z());
+            const int quads[6][4] = { {0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5} };
+            for (const auto& q : quads)
+            {
+                mesh.indices.emplace_back(base + q[0], base + q[1], base + q[2]);
+                mesh.indices.emplace_back(base + q[0], base + q[2], base + q[3]);
+            }
+        };
+
+        addBox(Vec3f(-10.0f, -0.1f, -4.0f), Vec3f(10.0f, 0.0f, 4.0f));
+        mt19937 rng(7);
+        uniform_real_distribution<float> x(-10.0f, 10.0f), y(0.0f, 8.0f), z(-4.0f, 4.0f), s(0.02f, 0.6f);
+        for (uint32_t i = 0; i < num_boxes; i++)
+        {
+            const Vec3f c(x(rng), y(rng), z(rng));
+            const Vec3f e(s(rng), s(rng), s(rng));
+            addBox(c - e * 0.5f, c + e * 0.5f);
+        }
+        return mesh;
+    }
+
+    optional<Mesh> loadMesh(const filesystem::path& path)
+    {
+        if (!pgFindDataPath(path))
+            return nullopt;
+        TriangleMesh tm(path);
+        if (tm.numFaces() == 0)
+            return nullopt;
+        Mesh mesh{ path.filename().string(), tm.vertices() };
+        for (const Face& f : tm.faces())
+            mesh.indices.push_back(f.vertex_id);
+        return mesh;
+    }
+
+    bool intersectTriangle(const Mesh& mesh, uint32_t prim_id, Ray& ray, HitRecord& rec)
+    {
+        const Vec3i& idx = mesh.indices[prim_id];
+        Vec2f bc;
+        float t;
+        if (!pgIntersectionTriangle(mesh.vertices[idx.x()], mesh.vertices[idx.y()], mesh.vertices[idx.z()], ray, &bc, &t))
+            return false;
+        ray.tmax = t;
+        rec = { true, prim_id, t };
+        return true;
+    }
+
+    // Primary rays of a pinhole camera looking at the center of the mesh
+    struct PinholeCamera {
+        Vec3f origin, lower_left, horizontal, vertical;
+
+        PinholeCamera(const AABB& bound)
+        {
+            const Vec3f center = (bound.min() + bound.max()) * 0.5f;
+            const float radius = length(bound.max() - bound.min()) * 0.5f;
+            origin = center + Vec3f(0.3f, 0.2f, 1.0f) * radius * 1.5f;
+            const Vec3f w = normalize(origin - center);
+            const Vec3f u = normalize(cross(Vec3f(0, 1, 0), w));
+            const Vec3f v = cross(w, u);
+            horizontal = u * 1.2f;
+            vertical = v * 1.2f;
+            lower_left = origin - horizontal * 0.5f - vertical * 0.5f - w;
+        }
+
+        Ray generate(float s, float t) const
+        {
+            return Ray(origin, normalize(lower_left + horizontal * s + vertical * t - origin), 0.0f, 1e16f);
+        }
+    };
+
+    template <class Traverse>
+    double measure(const Traverse& traverse)
+    {
+        auto t0 = chrono::high_resolution_clock::now();
+        traverse();
+        auto t1 = chrono::high_resolution_clock::now();
+        return chrono::duration<double>(t1 - t0).count();
+    }
+} // nonamed namespace
+
+template <uint32_t N>
+static void checkWide(const Mesh& mesh, const BVH& bvh, const vector<Ray>& rays)
+{
+    WideBVH<N> wide;
+    wide.build(bvh);
+
+    for (const Ray& ray : rays)
+    {
+        HitRecord expected, actual;
+        Ray r0 = ray, r1 = ray;
+        bvh.intersect(r0, [&](uint32_t id, Ray& r) { return intersectTriangle(mesh, id, r, expected); });
+        const bool hit = wide.intersect(r1, [&](uint32_t id, Ray& r) { return intersectTriangle(mesh, id, r, actual); });
+        assert(hit == expected.hit);
+        assert(actual.prim_id == expected.prim_id && actual.t == expected.t);
+
+        const bool occluded = wide.occluded(ray, [&](uint32_t id, const Ray& r) { Ray rr = r; HitRecord tmp; return intersectTriangle(mesh, id, rr, tmp); });
+        assert(occluded == expected.hit);
+    }
+}
+
+template <uint32_t N, uint32_t K>
+static void checkPacket(const Mesh& mesh, const vector<Ray>& rays)
+{
+    WideBVH<N> wide;
+    wide.build(triangleBounds(mesh));
+
+    for (size_t base = 0; base + K <= rays.size(); base += K)
+    {
+        RayPacket<K> packet;
+        for (uint32_t i = 0; i < K; i++)
+            packet.set(i, rays[base + i]);
+        // Deactivate one ray to check that inactive rays are left untouched
+        packet.tmin[K - 1] = 1.0f;
+        packet.tmax[K - 1] = 0.0f;
+
+        HitRecord records[K];
+        // intersect() shortens tmax of the packet, so the occlusion is tested first
+        const uint32_t occluded = wide.occluded(packet, [&](uint32_t id, uint32_t, const Ray& r) { Ray rr = r; HitRecord tmp; return intersectTriangle(mesh, id, rr, tmp); });
+        const uint32_t mask = wide.intersect(packet, [&](uint32_t id, uint32_t i, Ray& r) { return intersectTriangle(mesh, id, r, records[i]); });
+        assert(!(mask & (1u << (K - 1))) && !(occluded & (1u << (K - 1))));
+
+        for (uint32_t i = 0; i + 1 < K; i++)
+        {
+            HitRecord expected;
+            Ray r = rays[base + i];
+            wide.intersect(r, [&](uint32_t id, Ray& rr) { return intersectTriangle(mesh, id, rr, expected); });
+            assert(expected.hit == ((mask >> i) & 1u));
+            assert(expected.hit == ((occluded >> i) & 1u));
+            if (expected.hit)
+            {
+                assert(records[i].prim_id == expected.prim_id && records[i].t == expected.t);
+                assert(packet.tmax[i] == expected.t);
+            }
+        }
+    }
+}
+
+static void testCorrectness()
+{
+    const Mesh meshes[] = { bumpySphere(64), boxRoom(500) };
+    for (const Mesh& mesh : meshes)
+    {
+        BVH bvh;
+        bvh.build(triangleBounds(mesh));
+
+        // Coherent camera rays and random rays
+        const AABB bound = meshBound(mesh);
+        PinholeCamera camera(bound);
+        vector<Ray> rays;
+        for (uint32_t y = 0; y < 64; y++)
+            for (uint32_t x = 0; x < 64; x++)
+                rays.push_back(camera.generate((x + 0.5f) / 64, (y + 0.5f) / 64));
+        mt19937 rng(3);
+        uniform_real_distribution<float> u(-1.0f, 1.0f);
+        const Vec3f center = (bound.min() + bound.max()) * 0.5f;
+        const Vec3f extent = bound.max() - bound.min();
+        for (int i = 0; i < 4096; i++)
+        {
+            const Vec3f o = center + Vec3f(u(rng), u(rng), u(rng)) * extent;
+            Vec3f d(u(rng), u(rng), u(rng));
+            // Axis-aligned directions exercise the NaN handling of the slab test
+            if (i % 16 == 0) d = Vec3f(0.0f, -1.0f, 0.0f);
+            rays.emplace_back(o, normalize(d), 0.0f, 1e16f);
+        }
+
+        checkWide<4>(mesh, bvh, rays);
+        checkWide<8>(mesh, bvh, rays);
+        checkPacket<4, 8>(mesh, rays);
+        checkPacket<8, 8>(mesh, rays);
+        checkPacket<8, 16>(mesh, rays);
+    }
+}
+
+static void benchmark(const Mesh& mesh)
+{
+    constexpr uint32_t W = 512, H = 512;
+    const vector<AABB> bounds = triangleBounds(mesh);
+
+    BVH bvh;
+    const double build_time = measure([&] { bvh.build(bounds); });
+    BVH4 bvh4;
+    BVH8 bvh8;
+    const double collapse_time = measure([&] { bvh4.build(bvh); bvh8.build(bvh); });
+
+    PinholeCamera camera(meshBound(mesh));
+    cout << mesh.name << " (" << mesh.indices.size() << " triangles): build " << build_time * 1e3 << " ms, collapse to BVH4 + BVH8 " << collapse_time * 1e3 << " ms" << endl;
+
+    auto report = [&](const char* label, double seconds, uint32_t hits)
+    {
+        cout << "  " << label << ": " << (W * H) / seconds * 1e-6 << " Mrays/s (" << hits << " hits)" << endl;
+    };
+
+    auto single = [&](const char* label, const auto& accel)
+    {
+        uint32_t hits = 0;
+        const double t = measure([&]
+        {
+            for (uint32_t y = 0; y < H; y++)
+            {
+                for (uint32_t x = 0; x < W; x++)
+                {
+                    Ray ray = camera.generate((x + 0.5f) / W, (y + 0.5f) / H);
+                    HitRecord rec;
+                    hits += accel.intersect(ray, [&](uint32_t id, Ray& r) { return intersectTriangle(mesh, id, r, rec); });
+                }
+            }
+        });
+        report(label, t, hits);
+    };
+
+    // Packets cover 4x2 or 4x4 pixel tiles
+    auto packet = [&]<uint32_t K>(const char* label, const BVH8& accel, std::integral_constant<uint32_t, K>)
+    {
+        constexpr uint32_t TW = 4, TH = K / 4;
+        uint32_t hits = 0;
+        const double t = measure([&]
+        {
+            for (uint32_t y0 = 0; y0 < H; y0 += TH)
+            {
+                for (uint32_t x0 = 0; x0 < W; x0 += TW)
+                {
+                    RayPacket<K> p;
+                    for (uint32_t i = 0; i < K; i++)
+                        p.set(i, camera.generate((x0 + i % TW + 0.5f) / W, (y0 + i / TW + 0.5f) / H));
+                    HitRecord recs[K];
+                    hits += std::popcount(accel.intersect(p, [&](uint32_t id, uint32_t i, Ray& r) { return intersectTriangle(mesh, id, r, recs[i]); }));
+                }
+            }
+        });
+        report(label, t, hits);
+    };
+
+    single("binary (scalar) ", bvh);
+    single("BVH4 single ray ", bvh4);
+    single("BVH8 single ray ", bvh8);
+    packet("BVH8 8-ray packet ", bvh8, std::integral_constant<uint32_t, 8>{});
+    packet("BVH8 16-ray packet", bvh8, std::integral_constant<uint32_t, 16>{});
+}
+
+int main(int argc, char* argv[])
+{
+    testCorrectness();
+
+#if defined(PRAYGROUND_CPU_AVX512)
+    cout << "SIMD: AVX-512" << endl;
+#elif defined(PRAYGROUND_CPU_AVX)
+    cout << "SIMD: AVX" << endl;
+#elif defined(PRAYGROUND_CPU_SSE)
+    cout << "SIMD: SSE" << endl;
+#else
+    cout << "SIMD: none (scalar fallback)" << endl;
+#endif
+
+    vector<filesystem::path> paths;
+    for (int i = 1; i < argc; i++)
+        paths.emplace_back(argv[i]);
+    if (paths.empty())
+        paths = { "resources/model/bunny.obj", "resources/model/sponza/sponza.obj" };
+
+    bool benchmarked = false;
+    for (const auto& path : paths)
+    {
+        if (auto mesh = loadMesh(path))
+        {
+            benchmark(mesh.value());
+            benchmarked = true;
+        }
+        else
+        {
+            cout << path.string() << " is not found." << endl;
+        }
+    }
+    if (!benchmarked)
+    {
+        benchmark(bumpySphere(256));
+        benchmark(boxRoom(20000));
+    }
+
+    cout << "wide_bvh: all tests passed" << endl;
+    return 0;
+}
@@ -0,0 +1,378 @@
+#include <prayground/math/matrix.h>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace prayground;
+
+namespace {
+    // Scalar templates of Matrix before the host SIMD path
+    namespace scalar {
+        Matrix4f mul(const Matrix4f& m1, const Matrix4f& m2)
+        {
+            Matrix4f ret;
+            for (uint32_t row = 0; row < 4; row++)
+            {
+                for (uint32_t col = 0; col < 4; col++)
+                {
+                    float sum = 0.0f;
+                    for (uint32_t tmp = 0; tmp < 4; tmp++)
+                        sum += m1[row * 4 + tmp] * m2[tmp * 4 + col];
+                    ret[row * 4 + col] = sum;
+                }
+            }
+            return ret;
+        }
+
+        Matrix4f inverse(const Matrix4f& m)
+        {
+            Matrix4f ret = Matrix4f::identity();
+            Matrix4f mat(m);
+            float tmp;
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                tmp = 1.0f / mat[i * 4 + i];
+                for (uint32_t j = 0; j < 4; j++)
+                {
+                    mat[i * 4 + j] *= tmp;
+                    ret[i * 4 + j] *= tmp;
+                }
+                for (uint32_t j = 0; j < 4; j++)
+                {
+                    if (i != j)
+                    {
+                        tmp = mat[j * 4 + i];
+                        for (uint32_t k = 0; k < 4; k++)
+                        {
+                            mat[j * 4 + k] -= mat[i * 4 + k] * tmp;
+                            ret[j * 4 + k] -= ret[i * 4 + k] * tmp;
+                        }
+                    }
+                }
+            }
+            return ret;
+        }
+
+        Vec3f normalMul(const Matrix4f& inv, const Vec3f& n)
+        {
+            return Vec3f(
+                inv[0] * n.x() + inv[4] * n.y() + inv[8]  * n.z(),
+                inv[1] * n.x() + inv[5] * n.y() + inv[9]  * n.z(),
+                inv[2] * n.x() + inv[6] * n.y() + inv[10] * n.z());
+        }
+
+        void bound(const vector<Vec3f>& points, Vec3f& bmin, Vec3f& bmax)
+        {
+            bmin = bmax = points[0];
+            for (const Vec3f& v : points)
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    bmin[i] = fminf(bmin[i], v[i]);
+                    bmax[i] = fmaxf(bmax[i], v[i]);
+                }
+            }
+        }
+    } // namespace scalar
+
+    // Inverse in double precision with partial pivoting as the reference
+    bool inverseDouble(const Matrix4f& m, double (&inv)[16])
+    {
+        double a[4][8];
+        for (int i = 0; i < 4; i++)
+        {
+            for (int j = 0; j < 4; j++)
+            {
+                a[i][j] = m[i * 4 + j];
+                a[i][j + 4] = i == j ? 1.0 : 0.0;
+            }
+        }
+        for (int i = 0; i < 4; i++)
+        {
+            int pivot = i;
+            for (int j = i + 1; j < 4; j++)
+                if (fabs(a[j][i]) > fabs(a[pivot][i])) pivot = j;
+            if (fabs(a[pivot][i]) < 1e-12) return false;
+            swap(a[i], a[pivot]);
+            const double d = 1.0 / a[i][i];
+            for (int k = 0; k < 8; k++) a[i][k] *= d;
+            for (int j = 0; j < 4; j++)
+            {
+                if (j == i) continue;
+                const double f = a[j][i];
+                for (int k = 0; k < 8; k++) a[j][k] -= a[i][k] * f;
+            }
+        }
+        for (int i = 0; i < 4; i++)
+            for (int j = 0; j < 4; j++)
+                inv[i * 4 + j] = a[i][j + 4];
+        return true;
+    }
+
+    Matrix4f randomMatrix(mt19937& rng, bool affine)
+    {
+        uniform_real_distribution<float> dist(-2.0f, 2.0f);
+        Matrix4f m;
+        for (int i = 0; i < 16; i++)
+            m[i] = dist(rng);
+        if (affine)
+        {
+            m[12] = m[13] = m[14] = 0.0f;
+            m[15] = 1.0f;
+        }
+        return m;
+    }
+
+    bool near(float a, float b, float eps)
+    {
+        return fabsf(a - b) <= eps * fmaxf(1.0f, fabsf(b));
+    }
+
+    bool near(const Vec3f& a, const Vec3f& b, float eps)
+    {
+        return near(a[0], b[0], eps) && near(a[1], b[1], eps) && near(a[2], b[2], eps);
+    }
+} // nonamed namespace
+
+static void testMul()
+{
+    mt19937 rng(1);
+    for (int it = 0; it < 10000; it++)
+    {
+        const Matrix4f a = randomMatrix(rng, it % 2 == 0);
+        const Matrix4f b = randomMatrix(rng, it % 3 == 0);
+        const Matrix4f ref = scalar::mul(a, b);
+        const Matrix4f m = a * b;
+        // Same summation order, so only FMA contraction may differ
+        for (int i = 0; i < 16; i++)
+            assert(near(m[i], ref[i], 1e-6f));
+
+        Matrix4f c = a;
+        c *= b;
+        assert(c == m);
+    }
+
+    // Composition of transformations
+    const Matrix4f t = Matrix4f::translate(1.0f, 2.0f, 3.0f) * Matrix4f::scale(2.0f);
+    assert(t.pointMul(Vec3f(1.0f, 1.0f, 1.0f)) == Vec3f(3.0f, 4.0f, 5.0f));
+}
+
+static void testInverse()
+{
+    mt19937 rng(2);
+    int num_tested = 0;
+    for (int it = 0; it < 10000; it++)
+    {
+        const Matrix4f m = randomMatrix(rng, it % 2 == 0);
+        double ref[16];
+        if (!inverseDouble(m, ref))
+            continue;
+        // Skip ill-conditioned matrices, where float results are meaningless either way
+        double norm = 0.0, inv_norm = 0.0;
+        for (int i = 0; i < 16; i++)
+        {
+            norm = fmax(norm, fabs(m[i]));
+            inv_norm = fmax(inv_norm, fabs(ref[i]));
+        }
+        if (norm * inv_norm > 1e3)
+            continue;
+
+        const Matrix4f inv = m.inverse();
+        for (int i = 0; i < 16; i++)
+            assert(fabs(inv[i] - ref[i]) <= 1e-4 * fmax(1.0, inv_norm));
+
+        // Rounding errors are amplified by the condition number
+        const Matrix4f identity = m * inv;
+        const float eps = 1e-6f * static_cast<float>(norm * inv_norm);
+        for (int i = 0; i < 16; i++)
+            assert(near(identity[i], Matrix4f::identity()[i], eps));
+        num_tested++;
+    }
+    assert(num_tested > 5000);
+
+    // Zero diagonal elements, which Gauss-Jordan elimination without pivoting failed on
+    const Matrix4f rot = Matrix4f::rotate(math::pi / 2.0f, Vec3f(0.0f, 0.0f, 1.0f)) * Matrix4f::translate(1.0f, 2.0f, 3.0f);
+    const Matrix4f swap_xy = Matrix4f({ 0, 1, 0, 0,  1, 0, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1 });
+    for (const Matrix4f& m : { rot, swap_xy })
+    {
+        const Matrix4f identity = m * m.inverse();
+        for (int i = 0; i < 16; i++)
+            assert(near(identity[i], Matrix4f::identity()[i], 1e-6f));
+    }
+    assert(isnan(scalar::inverse(swap_xy)[0]) || isinf(scalar::inverse(swap_xy)[0]));
+    assert(swap_xy.inverse() == swap_xy);
+
+    // Well-conditioned matrices agree with the previous implementation
+    for (int it = 0; it < 1000; it++)
+    {
+        const Matrix4f m = Matrix4f::translate(1.0f, -2.0f, 0.5f) * Matrix4f::rotate(0.001f * it, Vec3f(1.0f, 2.0f, 3.0f)) * Matrix4f::scale(Vec3f(1.0f, 2.0f, 3.0f));
+        const Matrix4f a = m.inverse();
+        const Matrix4f b = scalar::inverse(m);
+        for (int i = 0; i < 16; i++)
+            assert(near(a[i], b[i], 1e-5f));
+    }
+}
+
+static void testTransforms()
+{
+    mt19937 rng(3);
+    uniform_real_distribution<float> dist(-10.0f, 10.0f);
+    for (int it = 0; it < 200; it++)
+    {
+        const Matrix4f m = randomMatrix(rng, it % 2 == 0);
+        const Matrix4f inv = m.inverse();
+        // Every count up to 67 to cover the last element of the array
+        const size_t n = it % 68;
+        vector<Vec3f> src(n), points(n), vectors(n), normals(n);
+        for (auto& p : src)
+            p = Vec3f(dist(rng), dist(rng), dist(rng));
+
+        transformPoints(m, src.data(), points.data(), n);
+        transformVectors(m, src.data(), vectors.data(), n);
+        transformNormals(m, src.data(), normals.data(), n);
+        for (size_t i = 0; i < n; i++)
+        {
+            // FMA contraction may change the rounding of cancelling terms
+            assert(near(points[i], m.pointMul(src[i]), 1e-4f));
+            assert(near(vectors[i], m.vectorMul(src[i]), 1e-4f));
+            assert(near(normals[i], scalar::normalMul(inv, src[i]), 1e-4f));
+            assert(near(normals[i], m.normalMul(src[i]), 1e-4f));
+        }
+
+        // In place
+        vector<Vec3f> in_place = src;
+        transformPoints(m, in_place.data(), in_place.data(), n);
+        for (size_t i = 0; i < n; i++)
+            assert(in_place[i] == points[i]);
+    }
+
+    // Affine transforms keep w == 1 and the result is exact
+    const Matrix4f t = Matrix4f::translate(1.0f, 2.0f, 3.0f);
+    Vec3f p(1.0f, 1.0f, 1.0f);
+    transformPoints(t, &p, &p, 1);
+    assert(p == Vec3f(2.0f, 3.0f, 4.0f));
+    Vec3f v(1.0f, 1.0f, 1.0f);
+    transformVectors(t, &v, &v, 1);
+    assert(v == Vec3f(1.0f, 1.0f, 1.0f));
+}
+
+static void testBound()
+{
+    mt19937 rng(4);
+    uniform_real_distribution<float> dist(-100.0f, 100.0f);
+    Vec3f bmin, bmax;
+    assert(!impl::minMaxPoints(nullptr, 0, bmin, bmax));
+    for (size_t n = 1; n < 100; n++)
+    {
+        vector<Vec3f> points(n);
+        for (auto& p : points)
+            p = Vec3f(dist(rng), dist(rng), dist(rng));
+        Vec3f ref_min, ref_max;
+        scalar::bound(points, ref_min, ref_max);
+        assert(impl::minMaxPoints(points.data(), n, bmin, bmax));
+        assert(bmin == ref_min && bmax == ref_max);
+
+        // NaN components are ignored
+        points[n / 2][n % 3] = NAN;
+        scalar::bound(points, ref_min, ref_max);
+        impl::minMaxPoints(points.data(), n, bmin, bmax);
+        if (n > 1)
+            assert(bmin == ref_min && bmax == ref_max);
+    }
+}
+
+static void benchmark()
+{
+    constexpr int num_matrices = 1024;
+    constexpr int num_iterations = 1000;
+    mt19937 rng(5);
+    vector<Matrix4f> matrices(num_matrices);
+    for (auto& m : matrices)
+        m = randomMatrix(rng, false) + Matrix4f::identity() * 8.0f;
+
+    auto time = [](const char* label, auto func)
+    {
+        auto t0 = chrono::high_resolution_clock::now();
+        const float sum = func();
+        auto t1 = chrono::high_resolution_clock::now();
+        cout << label << ": " << chrono::duration<double, milli>(t1 - t0).count() << " ms (" << sum << ")" << endl;
+    };
+
+    time("Scalar Matrix4f * Matrix4f", [&] {
+        float sum = 0.0f;
+        for (int it = 0; it < num_iterations; it++)
+            for (int i = 0; i < num_matrices; i++)
+                sum += scalar::mul(matrices[i], matrices[(i + it) % num_matrices])[it % 16];
+        return sum;
+    });
+    time("SIMD Matrix4f * Matrix4f", [&] {
+        float sum = 0.0f;
+        for (int it = 0; it < num_iterations; it++)
+            for (int i = 0; i < num_matrices; i++)
+                sum += (matrices[i] * matrices[(i + it) % num_matrices])[it % 16];
+        return sum;
+    });
+
+    time("Scalar Matrix4f::inverse", [&] {
+        float sum = 0.0f;
+        for (int it = 0; it < num_iterations; it++)
+            for (int i = 0; i < num_matrices; i++)
+                sum += scalar::inverse(matrices[i])[it % 16];
+        return sum;
+    });
+    time("SIMD Matrix4f::inverse", [&] {
+        float sum = 0.0f;
+        for (int it = 0; it < num_iterations; it++)
+            for (int i = 0; i < num_matrices; i++)
+                sum += matrices[i].inverse()[it % 16];
+        return sum;
+    });
+
+    constexpr size_t num_points = 1 << 20;
+    uniform_real_distribution<float> dist(-10.0f, 10.0f);
+    vector<Vec3f> points(num_points), transformed(num_points);
+    for (auto& p : points)
+        p = Vec3f(dist(rng), dist(rng), dist(rng));
+    const Matrix4f m = Matrix4f::translate(1.0f, 2.0f, 3.0f) * Matrix4f::rotate(0.3f, Vec3f(1.0f, 1.0f, 0.0f));
+
+    time("Scalar pointMul (1M points x 20)", [&] {
+        for (int it = 0; it < 20; it++)
+            for (size_t i = 0; i < num_points; i++)
+                transformed[i] = m.pointMul(points[i]);
+        return transformed[num_points / 2].x();
+    });
+    time("SIMD transformPoints (1M points x 20)", [&] {
+        for (int it = 0; it < 20; it++)
+            transformPoints(m, points.data(), transformed.data(), num_points);
+        return transformed[num_points / 2].x();
+    });
+
+    time("Scalar bound (1M points x 20)", [&] {
+        Vec3f bmin, bmax;
+        for (int it = 0; it < 20; it++)
+            scalar::bound(points, bmin, bmax);
+        return bmax.x() - bmin.x();
+    });
+    time("SIMD minMaxPoints (1M points x 20)", [&] {
+        Vec3f bmin, bmax;
+        for (int it = 0; it < 20; it++)
+            impl::minMaxPoints(points.data(), num_points, bmin, bmax);
+        return bmax.x() - bmin.x();
+    });
+}
+
+int main()
+{
+    testMul();
+    testInverse();
+    testTransforms();
+    testBound();
+    benchmark();
+
+    cout << "matrix_simd: all tests passed" << endl;
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <prayground/texture/noise_bake.h>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace prayground;
+
+namespace {
+    bool near(float a, float b, float eps = 1e-5f)
+    {
+        return fabsf(a - b) <= eps * fmaxf(1.0f, fabsf(b));
+    }
+
+    // Texel centers of the grid, as documented in NoiseBakeDesc
+    Vec3f texelCenter(const NoiseBakeDesc& desc, int x, int y, int z, int nx, int ny, int nz)
+    {
+        const Vec3f texel = desc.domain.extent() / Vec3f(float(nx), float(ny), float(nz));
+        return desc.domain.min() + (Vec3f(float(x), float(y), float(z)) + 0.5f) * texel;
+    }
+} // nonamed namespace
+
+static void testNoise()
+{
+    const PerlinNoise noise(7);
+
+    // Integer lattice points, where the noise is 0
+    const Vec3f lattice[3] = { Vec3f(0.0f), Vec3f(-3.0f, 5.0f, 255.0f), Vec3f(256.0f, -256.0f, 1.0f) };
+    for (const Vec3f& p : lattice)
+        assert(noise.noise(p) == 0.0f);
+
+    // Tables are stored in place, so copies give the same noise
+    const PerlinNoise copy = noise;
+    assert(copy.noise(Vec3f(0.3f, 1.7f, -2.2f)) == noise.noise(Vec3f(0.3f, 1.7f, -2.2f)));
+    assert(PerlinNoise(8).noise(Vec3f(0.3f, 1.7f, -2.2f)) != noise.noise(Vec3f(0.3f, 1.7f, -2.2f)));
+}
+
+static void testBake()
+{
+    const PerlinNoise noise(3);
+    NoiseBakeDesc desc;
+    desc.domain = AABB(Vec3f(-2.0f, 1.0f, 0.5f), Vec3f(6.0f, 5.0f, 4.5f));
+
+    for (NoiseBakeType type : { NoiseBakeType::Noise, NoiseBakeType::Turbulence })
+    {
+        desc.type = type;
+        const int nx = 37, ny = 12, nz = 5;
+        const NoiseVolume volume = bakeNoiseVolume(noise, desc, nx, ny, nz);
+        assert(volume.data.size() == size_t(nx) * ny * nz);
+        for (int z = 0; z < nz; z++)
+        {
+            for (int y = 0; y < ny; y++)
+            {
+                for (int x = 0; x < nx; x++)
+                {
+                    const Vec3f p = texelCenter(desc, x, y, z, nx, ny, nz);
+                    const float ref = type == NoiseBakeType::Turbulence ? noise.turb(p, desc.depth) : noise.noise(p);
+                    assert(near(volume.at(x, y, z), ref));
+                    // Texel centers are sampled without interpolation
+                    const Vec3f uvw((x + 0.5f) / nx, (y + 0.5f) / ny, (z + 0.5f) / nz);
+                    assert(near(volume.sample(uvw), volume.at(x, y, z)));
+                }
+            }
+        }
+        // Halfway between two texels, and clamped outside
+        assert(near(volume.sample(Vec3f(1.0f / nx, 0.5f / ny, 0.5f / nz)), 0.5f * (volume.at(0, 0, 0) + volume.at(1, 0, 0))));
+        assert(volume.sample(Vec3f(-1.0f)) == volume.at(0, 0, 0));
+        assert(volume.sample(Vec3f(2.0f)) == volume.at(nx - 1, ny - 1, nz - 1));
+    }
+}
+
+static void testMipChain()
+{
+    const PerlinNoise noise(5);
+    NoiseBakeDesc desc;
+    desc.domain = AABB(Vec3f(0.0f), Vec3f(8.0f));
+    const NoiseVolume base = bakeNoiseVolume(noise, desc, 16, 8, 4);
+
+    const vector<NoiseVolume> levels = buildMipChain(base);
+    assert(levels.size() == 4);
+    assert(levels[0].nx == 8 && levels[0].ny == 4 && levels[0].nz == 2);
+    assert(levels[3].nx == 1 && levels[3].ny == 1 && levels[3].nz == 1);
+    const float b = (base.at(2, 4, 0) + base.at(3, 4, 0) + base.at(2, 5, 0) + base.at(3, 5, 0)
+                   + base.at(2, 4, 1) + base.at(3, 4, 1) + base.at(2, 5, 1) + base.at(3, 5, 1)) / 8.0f;
+    assert(near(levels[0].at(1, 2, 0), b));
+
+    // Box filters preserve the mean
+    double mean = 0.0;
+    for (float v : base.data) mean += v;
+    mean /= base.data.size();
+    assert(fabs(levels.back().data[0] - mean) < 1e-4);
+
+    // Odd sizes: the last texel covers 3 texels
+    const NoiseVolume odd = bakeNoiseVolume(noise, desc, 5, 1, 1);
+    const vector<NoiseVolume> odd_levels = buildMipChain(odd);
+    assert(odd_levels.size() == 2 && odd_levels[0].nx == 2);
+    assert(near(odd_levels[0].at(0, 0, 0), (odd.at(0, 0, 0) + odd.at(1, 0, 0)) / 2.0f));
+    assert(near(odd_levels[0].at(1, 0, 0), (odd.at(2, 0, 0) + odd.at(3, 0, 0) + odd.at(4, 0, 0)) / 3.0f));
+}
+
+static void testBitmap()
+{
+    const PerlinNoise noise(9);
+    NoiseBakeDesc desc;
+    desc.domain = AABB(Vec3f(0.0f, 0.0f, -1.0f), Vec3f(4.0f, 2.0f, 1.0f));
+    const FloatBitmap bitmap = bakeNoiseBitmap(noise, desc, 32, 16);
+    assert(bitmap.width() == 32 && bitmap.height() == 16 && bitmap.channels() == 1);
+    // Single slice at the middle of the domain in z
+    const NoiseVolume slice = bakeNoiseVolume(noise, desc, 32, 16, 1);
+    for (int i = 0; i < 32 * 16; i++)
+        assert(bitmap.data()[i] == slice.data[i]);
+    assert(near(bitmap.data()[0], noise.turb(Vec3f(0.0625f, 0.0625f, 0.0f), desc.depth)));
+
+    const vector<FloatBitmap> levels = buildMipChain(bitmap);
+    assert(levels.size() == 5);
+    assert(levels[0].width() == 16 && levels[0].height() == 8 && levels[0].channels() == 1);
+    assert(levels[4].width() == 1 && levels[4].height() == 1);
+    const float* b = bitmap.data();
+    assert(near(levels[0].data()[0], (b[0] + b[1] + b[32] + b[33]) / 4.0f));
+}
+
+static void benchmark()
+{
+    const PerlinNoise noise(1);
+    NoiseBakeDesc desc;
+    desc.domain = AABB(Vec3f(0.0f), Vec3f(16.0f, 16.0f, 1.0f));
+    constexpr int res = 512;
+
+    auto t0 = chrono::high_resolution_clock::now();
+    vector<float> ref(res * res);
+    for (int y = 0; y < res; y++)
+        for (int x = 0; x < res; x++)
+            ref[y * res + x] = noise.turb(texelCenter(desc, x, y, 0, res, res, 1), desc.depth);
+    auto t1 = chrono::high_resolution_clock::now();
+    cout << "Scalar turb (" << res << "x" << res << "): " << chrono::duration<double, milli>(t1 - t0).count() << " ms" << endl;
+
+    t0 = chrono::high_resolution_clock::now();
+    vector<float> baked(res * res);
+    bakeNoise(noise, desc, res, res, 1, baked.data());
+    t1 = chrono::high_resolution_clock::now();
+    cout << "bakeNoise (" << res << "x" << res << "): " << chrono::duration<double, milli>(t1 - t0).count() << " ms" << endl;
+
+    for (int i = 0; i < res * res; i++)
+        assert(near(baked[i], ref[i]));
+}
+
+int main()
+{
+    testNoise();
+    testBake();
+    testMipChain();
+    testBitmap();
+    benchmark();
+
+    cout << "noise_bake: all tests passed" << endl;
+    return 0;
+}
@@ -0,0 +1,268 @@
+#include <prayground/math/random.h>
+#include <prayground/core/sampler.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace prayground;
+
+// Statistical tests in the style of TestU01 SmallCrush, small enough to run in the test suite.
+// Every statistic is converted to a z-score, and generators fail at |z| > 6.
+namespace {
+    constexpr double kMaxZ = 6.0;
+
+    // Stream of 32-bit words from a generator
+    using Source = function<uint32_t()>;
+
+    // Chi-square statistic with k - 1 degrees of freedom, normalized to a z-score
+    double chiSquareZ(const vector<uint64_t>& counts, double expected)
+    {
+        double chi2 = 0.0;
+        for (uint64_t c : counts)
+            chi2 += (c - expected) * (c - expected) / expected;
+        const double dof = static_cast<double>(counts.size() - 1);
+        return (chi2 - dof) / sqrt(2.0 * dof);
+    }
+
+    // Frequency of each byte of the words
+    double byteFrequencyZ(const Source& next, size_t n)
+    {
+        vector<uint64_t> counts(256, 0);
+        for (size_t i = 0; i < n; i++)
+        {
+            const uint32_t v = next();
+            for (int b = 0; b < 4; b++)
+                counts[(v >> (8 * b)) & 0xffu]++;
+        }
+        return chiSquareZ(counts, n * 4.0 / 256.0);
+    }
+
+    // Pairs of consecutive outputs on a 64x64 grid of the top bits
+    double serialPairZ(const Source& next, size_t n)
+    {
+        vector<uint64_t> counts(64 * 64, 0);
+        for (size_t i = 0; i < n; i++)
+        {
+            const uint32_t a = next() >> 26, b = next() >> 26;
+            counts[a * 64 + b]++;
+        }
+        return chiSquareZ(counts, n / 4096.0);
+    }
+
+    // Same as serialPairZ with the lowest 6 bits, where LCGs are weakest
+    double serialPairLowZ(const Source& next, size_t n)
+    {
+        vector<uint64_t> counts(64 * 64, 0);
+        for (size_t i = 0; i < n; i++)
+        {
+            const uint32_t a = next() & 63u, b = next() & 63u;
+            counts[a * 64 + b]++;
+        }
+        return chiSquareZ(counts, n / 4096.0);
+    }
+
+    /**
+     * Birthday spacings (Marsaglia). n birthdays in 2^days_log2 days; the number of repeated
+     * spacings between sorted birthdays is Poisson with lambda = n^3 / (4 * 2^days_log2).
+     */
+    double birthdaySpacingsZ(const Source& next, int days_log2, uint32_t n, int trials)
+    {
+        uint64_t collisions = 0;
+        vector<uint32_t> days(n), spacings(n);
+        for (int t = 0; t < trials; t++)
+        {
+            for (auto& d : days)
+                d = next() >> (32 - days_log2);
+            sort(days.begin(), days.end());
+            spacings[0] = days[0];
+            for (uint32_t i = 1; i < n; i++)
+                spacings[i] = days[i] - days[i - 1];
+            sort(spacings.begin(), spacings.end());
+            for (uint32_t i = 1; i < n; i++)
+                collisions += spacings[i] == spacings[i - 1];
+        }
+        const double lambda = static_cast<double>(n) * n * n / (4.0 * ldexp(1.0, days_log2)) * trials;
+        return (collisions - lambda) / sqrt(lambda);
+    }
+
+    // Every output bit flips with probability 1/2 when one input bit flips
+    double avalancheMaxBias(const function<uint32_t(uint32_t, uint32_t, uint32_t)>& hash, uint32_t n)
+    {
+        double max_bias = 0.0;
+        for (int input = 0; input < 3; input++)
+        {
+            for (int bit = 0; bit < 32; bit += 3)
+            {
+                vector<uint32_t> flips(32, 0);
+                for (uint32_t i = 0; i < n; i++)
+                {
+                    uint32_t in[3] = { i * 0x9e3779b9u, i, i >> 3 };
+                    const uint32_t a = hash(in[0], in[1], in[2]);
+                    in[input] ^= 1u << bit;
+                    const uint32_t b = hash(in[0], in[1], in[2]);
+                    for (int o = 0; o < 32; o++)
+                        flips[o] += ((a ^ b) >> o) & 1u;
+                }
+                for (uint32_t f : flips)
+                    max_bias = std::max(max_bias, fabs(static_cast<double>(f) / n - 0.5));
+            }
+        }
+        return max_bias;
+    }
+
+    struct Battery {
+        double frequency, serial, serial_low, birthday;
+
+        bool passed() const
+        {
+            return fabs(frequency) < kMaxZ && fabs(serial) < kMaxZ && fabs(serial_low) < kMaxZ && fabs(birthday) < kMaxZ;
+        }
+    };
+
+    Battery runBattery(const char* name, const function<Source()>& make)
+    {
+        Battery r;
+        r.frequency = byteFrequencyZ(make(), 1 << 20);
+        r.serial = serialPairZ(make(), 1 << 21);
+        r.serial_low = serialPairLowZ(make(), 1 << 21);
+        r.birthday = birthdaySpacingsZ(make(), 32, 1 << 12, 64);
+        cout << name << ": frequency z = " << r.frequency << ", serial z = " << r.serial
+             << ", serial (low bits) z = " << r.serial_low << ", birthday spacings z = " << r.birthday << endl;
+        return r;
+    }
+} // nonamed namespace
+
+static void testKnownAnswers()
+{
+    // pcg32-demo of the reference implementation, seed 42 and stream 54
+    PCG32 pcg(42u, 54u);
+    const uint32_t pcg_expected[6] = { 0xa15c02b7u, 0x7b47f409u, 0xba1d3330u, 0x83d2f293u, 0xbfa4784bu, 0xcbed606eu };
+    for (uint32_t v : pcg_expected)
+        assert(pcg.nextUint() == v);
+
+    // Known-answer tests of Random123
+    Vec4ui r = philox4x32(Vec4ui(0u), Vec2ui(0u));
+    assert(r[0] == 0x6627e8d5u && r[1] == 0xe169c58du && r[2] == 0xbc57ac4cu && r[3] == 0x9b00dbd8u);
+    r = philox4x32(Vec4ui(0xffffffffu), Vec2ui(0xffffffffu));
+    assert(r[0] == 0x408f276du && r[1] == 0x41c83b0eu && r[2] == 0xa20bc7c6u && r[3] == 0x6d5451fdu);
+    r = philox4x32(Vec4ui(0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u), Vec2ui(0xa4093822u, 0x299f31d0u));
+    assert(r[0] == 0xd16cfe09u && r[1] == 0x94fdccebu && r[2] == 0x5001e420u && r[3] == 0x24126ea1u);
+}
+
+static void testSkipAhead()
+{
+    PCG32 a(7u, 3u), b(7u, 3u);
+    for (int i = 0; i < 1000; i++)
+        a.nextUint();
+    b.advance(1000);
+    assert(a == b && a.nextUint() == b.nextUint());
+
+    // Going back
+    b.advance(-1001);
+    PCG32 c(7u, 3u);
+    assert(b == c);
+
+    // Streams are different sequences
+    PCG32 d(7u, 4u);
+    assert(c.nextUint() != d.nextUint());
+
+    // Dimensions of the hash are independent of the order they are drawn
+    IndependentSampler s0(123u, 5u, 9u);
+    const Vec3f u = s0.get3D();
+    IndependentSampler s1(123u, 5u, 9u);
+    s1.setDimension(2);
+    assert(s1.get1D() == u[2]);
+    assert(sampleFloat(123u, 5u, 1u, 9u) == u[1]);
+
+    // The cached Philox blocks give the same values as the stateless hash, from any starting dimension
+    for (uint32_t start = 0; start < 8; start++)
+    {
+        IndependentSampler s(77u, 3u, 1u, start);
+        for (uint32_t d = start; d < start + 21; d++)
+            assert(s.get1D() == sampleFloat(77u, 3u, d, 1u));
+        s.setDimension(start);
+        assert(s.get1D() == sampleFloat(77u, 3u, start, 1u));
+    }
+    // 2D samples start at an even dimension, so both values come from one block
+    IndependentSampler s2(77u, 3u, 1u, 3u);
+    const Vec2f uv = s2.get2D();
+    assert(uv[0] == sampleFloat(77u, 3u, 4u, 1u) && uv[1] == sampleFloat(77u, 3u, 5u, 1u) && s2.dimension() == 6u);
+
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        const float f = sampleFloat(i, i * 7u, i % 13u);
+        assert(f >= 0.0f && f < 1.0f);
+        assert(PCG32(i).nextUint(17u) < 17u);
+    }
+    assert(uintToFloat(0xffffffffu) < 1.0f);
+}
+
+static void testStatistics()
+{
+    const Battery pcg = runBattery("PCG32", [] {
+        return [rng = PCG32(2024u)]() mutable { return rng.nextUint(); };
+    });
+    // Sequential counters, as the consecutive dimensions of a path
+    const Battery philox = runBattery("sampleHash (dimensions)", [] {
+        return [i = 0u]() mutable { return sampleHash(17u, 3u, i++); };
+    });
+    // Same dimension of neighbouring pixels
+    const Battery pixels = runBattery("sampleHash (pixels)", [] {
+        return [i = 0u]() mutable { return sampleHash(i++, 0u, 4u); };
+    });
+    // Legacy generator for reference. The 24-bit outputs are moved to the top bits, so the low byte is always 0.
+    runBattery("lcg (reference)", [] {
+        return [seed = tea<4>(0u, 0u)]() mutable { return lcg(seed) << 8; };
+    });
+
+    assert(pcg.passed());
+    assert(philox.passed());
+    assert(pixels.passed());
+
+    const double bias = avalancheMaxBias([](uint32_t p, uint32_t s, uint32_t d) { return sampleHash(p, s, d); }, 1 << 14);
+    const double tea_bias = avalancheMaxBias([](uint32_t p, uint32_t s, uint32_t d) { return tea<4>(p ^ (d * 0x9e3779b9u), s); }, 1 << 14);
+    cout << "Avalanche max bias: sampleHash = " << bias << ", tea<4> = " << tea_bias << endl;
+    // 4 sigma of the binomial with 2^14 trials is 0.016
+    assert(bias < 0.02);
+}
+
+static void benchmark()
+{
+    constexpr uint32_t n = 1 << 24;
+    auto time = [](const char* label, auto func)
+    {
+        auto t0 = chrono::high_resolution_clock::now();
+        const double sum = func();
+        auto t1 = chrono::high_resolution_clock::now();
+        cout << label << ": " << chrono::duration<double, milli>(t1 - t0).count() << " ms (mean " << sum / n << ")" << endl;
+    };
+
+    time("rnd (lcg, 16M)", [] { uint32_t seed = tea<4>(0u, 0u); double s = 0.0; for (uint32_t i = 0; i < n; i++) s += rnd(seed); return s; });
+    time("PCG32::nextFloat (16M)", [] { PCG32 rng; double s = 0.0; for (uint32_t i = 0; i < n; i++) s += rng.nextFloat(); return s; });
+    time("sampleFloat (16M)", [] { double s = 0.0; for (uint32_t i = 0; i < n; i++) s += sampleFloat(i >> 8, 0u, i & 255u); return s; });
+    time("IndependentSampler::get1D (16M)", [] {
+        double s = 0.0;
+        for (uint32_t p = 0; p < (n >> 8); p++)
+        {
+            IndependentSampler sampler(p, 0u);
+            for (uint32_t d = 0; d < 256; d++) s += sampler.get1D();
+        }
+        return s;
+    });
+}
+
+int main()
+{
+    testKnownAnswers();
+    testSkipAhead();
+    testStatistics();
+    benchmark();
+
+    cout << "random: all tests passed" << endl;
+    return 0;
+}
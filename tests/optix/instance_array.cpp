@@ -0,0 +1,90 @@
+#include <prayground/optix/instance_array.h>
+#include <prayground/core/util.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <numeric>
+#include <random>
+
+using namespace std;
+using namespace prayground;
+
+static void testDirtyRanges()
+{
+    InstanceArray instances;
+    for (int i = 0; i < 100; i++)
+        instances.add(OptixInstance{});
+    instances.clearDirty();
+    assert(instances.dirtyRanges().empty());
+
+    instances.setTransform(3, Matrix4f::translate({ 1.0f, 2.0f, 3.0f }));
+    instances.setTransform(4, Matrix4f::scale(2.0f));
+    instances.setTransform(10, Matrix4f::identity());
+    auto ranges = instances.dirtyRanges();
+    assert((ranges == vector<IndexRange>{ {3, 2}, {10, 1} }));
+    assert((instances.dirtyRanges(8) == vector<IndexRange>{ {3, 8} }));
+    assert(instances[3].transform[3] == 1.0f && instances[3].transform[7] == 2.0f && instances[3].transform[11] == 3.0f);
+
+    // Setting the same record doesn't mark it dirty
+    instances.clearDirty();
+    OptixInstance same = instances[3];
+    assert(!instances.set(3, same));
+    assert(instances.dirtyRanges().empty());
+}
+
+int main()
+{
+    testDirtyRanges();
+
+    constexpr uint32_t N = 1'000'000;
+    InstanceArray instances;
+    instances.reserve(N);
+    for (uint32_t i = 0; i < N; i++)
+    {
+        OptixInstance instance{};
+        instance.instanceId = i;
+        instance.visibilityMask = 255;
+        instances.add(instance);
+    }
+    instances.clearDirty();
+
+    vector<Matrix4f> transforms(N);
+    for (uint32_t i = 0; i < N; i++)
+        transforms[i] = Matrix4f::translate({ (float)i, 0.0f, (float)(i % 1000) });
+
+    // Shuffled ids to mimic crowds updated out of order
+    vector<uint32_t> ids(N);
+    iota(ids.begin(), ids.end(), 0u);
+    shuffle(ids.begin(), ids.end(), mt19937(0));
+
+    auto bench = [&](const char* label, auto&& func)
+    {
+        constexpr int num_iterations = 10;
+        auto start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < num_iterations; i++)
+            func();
+        auto end = chrono::high_resolution_clock::now();
+        double ms = chrono::duration<double, milli>(end - start).count() / num_iterations;
+        pgLog(label, ms, "ms");
+    };
+
+    bench("Per-instance setTransform (10^6) :", [&]() {
+        for (uint32_t i = 0; i < N; i++)
+            instances.setTransform(ids[i], transforms[i]);
+    });
+    bench("Bulk updateTransforms in order   :", [&]() {
+        instances.updateTransforms(transforms);
+    });
+    bench("Bulk updateTransforms (10^6)     :", [&]() {
+        instances.updateTransforms(transforms, ids);
+    });
+    bench("dirtyRanges (all dirty)          :", [&]() {
+        auto ranges = instances.dirtyRanges(16);
+        assert(ranges.size() == 1);
+    });
+
+    for (uint32_t i = 0; i < N; i++)
+        assert(instances[ids[i]].transform[3] == transforms[i][3]);
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <prayground/optix/module_cache.h>
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+using namespace prayground;
+namespace fs = std::filesystem;
+
+static void writeText(const fs::path& path, const string& text)
+{
+    fs::create_directories(path.parent_path());
+    ofstream(path, ios::binary) << text;
+}
+
+static void testHasher()
+{
+    assert(ModuleHasher().update("abc").digest() == ModuleHasher().update("abc").digest());
+    assert(ModuleHasher().update("abc").digest() != ModuleHasher().update("abd").digest());
+    // Strings are length-prefixed
+    assert(ModuleHasher().update("ab").update("c").digest() != ModuleHasher().update("a").update("bc").digest());
+    assert(ModuleHasher().digest().size() == 32);
+
+    OptixModuleCompileOptions module_options{};
+    OptixPipelineCompileOptions pipeline_options{};
+    pipeline_options.pipelineLaunchParamsVariableName = "params";
+    auto hashOptions = [&]()
+    {
+        ModuleHasher hasher;
+        hashCompileOptions(hasher, module_options, pipeline_options);
+        return hasher.digest();
+    };
+    const string base = hashOptions();
+
+    // The name is hashed by its contents, not by its address
+    string name = "params";
+    pipeline_options.pipelineLaunchParamsVariableName = name.c_str();
+    assert(hashOptions() == base);
+
+    pipeline_options.numPayloadValues = 5;
+    assert(hashOptions() != base);
+    pipeline_options.numPayloadValues = 0;
+
+    module_options.optLevel = OPTIX_COMPILE_OPTIMIZATION_LEVEL_0;
+    assert(hashOptions() != base);
+}
+
+static void testIncludeScan(const fs::path& root)
+{
+    const string source =
+        "#include \"a.h\"\n"
+        "  #  include <sub/b.h>\n"
+        "// #include \"commented.h\"\n"
+        "#include <cuda_runtime.h>\n"
+        "#define X 1\n";
+    auto names = parseIncludeDirectives(source);
+    assert((names == vector<string>{ "a.h", "sub/b.h", "cuda_runtime.h" }));
+
+    writeText(root / "src" / "a.h", "#include \"c.h\"\n#include \"a.h\"\n");
+    writeText(root / "src" / "c.h", "int c;\n");
+    writeText(root / "inc" / "sub" / "b.h", "#include \"d.h\"\n");
+    writeText(root / "inc" / "sub" / "d.h", "int d;\n");
+
+    // cuda_runtime.h isn't found and is skipped. The cycle of a.h terminates.
+    auto closure = scanIncludeClosure(source, root / "src", { root / "inc" });
+    assert(closure.size() == 4);
+    for (auto file : { root / "src" / "a.h", root / "src" / "c.h", root / "inc" / "sub" / "b.h", root / "inc" / "sub" / "d.h" })
+        assert(find(closure.begin(), closure.end(), fs::canonical(file)) != closure.end());
+
+    // Editing a header changes the hash of the closure
+    ModuleHasher before;
+    hashFiles(before, closure);
+    writeText(root / "inc" / "sub" / "d.h", "int d = 1;\n");
+    ModuleHasher after;
+    hashFiles(after, closure);
+    assert(before.digest() != after.digest());
+}
+
+static void testStore(const fs::path& root)
+{
+    ModuleCache cache(root / "cache");
+    const string key = ModuleHasher().update("module").digest();
+    assert(!cache.load(key, ".ptx"));
+
+    assert(cache.store(key, ".ptx", "ptx v1"));
+    assert(cache.load(key, ".ptx").value() == "ptx v1");
+    assert(cache.store(key, ".ptx", "ptx v2"));
+    assert(cache.load(key, ".ptx").value() == "ptx v2");
+
+    // Concurrent writers: readers always see a complete entry and no temporary file is left
+    const string big_a(1 << 20, 'a'), big_b(1 << 20, 'b');
+    vector<thread> threads;
+    for (int i = 0; i < 8; i++)
+    {
+        threads.emplace_back([&, i]()
+        {
+            for (int j = 0; j < 10; j++)
+            {
+                cache.store(key, ".ptx", i % 2 ? big_a : big_b);
+                auto data = cache.load(key, ".ptx");
+                assert(data && (data.value() == big_a || data.value() == big_b));
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    for (const auto& entry : fs::directory_iterator(root / "cache"))
+        assert(entry.path().string().find(".tmp.") == string::npos);
+
+    // The lock serializes the compilation of the same key
+    int compiled = 0;
+    threads.clear();
+    const string key2 = ModuleHasher().update("module2").digest();
+    for (int i = 0; i < 4; i++)
+    {
+        threads.emplace_back([&]()
+        {
+            auto lock = cache.lock(key2);
+            assert(lock.locked());
+            if (!cache.load(key2, ".ptx"))
+            {
+                compiled++;
+                this_thread::sleep_for(chrono::milliseconds(10));
+                cache.store(key2, ".ptx", "compiled");
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    assert(compiled == 1);
+}
+
+int main()
+{
+    const fs::path root = fs::temp_directory_path() / "prayground_module_cache_test";
+    fs::remove_all(root);
+
+    testHasher();
+    testIncludeScan(root);
+    testStore(root);
+
+    fs::remove_all(root);
+    cout << "module_cache: all tests passed" << endl;
+    return 0;
+}
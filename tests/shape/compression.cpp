@@ -0,0 +1,243 @@
+#include <prayground/math/compression.h>
+#include <prayground/shape/trianglemesh.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <set>
+#include <tuple>
+
+using namespace std;
+using namespace prayground;
+
+namespace {
+    vector<Vec3f> randomUnitVectors(size_t n, uint32_t seed)
+    {
+        mt19937 rng(seed);
+        normal_distribution<float> gauss;
+        vector<Vec3f> v(n);
+        for (auto& x : v)
+            x = normalize(Vec3f(gauss(rng), gauss(rng), gauss(rng)));
+        return v;
+    }
+
+    float angleDegrees(const Vec3f& a, const Vec3f& b)
+    {
+        // atan2 keeps precision for small angles unlike acos
+        return math::degrees(atan2f(length(cross(a, b)), dot(a, b)));
+    }
+
+    /**
+     * n x n quads on a wavy surface with smooth normals. Texcoords are split along the middle column
+     * like a UV seam, so the unified index stream has to duplicate those vertices.
+     */
+    TriangleMesh seamedGrid(int n)
+    {
+        TriangleMesh mesh;
+        auto height = [](float x, float z) { return 0.2f * sinf(x) * cosf(z); };
+        for (int z = 0; z <= n; z++)
+        {
+            for (int x = 0; x <= n; x++)
+            {
+                const float fx = x * 0.1f, fz = z * 0.1f;
+                mesh.addVertex(Vec3f(fx, height(fx, fz), fz));
+                const float dx = 0.2f * cosf(fx) * cosf(fz), dz = -0.2f * sinf(fx) * sinf(fz);
+                mesh.addNormal(normalize(Vec3f(-dx, 1.0f, -dz)));
+            }
+        }
+        // Texcoords of the right half are offset, and the middle column has both
+        for (int z = 0; z <= n; z++)
+            for (int x = 0; x <= n; x++)
+                mesh.addTexcoord(Vec2f((float)x / n, (float)z / n));
+        const int32_t offset = static_cast<int32_t>(mesh.numTexcoords());
+        for (int z = 0; z <= n; z++)
+            for (int x = 0; x <= n; x++)
+                mesh.addTexcoord(Vec2f((float)x / n + 0.5f, (float)z / n));
+
+        auto id = [&](int x, int z) { return z * (n + 1) + x; };
+        for (int z = 0; z < n; z++)
+        {
+            for (int x = 0; x < n; x++)
+            {
+                const Vec3i a(id(x, z), id(x, z + 1), id(x + 1, z + 1));
+                const Vec3i b(id(x, z), id(x + 1, z + 1), id(x + 1, z));
+                const Vec3i t = x < n / 2 ? Vec3i(0) : Vec3i(offset);
+                mesh.addFace(Face{ a, a, a + t });
+                mesh.addFace(Face{ b, b, b + t });
+            }
+        }
+        return mesh;
+    }
+} // nonamed namespace
+
+static void testHalf()
+{
+    assert(floatToHalf(0.0f) == 0x0000);
+    assert(floatToHalf(-0.0f) == 0x8000);
+    assert(floatToHalf(1.0f) == 0x3c00);
+    assert(floatToHalf(-2.0f) == 0xc000);
+    assert(floatToHalf(65504.0f) == 0x7bff);
+    assert(floatToHalf(65520.0f) == 0x7c00);
+    assert(floatToHalf(numeric_limits<float>::infinity()) == 0x7c00);
+    assert(floatToHalf(-numeric_limits<float>::infinity()) == 0xfc00);
+    assert((floatToHalf(numeric_limits<float>::quiet_NaN()) & 0x7fff) > 0x7c00);
+    assert(floatToHalf(ldexpf(1.0f, -24)) == 0x0001);
+    assert(floatToHalf(ldexpf(1.0f, -26)) == 0x0000);
+    // Ties round to even
+    assert(floatToHalf(1.0f + ldexpf(1.0f, -11)) == 0x3c00);
+    assert(floatToHalf(1.0f + 3.0f * ldexpf(1.0f, -11)) == 0x3c02);
+    assert(floatToHalf(ldexpf(3.0f, -25)) == 0x0002);
+
+    // Every half value survives a round trip
+    for (uint32_t h = 0; h < 0x10000; h++)
+    {
+        const float f = halfToFloat(static_cast<uint16_t>(h));
+        if (isnan(f))
+        {
+            assert((h & 0x7c00) == 0x7c00 && (h & 0x3ff) != 0);
+            continue;
+        }
+        assert(floatToHalf(f) == h);
+    }
+    assert(halfToFloat(0x3555) == 0.333251953125f);
+    assert(halfToFloat(0x0001) == ldexpf(1.0f, -24));
+
+    // Batch conversion gives the same bits as the scalar one, including specials and remainders
+    mt19937 rng(3);
+    uniform_real_distribution<float> exponent(-30.0f, 20.0f);
+    vector<Vec2f> values;
+    for (int i = 0; i < 100003; i++)
+        values.emplace_back(ldexpf(1.0f + (rng() & 0xffffff) / 16777216.0f, (int)exponent(rng)) * (rng() & 1 ? 1.0f : -1.0f),
+                            uintAsFloat(static_cast<uint32_t>(rng())));
+    values.emplace_back(numeric_limits<float>::infinity(), numeric_limits<float>::quiet_NaN());
+    vector<uint32_t> packed(values.size());
+    packHalf2(values.data(), packed.data(), values.size());
+    for (size_t i = 0; i < values.size(); i++)
+        assert(packed[i] == packHalf2(values[i]));
+
+    vector<Vec2f> unpacked(values.size());
+    unpackHalf2(packed.data(), unpacked.data(), packed.size());
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        const Vec2f expected = unpackHalf2(packed[i]);
+        for (int k = 0; k < 2; k++)
+            assert(floatAsUint(unpacked[i][k]) == floatAsUint(expected[k]));
+    }
+}
+
+static void testOctahedral()
+{
+    const Vec3f axes[] = { Vec3f(1, 0, 0), Vec3f(-1, 0, 0), Vec3f(0, 1, 0), Vec3f(0, -1, 0), Vec3f(0, 0, 1), Vec3f(0, 0, -1) };
+    for (const Vec3f& axis : axes)
+        assert(length(octDecode(octEncode(axis)) - axis) < 1e-6f);
+    assert(length(octDecode(octEncode(Vec3f(0.0f))) - Vec3f(0, 0, 1)) < 1e-6f);
+
+    const vector<Vec3f> normals = randomUnitVectors(100003, 1);
+    vector<uint32_t> packed(normals.size());
+    octEncode(normals.data(), packed.data(), normals.size());
+    vector<Vec3f> decoded(normals.size());
+    octDecode(packed.data(), decoded.data(), packed.size());
+
+    float max_error = 0.0f;
+    for (size_t i = 0; i < normals.size(); i++)
+    {
+        assert(packed[i] == octEncode(normals[i]));
+        assert(length(decoded[i] - octDecode(packed[i])) < 1e-6f);
+        assert(fabsf(length(decoded[i]) - 1.0f) < 1e-5f);
+        max_error = std::max(max_error, angleDegrees(normals[i], decoded[i]));
+    }
+    cout << "octahedral: max error " << max_error << " degrees" << endl;
+    assert(max_error < 0.01f);
+}
+
+static void testCompactBuffers()
+{
+    constexpr int n = 64;
+    const TriangleMesh mesh = seamedGrid(n);
+    const TriangleMesh::CompactBuffers buffers = mesh.compactBuffers();
+
+    // One vertex for each distinct (position, normal, texcoord), duplicated only on the seam
+    set<tuple<int32_t, int32_t, int32_t>> corners;
+    for (const Face& face : mesh.faces())
+        for (int k = 0; k < 3; k++)
+            corners.emplace(face.vertex_id[k], face.normal_id[k], face.texcoord_id[k]);
+    assert(buffers.vertices.size() == corners.size());
+    assert(buffers.vertices.size() == (n + 1) * (n + 1) + (n + 1));
+    assert(buffers.normals.size() == buffers.vertices.size());
+    assert(buffers.texcoords.size() == buffers.vertices.size());
+    assert(buffers.indices.size() == mesh.numFaces());
+
+    for (uint32_t f = 0; f < mesh.numFaces(); f++)
+    {
+        const Face& face = mesh.faceAt(f);
+        for (int k = 0; k < 3; k++)
+        {
+            const uint32_t v = buffers.indices[f][k];
+            assert(buffers.vertices[v] == mesh.vertexAt(face.vertex_id[k]));
+            assert(angleDegrees(octDecode(buffers.normals[v]), mesh.normalAt(face.normal_id[k])) < 0.01f);
+            const Vec2f uv = unpackHalf2(buffers.texcoords[v]);
+            const Vec2f expected = mesh.texcoordAt(face.texcoord_id[k]);
+            assert(fabsf(uv[0] - expected[0]) <= 1e-3f && fabsf(uv[1] - expected[1]) <= 1e-3f);
+        }
+    }
+
+    // Vertices are numbered in the order of first use
+    uint32_t next = 0;
+    for (const Vec3ui& idx : buffers.indices)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            assert(idx[k] <= next);
+            if (idx[k] == next) next++;
+        }
+    }
+
+    // Meshes without normals and texcoords keep only positions
+    TriangleMesh positions_only(mesh.vertices(), mesh.faces(), {}, {});
+    const auto position_buffers = positions_only.compactBuffers();
+    assert(position_buffers.vertices.size() == mesh.numVertices());
+    assert(position_buffers.normals.empty() && position_buffers.texcoords.empty());
+
+    const size_t full_bytes = mesh.numVertices() * sizeof(Vec3f) + mesh.numNormals() * sizeof(Vec3f)
+                            + mesh.numTexcoords() * sizeof(Vec2f) + mesh.numFaces() * sizeof(Face);
+    const size_t compact_bytes = buffers.vertices.size() * sizeof(Vec3f) + buffers.normals.size() * sizeof(uint32_t)
+                               + buffers.texcoords.size() * sizeof(uint32_t) + buffers.indices.size() * sizeof(Vec3ui);
+    assert(compact_bytes * 2 < full_bytes);
+    cout << "compact storage: " << full_bytes << " -> " << compact_bytes << " bytes" << endl;
+}
+
+int main()
+{
+    testHalf();
+    testOctahedral();
+    testCompactBuffers();
+
+    // Throughput of batch and scalar conversions
+    const vector<Vec3f> normals = randomUnitVectors(1 << 22, 2);
+    vector<uint32_t> packed(normals.size());
+    vector<Vec3f> decoded(normals.size());
+    auto time = [](const char* label, auto&& func)
+    {
+        auto t0 = chrono::high_resolution_clock::now();
+        func();
+        auto t1 = chrono::high_resolution_clock::now();
+        cout << label << ": " << chrono::duration<double, milli>(t1 - t0).count() << " ms" << endl;
+    };
+    time("octEncode (scalar, 4M)", [&] { for (size_t i = 0; i < normals.size(); i++) packed[i] = octEncode(normals[i]); });
+    time("octEncode (batch, 4M)", [&] { octEncode(normals.data(), packed.data(), normals.size()); });
+    time("octDecode (scalar, 4M)", [&] { for (size_t i = 0; i < packed.size(); i++) decoded[i] = octDecode(packed[i]); });
+    time("octDecode (batch, 4M)", [&] { octDecode(packed.data(), decoded.data(), packed.size()); });
+
+    vector<Vec2f> texcoords(normals.size());
+    for (size_t i = 0; i < normals.size(); i++)
+        texcoords[i] = Vec2f(normals[i][0], normals[i][1]);
+    time("packHalf2 (scalar, 4M)", [&] { for (size_t i = 0; i < texcoords.size(); i++) packed[i] = packHalf2(texcoords[i]); });
+    time("packHalf2 (batch, 4M)", [&] { packHalf2(texcoords.data(), packed.data(), texcoords.size()); });
+    time("unpackHalf2 (scalar, 4M)", [&] { for (size_t i = 0; i < packed.size(); i++) texcoords[i] = unpackHalf2(packed[i]); });
+    time("unpackHalf2 (batch, 4M)", [&] { unpackHalf2(packed.data(), texcoords.data(), packed.size()); });
+
+    cout << "compression: all tests passed" << endl;
+    return 0;
+}
@@ -0,0 +1,274 @@
+#include <prayground/shape/gltfmesh.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace std;
+using namespace prayground;
+
+namespace {
+    // 2x2 RGB image: red, green / blue, white
+    const uint8_t png_2x2[] = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x02,
+        0x00, 0x00, 0x00, 0x02, 0x08, 0x02, 0x00, 0x00, 0x00, 0xfd, 0xd4, 0x9a, 0x73, 0x00, 0x00, 0x00, 0x12, 0x49, 0x44, 0x41,
+        0x54, 0x78, 0x9c, 0x63, 0xf8, 0xcf, 0xc0, 0xc0, 0x00, 0xc2, 0x0c, 0xff, 0x81, 0x00, 0x00, 0x1f, 0xee, 0x05, 0xfb, 0x0b,
+        0xd9, 0x68, 0x8b, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82
+    };
+
+    struct BinaryBuffer {
+        string bytes;
+
+        // Return the byte offset of the appended data
+        size_t append(const void* data, size_t size)
+        {
+            const size_t offset = bytes.size();
+            bytes.append(static_cast<const char*>(data), size);
+            bytes.resize((bytes.size() + 3) & ~size_t(3), '\0');
+            return offset;
+        }
+    };
+
+    string base64(const string& bytes)
+    {
+        static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        string out;
+        for (size_t i = 0; i < bytes.size(); i += 3)
+        {
+            uint32_t v = static_cast<uint8_t>(bytes[i]) << 16;
+            if (i + 1 < bytes.size()) v |= static_cast<uint8_t>(bytes[i + 1]) << 8;
+            if (i + 2 < bytes.size()) v |= static_cast<uint8_t>(bytes[i + 2]);
+            out += table[(v >> 18) & 63];
+            out += table[(v >> 12) & 63];
+            out += i + 1 < bytes.size() ? table[(v >> 6) & 63] : '=';
+            out += i + 2 < bytes.size() ? table[v & 63] : '=';
+        }
+        return out;
+    }
+
+    /**
+     * One mesh with two primitives instanced by two nodes under a translated root.
+     * - Primitive 0: indexed quad with interleaved normals and normalized ushort texcoords
+     * - Primitive 1: triangle strip without normals/texcoords, whose third position is replaced by a sparse accessor
+     * - Two textures share one image
+     */
+    struct TestAsset {
+        BinaryBuffer bin;
+        string json_body;
+        size_t png_view;
+
+        TestAsset()
+        {
+            const float positions[] = {
+                0, 0, 0,  1, 0, 0,  1, 1, 0,  0, 1, 0,
+                0, 0, 1,  1, 0, 1,  0, 1, 1,  1, 1, 1
+            };
+            const size_t pos_offset = bin.append(positions, sizeof(positions));
+
+            // normal (12 bytes) + texcoord (4 bytes) + padding with 20 bytes stride
+            string interleaved;
+            const uint16_t uvs[4][2] = { { 0, 0 }, { 65535, 0 }, { 65535, 65535 }, { 0, 32768 } };
+            for (int i = 0; i < 4; i++)
+            {
+                const float n[3] = { 0, 0, 1 };
+                char vertex[20] = {};
+                memcpy(vertex, n, 12);
+                memcpy(vertex + 12, uvs[i], 4);
+                interleaved.append(vertex, 20);
+            }
+            const size_t attr_offset = bin.append(interleaved.data(), interleaved.size());
+
+            const uint8_t quad_indices[] = { 0, 1, 2, 0, 2, 3 };
+            const size_t quad_offset = bin.append(quad_indices, sizeof(quad_indices));
+            const uint16_t strip_indices[] = { 0, 1, 2, 3 };
+            const size_t strip_offset = bin.append(strip_indices, sizeof(strip_indices));
+            const uint8_t sparse_indices[] = { 2 };
+            const size_t sparse_index_offset = bin.append(sparse_indices, sizeof(sparse_indices));
+            const float sparse_values[] = { 0, 2, 1 };
+            const size_t sparse_value_offset = bin.append(sparse_values, sizeof(sparse_values));
+            const size_t png_offset = bin.append(png_2x2, sizeof(png_2x2));
+
+            auto view = [](size_t offset, size_t length, const string& extra = "") {
+                return "{\"buffer\":0,\"byteOffset\":" + to_string(offset) + ",\"byteLength\":" + to_string(length) + extra + "}";
+            };
+            png_view = 6;
+            json_body =
+                "\"asset\": {\"version\": \"2.0\"},\n"
+                "\"scene\": 0,\n"
+                "\"scenes\": [{\"nodes\": [0]}],\n"
+                "\"nodes\": [\n"
+                "  {\"name\": \"root\", \"translation\": [1, 0, 0], \"children\": [1, 2]},\n"
+                "  {\"name\": \"scaled\", \"mesh\": 0, \"scale\": [2, 2, 2]},\n"
+                "  {\"name\": \"moved\", \"mesh\": 0, \"matrix\": [1,0,0,0, 0,1,0,0, 0,0,1,0, 0,3,0,1]},\n"
+                "  {\"name\": \"hidden\", \"mesh\": 0}\n"
+                "],\n"
+                "\"meshes\": [{\"name\": \"two primitives\", \"primitives\": [\n"
+                "  {\"attributes\": {\"POSITION\": 0, \"NORMAL\": 2, \"TEXCOORD_0\": 3}, \"indices\": 4, \"material\": 1},\n"
+                "  {\"attributes\": {\"POSITION\": 1}, \"indices\": 5, \"mode\": 5, \"material\": 0},\n"
+                "  {\"attributes\": {\"POSITION\": 0}, \"mode\": 1}\n"
+                "]}],\n"
+                "\"accessors\": [\n"
+                "  {\"bufferView\": 0, \"componentType\": 5126, \"count\": 4, \"type\": \"VEC3\"},\n"
+                "  {\"bufferView\": 0, \"byteOffset\": 48, \"componentType\": 5126, \"count\": 4, \"type\": \"VEC3\",\n"
+                "   \"sparse\": {\"count\": 1, \"indices\": {\"bufferView\": 4, \"componentType\": 5121}, \"values\": {\"bufferView\": 5}}},\n"
+                "  {\"bufferView\": 1, \"componentType\": 5126, \"count\": 4, \"type\": \"VEC3\"},\n"
+                "  {\"bufferView\": 1, \"byteOffset\": 12, \"componentType\": 5123, \"normalized\": true, \"count\": 4, \"type\": \"VEC2\"},\n"
+                "  {\"bufferView\": 2, \"componentType\": 5121, \"count\": 6, \"type\": \"SCALAR\"},\n"
+                "  {\"bufferView\": 3, \"componentType\": 5123, \"count\": 4, \"type\": \"SCALAR\"}\n"
+                "],\n"
+                "\"bufferViews\": [\n  " +
+                view(pos_offset, sizeof(positions)) + ",\n  " +
+                view(attr_offset, interleaved.size(), ",\"byteStride\":20") + ",\n  " +
+                view(quad_offset, sizeof(quad_indices)) + ",\n  " +
+                view(strip_offset, sizeof(strip_indices)) + ",\n  " +
+                view(sparse_index_offset, sizeof(sparse_indices)) + ",\n  " +
+                view(sparse_value_offset, sizeof(sparse_values)) + ",\n  " +
+                view(png_offset, sizeof(png_2x2)) + "\n"
+                "],\n"
+                "\"materials\": [\n"
+                "  {\"name\": \"red\", \"pbrMetallicRoughness\": {\"baseColorFactor\": [1, 0, 0, 1], \"metallicFactor\": 0.25, \"baseColorTexture\": {\"index\": 1}}},\n"
+                "  {\"name\": \"tex\\u00e9\", \"emissiveFactor\": [1, 2, 3e0],\n"
+                "   \"pbrMetallicRoughness\": {\"baseColorTexture\": {\"index\": 0}, \"metallicRoughnessTexture\": {\"index\": 1}}}\n"
+                "],\n"
+                "\"textures\": [{\"source\": 0}, {\"source\": 0}],\n";
+        }
+
+        void writeGlb(const filesystem::path& path) const
+        {
+            string json = "{\n" + json_body +
+                "\"images\": [{\"bufferView\": " + to_string(png_view) + ", \"mimeType\": \"image/png\"}],\n"
+                "\"buffers\": [{\"byteLength\": " + to_string(bin.bytes.size()) + "}]\n}";
+            json.resize((json.size() + 3) & ~size_t(3), ' ');
+
+            auto u32 = [](uint32_t v) { return string(reinterpret_cast<const char*>(&v), 4); };
+            string glb = u32(0x46546c67) + u32(2) + u32(static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.bytes.size()));
+            glb += u32(static_cast<uint32_t>(json.size())) + u32(0x4e4f534a) + json;
+            glb += u32(static_cast<uint32_t>(bin.bytes.size())) + u32(0x004e4942) + bin.bytes;
+            ofstream(path, ios::binary) << glb;
+        }
+
+        // External buffer with a percent-encoded URI and the image in a data URI
+        void writeGltf(const filesystem::path& path) const
+        {
+            ofstream(path.parent_path() / "data file.bin", ios::binary) << bin.bytes;
+            const string png(reinterpret_cast<const char*>(png_2x2), sizeof(png_2x2));
+            ofstream(path) << "{\n" + json_body +
+                "\"images\": [{\"uri\": \"data:image/png;base64," + base64(png) + "\"}],\n"
+                "\"buffers\": [{\"uri\": \"data%20file.bin\", \"byteLength\": " + to_string(bin.bytes.size()) + "}]\n}";
+        }
+    };
+
+    bool near(float a, float b)
+    {
+        return fabsf(a - b) < 1e-5f;
+    }
+
+    void checkAsset(const glTFAsset& asset)
+    {
+        assert(asset.meshes().size() == 1);
+        const glTFMesh& mesh = *asset.meshes()[0];
+        assert(mesh.name() == "two primitives");
+
+        // The line primitive is skipped
+        assert(mesh.numVertices() == 8);
+        assert(mesh.numFaces() == 4);
+        assert(mesh.vertexAt(6) == Vec3f(0, 2, 1));
+        assert(mesh.vertexAt(7) == Vec3f(1, 1, 1));
+
+        // Quad
+        assert(mesh.faceAt(0).vertex_id == Vec3i(0, 1, 2) && mesh.faceAt(1).vertex_id == Vec3i(0, 2, 3));
+        assert(mesh.faceAt(1).normal_id == Vec3i(0, 2, 3) && mesh.faceAt(1).texcoord_id == Vec3i(0, 2, 3));
+        assert(mesh.normalAt(3) == Vec3f(0, 0, 1));
+        assert(mesh.texcoordAt(2) == Vec2f(1, 1));
+        assert(near(mesh.texcoordAt(3)[1], 32768.0f / 65535.0f));
+
+        // Strip keeps the winding of odd triangles, and gets flat normals and one texcoord
+        assert(mesh.faceAt(2).vertex_id == Vec3i(4, 5, 6) && mesh.faceAt(3).vertex_id == Vec3i(5, 7, 6));
+        assert(mesh.numTexcoords() == 5);
+        for (uint32_t f = 2; f < 4; f++)
+        {
+            const Face& face = mesh.faceAt(f);
+            assert(face.texcoord_id == Vec3i(4));
+            assert(face.normal_id[0] == face.normal_id[1] && face.normal_id[1] == face.normal_id[2]);
+            assert(length(mesh.normalAt(face.normal_id[0]) - Vec3f(0, 0, 1)) < 1e-6f);
+        }
+
+        // Primitives are bound to SBT indices in the order of their materials appearing
+        assert(mesh.materialIndices() == vector<int32_t>({ 1, 0 }));
+        assert(mesh.sbtIndices() == vector<uint32_t>({ 0, 0, 1, 1 }));
+        assert(mesh.numMaterials() == 2);
+
+        // Node instances of the default scene
+        const auto& instances = asset.instances();
+        assert(instances.size() == 2);
+        assert(instances[0].name == "scaled" && instances[0].mesh == 0);
+        const Matrix4f expected_scaled = Matrix4f::translate(Vec3f(1, 0, 0)) * Matrix4f::scale(2.0f);
+        const Matrix4f expected_moved = Matrix4f::translate(Vec3f(1, 3, 0));
+        for (int i = 0; i < 16; i++)
+        {
+            assert(near(instances[0].transform[i], expected_scaled[i]));
+            assert(near(instances[1].transform[i], expected_moved[i]));
+        }
+
+        assert(asset.materials().size() == 2);
+        const Attributes& red = asset.materials()[0];
+        assert(red.name == "red");
+        assert(red.findOneVec4f("base_color", Vec4f(0)) == Vec4f(1, 0, 0, 1));
+        assert(red.findOneFloat("metallic", 0.0f) == 0.25f && red.findOneFloat("roughness", 0.0f) == 1.0f);
+        assert(red.findOneInt("base_color_texture", -2) == 0);
+        assert(red.findOneInt("normal_texture", -2) == -1);
+        const Attributes& textured = asset.materials()[1];
+        assert(textured.name == "tex\xc3\xa9");
+        assert(textured.findOneVec3f("emission", Vec3f(0)) == Vec3f(1, 2, 3));
+        assert(textured.findOneInt("base_color_texture", -2) == 0 && textured.findOneInt("metallic_roughness_texture", -2) == 0);
+
+        // Textures sharing the image refer the same bitmap
+        assert(asset.images().size() == 1 && asset.images()[0]);
+        const Bitmap& image = *asset.images()[0];
+        assert(image.width() == 2 && image.height() == 2 && image.channels() == 3);
+        const uint8_t expected_pixels[] = { 255, 0, 0, 0, 255, 0, 0, 0, 255, 255, 255, 255 };
+        assert(memcmp(image.data(), expected_pixels, sizeof(expected_pixels)) == 0);
+    }
+
+    template <class Func>
+    bool throws(const Func& func)
+    {
+        try { func(); }
+        catch (const std::runtime_error&) { return true; }
+        return false;
+    }
+} // nonamed namespace
+
+int main()
+{
+    const filesystem::path dir = filesystem::temp_directory_path() / "prayground_gltf_test";
+    filesystem::create_directories(dir);
+
+    TestAsset asset;
+    asset.writeGlb(dir / "asset.glb");
+    asset.writeGltf(dir / "asset.gltf");
+    checkAsset(glTFAsset(dir / "asset.glb"));
+    checkAsset(glTFAsset(dir / "asset.gltf"));
+
+    // Broken files throw instead of reading out of buffers
+    {
+        ifstream in(dir / "asset.glb", ios::binary);
+        string glb((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        ofstream(dir / "truncated.glb", ios::binary) << glb.substr(0, glb.size() - 16);
+        ofstream(dir / "invalid.gltf") << "{\"asset\": {\"version\": \"2.0\"}, \"meshes\": [}";
+        ofstream(dir / "out_of_range.gltf") << "{\"asset\": {\"version\": \"2.0\"}, \"buffers\": [{\"uri\": \"data:application/octet-stream;base64,AAAA\", \"byteLength\": 3}],"
+            "\"bufferViews\": [{\"buffer\": 0, \"byteLength\": 3}], \"accessors\": [{\"bufferView\": 0, \"componentType\": 5126, \"count\": 1, \"type\": \"VEC3\"}],"
+            "\"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0}}]}]}";
+    }
+    assert(throws([&] { glTFAsset(dir / "truncated.glb"); }));
+    assert(throws([&] { glTFAsset(dir / "invalid.gltf"); }));
+    assert(throws([&] { glTFAsset(dir / "out_of_range.gltf"); }));
+
+    filesystem::remove_all(dir);
+
+    cout << "gltf: all tests passed" << endl;
+    return 0;
+}
@@ -0,0 +1,710 @@
+#include <prayground/shape/meshopt.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <tuple>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace prayground;
+
+namespace {
+    /**
+     * n x n quads on the XZ plane as a triangle soup like meshes loaded from OBJ files without shared vertices.
+     * Each corner is jittered less than `jitter` and every triangle has its own normals and texcoords.
+     */
+    TriangleMesh gridSoup(int n, float jitter, uint32_t seed)
+    {
+        mt19937 rng(seed);
+        uniform_real_distribution<float> offset(-jitter, jitter);
+
+        TriangleMesh mesh;
+        auto corner = [&](int x, int z)
+        {
+            const int32_t id = static_cast<int32_t>(mesh.numVertices());
+            mesh.addVertex(Vec3f(x + offset(rng), 0.0f, z + offset(rng)));
+            mesh.addNormal(Vec3f(0, 1, 0));
+            mesh.addTexcoord(Vec2f((float)x / n, (float)z / n));
+            return id;
+        };
+        for (int z = 0; z < n; z++)
+        {
+            for (int x = 0; x < n; x++)
+            {
+                const Vec3i t0(corner(x, z), corner(x, z + 1), corner(x + 1, z + 1));
+                const Vec3i t1(corner(x, z), corner(x + 1, z + 1), corner(x + 1, z));
+                mesh.addFace(Face{ t0, t0, t0 }, (x + z) % 3);
+                mesh.addFace(Face{ t1, t1, t1 }, (x + z) % 3);
+            }
+        }
+        return mesh;
+    }
+
+    // Shuffle faces and each vertex stream, like scanned meshes whose order has no spatial locality
+    TriangleMesh shuffled(const TriangleMesh& mesh, uint32_t seed)
+    {
+        mt19937 rng(seed);
+        auto permutation = [&](size_t n)
+        {
+            vector<uint32_t> p(n);
+            iota(p.begin(), p.end(), 0u);
+            shuffle(p.begin(), p.end(), rng);
+            return p;
+        };
+        const auto face_order = permutation(mesh.numFaces());
+        const auto v_map = permutation(mesh.numVertices());
+        const auto n_map = permutation(mesh.numNormals());
+        const auto t_map = permutation(mesh.numTexcoords());
+
+        vector<Vec3f> vertices(mesh.numVertices()), normals(mesh.numNormals());
+        vector<Vec2f> texcoords(mesh.numTexcoords());
+        for (uint32_t i = 0; i < mesh.numVertices(); i++) vertices[v_map[i]] = mesh.vertexAt(i);
+        for (uint32_t i = 0; i < mesh.numNormals(); i++) normals[n_map[i]] = mesh.normalAt(i);
+        for (uint32_t i = 0; i < mesh.numTexcoords(); i++) texcoords[t_map[i]] = mesh.texcoordAt(i);
+
+        vector<Face> faces;
+        vector<uint32_t> sbt_indices;
+        for (uint32_t i : face_order)
+        {
+            Face f = mesh.faceAt(i);
+            for (int k = 0; k < 3; k++)
+            {
+                f.vertex_id[k] = v_map[f.vertex_id[k]];
+                f.normal_id[k] = n_map[f.normal_id[k]];
+                f.texcoord_id[k] = t_map[f.texcoord_id[k]];
+            }
+            faces.emplace_back(f);
+            sbt_indices.emplace_back(mesh.sbtIndices()[i]);
+        }
+        return TriangleMesh(vertices, faces, normals, texcoords, sbt_indices);
+    }
+
+    // Faces described by their attribute values and SBT index, which are independent of the buffer layout
+    vector<tuple<float, float, float, float, float, uint32_t>> faceSignatures(const TriangleMesh& mesh)
+    {
+        vector<tuple<float, float, float, float, float, uint32_t>> signatures;
+        for (uint32_t i = 0; i < mesh.numFaces(); i++)
+        {
+            const Face& f = mesh.faceAt(i);
+            for (int k = 0; k < 3; k++)
+            {
+                const Vec3f& p = mesh.vertexAt(f.vertex_id[k]);
+                const Vec2f& t = mesh.texcoordAt(f.texcoord_id[k]);
+                // Corner index is folded into the position to keep the winding order
+                signatures.emplace_back(p.x() + k * 1000.0f, p.y(), p.z(), t.x(), t.y(), mesh.sbtIndices()[i]);
+            }
+        }
+        sort(signatures.begin(), signatures.end());
+        return signatures;
+    }
+
+    Vec3f centroid(const TriangleMesh& mesh, uint32_t i)
+    {
+        const Face& f = mesh.faceAt(i);
+        return (mesh.vertexAt(f.vertex_id[0]) + mesh.vertexAt(f.vertex_id[1]) + mesh.vertexAt(f.vertex_id[2])) / 3.0f;
+    }
+
+    // Average distance between centroids of consecutive faces
+    float averageStep(const TriangleMesh& mesh)
+    {
+        double sum = 0.0;
+        for (uint32_t i = 1; i < mesh.numFaces(); i++)
+            sum += length(centroid(mesh, i) - centroid(mesh, i - 1));
+        return static_cast<float>(sum / (mesh.numFaces() - 1));
+    }
+
+    // Set-associative LRU cache with 64-byte lines, to count misses independently of the hardware
+    class CacheSimulator {
+    public:
+        CacheSimulator(size_t size, uint32_t num_ways)
+            : m_num_sets(static_cast<uint32_t>(size / 64 / num_ways)), m_num_ways(num_ways), m_tags(m_num_sets * num_ways, ~0ull), m_ages(m_num_sets * num_ways, 0)
+        {}
+
+        void access(const void* ptr, size_t size)
+        {
+            const uint64_t first = reinterpret_cast<uint64_t>(ptr) / 64;
+            const uint64_t last = (reinterpret_cast<uint64_t>(ptr) + size - 1) / 64;
+            for (uint64_t line = first; line <= last; line++)
+                accessLine(line);
+        }
+
+        uint64_t misses() const { return m_misses; }
+    private:
+        void accessLine(uint64_t line)
+        {
+            const size_t base = (line % m_num_sets) * m_num_ways;
+            m_time++;
+            size_t victim = base;
+            for (size_t w = base; w < base + m_num_ways; w++)
+            {
+                if (m_tags[w] == line)
+                {
+                    m_ages[w] = m_time;
+                    return;
+                }
+                if (m_ages[w] < m_ages[victim])
+                    victim = w;
+            }
+            m_tags[victim] = line;
+            m_ages[victim] = m_time;
+            m_misses++;
+        }
+
+        uint32_t m_num_sets, m_num_ways;
+        vector<uint64_t> m_tags, m_ages;
+        uint64_t m_time = 0, m_misses = 0;
+    };
+
+    // Last-level cache read misses of this thread from the hardware counter, if the kernel allows
+    class CacheMissCounter {
+    public:
+        CacheMissCounter()
+        {
+#if defined(__linux__)
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+        }
+        ~CacheMissCounter()
+        {
+#if defined(__linux__)
+            if (m_fd >= 0) close(m_fd);
+#endif
+        }
+
+        bool available() const { return m_fd >= 0; }
+
+        void start()
+        {
+#if defined(__linux__)
+            if (m_fd < 0) return;
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+        }
+
+        uint64_t stop()
+        {
+            uint64_t count = 0;
+#if defined(__linux__)
+            if (m_fd < 0) return 0;
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(m_fd, &count, sizeof(count)) != sizeof(count))
+                count = 0;
+#endif
+            return count;
+        }
+    private:
+        int m_fd = -1;
+    };
+
+    /**
+     * Fetch attributes of faces hit in scanline order of their centroids over the XZ plane,
+     * as closest-hit programs do for coherent camera rays, and report time and cache misses.
+     */
+    void benchmarkAttributeFetch(const char* label, const TriangleMesh& mesh)
+    {
+        vector<uint32_t> hits(mesh.numFaces());
+        iota(hits.begin(), hits.end(), 0u);
+        vector<pair<float, float>> keys(mesh.numFaces());
+        for (uint32_t i = 0; i < mesh.numFaces(); i++)
+        {
+            const Vec3f c = centroid(mesh, i);
+            keys[i] = { floorf(c.z()), c.x() + (c.z() - floorf(c.z())) * 0.5f };
+        }
+        sort(hits.begin(), hits.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+        auto shade = [&](uint32_t id, CacheSimulator* cache)
+        {
+            const Face& f = mesh.faces()[id];
+            const Vec3f& p0 = mesh.vertices()[f.vertex_id[0]];
+            const Vec3f& p1 = mesh.vertices()[f.vertex_id[1]];
+            const Vec3f& p2 = mesh.vertices()[f.vertex_id[2]];
+            const Vec3f& n0 = mesh.normals()[f.normal_id[0]];
+            const Vec3f& n1 = mesh.normals()[f.normal_id[1]];
+            const Vec3f& n2 = mesh.normals()[f.normal_id[2]];
+            const Vec2f& t0 = mesh.texcoords()[f.texcoord_id[0]];
+            const Vec2f& t1 = mesh.texcoords()[f.texcoord_id[1]];
+            const Vec2f& t2 = mesh.texcoords()[f.texcoord_id[2]];
+            if (cache)
+            {
+                cache->access(&f, sizeof(Face));
+                for (const void* ptr : { (const void*)&p0, (const void*)&p1, (const void*)&p2, (const void*)&n0, (const void*)&n1, (const void*)&n2 })
+                    cache->access(ptr, sizeof(Vec3f));
+                for (const void* ptr : { (const void*)&t0, (const void*)&t1, (const void*)&t2 })
+                    cache->access(ptr, sizeof(Vec2f));
+            }
+            // Attributes at the centroid
+            return (p0 + p1 + p2 + n0 + n1 + n2).x() + (t0 + t1 + t2).y();
+        };
+
+        // 1 MiB 16-way L2
+        CacheSimulator cache(1 << 20, 16);
+        for (uint32_t id : hits)
+            shade(id, &cache);
+
+        CacheMissCounter counter;
+        volatile float sink = 0.0f;
+        counter.start();
+        auto t0 = chrono::high_resolution_clock::now();
+        for (uint32_t id : hits)
+            sink = sink + shade(id, nullptr);
+        auto t1 = chrono::high_resolution_clock::now();
+        const uint64_t hw_misses = counter.stop();
+
+        cout << label << ": " << chrono::duration<double, milli>(t1 - t0).count() << " ms, simulated L2 misses: " << cache.misses();
+        if (counter.available())
+            cout << ", LLC read misses: " << hw_misses;
+        cout << endl;
+    }
+
+    /**
+     * UV sphere of unit radius with shared vertices. Normals are shared with vertices, and texcoords
+     * are split on the seam at u = 0/1 and at the poles.
+     */
+    TriangleMesh uvSphere(int segments, int rings)
+    {
+        TriangleMesh mesh;
+        auto vertexId = [&](int s, int r)
+        {
+            if (r == 0) return 0;
+            if (r == rings) return 1;
+            return 2 + (r - 1) * segments + s % segments;
+        };
+        auto texcoordId = [&](int s, int r) { return r * (segments + 1) + s; };
+
+        mesh.addVertex(Vec3f(0, 1, 0));
+        mesh.addVertex(Vec3f(0, -1, 0));
+        for (int r = 1; r < rings; r++)
+        {
+            for (int s = 0; s < segments; s++)
+            {
+                const float theta = math::pi * r / rings, phi = math::two_pi * s / segments;
+                mesh.addVertex(Vec3f(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi)));
+            }
+        }
+        for (uint32_t i = 0; i < mesh.numVertices(); i++)
+            mesh.addNormal(mesh.vertexAt(i));
+        for (int r = 0; r <= rings; r++)
+            for (int s = 0; s <= segments; s++)
+                mesh.addTexcoord(Vec2f((float)s / segments, (float)r / rings));
+
+        for (int r = 0; r < rings; r++)
+        {
+            for (int s = 0; s < segments; s++)
+            {
+                const Vec3i a(vertexId(s, r), vertexId(s + 1, r + 1), vertexId(s, r + 1));
+                const Vec3i b(vertexId(s, r), vertexId(s + 1, r), vertexId(s + 1, r + 1));
+                const Vec3i ta(texcoordId(s, r), texcoordId(s + 1, r + 1), texcoordId(s, r + 1));
+                const Vec3i tb(texcoordId(s, r), texcoordId(s + 1, r), texcoordId(s + 1, r + 1));
+                if (r != 0)
+                    mesh.addFace(Face{ b, b, tb }, s % 2);
+                if (r != rings - 1)
+                    mesh.addFace(Face{ a, a, ta }, s % 2);
+            }
+        }
+        return mesh;
+    }
+
+    float faceArea(const TriangleMesh& mesh, const Face& face)
+    {
+        const Vec3f& p0 = mesh.vertexAt(face.vertex_id[0]);
+        return 0.5f * length(cross(mesh.vertexAt(face.vertex_id[1]) - p0, mesh.vertexAt(face.vertex_id[2]) - p0));
+    }
+} // nonamed namespace
+
+static void testWeld()
+{
+    constexpr int n = 32;
+    TriangleMesh mesh = gridSoup(n, 1e-4f, 1);
+    const TriangleMesh original = mesh;
+
+    // A duplicated face and a face which collapses to a line after welding
+    mesh.addFace(mesh.faceAt(5), 1);
+    const int32_t v = static_cast<int32_t>(mesh.numVertices());
+    mesh.addVertex(Vec3f(0, 0, 0));
+    mesh.addVertex(Vec3f(1e-5f, 0, 0));
+    mesh.addVertex(Vec3f(5, 0, 5));
+    mesh.addFace(Face{ Vec3i(v, v + 1, v + 2), Vec3i(0), Vec3i(0) }, 2);
+
+    MeshWeldSettings settings;
+    settings.position_tolerance = 1e-3f;
+    settings.normal_tolerance = 1e-3f;
+    settings.texcoord_tolerance = 1e-5f;
+    const MeshWeldStats stats = weldVertices(mesh, settings);
+
+    assert(stats.num_faces_before == 2 * n * n + 2);
+    assert(stats.num_faces_after == 2 * n * n);
+    assert(mesh.numFaces() == 2 * n * n);
+    assert(mesh.numVertices() == (n + 1) * (n + 1));
+    assert(mesh.numNormals() == 1);
+    assert(mesh.numTexcoords() == (n + 1) * (n + 1));
+    assert(mesh.numSbtIndices() == mesh.numFaces());
+
+    // Faces keep their order, positions (within the tolerance) and SBT indices
+    for (uint32_t i = 0; i < mesh.numFaces(); i++)
+    {
+        const Face& before = original.faceAt(i);
+        const Face& after = mesh.faceAt(i);
+        assert(mesh.sbtIndices()[i] == original.sbtIndices()[i]);
+        for (int k = 0; k < 3; k++)
+        {
+            assert(length(mesh.vertexAt(after.vertex_id[k]) - original.vertexAt(before.vertex_id[k])) < 2e-3f);
+            assert(mesh.texcoordAt(after.texcoord_id[k]) == original.texcoordAt(before.texcoord_id[k]));
+            assert(after.normal_id[k] == 0);
+        }
+    }
+
+    // Smooth normals are now shared by adjacent triangles
+    mesh.calculateNormalSmooth();
+    for (uint32_t i = 0; i < mesh.numNormals(); i++)
+        assert(fabsf(mesh.normalAt(i).y()) > 0.999f);
+
+    // Exact welding doesn't merge jittered vertices, but merges bitwise identical ones
+    TriangleMesh exact = gridSoup(4, 1e-4f, 2);
+    weldVertices(exact);
+    assert(exact.numVertices() == 4 * 4 * 6);
+    assert(exact.numNormals() == 1);
+    TriangleMesh clean = gridSoup(4, 0.0f, 3);
+    weldVertices(clean);
+    assert(clean.numVertices() == 5 * 5);
+
+    // Negative tolerances keep normals and texcoords
+    TriangleMesh keep = gridSoup(4, 0.0f, 4);
+    settings.normal_tolerance = -1.0f;
+    settings.texcoord_tolerance = -1.0f;
+    weldVertices(keep, settings);
+    assert(keep.numVertices() == 5 * 5);
+    assert(keep.numNormals() == 4 * 4 * 6);
+    assert(keep.numTexcoords() == 4 * 4 * 6);
+}
+
+static void testReorder()
+{
+    TriangleMesh mesh = gridSoup(32, 0.0f, 6);
+    weldVertices(mesh);
+    const TriangleMesh original = shuffled(mesh, 7);
+
+    for (auto curve : { SpaceFillingCurve::Morton, SpaceFillingCurve::Hilbert })
+    {
+        TriangleMesh reordered = original;
+        MeshReorderSettings settings;
+        settings.curve = curve;
+        reorderMesh(reordered, settings);
+
+        // The same faces with the same materials, in a different order
+        assert(reordered.numFaces() == original.numFaces());
+        assert(reordered.numVertices() == original.numVertices());
+        assert(reordered.numSbtIndices() == original.numSbtIndices());
+        assert(faceSignatures(reordered) == faceSignatures(original));
+
+        // Vertices are numbered in the order of first use
+        int32_t next = 0;
+        for (const Face& f : reordered.faces())
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                assert(f.vertex_id[k] <= next);
+                if (f.vertex_id[k] == next) next++;
+            }
+        }
+        assert(next == static_cast<int32_t>(reordered.numVertices()));
+
+        // Consecutive faces are close to each other
+        assert(averageStep(reordered) < 0.1f * averageStep(original));
+    }
+
+    // Faces only
+    TriangleMesh faces_only = original;
+    MeshReorderSettings settings;
+    settings.reorder_vertices = false;
+    reorderMesh(faces_only, settings);
+    assert(faceSignatures(faces_only) == faceSignatures(original));
+    for (uint32_t i = 0; i < original.numVertices(); i++)
+        assert(faces_only.vertexAt(i) == original.vertexAt(i));
+}
+
+static void testSimplify()
+{
+    // Closed surface with normal and texcoord seams
+    const TriangleMesh sphere = uvSphere(128, 64);
+    for (uint32_t num_clusters : { 1u, 4u })
+    {
+        MeshSimplifySettings settings;
+        settings.num_clusters = num_clusters;
+        const auto simplified = simplifyMesh(sphere, 2000, settings);
+        assert(simplified->numFaces() <= 2000 && simplified->numFaces() >= 1900);
+        assert(simplified->sbtIndices().size() == simplified->numFaces());
+
+        double mean_radius = 0.0;
+        for (uint32_t i = 0; i < simplified->numFaces(); i++)
+        {
+            const Face& face = simplified->faceAt(i);
+            const Vec3f p0 = simplified->vertexAt(face.vertex_id[0]);
+            const Vec3f p1 = simplified->vertexAt(face.vertex_id[1]);
+            const Vec3f p2 = simplified->vertexAt(face.vertex_id[2]);
+            const Vec3f c = (p0 + p1 + p2) / 3.0f;
+            // No flipped faces, and attributes still belong to their vertices
+            assert(dot(cross(p1 - p0, p2 - p0), c) > 0.0f);
+            for (int k = 0; k < 3; k++)
+            {
+                const Vec3f p = simplified->vertexAt(face.vertex_id[k]);
+                assert(dot(simplified->normalAt(face.normal_id[k]), p) > 0.999f);
+                const Vec2f uv = simplified->texcoordAt(face.texcoord_id[k]);
+                assert(fabsf(uv[1] - acosf(std::clamp(p[1], -1.0f, 1.0f)) / math::pi) < 1e-3f);
+            }
+            mean_radius += length(c);
+        }
+        mean_radius /= simplified->numFaces();
+        assert(mean_radius > 0.98);
+    }
+
+    // Open borders and per-face SBT indices
+    constexpr int n = 32;
+    TriangleMesh grid = gridSoup(n, 0.0f, 2);
+    weldVertices(grid);
+    for (bool lock_border : { false, true })
+    {
+        MeshSimplifySettings settings;
+        settings.lock_border = lock_border;
+        const auto simplified = simplifyMesh(grid, 200, settings);
+        assert(simplified->numFaces() <= 200);
+        float area = 0.0f;
+        uint32_t num_border_vertices = 0;
+        for (uint32_t i = 0; i < simplified->numFaces(); i++)
+            area += faceArea(*simplified, simplified->faceAt(i));
+        for (uint32_t i = 0; i < simplified->numVertices(); i++)
+        {
+            const Vec3f p = simplified->vertexAt(i);
+            if (p[0] == 0.0f || p[0] == n || p[2] == 0.0f || p[2] == n)
+                num_border_vertices++;
+        }
+        assert(fabsf(area - n * n) < 1e-2f);
+        assert(lock_border ? num_border_vertices == 4 * n : num_border_vertices < 4 * n);
+
+        assert(simplified->sbtIndices().size() == simplified->numFaces());
+        for (uint32_t sbt_idx : simplified->sbtIndices())
+            assert(sbt_idx < 3);
+    }
+
+    // Chain of LODs
+    const auto lods = generateLODs(sphere, { 8000, 2000, 500 });
+    assert(lods.size() == 3);
+    assert(lods[0]->numFaces() <= 8000 && lods[1]->numFaces() <= 2000 && lods[2]->numFaces() <= 500);
+    assert(lods[2]->numFaces() >= 400);
+
+    // max_error stops before the target
+    MeshSimplifySettings settings;
+    settings.max_error = 1e-3f;
+    assert(simplifyMesh(sphere, 100, settings)->numFaces() > 1000);
+}
+
+static void checkClusters(const TriangleMesh& mesh, const MeshClusters& result, const MeshClusterSettings& settings)
+{
+    // Every face belongs to exactly one cluster
+    assert(result.face_ids.size() == mesh.numFaces());
+    assert(result.local_indices.size() == result.face_ids.size() * 3);
+    vector<uint8_t> covered(mesh.numFaces(), 0);
+    for (uint32_t f : result.face_ids)
+    {
+        assert(f < mesh.numFaces() && !covered[f]);
+        covered[f] = 1;
+    }
+
+    uint32_t face_offset = 0, vertex_offset = 0;
+    for (const MeshCluster& cluster : result.clusters)
+    {
+        assert(cluster.face_offset == face_offset && cluster.vertex_offset == vertex_offset);
+        assert(cluster.num_faces > 0 && cluster.num_faces <= settings.max_triangles);
+        assert(cluster.num_vertices >= 3 && cluster.num_vertices <= settings.max_vertices);
+        face_offset += cluster.num_faces;
+        vertex_offset += cluster.num_vertices;
+
+        // Local indices reference the original positions of the faces, and each position appears once
+        const auto vertices_begin = result.vertex_ids.begin() + cluster.vertex_offset;
+        vector<uint32_t> unique_ids(vertices_begin, vertices_begin + cluster.num_vertices);
+        sort(unique_ids.begin(), unique_ids.end());
+        assert(unique(unique_ids.begin(), unique_ids.end()) == unique_ids.end());
+        for (uint32_t i = 0; i < cluster.num_faces; i++)
+        {
+            const Face& face = mesh.faceAt(result.face_ids[cluster.face_offset + i]);
+            for (int k = 0; k < 3; k++)
+            {
+                const uint8_t local = result.local_indices[(cluster.face_offset + i) * 3 + k];
+                assert(local < cluster.num_vertices);
+                assert(vertices_begin[local] == static_cast<uint32_t>(face.vertex_id[k]));
+            }
+        }
+
+        // Bounds are the tight bounds of the positions
+        Vec3f bmin(numeric_limits<float>::max()), bmax(-numeric_limits<float>::max());
+        for (uint32_t i = 0; i < cluster.num_vertices; i++)
+        {
+            const Vec3f& p = mesh.vertexAt(vertices_begin[i]);
+            for (int a = 0; a < 3; a++)
+            {
+                bmin[a] = std::min(bmin[a], p[a]);
+                bmax[a] = std::max(bmax[a], p[a]);
+            }
+        }
+        assert(cluster.bound.min() == bmin && cluster.bound.max() == bmax);
+    }
+    assert(face_offset == result.face_ids.size() && vertex_offset == result.vertex_ids.size());
+}
+
+// Average number of faces and diagonal of bounds per cluster
+static pair<float, float> clusterLocality(const MeshClusters& result)
+{
+    double diagonal = 0.0;
+    for (const MeshCluster& cluster : result.clusters)
+        diagonal += length(cluster.bound.max() - cluster.bound.min());
+    return { static_cast<float>(result.face_ids.size()) / result.clusters.size(), static_cast<float>(diagonal / result.clusters.size()) };
+}
+
+static void testClusters()
+{
+    const MeshClusterSettings settings;
+
+    // Large enough to be clustered in multiple ranges
+    const TriangleMesh sphere = uvSphere(512, 256);
+    const MeshClusters sphere_clusters = buildMeshClusters(sphere, settings);
+    checkClusters(sphere, sphere_clusters, settings);
+
+    // Clusters fill most of the limits and stay compact, regardless of the order of faces
+    TriangleMesh grid = gridSoup(256, 0.0f, 3);
+    weldVertices(grid);
+    const TriangleMesh scanned = shuffled(grid, 4);
+    const TriangleMesh* meshes[] = { &grid, &scanned };
+    for (const TriangleMesh* mesh : meshes)
+    {
+        const MeshClusters result = buildMeshClusters(*mesh, settings);
+        checkClusters(*mesh, result, settings);
+        const auto [faces_per_cluster, diagonal] = clusterLocality(result);
+        cout << "clusters: " << result.clusters.size() << ", " << faces_per_cluster << " faces/cluster, diagonal " << diagonal << endl;
+        // A square patch of 64 positions has 98 triangles and a diagonal of 7 quads (9.9)
+        assert(faces_per_cluster > 80.0f);
+        assert(diagonal < 16.0f);
+    }
+
+    // Unconnected triangles are packed along the curve
+    const TriangleMesh soup = gridSoup(64, 0.0f, 5);
+    const MeshClusters soup_clusters = buildMeshClusters(soup, settings);
+    checkClusters(soup, soup_clusters, settings);
+    assert(clusterLocality(soup_clusters).first > 18.0f);
+
+    // Small clusters and one triangle
+    MeshClusterSettings small_settings;
+    small_settings.max_triangles = 8;
+    small_settings.max_vertices = 6;
+    checkClusters(grid, buildMeshClusters(grid, small_settings), small_settings);
+    const TriangleMesh triangle(grid.vertices(), { grid.faceAt(0) }, {}, {});
+    assert(buildMeshClusters(triangle).clusters.size() == 1);
+    assert(buildMeshClusters(TriangleMesh()).clusters.empty());
+
+    // Parts cover the same faces with the same attributes and SBT indices
+    constexpr uint32_t max_faces = 10000;
+    const MeshClusters grid_clusters = buildMeshClusters(grid, settings);
+    const auto parts = splitMeshByClusters(grid, grid_clusters, max_faces);
+    assert(parts.size() > 1);
+    vector<Vec3f> vertices, normals;
+    vector<Vec2f> texcoords;
+    vector<Face> faces;
+    vector<uint32_t> sbt_indices;
+    for (const auto& part : parts)
+    {
+        // Every part but the last is filled up to a cluster
+        assert(part->numFaces() <= max_faces);
+        assert(part == parts.back() || part->numFaces() > max_faces - settings.max_triangles);
+        assert(part->sbtIndices().size() == part->numFaces());
+        assert(part->numMaterials() == 3);
+        for (Face face : part->faces())
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                assert(face.vertex_id[k] < static_cast<int32_t>(part->numVertices()));
+                face.vertex_id[k] += static_cast<int32_t>(vertices.size());
+                face.normal_id[k] += static_cast<int32_t>(normals.size());
+                face.texcoord_id[k] += static_cast<int32_t>(texcoords.size());
+            }
+            faces.emplace_back(face);
+        }
+        vertices.insert(vertices.end(), part->vertices().begin(), part->vertices().end());
+        normals.insert(normals.end(), part->normals().begin(), part->normals().end());
+        texcoords.insert(texcoords.end(), part->texcoords().begin(), part->texcoords().end());
+        sbt_indices.insert(sbt_indices.end(), part->sbtIndices().begin(), part->sbtIndices().end());
+    }
+    assert(faceSignatures(TriangleMesh(vertices, faces, normals, texcoords, sbt_indices)) == faceSignatures(grid));
+}
+
+int main()
+{
+    testWeld();
+    testReorder();
+    testSimplify();
+    testClusters();
+
+    constexpr int n = 1000;
+    TriangleMesh mesh = gridSoup(n, 1e-4f, 5);
+    MeshWeldSettings settings;
+    settings.position_tolerance = 1e-3f;
+    auto t0 = chrono::high_resolution_clock::now();
+    const MeshWeldStats stats = weldVertices(mesh, settings);
+    auto t1 = chrono::high_resolution_clock::now();
+    cout << "weld " << stats.num_vertices_before << " -> " << stats.num_vertices_after << " vertices: "
+         << chrono::duration<double, milli>(t1 - t0).count() << " ms" << endl;
+
+    // Attribute fetches of a shuffled mesh before and after reordering
+    TriangleMesh grid = gridSoup(700, 0.0f, 8);
+    weldVertices(grid);
+    const TriangleMesh scanned = shuffled(grid, 9);
+    benchmarkAttributeFetch("attribute fetch (shuffled)", scanned);
+    for (auto [label, curve] : { make_pair("morton", SpaceFillingCurve::Morton), make_pair("hilbert", SpaceFillingCurve::Hilbert) })
+    {
+        TriangleMesh reordered = scanned;
+        MeshReorderSettings reorder_settings;
+        reorder_settings.curve = curve;
+        t0 = chrono::high_resolution_clock::now();
+        reorderMesh(reordered, reorder_settings);
+        t1 = chrono::high_resolution_clock::now();
+        cout << "reorder (" << label << ", " << reordered.numFaces() << " faces): " << chrono::duration<double, milli>(t1 - t0).count() << " ms" << endl;
+        benchmarkAttributeFetch((string("attribute fetch (") + label + ")").c_str(), reordered);
+    }
+
+    const TriangleMesh dense_sphere = uvSphere(1024, 512);
+    for (uint32_t num_clusters : { 1u, 0u })
+    {
+        MeshSimplifySettings simplify_settings;
+        simplify_settings.num_clusters = num_clusters;
+        t0 = chrono::high_resolution_clock::now();
+        const auto simplified = simplifyMesh(dense_sphere, dense_sphere.numFaces() / 10, simplify_settings);
+        t1 = chrono::high_resolution_clock::now();
+        cout << "simplify (" << (num_clusters == 1 ? "single cluster" : "clusters") << ") " << dense_sphere.numFaces() << " -> "
+             << simplified->numFaces() << " faces: " << chrono::duration<double, milli>(t1 - t0).count() << " ms" << endl;
+    }
+
+    // Clustering a mesh with 1M faces
+    t0 = chrono::high_resolution_clock::now();
+    const MeshClusters clusters = buildMeshClusters(dense_sphere);
+    t1 = chrono::high_resolution_clock::now();
+    cout << "clusters (" << dense_sphere.numFaces() << " faces -> " << clusters.clusters.size() << " clusters): "
+         << chrono::duration<double, milli>(t1 - t0).count() << " ms" << endl;
+
+    cout << "meshopt: all tests passed" << endl;
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <prayground/shape/primitivemesh.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <map>
+
+using namespace std;
+using namespace prayground;
+
+namespace {
+    Vec3f faceCentroid(const TriangleMesh& mesh, const Face& face)
+    {
+        return (mesh.vertexAt(face.vertex_id[0]) + mesh.vertexAt(face.vertex_id[1]) + mesh.vertexAt(face.vertex_id[2])) / 3.0f;
+    }
+
+    // Every index refers to an element of its buffer, and texcoords share the indices with positions
+    void checkIndices(const TriangleMesh& mesh)
+    {
+        assert(mesh.numTexcoords() == mesh.numVertices());
+        for (const Face& face : mesh.faces())
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                assert(face.vertex_id[k] >= 0 && face.vertex_id[k] < static_cast<int32_t>(mesh.numVertices()));
+                assert(face.normal_id[k] >= 0 && face.normal_id[k] < static_cast<int32_t>(mesh.numNormals()));
+                assert(face.texcoord_id[k] == face.vertex_id[k]);
+            }
+            assert(face.vertex_id[0] != face.vertex_id[1] && face.vertex_id[1] != face.vertex_id[2] && face.vertex_id[2] != face.vertex_id[0]);
+        }
+    }
+
+    // Every edge is shared by exactly two faces in the opposite directions
+    bool isClosed(const TriangleMesh& mesh)
+    {
+        map<pair<int32_t, int32_t>, int> edges;
+        for (const Face& face : mesh.faces())
+            for (int k = 0; k < 3; k++)
+                edges[{ face.vertex_id[k], face.vertex_id[(k + 1) % 3] }]++;
+        for (const auto& [edge, count] : edges)
+        {
+            auto opposite = edges.find({ edge.second, edge.first });
+            if (count != 1 || opposite == edges.end() || opposite->second != 1)
+                return false;
+        }
+        return true;
+    }
+
+    // Normals of the faces point away from the axis or the center
+    void checkOutwardNormals(const TriangleMesh& mesh, const Vec3f& scale)
+    {
+        for (const Face& face : mesh.faces())
+        {
+            const Vec3f n = mesh.normalAt(face.normal_id[0]);
+            assert(fabsf(length(n) - 1.0f) < 1e-5f);
+            assert(dot(n, faceCentroid(mesh, face) * scale) > 0.0f);
+        }
+    }
+} // nonamed namespace
+
+static void testIcoSphere()
+{
+    constexpr float radius = 2.0f;
+    for (int level = 0; level <= 5; level++)
+    {
+        const IcoSphereMesh mesh(radius, level);
+        const uint32_t num_faces = 20u << (2 * level);
+        assert(mesh.numFaces() == num_faces);
+        assert(mesh.numVertices() == num_faces / 2 + 2);
+        checkIndices(mesh);
+        assert(isClosed(mesh));
+        checkOutwardNormals(mesh, Vec3f(1.0f));
+        for (const Vec3f& v : mesh.vertices())
+            assert(fabsf(length(v) - radius) < 1e-5f * radius);
+    }
+
+    // Subdividing later gives the same mesh as subdividing in the constructor
+    IcoSphereMesh subdivided(radius, 2);
+    subdivided.subdivide(1);
+    const IcoSphereMesh direct(radius, 3);
+    assert(subdivided.vertices() == direct.vertices());
+    assert(subdivided.numFaces() == direct.numFaces());
+    for (uint32_t i = 0; i < direct.numFaces(); i++)
+        assert(subdivided.faceAt(i).vertex_id == direct.faceAt(i).vertex_id);
+}
+
+static void testUVSphere()
+{
+    const Vec2ui resolution(16, 8);
+    const UVSphereMesh mesh(1.0f, resolution);
+    assert(mesh.numVertices() == resolution.x() * (resolution.y() - 1) + 2);
+    assert(mesh.numFaces() == 2 * resolution.x() * (resolution.y() - 1));
+    checkIndices(mesh);
+    assert(isClosed(mesh));
+    checkOutwardNormals(mesh, Vec3f(1.0f));
+    for (const Vec3f& v : mesh.vertices())
+        assert(fabsf(length(v) - 1.0f) < 1e-5f);
+}
+
+static void testCylinder()
+{
+    const Vec2ui resolution(12, 4);
+    const CylinderMesh mesh(1.0f, 2.0f, resolution);
+    assert(mesh.numVertices() == resolution.x() * (resolution.y() + 1) + 2);
+    assert(mesh.numFaces() == 2 * resolution.x() * (resolution.y() + 1));
+    checkIndices(mesh);
+    for (const Face& face : mesh.faces())
+    {
+        const Vec3f n = mesh.normalAt(face.normal_id[0]);
+        const Vec3f c = faceCentroid(mesh, face);
+        // Caps face along the axis, and the side faces away from it
+        if (fabsf(n[1]) > 0.5f)
+            assert(n[1] * c[1] > 0.0f && fabsf(fabsf(c[1]) - 1.0f) < 1e-5f);
+        else
+            assert(dot(n, Vec3f(c[0], 0.0f, c[2])) > 0.0f);
+    }
+}
+
+static void testPlane()
+{
+    for (Axis axis : { Axis::X, Axis::Y, Axis::Z })
+    {
+        const Vec2f size(4.0f, 2.0f);
+        const Vec2ui resolution(8, 3);
+        const PlaneMesh mesh(size, resolution, axis);
+        assert(mesh.numVertices() == (resolution.x() + 1) * (resolution.y() + 1));
+        assert(mesh.numFaces() == 2 * resolution.x() * resolution.y());
+        checkIndices(mesh);
+
+        float area = 0.0f;
+        for (const Face& face : mesh.faces())
+        {
+            const Vec3f& p0 = mesh.vertexAt(face.vertex_id[0]);
+            const Vec3f c = cross(mesh.vertexAt(face.vertex_id[1]) - p0, mesh.vertexAt(face.vertex_id[2]) - p0);
+            area += 0.5f * length(c);
+            // Geometric normals agree with the shading normal up to the sign, which is the same for all faces
+            assert(fabsf(dot(normalize(c), mesh.normalAt(face.normal_id[0]))) > 0.999f);
+        }
+        assert(fabsf(area - size.x() * size.y()) < 1e-4f);
+        for (const Vec3f& v : mesh.vertices())
+            assert(v[static_cast<int>(axis)] == 0.0f);
+    }
+}
+
+int main()
+{
+    testIcoSphere();
+    testUVSphere();
+    testCylinder();
+    testPlane();
+
+    auto time = [](const string& label, auto&& func)
+    {
+        auto t0 = chrono::high_resolution_clock::now();
+        const uint32_t num_faces = func();
+        auto t1 = chrono::high_resolution_clock::now();
+        cout << label << " (" << num_faces << " faces): " << chrono::duration<double, milli>(t1 - t0).count() << " ms" << endl;
+    };
+    for (int level : { 6, 7, 8 })
+        time("icosphere level " + to_string(level), [&] { return IcoSphereMesh(1.0f, level).numFaces(); });
+    for (uint32_t res : { 256u, 1024u, 2048u })
+        time("uv sphere " + to_string(res) + "x" + to_string(res / 2), [&] { return UVSphereMesh(1.0f, Vec2ui(res, res / 2)).numFaces(); });
+    for (uint32_t res : { 1024u, 2048u, 4096u })
+        time("plane " + to_string(res) + "x" + to_string(res), [&] { return PlaneMesh(Vec2f(10.0f), Vec2ui(res, res)).numFaces(); });
+
+    cout << "primitivemesh: all tests passed" << endl;
+    return 0;
+}